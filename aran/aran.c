@@ -28,6 +28,16 @@
  * #AranSolver.
  */
 
+/**
+ * AranParticleRole:
+ * @ARAN_PARTICLE_SOURCE: particle generates field.
+ * @ARAN_PARTICLE_TARGET: particle receives field.
+ * @ARAN_PARTICLE_SOURCE_TARGET: both.
+ *
+ * Particle roles flags used to restrict FMM operators to the required
+ * computations (see aran_solver3d_set_roles()).
+ */
+
 /**
  * gcomplex64:
  *
@@ -59,6 +69,11 @@ void aran_solver3d_init ();
  */
 void aran_init()
 {
+#if !GLIB_CHECK_VERSION (2, 32, 0)
+  /* threaded solvers and thread safe coefficient tables need it */
+  if (! g_thread_supported ()) g_thread_init (NULL);
+#endif
+
   g_type_init ();
 
   aran_solver2d_init ();
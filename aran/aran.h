@@ -26,6 +26,14 @@ G_BEGIN_DECLS;
 
 typedef void (*AranZeroFunc) (gpointer devel);
 
+typedef enum _AranParticleRole AranParticleRole;
+
+enum _AranParticleRole {
+  ARAN_PARTICLE_SOURCE = 1 << 0,
+  ARAN_PARTICLE_TARGET = 1 << 1,
+  ARAN_PARTICLE_SOURCE_TARGET = ARAN_PARTICLE_SOURCE | ARAN_PARTICLE_TARGET,
+};
+
 void aran_init();
 
 G_END_DECLS;
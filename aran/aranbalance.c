@@ -0,0 +1,188 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "aran-config.h"
+
+#include "aranbalance.h"
+
+#ifdef VSG_HAVE_MPI
+
+/**
+ * AranBalance:
+ *
+ * Opaque structure. Possesses only private data.
+ *
+ * Repartitioning policy of a parallel solver. Every step, the work of the
+ * slowest processor exceeds the mean work by some amount that a perfect
+ * repartitioning would save. #AranBalance accumulates this loss since the
+ * last repartitioning and asks for a new one as soon as it outweighs the
+ * time a repartitioning takes.
+ */
+struct _AranBalance
+{
+  MPI_Comm communicator;
+  gint sz;
+
+  gdouble tolerance;
+  gdouble migration_time;
+
+  gdouble max;
+  gdouble mean;
+  gdouble loss;
+};
+
+/**
+ * aran_balance_new:
+ * @communicator: the communicator of the solver.
+ * @tolerance: relative imbalance ignored by the policy.
+ *
+ * Creates a new repartitioning policy. Steps where the maximum work stays
+ * below (1 + @tolerance) times the mean work are not accounted for as
+ * losses. Until a first repartitioning is measured, its time is assumed to
+ * be zero, so that the first noticeable imbalance triggers it.
+ *
+ * Returns: newly allocated #AranBalance.
+ */
+AranBalance *aran_balance_new (MPI_Comm communicator, gdouble tolerance)
+{
+  AranBalance *balance = g_malloc (sizeof (AranBalance));
+
+  balance->communicator = communicator;
+  MPI_Comm_size (communicator, &balance->sz);
+
+  balance->tolerance = tolerance;
+  balance->migration_time = 0.;
+
+  balance->max = 0.;
+  balance->mean = 0.;
+  balance->loss = 0.;
+
+  return balance;
+}
+
+/**
+ * aran_balance_free:
+ * @balance: an #AranBalance.
+ *
+ * Deallocates @balance.
+ */
+void aran_balance_free (AranBalance *balance)
+{
+  g_return_if_fail (balance != NULL);
+
+  g_free (balance);
+}
+
+/**
+ * aran_balance_set_migration_time:
+ * @balance: an #AranBalance.
+ * @migration_time: estimated repartitioning time in seconds.
+ *
+ * Sets the repartitioning cost estimate used before any repartitioning is
+ * measured by aran_balance_done().
+ */
+void aran_balance_set_migration_time (AranBalance *balance,
+                                      gdouble migration_time)
+{
+  g_return_if_fail (balance != NULL);
+
+  balance->migration_time = migration_time;
+}
+
+/**
+ * aran_balance_step:
+ * @balance: an #AranBalance.
+ * @work: time spent by the calling processor during the last step.
+ *
+ * Collective call recording the work of every processor for one step.
+ */
+void aran_balance_step (AranBalance *balance, gdouble work)
+{
+  gdouble sum;
+
+  g_return_if_fail (balance != NULL);
+
+  MPI_Allreduce (&work, &balance->max, 1, MPI_DOUBLE, MPI_MAX,
+                 balance->communicator);
+  MPI_Allreduce (&work, &sum, 1, MPI_DOUBLE, MPI_SUM, balance->communicator);
+
+  balance->mean = sum / balance->sz;
+
+  /* time a perfect repartitioning would have saved during this step */
+  if (balance->max > (1. + balance->tolerance) * balance->mean)
+    balance->loss += balance->max - balance->mean;
+}
+
+/**
+ * aran_balance_needed:
+ * @balance: an #AranBalance.
+ *
+ * Tells whether repartitioning is worth its cost: the losses accumulated
+ * since the last repartitioning are compared with the repartitioning time.
+ * This answer is the same on every processor.
+ *
+ * Returns: %TRUE when a repartitioning should be done.
+ */
+gboolean aran_balance_needed (AranBalance *balance)
+{
+  g_return_val_if_fail (balance != NULL, FALSE);
+
+  return balance->loss > 0. && balance->loss >= balance->migration_time;
+}
+
+/**
+ * aran_balance_done:
+ * @balance: an #AranBalance.
+ * @migration_time: time spent by the calling processor in repartitioning.
+ *
+ * Collective call recording a repartitioning. The slowest processor time
+ * becomes the new repartitioning cost estimate and accumulated losses are
+ * cleared.
+ */
+void aran_balance_done (AranBalance *balance, gdouble migration_time)
+{
+  g_return_if_fail (balance != NULL);
+
+  MPI_Allreduce (&migration_time, &balance->migration_time, 1, MPI_DOUBLE,
+                 MPI_MAX, balance->communicator);
+
+  balance->loss = 0.;
+}
+
+/**
+ * aran_balance_get_imbalance:
+ * @balance: an #AranBalance.
+ * @max: result for the maximum work of the last step or %NULL.
+ * @mean: result for the mean work of the last step or %NULL.
+ * @loss: result for the losses accumulated since the last repartitioning
+ * or %NULL.
+ *
+ * Queries @balance state.
+ */
+void aran_balance_get_imbalance (AranBalance *balance, gdouble *max,
+                                 gdouble *mean, gdouble *loss)
+{
+  g_return_if_fail (balance != NULL);
+
+  if (max != NULL) *max = balance->max;
+  if (mean != NULL) *mean = balance->mean;
+  if (loss != NULL) *loss = balance->loss;
+}
+
+#endif /* VSG_HAVE_MPI */
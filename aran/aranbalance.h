@@ -0,0 +1,55 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __ARAN_BALANCE_H__
+#define __ARAN_BALANCE_H__
+
+#include <glib.h>
+
+#include <vsg/vsgd.h>
+
+G_BEGIN_DECLS;
+
+#ifdef VSG_HAVE_MPI
+
+/* typedefs */
+typedef struct _AranBalance AranBalance;
+
+/* functions */
+AranBalance *aran_balance_new (MPI_Comm communicator, gdouble tolerance);
+
+void aran_balance_free (AranBalance *balance);
+
+void aran_balance_set_migration_time (AranBalance *balance,
+                                      gdouble migration_time);
+
+void aran_balance_step (AranBalance *balance, gdouble work);
+
+gboolean aran_balance_needed (AranBalance *balance);
+
+void aran_balance_done (AranBalance *balance, gdouble migration_time);
+
+void aran_balance_get_imbalance (AranBalance *balance, gdouble *max,
+                                 gdouble *mean, gdouble *loss);
+
+#endif /* VSG_HAVE_MPI */
+
+G_END_DECLS;
+
+#endif /* __ARAN_BALANCE_H__ */
@@ -40,6 +40,7 @@ gdouble aran_slow_binomial (guint n, guint p)
 }
 
 static AranBinomialBufferd *_binomial = NULL;
+G_LOCK_DEFINE_STATIC (binomial);
 
 static gdouble _binomial_generator (guint l, guint m, AranBinomialBufferd *buf)
 {
@@ -91,17 +92,29 @@ gdouble aran_fast_binomial (guint n, guint p)
  * Preallocates binomial coefficients up to n=@max. Calling this for a
  * sufficiently large @max can improve your program efficiency, since
  * successive calls with slowly increasing values of @max can lead to
- * numerous buffer reallocations.
+ * numerous buffer reallocations. This function is thread safe.
  */
 void aran_binomial_require (guint max)
 {
-  if (_binomial == NULL)
+  if (g_atomic_pointer_get (&_binomial) == NULL)
     {
-      _binomial = aran_binomial_bufferd_new (_binomial_generator, max);
-      g_atexit (_binomial_atexit);
-    }
-  else
-    {
-      aran_binomial_bufferd_require (_binomial, max);
+      AranBinomialBufferd *buf =
+        aran_binomial_bufferd_new (_binomial_generator, max);
+
+      G_LOCK (binomial);
+
+      if (_binomial == NULL)
+        {
+          g_atomic_pointer_set (&_binomial, buf);
+          buf = NULL;
+
+          g_atexit (_binomial_atexit);
+        }
+
+      G_UNLOCK (binomial);
+
+      aran_binomial_bufferd_free (buf);
     }
+
+  aran_binomial_bufferd_require (_binomial, max);
 }
@@ -19,6 +19,8 @@
 
 #include "aranbinomialbuffer@t@.h"
 
+#include <string.h>
+
 /**
  * AranBinomialBuffer@t@: 
  *
@@ -30,8 +32,24 @@ struct _AranBinomialBuffer@t@ {
   @type@ *buffer;
   @type@ **direct;
   AranBinomialBuffer@t@Generator generator;
+  GSList *retired;
 };
 
+/* protects buffers growth. Superseded arrays are kept until the buffer is
+ * freed because other threads may still be reading them.
+ */
+G_LOCK_DEFINE_STATIC (binomial_buffer@t@);
+
+static void _retired_free (GSList *retired)
+{
+  GSList *l;
+
+  for (l = retired; l != NULL; l = l->next)
+    g_free (l->data);
+
+  g_slist_free (retired);
+}
+
 /**
  * AranBinomialBuffer@t@Generator: 
  * @l: degree of term.
@@ -68,6 +86,7 @@ aran_binomial_buffer@t@_new (AranBinomialBuffer@t@Generator generator,
   ret->generator = generator;
   ret->buffer = NULL;
   ret->direct = NULL;
+  ret->retired = NULL;
 
   aran_binomial_buffer@t@_require (ret, l);
 
@@ -90,6 +109,8 @@ void aran_binomial_buffer@t@_free (AranBinomialBuffer@t@ *buf)
       if (buf->direct != NULL)
         g_free (buf->direct);
 
+      _retired_free (buf->retired);
+
       buf->buffer = NULL;
       buf->direct = NULL;
 
@@ -102,40 +123,76 @@ void aran_binomial_buffer@t@_free (AranBinomialBuffer@t@ *buf)
  * @buf: an #AranBinomialBuffer@t@.
  * @max: a #guint.
  *
- * Preallocates @buf coefficients up to n=@max. 
+ * Preallocates @buf coefficients up to n=@max. This function is thread
+ * safe: growth is computed aside and terms already available are never
+ * moved for concurrent readers.
  */
 void aran_binomial_buffer@t@_require (AranBinomialBuffer@t@ *buf,
                                       guint max)
 {
+  AranBinomialBuffer@t@ tmp;
   guint l, size;
   gint i, j, oldl;
 
   g_return_if_fail (buf != NULL);
 
-  if (buf->l >= (gint) max) return;
+  oldl = g_atomic_int_get (&buf->l);
 
-  l = MAX (buf->l, 1);
+  if (oldl >= (gint) max) return;
+
+  l = MAX (oldl, 1);
 
   while (l < (gint) max) l *= 2;
 
   size = ((l+1)*(l+2))/2;
 
-  buf->direct = g_realloc (buf->direct, (l+1) * sizeof (@type@ *));
-  buf->buffer = g_realloc (buf->buffer, size * sizeof (@type@));
+  /* @tmp is already sized for recursive generators */
+  tmp.l = l;
+  tmp.generator = buf->generator;
+  tmp.retired = NULL;
+  tmp.direct = g_malloc ((l+1) * sizeof (@type@ *));
+  tmp.buffer = g_malloc (size * sizeof (@type@));
+
+  if (oldl >= 0)
+    memcpy (tmp.buffer, g_atomic_pointer_get (&buf->buffer),
+            (((oldl+1)*(oldl+2))/2) * sizeof (@type@));
 
   for (i=0; i<=l; i ++)
     {
-      buf->direct[i] = buf->buffer + (i*(i+1))/2;
+      tmp.direct[i] = tmp.buffer + (i*(i+1))/2;
     }
 
-  oldl = buf->l;
-  buf->l = l;
-
   for (i=oldl+1; i<=l; i ++)
     {
       for (j=0; j<=i; j ++)
-        buf->direct[i][j] = buf->generator (i, j, buf);
+        tmp.direct[i][j] = tmp.generator (i, j, &tmp);
     }
+
+  G_LOCK (binomial_buffer@t@);
+
+  if (buf->l < tmp.l)
+    {
+      if (buf->buffer != NULL)
+        {
+          buf->retired = g_slist_prepend (buf->retired, buf->buffer);
+          buf->retired = g_slist_prepend (buf->retired, buf->direct);
+        }
+
+      g_atomic_pointer_set (&buf->buffer, tmp.buffer);
+      g_atomic_pointer_set (&buf->direct, tmp.direct);
+      buf->retired = g_slist_concat (tmp.retired, buf->retired);
+
+      g_atomic_int_set (&buf->l, tmp.l);
+    }
+  else
+    {
+      /* another thread was faster */
+      g_free (tmp.buffer);
+      g_free (tmp.direct);
+      _retired_free (tmp.retired);
+    }
+
+  G_UNLOCK (binomial_buffer@t@);
 }
 
 /**
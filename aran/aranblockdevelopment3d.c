@@ -0,0 +1,1195 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "aranblockdevelopment3d.h"
+
+#include "aransphericalharmonic.h"
+#include "aransphericalseriesd.h"
+#include "aransphericalseriesd-private.h"
+
+#include <string.h>
+#include <math.h>
+
+/**
+ * ARAN_TYPE_BLOCK_DEVELOPMENT3D:
+ *
+ * #AranBlockDevelopment3d #GBoxed #GType.
+ */
+
+/**
+ * AranBlockDevelopment3d:
+ * @posdeg: Local expansion degree.
+ * @negdeg: Multipole expansion degree.
+ * @block_size: number of right hand sides.
+ * @multipole: Multipole expansions coefficients.
+ * @local: Local expansions coefficients.
+ *
+ * A structure used as #VsgPRTree3d node_data within an #AranSolver3d in
+ * order to solve @block_size problems sharing the same geometry at
+ * once. Coefficients of the @block_size expansions are interleaved: the
+ * @block_size values of a given term are stored contiguously. This way,
+ * translation operators compute their geometric factors once and apply them
+ * to every right hand side.
+ */
+
+static inline gsize _multipole_size (guint8 negdeg)
+{
+  return (negdeg * (negdeg + 1)) / 2;
+}
+
+static inline gsize _local_size (guint8 posdeg)
+{
+  return ((posdeg + 1) * (posdeg + 2)) / 2;
+}
+
+static inline gcomplex128 *
+_block_multipole_term (const AranBlockDevelopment3d *abd, guint l, guint m)
+{
+  return abd->multipole + ((l * (l + 1)) / 2 + m) * abd->block_size;
+}
+
+static inline gcomplex128 *
+_block_local_term (const AranBlockDevelopment3d *abd, guint l, guint m)
+{
+  return abd->local + ((l * (l + 1)) / 2 + m) * abd->block_size;
+}
+
+/* functions */
+
+GType aran_block_development3d_get_type ()
+{
+  static GType devtype = G_TYPE_NONE;
+
+  if (G_UNLIKELY (devtype == G_TYPE_NONE))
+    {
+      devtype =
+	g_boxed_type_register_static ("AranBlockDevelopment3d",
+				      (GBoxedCopyFunc)
+                                      aran_block_development3d_clone,
+				      (GBoxedFreeFunc)
+                                      aran_block_development3d_free);
+    }
+
+  return devtype;
+}
+
+/**
+ * aran_block_development3d_new:
+ * @posdeg: a #guint8.
+ * @negdeg: a #guint8.
+ * @block_size: number of right hand sides.
+ *
+ * Allocates a new #AranBlockDevelopment3d structure holding @block_size
+ * multipole expansions of degree @negdeg and @block_size local expansions of
+ * degree MAX (@posdeg, @negdeg), the same way aran_development3d_new() does
+ * for a single right hand side.
+ *
+ * Returns: newly allocated structure.
+ */
+AranBlockDevelopment3d *aran_block_development3d_new (guint8 posdeg,
+                                                      guint8 negdeg,
+                                                      guint block_size)
+{
+  AranBlockDevelopment3d *result;
+  guint8 locdeg = MAX (posdeg, negdeg);
+
+  g_return_val_if_fail (block_size > 0, NULL);
+
+  result =
+    (AranBlockDevelopment3d *) g_malloc (sizeof (AranBlockDevelopment3d));
+
+  /* ensure alpha and beta coefficients are initialized */
+  aran_spherical_seriesd_free (aran_spherical_seriesd_new (locdeg, negdeg));
+
+  result->posdeg = locdeg;
+  result->negdeg = negdeg;
+  result->block_size = block_size;
+
+  result->multipole = g_malloc0 (_multipole_size (negdeg) * block_size *
+                                 sizeof (gcomplex128));
+  result->local = g_malloc0 (_local_size (locdeg) * block_size *
+                             sizeof (gcomplex128));
+
+  return result;
+}
+
+/**
+ * aran_block_development3d_free:
+ * @abd: an #AranBlockDevelopment3d.
+ *
+ * Deallocates @abd and all associated memory.
+ */
+void aran_block_development3d_free (AranBlockDevelopment3d *abd)
+{
+  g_free (abd->multipole);
+  g_free (abd->local);
+  g_free (abd);
+}
+
+/**
+ * aran_block_development3d_copy:
+ * @src: an #AranBlockDevelopment3d.
+ * @dst: an #AranBlockDevelopment3d.
+ *
+ * Copies @src into @dst. Development degrees and block sizes must coincide.
+ */
+void aran_block_development3d_copy (const AranBlockDevelopment3d *src,
+                                    AranBlockDevelopment3d *dst)
+{
+  g_return_if_fail (src != NULL);
+  g_return_if_fail (dst != NULL);
+  g_return_if_fail (src->posdeg == dst->posdeg &&
+                    src->negdeg == dst->negdeg &&
+                    src->block_size == dst->block_size);
+
+  memcpy (dst->multipole, src->multipole,
+          _multipole_size (src->negdeg) * src->block_size *
+          sizeof (gcomplex128));
+  memcpy (dst->local, src->local,
+          _local_size (src->posdeg) * src->block_size * sizeof (gcomplex128));
+}
+
+/**
+ * aran_block_development3d_clone:
+ * @src: an #AranBlockDevelopment3d.
+ *
+ * Duplicates @src.
+ *
+ * Returns: newly allocated copy of @src.
+ */
+AranBlockDevelopment3d *
+aran_block_development3d_clone (AranBlockDevelopment3d *src)
+{
+  AranBlockDevelopment3d *dst;
+
+  g_return_val_if_fail (src != NULL, NULL);
+
+  dst = aran_block_development3d_new (src->posdeg, src->negdeg,
+                                      src->block_size);
+
+  aran_block_development3d_copy (src, dst);
+
+  return dst;
+}
+
+/**
+ * aran_block_development3d_set_zero:
+ * @abd: an #AranBlockDevelopment3d.
+ *
+ * Sets all @abd coefficients to zero.
+ */
+void aran_block_development3d_set_zero (AranBlockDevelopment3d *abd)
+{
+  g_return_if_fail (abd != NULL);
+
+  memset (abd->multipole, 0,
+          _multipole_size (abd->negdeg) * abd->block_size *
+          sizeof (gcomplex128));
+  memset (abd->local, 0,
+          _local_size (abd->posdeg) * abd->block_size * sizeof (gcomplex128));
+}
+
+/**
+ * aran_block_development3d_get_block_size:
+ * @abd: an #AranBlockDevelopment3d.
+ *
+ * Returns: number of right hand sides in @abd.
+ */
+guint aran_block_development3d_get_block_size (const AranBlockDevelopment3d *abd)
+{
+  g_return_val_if_fail (abd != NULL, 0);
+
+  return abd->block_size;
+}
+
+/**
+ * aran_block_development3d_get_multipole_term:
+ * @abd: an #AranBlockDevelopment3d.
+ * @l: a #guint. Condition @l < @abd->negdeg must hold.
+ * @m: a #guint. Condition @m <= @l must hold.
+ *
+ * Provides access to the @abd->block_size multipole coefficients of
+ * degree @l and order @m.
+ *
+ * Returns: address of the first coefficient.
+ */
+gcomplex128 *
+aran_block_development3d_get_multipole_term (AranBlockDevelopment3d *abd,
+                                             guint l, guint m)
+{
+  g_return_val_if_fail (abd != NULL, NULL);
+  g_return_val_if_fail (l < abd->negdeg && m <= l, NULL);
+
+  return _block_multipole_term (abd, l, m);
+}
+
+/**
+ * aran_block_development3d_get_local_term:
+ * @abd: an #AranBlockDevelopment3d.
+ * @l: a #guint. Condition @l <= @abd->posdeg must hold.
+ * @m: a #guint. Condition @m <= @l must hold.
+ *
+ * Provides access to the @abd->block_size local coefficients of
+ * degree @l and order @m.
+ *
+ * Returns: address of the first coefficient.
+ */
+gcomplex128 *
+aran_block_development3d_get_local_term (AranBlockDevelopment3d *abd,
+                                         guint l, guint m)
+{
+  g_return_val_if_fail (abd != NULL, NULL);
+  g_return_val_if_fail (l <= abd->posdeg && m <= l, NULL);
+
+  return _block_local_term (abd, l, m);
+}
+
+/**
+ * aran_block_development3d_write:
+ * @abd: an #AranBlockDevelopment3d.
+ * @file: output file.
+ *
+ * Writes @abd to @file.
+ */
+void aran_block_development3d_write (AranBlockDevelopment3d *abd, FILE *file)
+{
+  guint l, m, k;
+
+  g_return_if_fail (abd != NULL);
+
+  fprintf (file, "{multipole= [");
+  for (l=0; l<abd->negdeg; l ++)
+    for (m=0; m<=l; m ++)
+      {
+        gcomplex128 *term = _block_multipole_term (abd, l, m);
+
+        fprintf (file, "[%d,%d]:(", -l-1, m);
+        for (k=0; k<abd->block_size; k ++)
+          fprintf (file, "(%e,%e) ", creal (term[k]), cimag (term[k]));
+        fprintf (file, "), ");
+      }
+
+  fprintf (file, "], local= [");
+  for (l=0; l<=abd->posdeg; l ++)
+    for (m=0; m<=l; m ++)
+      {
+        gcomplex128 *term = _block_local_term (abd, l, m);
+
+        fprintf (file, "[%d,%d]:(", l, m);
+        for (k=0; k<abd->block_size; k ++)
+          fprintf (file, "(%e,%e) ", creal (term[k]), cimag (term[k]));
+        fprintf (file, "), ");
+      }
+  fprintf (file, "]}");
+}
+
+/**
+ * aran_block_development3d_p2m:
+ * @position: particle position
+ * @charges: particle charges, one for each right hand side.
+ * @dst_node: @dst tree node info.
+ * @dst: an #AranBlockDevelopment3d.
+ *
+ * compute some particle contribution to the Multipole expansions of @dst.
+ */
+void aran_block_development3d_p2m (const VsgVector3d *position,
+                                   const gdouble *charges,
+                                   const VsgPRTree3dNodeInfo *dst_node,
+                                   AranBlockDevelopment3d *dst)
+{
+  VsgVector3d tmp;
+  guint deg = dst->negdeg;
+  guint k, bs = dst->block_size;
+  gint l, m;
+  gcomplex128 harmonics[((deg+1)*(deg+2))/2];
+  gdouble r, cost, sint, cosp, sinp;
+  gcomplex128 expp;
+  gdouble fact;
+
+  vsg_vector3d_sub (position, &dst_node->center, &tmp);
+
+  vsg_vector3d_to_spherical_internal (&tmp, &r, &cost, &sint, &cosp, &sinp);
+  expp = cosp + G_I * sinp;
+
+  aran_spherical_harmonic_evaluate_multiple_internal (deg, cost, sint, expp,
+						      harmonics);
+
+  fact = 1.;
+
+  for (l=0; l<deg; l ++)
+    {
+      gcomplex128 *hterm = aran_spherical_harmonic_multiple_get_term (l, 0,
+                                                                      harmonics);
+
+      for (m=0; m<=l; m ++)
+	{
+          gcomplex128 *ptr = _block_multipole_term (dst, l, m);
+          gcomplex128 term = conj (fact * (4.*G_PI / (l+l+1.)) * hterm[m]);
+
+          for (k=0; k<bs; k ++)
+            ptr[k] += charges[k] * term;
+	}
+      fact *= r;
+    }
+}
+
+/**
+ * aran_block_development3d_p2l:
+ * @position: particle position
+ * @charges: particle charges, one for each right hand side.
+ * @dst_node: @dst tree node info.
+ * @dst: an #AranBlockDevelopment3d.
+ *
+ * compute some particle contribution to the Local expansions of @dst.
+ */
+void aran_block_development3d_p2l (const VsgVector3d *position,
+                                   const gdouble *charges,
+                                   const VsgPRTree3dNodeInfo *dst_node,
+                                   AranBlockDevelopment3d *dst)
+{
+  VsgVector3d tmp;
+  guint deg = dst->posdeg;
+  guint k, bs = dst->block_size;
+  gint l, m;
+  gcomplex128 harmonics[((deg+1)*(deg+2))/2];
+  gdouble r, cost, sint, cosp, sinp;
+  gcomplex128 expp;
+  gdouble fact, inv_r;
+
+  vsg_vector3d_sub (position, &dst_node->center, &tmp);
+
+  vsg_vector3d_to_spherical_internal (&tmp, &r, &cost, &sint, &cosp, &sinp);
+  expp = cosp + G_I * sinp;
+
+  aran_spherical_harmonic_evaluate_multiple_internal (deg, cost, sint, expp,
+                                                      harmonics);
+
+  inv_r = 1. / r;
+  fact = inv_r;
+
+  for (l=0; l<=deg; l ++)
+    {
+      gcomplex128 *hterm = aran_spherical_harmonic_multiple_get_term (l, 0,
+                                                                      harmonics);
+
+      for (m=0; m<=l; m ++)
+        {
+          gcomplex128 *ptr = _block_local_term (dst, l, m);
+          gcomplex128 term = conj (fact * (4.*G_PI / (l+l+1.)) * hterm[m]);
+
+          for (k=0; k<bs; k ++)
+            ptr[k] += charges[k] * term;
+        }
+      fact *= inv_r;
+    }
+}
+
+/*
+ * Same formula as the multipole translation of an #AranSphericalSeriesd
+ * with geometric factors shared between right hand sides.
+ */
+static void _block_multipole_translate (const AranBlockDevelopment3d *src,
+                                        AranBlockDevelopment3d *dst,
+                                        gdouble r,
+                                        gdouble cost, gdouble sint,
+                                        gdouble cosp, gdouble sinp)
+{
+  gint l, m;
+  gint n, o;
+  guint k, bs = dst->block_size;
+  gdouble rpow[dst->negdeg];
+  gdouble pow;
+  gcomplex128 *srcterm, *dstterm, *hterm;
+  gint d = MAX (src->negdeg, dst->negdeg) - 1;
+  gcomplex128 harmonics[((d + 1) * (d + 2)) / 2];
+  gcomplex128 expp = cosp + G_I * sinp;
+
+  if (dst->negdeg == 0) return;
+
+  aran_spherical_seriesd_alpha_require (d);
+  aran_spherical_seriesd_beta_require (d);
+
+  aran_spherical_harmonic_evaluate_multiple_internal (dst->negdeg - 1, cost,
+                                                      sint, expp, harmonics);
+
+  pow = 1.;
+  for (l = 0; l < dst->negdeg; l++)
+    {
+      rpow[l] = pow;
+      pow *= r;
+      for (m = 0; m <= l; m++)
+        {
+          dstterm = _block_multipole_term (dst, l, m);
+
+          for (n = 0; n <= MIN (l, src->negdeg - 1); n++)
+            {
+              gdouble normaliz = aran_spherical_seriesd_beta (l - n) *
+                aran_spherical_seriesd_beta (l) /
+                aran_spherical_seriesd_beta (n) * rpow[l - n];
+
+              hterm = aran_spherical_harmonic_multiple_get_term (l - n, 0,
+                                                                 harmonics);
+
+              for (o = MAX (-n, m + n - l); o <= MIN (n, l + m - n); o++)
+                {
+                  guint abs_m_m_o = ABS (m - o);
+                  gdouble factor =
+                    aran_spherical_seriesd_alpha (l - n, abs_m_m_o) *
+                    aran_spherical_seriesd_alpha (n, ABS (o)) /
+                    aran_spherical_seriesd_alpha (l, ABS (m));
+
+                  gcomplex128 h = conj (hterm[abs_m_m_o]);
+
+                  /* h=conj ( Y_(l-n)^(m-o) ) */
+                  if ((m - o) < 0)
+                    h = _sph_sym (h, abs_m_m_o);
+
+                  h *= factor * normaliz;
+
+                  srcterm = _block_multipole_term (src, n, ABS (o));
+
+                  if (o >= 0)
+                    for (k = 0; k < bs; k++)
+                      dstterm[k] += h * srcterm[k];
+                  else
+                    for (k = 0; k < bs; k++)
+                      dstterm[k] += h * _sph_sym (srcterm[k], -o);
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Same formula as the local translation of an #AranSphericalSeriesd
+ * with geometric factors shared between right hand sides.
+ */
+static void _block_local_translate (const AranBlockDevelopment3d *src,
+                                    AranBlockDevelopment3d *dst,
+                                    gdouble r,
+                                    gdouble cost, gdouble sint,
+                                    gdouble cosp, gdouble sinp)
+{
+  gint l, m;
+  gint n, o;
+  guint k, bs = dst->block_size;
+  gdouble rpow[src->posdeg + 1];
+  gdouble pow;
+  gcomplex128 *srcterm, *dstterm, *hterm;
+  gint d = MAX (src->posdeg, dst->posdeg);
+  gcomplex128 harmonics[((d + 1) * (d + 2)) / 2];
+  gcomplex128 expp = cosp + G_I * sinp;
+
+  aran_spherical_seriesd_beta_require (d);
+  aran_spherical_seriesd_alpha_require (d);
+
+  aran_spherical_harmonic_evaluate_multiple_internal (src->posdeg, cost, sint,
+                                                      expp, harmonics);
+
+  pow = 1.;
+  for (l = 0; l <= src->posdeg; l++)
+    {
+      rpow[l] = pow;
+      pow *= r;
+    }
+
+  for (l = 0; l <= dst->posdeg; l++)
+    {
+      for (m = 0; m <= l; m++)
+        {
+          dstterm = _block_local_term (dst, l, m);
+
+          for (n = l; n <= src->posdeg; n++)
+            {
+              gdouble normaliz = aran_spherical_seriesd_beta (n - l) *
+                aran_spherical_seriesd_beta (l) /
+                aran_spherical_seriesd_beta (n) * rpow[n - l];
+
+              hterm = aran_spherical_harmonic_multiple_get_term (n - l, 0,
+                                                                 harmonics);
+
+              for (o = l + m - n; o <= m + n - l; o++)
+                {
+                  gint o_m_m = o - m;
+                  guint abs_o_m_m = ABS (o_m_m);
+
+                  gdouble factor =
+                    aran_spherical_seriesd_alpha (n - l, abs_o_m_m) *
+                    aran_spherical_seriesd_alpha (l, ABS (m)) /
+                    aran_spherical_seriesd_alpha (n, ABS (o));
+
+                  gcomplex128 h = hterm[abs_o_m_m];
+
+                  /* h = Y_(n-l)^(o-m) */
+                  if (o_m_m < 0)
+                    h = _sph_sym (h, abs_o_m_m);
+
+                  h *= factor * normaliz;
+
+                  srcterm = _block_local_term (src, n, ABS (o));
+
+                  if (o >= 0)
+                    for (k = 0; k < bs; k++)
+                      dstterm[k] += h * srcterm[k];
+                  else
+                    for (k = 0; k < bs; k++)
+                      dstterm[k] += h * _sph_sym (srcterm[k], -o);
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Same formula as the multipole to local transformation of an
+ * #AranSphericalSeriesd with geometric factors shared between right hand
+ * sides.
+ */
+static void _block_multipole_to_local (const AranBlockDevelopment3d *src,
+                                       AranBlockDevelopment3d *dst,
+                                       gdouble r,
+                                       gdouble cost, gdouble sint,
+                                       gdouble cosp, gdouble sinp)
+{
+  gint l, m;
+  gint n, o;
+  guint k, bs = dst->block_size;
+  gint d = dst->posdeg + src->negdeg;
+  gdouble rpow[d + 1];
+  gdouble pow, inv_r;
+  gcomplex128 *srcterm, *dstterm, *hterm;
+  gcomplex128 harmonics[((d + 1) * (d + 2)) / 2];
+  gcomplex128 expp = cosp + G_I * sinp;
+  gcomplex128 sum[bs];
+  gdouble sign;
+
+  aran_spherical_seriesd_alpha_require (d);
+  aran_spherical_seriesd_beta_require (d);
+
+  aran_spherical_harmonic_evaluate_multiple_internal (d, cost, sint, expp,
+                                                      harmonics);
+
+  inv_r = 1. / r;
+  pow = 1.;
+  for (l = 0; l <= d; l++)
+    {
+      rpow[l] = pow;
+      pow *= inv_r;
+    }
+
+  sign = 1.;
+  for (l = 0; l <= dst->posdeg; l++)
+    {
+      for (m = 0; m <= l; m++)
+        {
+          dstterm = _block_local_term (dst, l, m);
+
+          for (n = 0; n < src->negdeg; n++)
+            {
+              gdouble normaliz = aran_spherical_seriesd_beta (l + n) *
+                aran_spherical_seriesd_beta (l) /
+                aran_spherical_seriesd_beta (n) * sign * rpow[l + n + 1];
+              gcomplex128 h;
+
+              hterm = aran_spherical_harmonic_multiple_get_term (l + n, 0,
+                                                                 harmonics);
+
+              h = aran_spherical_seriesd_alpha (l, m) *
+                aran_spherical_seriesd_alpha (n, 0) /
+                aran_spherical_seriesd_alpha (l + n, m) * hterm[m];
+
+              srcterm = _block_multipole_term (src, n, 0);
+              for (k = 0; k < bs; k++)
+                sum[k] = h * srcterm[k];
+
+              for (o = 1; o <= n; o++)
+                {
+                  guint m_p_o = m + o;
+                  guint abs_m_m_o = ABS (m - o);
+                  gdouble factor = aran_spherical_seriesd_alpha (l, m) *
+                    aran_spherical_seriesd_alpha (n, o);
+                  gcomplex128 hp, hm;
+
+                  /* hp= Y_(l+n)^(m+o) */
+                  hp = hterm[m_p_o] * factor /
+                    aran_spherical_seriesd_alpha (l + n, m_p_o);
+
+                  /* hm= Y_(l+n)^(m-o) */
+                  hm = hterm[abs_m_m_o];
+                  if ((m - o) < 0)
+                    hm = _sph_sym (hm, abs_m_m_o);
+                  hm *= factor / aran_spherical_seriesd_alpha (l + n,
+                                                               abs_m_m_o);
+
+                  srcterm = _block_multipole_term (src, n, o);
+                  for (k = 0; k < bs; k++)
+                    sum[k] += hp * srcterm[k] + hm * _sph_sym (srcterm[k], o);
+                }
+
+              for (k = 0; k < bs; k++)
+                dstterm[k] += conj (sum[k]) * normaliz;
+            }
+        }
+      sign = -sign;
+    }
+}
+
+/**
+ * aran_block_development3d_m2m:
+ * @src_node: @src tree node info.
+ * @src: an #AranBlockDevelopment3d.
+ * @dst_node: @dst tree node info.
+ * @dst: an #AranBlockDevelopment3d.
+ *
+ * Performs multipole 2 multipole translation between @src and @dst for all
+ * right hand sides at once.
+ */
+void aran_block_development3d_m2m (const VsgPRTree3dNodeInfo *src_node,
+                                   AranBlockDevelopment3d *src,
+                                   const VsgPRTree3dNodeInfo *dst_node,
+                                   AranBlockDevelopment3d *dst)
+{
+  VsgVector3d tmp;
+  gdouble r, cost, sint, cosp, sinp;
+
+  g_return_if_fail (src->block_size == dst->block_size);
+
+  vsg_vector3d_sub (&dst_node->center, &src_node->center, &tmp);
+
+  vsg_vector3d_to_spherical_internal (&tmp, &r, &cost, &sint, &cosp, &sinp);
+
+  _block_multipole_translate (src, dst, r, -cost, sint, -cosp, -sinp);
+}
+
+/**
+ * aran_block_development3d_m2l:
+ * @src_node: @src tree node info.
+ * @src: an #AranBlockDevelopment3d.
+ * @dst_node: @dst tree node info.
+ * @dst: an #AranBlockDevelopment3d.
+ *
+ * Performs multipole 2 local translation between @src and @dst for all
+ * right hand sides at once.
+ */
+void aran_block_development3d_m2l (const VsgPRTree3dNodeInfo *src_node,
+                                   AranBlockDevelopment3d *src,
+                                   const VsgPRTree3dNodeInfo *dst_node,
+                                   AranBlockDevelopment3d *dst)
+{
+  VsgVector3d tmp;
+  gdouble r, cost, sint, cosp, sinp;
+
+  g_return_if_fail (src->block_size == dst->block_size);
+
+  vsg_vector3d_sub (&dst_node->center, &src_node->center, &tmp);
+
+  vsg_vector3d_to_spherical_internal (&tmp, &r, &cost, &sint, &cosp, &sinp);
+
+  _block_multipole_to_local (src, dst, r, cost, sint, cosp, sinp);
+}
+
+/**
+ * aran_block_development3d_l2l:
+ * @src_node: @src tree node info.
+ * @src: an #AranBlockDevelopment3d.
+ * @dst_node: @dst tree node info.
+ * @dst: an #AranBlockDevelopment3d.
+ *
+ * Performs local 2 local translation between @src and @dst for all
+ * right hand sides at once.
+ */
+void aran_block_development3d_l2l (const VsgPRTree3dNodeInfo *src_node,
+                                   AranBlockDevelopment3d *src,
+                                   const VsgPRTree3dNodeInfo *dst_node,
+                                   AranBlockDevelopment3d *dst)
+{
+  VsgVector3d tmp;
+  gdouble r, cost, sint, cosp, sinp;
+
+  g_return_if_fail (src->block_size == dst->block_size);
+
+  vsg_vector3d_sub (&dst_node->center, &src_node->center, &tmp);
+
+  vsg_vector3d_to_spherical_internal (&tmp, &r, &cost, &sint, &cosp, &sinp);
+
+  _block_local_translate (src, dst, r, cost, sint, cosp, sinp);
+}
+
+/**
+ * aran_block_development3d_m2p:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranBlockDevelopment3d.
+ * @pos: evaluation position.
+ * @values: result values, one for each right hand side.
+ *
+ * Evaluates the multipole expansions of @devel at @pos.
+ */
+void aran_block_development3d_m2p (const VsgPRTree3dNodeInfo *devel_node,
+                                   AranBlockDevelopment3d *devel,
+                                   const VsgVector3d *pos,
+                                   gcomplex128 *values)
+{
+  VsgVector3d tmp;
+  gint l, m;
+  guint k, bs = devel->block_size;
+  gint deg = devel->negdeg;
+  gcomplex128 harmonics[((deg + 1) * (deg + 2)) / 2];
+  gcomplex128 *coefficient, *hterm;
+  gdouble r, cost, sint, cosp, sinp;
+  gdouble fact, inv_r;
+
+  for (k = 0; k < bs; k++)
+    values[k] = 0.;
+
+  if (deg == 0) return;
+
+  vsg_vector3d_sub (pos, &devel_node->center, &tmp);
+
+  vsg_vector3d_to_spherical_internal (&tmp, &r, &cost, &sint, &cosp, &sinp);
+
+  aran_spherical_harmonic_evaluate_multiple_internal (deg - 1, cost, sint,
+                                                      cosp + G_I * sinp,
+                                                      harmonics);
+
+  inv_r = 1. / r;
+  fact = inv_r;
+
+  for (l = 0; l < deg; l++)
+    {
+      hterm = aran_spherical_harmonic_multiple_get_term (l, 0, harmonics);
+
+      coefficient = _block_multipole_term (devel, l, 0);
+      for (k = 0; k < bs; k++)
+        values[k] += coefficient[k] * hterm[0] * fact;
+
+      for (m = 1; m <= l; m++)
+        {
+          gcomplex128 h = 2. * fact * hterm[m];
+
+          coefficient = _block_multipole_term (devel, l, m);
+          for (k = 0; k < bs; k++)
+            values[k] += creal (coefficient[k] * h);
+        }
+
+      fact *= inv_r;
+    }
+}
+
+/**
+ * aran_block_development3d_l2p:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranBlockDevelopment3d.
+ * @pos: evaluation position.
+ * @values: result values, one for each right hand side.
+ *
+ * Evaluates the local expansions of @devel at @pos.
+ */
+void aran_block_development3d_l2p (const VsgPRTree3dNodeInfo *devel_node,
+                                   AranBlockDevelopment3d *devel,
+                                   const VsgVector3d *pos,
+                                   gcomplex128 *values)
+{
+  VsgVector3d tmp;
+  gint l, m;
+  guint k, bs = devel->block_size;
+  gint deg = devel->posdeg;
+  gcomplex128 harmonics[((deg + 1) * (deg + 2)) / 2];
+  gcomplex128 *coefficient, *hterm;
+  gdouble r, cost, sint, cosp, sinp;
+  gdouble fact;
+
+  vsg_vector3d_sub (pos, &devel_node->center, &tmp);
+
+  vsg_vector3d_to_spherical_internal (&tmp, &r, &cost, &sint, &cosp, &sinp);
+
+  aran_spherical_harmonic_evaluate_multiple_internal (deg, cost, sint,
+                                                      cosp + G_I * sinp,
+                                                      harmonics);
+
+  for (k = 0; k < bs; k++)
+    values[k] = 0.;
+
+  fact = 1.;
+
+  for (l = 0; l <= deg; l++)
+    {
+      hterm = aran_spherical_harmonic_multiple_get_term (l, 0, harmonics);
+
+      coefficient = _block_local_term (devel, l, 0);
+      for (k = 0; k < bs; k++)
+        values[k] += coefficient[k] * hterm[0] * fact;
+
+      for (m = 1; m <= l; m++)
+        {
+          gcomplex128 h = 2. * fact * hterm[m];
+
+          coefficient = _block_local_term (devel, l, m);
+          for (k = 0; k < bs; k++)
+            values[k] += creal (coefficient[k] * h);
+        }
+
+      fact *= r;
+    }
+}
+
+/*
+ * gradients are evaluated one right hand side at a time with the
+ * #AranSphericalSeriesd kernel.
+ */
+static void _block_gradient_evaluate (const gcomplex128 *coefficients,
+                                      guint bs,
+                                      AranSphericalSeriesd *ass,
+                                      gint sign,
+                                      const VsgVector3d *x,
+                                      VsgVector3d *grads)
+{
+  guint8 deg = (sign > 0) ? aran_spherical_seriesd_get_posdeg (ass) :
+    aran_spherical_seriesd_get_negdeg (ass);
+  guint size = (sign > 0) ? _local_size (deg) : _multipole_size (deg);
+  guint k, i;
+
+  if (size == 0)
+    {
+      for (k = 0; k < bs; k++)
+        vsg_vector3d_set (&grads[k], 0., 0., 0.);
+      return;
+    }
+
+  for (k = 0; k < bs; k++)
+    {
+      gcomplex128 *dst = (sign > 0) ?
+        _spherical_seriesd_get_pos_term (ass, 0, 0) :
+        _spherical_seriesd_get_neg_term (ass, 0, 0);
+
+      for (i = 0; i < size; i++)
+        dst[i] = coefficients[i * bs + k];
+
+      aran_spherical_seriesd_gradient_evaluate (ass, x, &grads[k]);
+    }
+}
+
+/**
+ * aran_block_development3d_m2pv:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranBlockDevelopment3d.
+ * @pos: evaluation position.
+ * @grads: result gradients, one for each right hand side.
+ *
+ * Evaluates the gradients of the multipole expansions of @devel at @pos.
+ */
+void aran_block_development3d_m2pv (const VsgPRTree3dNodeInfo *devel_node,
+                                    AranBlockDevelopment3d *devel,
+                                    const VsgVector3d *pos,
+                                    VsgVector3d *grads)
+{
+  VsgVector3d tmp;
+  AranSphericalSeriesd *ass;
+
+  vsg_vector3d_sub (pos, &devel_node->center, &tmp);
+
+  ass = aran_spherical_seriesd_new (0, devel->negdeg);
+
+  _block_gradient_evaluate (devel->multipole, devel->block_size, ass, -1,
+                            &tmp, grads);
+
+  aran_spherical_seriesd_free (ass);
+}
+
+/**
+ * aran_block_development3d_l2pv:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranBlockDevelopment3d.
+ * @pos: evaluation position.
+ * @grads: result gradients, one for each right hand side.
+ *
+ * Evaluates the gradients of the local expansions of @devel at @pos.
+ */
+void aran_block_development3d_l2pv (const VsgPRTree3dNodeInfo *devel_node,
+                                    AranBlockDevelopment3d *devel,
+                                    const VsgVector3d *pos,
+                                    VsgVector3d *grads)
+{
+  VsgVector3d tmp;
+  AranSphericalSeriesd *ass;
+
+  vsg_vector3d_sub (pos, &devel_node->center, &tmp);
+
+  ass = aran_spherical_seriesd_new (devel->posdeg, 0);
+
+  _block_gradient_evaluate (devel->local, devel->block_size, ass, 1,
+                            &tmp, grads);
+
+  aran_spherical_seriesd_free (ass);
+}
+
+#ifdef VSG_HAVE_MPI
+
+void aran_block_development3d_vtable_init (VsgParallelVTable *vtable,
+                                           guint8 posdeg, guint8 negdeg,
+                                           guint block_size)
+{
+  vtable->alloc = (VsgMigrableAllocDataFunc) aran_block_development3d_alloc;
+  vtable->alloc_data = aran_block_development3d_new (posdeg, negdeg,
+                                                     block_size);
+
+  vtable->destroy = aran_block_development3d_destroy;
+  vtable->destroy_data = NULL;
+
+  vtable->migrate.pack =
+    (VsgMigrablePackDataFunc) aran_block_development3d_migrate_pack;
+  vtable->migrate.pack_data = NULL;
+
+  vtable->migrate.unpack =
+    (VsgMigrablePackDataFunc) aran_block_development3d_migrate_unpack;
+  vtable->migrate.unpack_data = NULL;
+
+  vtable->visit_forward.pack =
+    (VsgMigrablePackDataFunc) aran_block_development3d_visit_fw_pack;
+  vtable->visit_forward.pack_data = NULL;
+
+  vtable->visit_forward.unpack =
+    (VsgMigrablePackDataFunc) aran_block_development3d_visit_fw_unpack;
+  vtable->visit_forward.unpack_data = NULL;
+
+  vtable->visit_forward.reduce =
+    (VsgMigrableReductionDataFunc) aran_block_development3d_visit_fw_reduce;
+  vtable->visit_forward.reduce_data = NULL;
+
+  vtable->visit_backward.pack =
+    (VsgMigrablePackDataFunc) aran_block_development3d_visit_bw_pack;
+  vtable->visit_backward.pack_data = NULL;
+
+  vtable->visit_backward.unpack =
+    (VsgMigrablePackDataFunc) aran_block_development3d_visit_bw_unpack;
+  vtable->visit_backward.unpack_data = NULL;
+
+  vtable->visit_backward.reduce =
+    (VsgMigrableReductionDataFunc) aran_block_development3d_visit_bw_reduce;
+  vtable->visit_backward.reduce_data = NULL;
+}
+
+void aran_block_development3d_vtable_clear (VsgParallelVTable *vtable)
+{
+  g_return_if_fail (vtable != NULL);
+  g_return_if_fail (vtable->alloc_data != NULL);
+
+  aran_block_development3d_free (vtable->alloc_data);
+}
+
+/**
+ * aran_block_development3d_alloc:
+ * @resident: unused.
+ * @src: an example #AranBlockDevelopment3d to copy from.
+ *
+ * Allocates a new #AranBlockDevelopment3d by clonig @src.
+ *
+ * Returns: a copy of @src.
+ */
+gpointer aran_block_development3d_alloc (gboolean resident,
+                                         AranBlockDevelopment3d *src)
+{
+  return g_boxed_copy (ARAN_TYPE_BLOCK_DEVELOPMENT3D, src);
+}
+
+/**
+ * aran_block_development3d_destroy:
+ * @data: A #AranBlockDevelopment3d.
+ * @resident: unused.
+ * @user_data: unused.
+ *
+ * Deletes @data from memory.
+ */
+void aran_block_development3d_destroy (gpointer data, gboolean resident,
+                                       gpointer user_data)
+{
+  g_assert (data != NULL);
+  g_boxed_free (ARAN_TYPE_BLOCK_DEVELOPMENT3D, data);
+}
+
+static void _block_multipole_pack (AranBlockDevelopment3d *devel,
+                                   VsgPackedMsg *pm)
+{
+  vsg_packed_msg_send_append (pm, devel->multipole,
+                              _multipole_size (devel->negdeg) *
+                              devel->block_size,
+                              ARAN_MPI_TYPE_GCOMPLEX128);
+}
+
+static void _block_multipole_unpack (AranBlockDevelopment3d *devel,
+                                     VsgPackedMsg *pm)
+{
+  vsg_packed_msg_recv_read (pm, devel->multipole,
+                            _multipole_size (devel->negdeg) *
+                            devel->block_size,
+                            ARAN_MPI_TYPE_GCOMPLEX128);
+}
+
+static void _block_local_pack (AranBlockDevelopment3d *devel,
+                               VsgPackedMsg *pm)
+{
+  vsg_packed_msg_send_append (pm, devel->local,
+                              _local_size (devel->posdeg) *
+                              devel->block_size,
+                              ARAN_MPI_TYPE_GCOMPLEX128);
+}
+
+static void _block_local_unpack (AranBlockDevelopment3d *devel,
+                                 VsgPackedMsg *pm)
+{
+  vsg_packed_msg_recv_read (pm, devel->local,
+                            _local_size (devel->posdeg) *
+                            devel->block_size,
+                            ARAN_MPI_TYPE_GCOMPLEX128);
+}
+
+/**
+ * aran_block_development3d_migrate_pack:
+ * @devel: an #AranBlockDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs complete packing of @devel into @pm for a migration
+ * between processors.
+ */
+void aran_block_development3d_migrate_pack (AranBlockDevelopment3d *devel,
+                                            VsgPackedMsg *pm,
+                                            gpointer user_data)
+{
+  _block_multipole_pack (devel, pm);
+  _block_local_pack (devel, pm);
+}
+
+/**
+ * aran_block_development3d_migrate_unpack:
+ * @devel: an #AranBlockDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm in a migration between processors and
+ * stores it in @devel.
+ */
+void aran_block_development3d_migrate_unpack (AranBlockDevelopment3d *devel,
+                                              VsgPackedMsg *pm,
+                                              gpointer user_data)
+{
+  _block_multipole_unpack (devel, pm);
+  _block_local_unpack (devel, pm);
+}
+
+/**
+ * aran_block_development3d_visit_fw_pack:
+ * @devel: an #AranBlockDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs packing of @devel into @pm for a near/far forward visit
+ * of a local node to another processor.
+ */
+void aran_block_development3d_visit_fw_pack (AranBlockDevelopment3d *devel,
+                                             VsgPackedMsg *pm,
+                                             gpointer user_data)
+{
+  _block_multipole_pack (devel, pm);
+}
+
+/**
+ * aran_block_development3d_visit_fw_unpack:
+ * @devel: an #AranBlockDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm for a near/far forward visit of a
+ * remote node.
+ */
+void aran_block_development3d_visit_fw_unpack (AranBlockDevelopment3d *devel,
+                                               VsgPackedMsg *pm,
+                                               gpointer user_data)
+{
+  _block_multipole_unpack (devel, pm);
+}
+
+/**
+ * aran_block_development3d_visit_fw_reduce:
+ * @a: source #AranBlockDevelopment3d.
+ * @b: destination #AranBlockDevelopment3d.
+ * @user_data: unused.
+ *
+ * Forward visit reduction operator for #AranBlockDevelopment3d.
+ */
+void aran_block_development3d_visit_fw_reduce (AranBlockDevelopment3d *a,
+                                               AranBlockDevelopment3d *b,
+                                               gpointer user_data)
+{
+  gsize i, size = _multipole_size (b->negdeg) * b->block_size;
+
+  for (i = 0; i < size; i++)
+    b->multipole[i] += a->multipole[i];
+}
+
+/**
+ * aran_block_development3d_visit_bw_pack:
+ * @devel: an #AranBlockDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs packing of @devel into @pm for a near/far backward visit
+ * of a remote node to its original processor.
+ */
+void aran_block_development3d_visit_bw_pack (AranBlockDevelopment3d *devel,
+                                             VsgPackedMsg *pm,
+                                             gpointer user_data)
+{
+  _block_local_pack (devel, pm);
+}
+
+/**
+ * aran_block_development3d_visit_bw_unpack:
+ * @devel: an #AranBlockDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm for a near/far backward visit of a
+ * remote node.
+ */
+void aran_block_development3d_visit_bw_unpack (AranBlockDevelopment3d *devel,
+                                               VsgPackedMsg *pm,
+                                               gpointer user_data)
+{
+  _block_local_unpack (devel, pm);
+}
+
+/**
+ * aran_block_development3d_visit_bw_reduce:
+ * @a: source #AranBlockDevelopment3d.
+ * @b: destination #AranBlockDevelopment3d.
+ * @user_data: unused.
+ *
+ * Backward visit reduction operator for #AranBlockDevelopment3d.
+ */
+void aran_block_development3d_visit_bw_reduce (AranBlockDevelopment3d *a,
+                                               AranBlockDevelopment3d *b,
+                                               gpointer user_data)
+{
+  gsize i, size = _local_size (b->posdeg) * b->block_size;
+
+  for (i = 0; i < size; i++)
+    b->local[i] += a->local[i];
+}
+
+#endif /* VSG_HAVE_MPI */
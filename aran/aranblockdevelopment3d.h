@@ -0,0 +1,175 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __ARAN_BLOCK_DEVELOPMENT3D_H__
+#define __ARAN_BLOCK_DEVELOPMENT3D_H__
+
+#include <glib-object.h>
+
+#include <vsg/vsgd.h>
+#ifdef VSG_HAVE_MPI
+#include <vsg/vsgpackedmsg.h>
+#endif
+
+#include <aran/arancomplex.h>
+
+G_BEGIN_DECLS;
+
+/* macros */
+#define ARAN_TYPE_BLOCK_DEVELOPMENT3D (aran_block_development3d_get_type ())
+
+/* typedefs */
+
+typedef struct _AranBlockDevelopment3d AranBlockDevelopment3d;
+
+struct _AranBlockDevelopment3d
+{
+  guint8 posdeg;
+  guint8 negdeg;
+  guint block_size;
+
+  gcomplex128 *multipole;
+  gcomplex128 *local;
+};
+
+/* functions */
+GType aran_block_development3d_get_type ();
+
+AranBlockDevelopment3d *aran_block_development3d_new (guint8 posdeg,
+                                                      guint8 negdeg,
+                                                      guint block_size);
+
+void aran_block_development3d_free (AranBlockDevelopment3d *abd);
+
+void aran_block_development3d_copy (const AranBlockDevelopment3d *src,
+                                    AranBlockDevelopment3d *dst);
+
+AranBlockDevelopment3d *
+aran_block_development3d_clone (AranBlockDevelopment3d *src);
+
+void aran_block_development3d_set_zero (AranBlockDevelopment3d *abd);
+
+guint aran_block_development3d_get_block_size (const AranBlockDevelopment3d *abd);
+
+gcomplex128 *
+aran_block_development3d_get_multipole_term (AranBlockDevelopment3d *abd,
+                                             guint l, guint m);
+
+gcomplex128 *
+aran_block_development3d_get_local_term (AranBlockDevelopment3d *abd,
+                                         guint l, guint m);
+
+void aran_block_development3d_write (AranBlockDevelopment3d *abd, FILE *file);
+
+void aran_block_development3d_p2m (const VsgVector3d *position,
+                                   const gdouble *charges,
+                                   const VsgPRTree3dNodeInfo *dst_node,
+                                   AranBlockDevelopment3d *dst);
+
+void aran_block_development3d_p2l (const VsgVector3d *position,
+                                   const gdouble *charges,
+                                   const VsgPRTree3dNodeInfo *dst_node,
+                                   AranBlockDevelopment3d *dst);
+
+void aran_block_development3d_m2m (const VsgPRTree3dNodeInfo *src_node,
+                                   AranBlockDevelopment3d *src,
+                                   const VsgPRTree3dNodeInfo *dst_node,
+                                   AranBlockDevelopment3d *dst);
+
+void aran_block_development3d_m2l (const VsgPRTree3dNodeInfo *src_node,
+                                   AranBlockDevelopment3d *src,
+                                   const VsgPRTree3dNodeInfo *dst_node,
+                                   AranBlockDevelopment3d *dst);
+
+void aran_block_development3d_l2l (const VsgPRTree3dNodeInfo *src_node,
+                                   AranBlockDevelopment3d *src,
+                                   const VsgPRTree3dNodeInfo *dst_node,
+                                   AranBlockDevelopment3d *dst);
+
+void aran_block_development3d_m2p (const VsgPRTree3dNodeInfo *devel_node,
+                                   AranBlockDevelopment3d *devel,
+                                   const VsgVector3d *pos,
+                                   gcomplex128 *values);
+
+void aran_block_development3d_l2p (const VsgPRTree3dNodeInfo *devel_node,
+                                   AranBlockDevelopment3d *devel,
+                                   const VsgVector3d *pos,
+                                   gcomplex128 *values);
+
+void aran_block_development3d_m2pv (const VsgPRTree3dNodeInfo *devel_node,
+                                    AranBlockDevelopment3d *devel,
+                                    const VsgVector3d *pos,
+                                    VsgVector3d *grads);
+
+void aran_block_development3d_l2pv (const VsgPRTree3dNodeInfo *devel_node,
+                                    AranBlockDevelopment3d *devel,
+                                    const VsgVector3d *pos,
+                                    VsgVector3d *grads);
+
+#ifdef VSG_HAVE_MPI
+
+void aran_block_development3d_vtable_init (VsgParallelVTable *vtable,
+                                           guint8 posdeg, guint8 negdeg,
+                                           guint block_size);
+
+void aran_block_development3d_vtable_clear (VsgParallelVTable *vtable);
+
+gpointer aran_block_development3d_alloc (gboolean resident,
+                                         AranBlockDevelopment3d *src);
+
+void aran_block_development3d_destroy (gpointer data, gboolean resident,
+                                       gpointer user_data);
+
+void aran_block_development3d_migrate_pack (AranBlockDevelopment3d *devel,
+                                            VsgPackedMsg *pm,
+                                            gpointer user_data);
+
+void aran_block_development3d_migrate_unpack (AranBlockDevelopment3d *devel,
+                                              VsgPackedMsg *pm,
+                                              gpointer user_data);
+
+void aran_block_development3d_visit_fw_pack (AranBlockDevelopment3d *devel,
+                                             VsgPackedMsg *pm,
+                                             gpointer user_data);
+
+void aran_block_development3d_visit_fw_unpack (AranBlockDevelopment3d *devel,
+                                               VsgPackedMsg *pm,
+                                               gpointer user_data);
+
+void aran_block_development3d_visit_fw_reduce (AranBlockDevelopment3d *a,
+                                               AranBlockDevelopment3d *b,
+                                               gpointer user_data);
+
+void aran_block_development3d_visit_bw_pack (AranBlockDevelopment3d *devel,
+                                             VsgPackedMsg *pm,
+                                             gpointer user_data);
+
+void aran_block_development3d_visit_bw_unpack (AranBlockDevelopment3d *devel,
+                                               VsgPackedMsg *pm,
+                                               gpointer user_data);
+
+void aran_block_development3d_visit_bw_reduce (AranBlockDevelopment3d *a,
+                                               AranBlockDevelopment3d *b,
+                                               gpointer user_data);
+
+#endif /* VSG_HAVE_MPI */
+
+G_END_DECLS;
+
+#endif /* __ARAN_BLOCK_DEVELOPMENT3D_H__ */
@@ -0,0 +1,1213 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "arancartesiandevelopment3d.h"
+
+#include <string.h>
+#include <math.h>
+
+/**
+ * ARAN_TYPE_CARTESIAN_DEVELOPMENT3D:
+ *
+ * #AranCartesianDevelopment3d #GBoxed #GType.
+ */
+
+/**
+ * ARAN_CARTESIAN_DEVELOPMENT3D_MAX_ORDER:
+ *
+ * Maximum order of an #AranCartesianDevelopment3d.
+ */
+
+/**
+ * ARAN_CARTESIAN_DEVELOPMENT3D_SIZE:
+ * @order: expansion order.
+ *
+ * Number of terms of a cartesian expansion of order @order.
+ */
+
+/**
+ * AranCartesianDevelopment3d:
+ * @order: expansions order.
+ * @multipole: Multipole expansion coefficients.
+ * @local: Local (Taylor) expansion coefficients.
+ *
+ * A structure used as #VsgPRTree3d node_data within an #AranSolver3d for
+ * Newton potential (1/r) problems with low order expansions. Expansions
+ * are real cartesian tensors indexed by monomials x^a y^b z^c with
+ * a+b+c <= @order, stored by increasing degree:
+ *
+ * @multipole[a,b,c] = sum_i q_i (y_i - center)^(a,b,c) and
+ * potential(x) = sum_{a,b,c} @local[a,b,c] (x - center)^(a,b,c).
+ *
+ * This avoids complex arithmetic and spherical coordinates of
+ * #AranDevelopment3d, which dominate computations at low orders.
+ */
+
+#define _NTERMS(p) ARAN_CARTESIAN_DEVELOPMENT3D_SIZE (p)
+
+/* monomials are needed one degree above expansion order for gradients */
+#define _MAX_TERMS _NTERMS (ARAN_CARTESIAN_DEVELOPMENT3D_MAX_ORDER + 1)
+
+/* number of particles processed at once by multiple particles kernels */
+#define _CHUNK (64)
+
+/* exponents of monomial k */
+static const guint8 _exps[_MAX_TERMS][3] = {
+  {0,0,0}, {1,0,0}, {0,1,0}, {0,0,1}, {2,0,0}, {1,1,0}, {1,0,1}, {0,2,0},
+  {0,1,1}, {0,0,2}, {3,0,0}, {2,1,0}, {2,0,1}, {1,2,0}, {1,1,1}, {1,0,2},
+  {0,3,0}, {0,2,1}, {0,1,2}, {0,0,3}, {4,0,0}, {3,1,0}, {3,0,1}, {2,2,0},
+  {2,1,1}, {2,0,2}, {1,3,0}, {1,2,1}, {1,1,2}, {1,0,3}, {0,4,0}, {0,3,1},
+  {0,2,2}, {0,1,3}, {0,0,4}, {5,0,0}, {4,1,0}, {4,0,1}, {3,2,0}, {3,1,1},
+  {3,0,2}, {2,3,0}, {2,2,1}, {2,1,2}, {2,0,3}, {1,4,0}, {1,3,1}, {1,2,2},
+  {1,1,3}, {1,0,4}, {0,5,0}, {0,4,1}, {0,3,2}, {0,2,3}, {0,1,4}, {0,0,5},
+};
+
+/* monomial k = monomial _pred[k] * coordinate _dim[k] */
+static const guint8 _pred[_MAX_TERMS] = {
+  0, 0, 0, 0, 1, 2, 3, 2, 3, 3, 4, 5, 6, 7, 8, 9, 7, 8, 9, 9, 10, 11, 12,
+  13, 14, 15, 16, 17, 18, 19, 16, 17, 18, 19, 19, 20, 21, 22, 23, 24, 25,
+  26, 27, 28, 29, 30, 31, 32, 33, 34, 30, 31, 32, 33, 34, 34,
+};
+
+static const guint8 _dim[_MAX_TERMS] = {
+  0, 0, 1, 2, 0, 0, 0, 1, 1, 2, 0, 0, 0, 0, 0, 0, 1, 1, 1, 2, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 1, 1, 1, 1, 1, 2,
+};
+
+static const gdouble _binomial[6][6] = {
+  {1., 0., 0., 0., 0., 0.},
+  {1., 1., 0., 0., 0., 0.},
+  {1., 2., 1., 0., 0., 0.},
+  {1., 3., 3., 1., 0., 0.},
+  {1., 4., 6., 4., 1., 0.},
+  {1., 5., 10., 10., 5., 1.},
+};
+
+static inline guint _index (guint a, guint b, guint c)
+{
+  guint n = a + b + c;
+  guint j = b + c;
+
+  return (n * (n + 1) * (n + 2)) / 6 + (j * (j + 1)) / 2 + c;
+}
+
+static inline guint _degree (guint k)
+{
+  return _exps[k][0] + _exps[k][1] + _exps[k][2];
+}
+
+/* tells if monomial j divides monomial k */
+static inline gboolean _divides (guint j, guint k)
+{
+  return _exps[j][0] <= _exps[k][0] && _exps[j][1] <= _exps[k][1] &&
+    _exps[j][2] <= _exps[k][2];
+}
+
+/* multi-index binomial coefficient C(alpha_k, alpha_j) */
+static inline gdouble _multi_binomial (guint k, guint j)
+{
+  return _binomial[_exps[k][0]][_exps[j][0]] *
+    _binomial[_exps[k][1]][_exps[j][1]] *
+    _binomial[_exps[k][2]][_exps[j][2]];
+}
+
+/*
+ * Kernels below take the expansion order as first argument. They are
+ * always called with a literal order through _CARTESIAN_DISPATCH so that
+ * the compiler may fully unroll their loops for each order.
+ */
+#define _CARTESIAN_DISPATCH(order, func, ...) G_STMT_START {    \
+    switch (order) {                                            \
+    case 0: func (0, __VA_ARGS__); break;                       \
+    case 1: func (1, __VA_ARGS__); break;                       \
+    case 2: func (2, __VA_ARGS__); break;                       \
+    case 3: func (3, __VA_ARGS__); break;                       \
+    case 4: func (4, __VA_ARGS__); break;                       \
+    default:                                                    \
+      g_critical ("invalid cartesian development order %d",     \
+                  (gint) (order));                              \
+    }                                                           \
+  } G_STMT_END
+
+/* monomials h^alpha for |alpha| <= p */
+static inline void _monomials (const gint p, const gdouble *h, gdouble *mon)
+{
+  gint k;
+
+  mon[0] = 1.;
+
+  for (k = 1; k < _NTERMS (p); k++)
+    mon[k] = mon[_pred[k]] * h[_dim[k]];
+}
+
+/*
+ * Taylor coefficients a_alpha(r) = D^alpha (1/|r|) / alpha! for
+ * |alpha| <= p, computed with the recurrence:
+ * n |r|^2 a_alpha + (2n-1) sum_i r_i a_{alpha-e_i}
+ *   + (n-1) sum_i a_{alpha-2e_i} = 0, with n = |alpha|.
+ */
+static inline void _taylor (const gint p, const gdouble *r, gdouble *a)
+{
+  gdouble invr2 = 1. / (r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+  gint k, i;
+
+  a[0] = sqrt (invr2);
+
+  for (k = 1; k < _NTERMS (p); k++)
+    {
+      gint n = _degree (k);
+      gdouble sum = 0.;
+
+      for (i = 0; i < 3; i++)
+        {
+          guint g[3] = {_exps[k][0], _exps[k][1], _exps[k][2]};
+
+          if (g[i] == 0) continue;
+
+          g[i] --;
+          sum += (2 * n - 1) * r[i] * a[_index (g[0], g[1], g[2])];
+
+          if (g[i] == 0) continue;
+
+          g[i] --;
+          sum += (n - 1) * a[_index (g[0], g[1], g[2])];
+        }
+
+      a[k] = - sum * invr2 / n;
+    }
+}
+
+static inline void _p2m (const gint p, const gdouble *h, gdouble charge,
+                         gdouble *multipole)
+{
+  gdouble mon[_NTERMS (p)];
+  gint k;
+
+  _monomials (p, h, mon);
+
+  for (k = 0; k < _NTERMS (p); k++)
+    multipole[k] += charge * mon[k];
+}
+
+static inline void _p2l (const gint p, const gdouble *r, gdouble charge,
+                         gdouble *local)
+{
+  gdouble a[_NTERMS (p)];
+  gint k;
+
+  _taylor (p, r, a);
+
+  for (k = 0; k < _NTERMS (p); k++)
+    local[k] += charge * a[k];
+}
+
+/* M'_alpha = sum_{beta <= alpha} C(alpha,beta) M_beta d^(alpha-beta) */
+static inline void _m2m (const gint p, const gdouble *d, const gdouble *src,
+                         gdouble *dst)
+{
+  gdouble mon[_NTERMS (p)];
+  gint k, j;
+
+  _monomials (p, d, mon);
+
+  for (k = 0; k < _NTERMS (p); k++)
+    {
+      gdouble sum = 0.;
+
+      for (j = 0; j <= k; j++)
+        {
+          if (! _divides (j, k)) continue;
+
+          sum += _multi_binomial (k, j) * src[j] *
+            mon[_index (_exps[k][0] - _exps[j][0],
+                        _exps[k][1] - _exps[j][1],
+                        _exps[k][2] - _exps[j][2])];
+        }
+
+      dst[k] += sum;
+    }
+}
+
+/*
+ * L_beta = sum_alpha (-1)^|alpha| C(alpha+beta,alpha) M_alpha a_{alpha+beta}
+ * truncated to |alpha|+|beta| <= p.
+ */
+static inline void _m2l (const gint p, const gdouble *r, const gdouble *src,
+                         gdouble *dst)
+{
+  gdouble a[_NTERMS (p)];
+  gint k, j;
+
+  _taylor (p, r, a);
+
+  for (k = 0; k < _NTERMS (p); k++)
+    {
+      gint nk = _degree (k);
+      gdouble sum = 0.;
+
+      for (j = 0; j < _NTERMS (p - nk); j++)
+        {
+          guint s = _index (_exps[k][0] + _exps[j][0],
+                            _exps[k][1] + _exps[j][1],
+                            _exps[k][2] + _exps[j][2]);
+          gdouble t = _multi_binomial (s, j) * src[j] * a[s];
+
+          sum += (_degree (j) % 2 == 0) ? t : -t;
+        }
+
+      dst[k] += sum;
+    }
+}
+
+/* L'_beta = sum_{alpha >= beta} C(alpha,beta) L_alpha d^(alpha-beta) */
+static inline void _l2l (const gint p, const gdouble *d, const gdouble *src,
+                         gdouble *dst)
+{
+  gdouble mon[_NTERMS (p)];
+  gint k, j;
+
+  _monomials (p, d, mon);
+
+  for (k = 0; k < _NTERMS (p); k++)
+    {
+      gdouble sum = 0.;
+
+      for (j = k; j < _NTERMS (p); j++)
+        {
+          if (! _divides (k, j)) continue;
+
+          sum += _multi_binomial (j, k) * src[j] *
+            mon[_index (_exps[j][0] - _exps[k][0],
+                        _exps[j][1] - _exps[k][1],
+                        _exps[j][2] - _exps[k][2])];
+        }
+
+      dst[k] += sum;
+    }
+}
+
+static inline void _l2p (const gint p, const gdouble *h, const gdouble *local,
+                         gdouble *res)
+{
+  gdouble mon[_NTERMS (p)];
+  gdouble sum = 0.;
+  gint k;
+
+  _monomials (p, h, mon);
+
+  for (k = 0; k < _NTERMS (p); k++)
+    sum += local[k] * mon[k];
+
+  *res = sum;
+}
+
+/* gradient of the local expansion as expansions of order p-1 */
+static inline void _local_gradient (const gint p, const gdouble *local,
+                                    gdouble *gx, gdouble *gy, gdouble *gz)
+{
+  gdouble *g[3] = {gx, gy, gz};
+  gint k, i;
+
+  for (k = 1; k < _NTERMS (p); k++)
+    {
+      for (i = 0; i < 3; i++)
+        {
+          guint e[3] = {_exps[k][0], _exps[k][1], _exps[k][2]};
+
+          if (e[i] == 0) continue;
+
+          e[i] --;
+          g[i][_index (e[0], e[1], e[2])] = _exps[k][i] * local[k];
+        }
+    }
+}
+
+static inline void _l2pv (const gint p, const gdouble *h, const gdouble *local,
+                          VsgVector3d *grad)
+{
+  gdouble mon[_NTERMS (p)];
+  gdouble gx[_NTERMS (p)], gy[_NTERMS (p)], gz[_NTERMS (p)];
+  gdouble sx = 0., sy = 0., sz = 0.;
+  gint k;
+
+  if (p == 0)
+    {
+      grad->x = grad->y = grad->z = 0.;
+      return;
+    }
+
+  _local_gradient (p, local, gx, gy, gz);
+  _monomials (p, h, mon);
+
+  for (k = 0; k < _NTERMS (p - 1); k++)
+    {
+      sx += gx[k] * mon[k];
+      sy += gy[k] * mon[k];
+      sz += gz[k] * mon[k];
+    }
+
+  grad->x = sx;
+  grad->y = sy;
+  grad->z = sz;
+}
+
+static inline void _m2p (const gint p, const gdouble *r,
+                         const gdouble *multipole, gdouble *res)
+{
+  gdouble a[_NTERMS (p)];
+  gdouble sum = 0.;
+  gint k;
+
+  _taylor (p, r, a);
+
+  for (k = 0; k < _NTERMS (p); k++)
+    {
+      gdouble t = multipole[k] * a[k];
+
+      sum += (_degree (k) % 2 == 0) ? t : -t;
+    }
+
+  *res = sum;
+}
+
+/* d/dr_i a_alpha = (alpha_i+1) a_{alpha+e_i} */
+static inline void _m2pv (const gint p, const gdouble *r,
+                          const gdouble *multipole, VsgVector3d *grad)
+{
+  gdouble a[_NTERMS (p + 1)];
+  gdouble s[3] = {0., 0., 0.};
+  gint k, i;
+
+  _taylor (p + 1, r, a);
+
+  for (k = 0; k < _NTERMS (p); k++)
+    {
+      gdouble m = (_degree (k) % 2 == 0) ? multipole[k] : -multipole[k];
+
+      for (i = 0; i < 3; i++)
+        {
+          guint e[3] = {_exps[k][0], _exps[k][1], _exps[k][2]};
+
+          e[i] ++;
+          s[i] += m * (_exps[k][i] + 1) * a[_index (e[0], e[1], e[2])];
+        }
+    }
+
+  grad->x = s[0];
+  grad->y = s[1];
+  grad->z = s[2];
+}
+
+static inline void _p2m_multiple (const gint p, guint n, const gdouble *x,
+                                  const gdouble *y, const gdouble *z,
+                                  const gdouble *charges,
+                                  const VsgVector3d *center,
+                                  gdouble *multipole)
+{
+  gdouble h[3][_CHUNK];
+  gdouble mon[_NTERMS (p)][_CHUNK];
+  guint start, j, m;
+  gint k;
+
+  for (start = 0; start < n; start += _CHUNK)
+    {
+      m = MIN (_CHUNK, n - start);
+
+      for (j = 0; j < m; j++)
+        {
+          h[0][j] = x[start + j] - center->x;
+          h[1][j] = y[start + j] - center->y;
+          h[2][j] = z[start + j] - center->z;
+          mon[0][j] = charges[start + j];
+        }
+
+      for (k = 1; k < _NTERMS (p); k++)
+        {
+          const gdouble *pred = mon[_pred[k]];
+          const gdouble *hd = h[_dim[k]];
+
+          for (j = 0; j < m; j++)
+            mon[k][j] = pred[j] * hd[j];
+        }
+
+      for (k = 0; k < _NTERMS (p); k++)
+        {
+          gdouble sum = 0.;
+
+          for (j = 0; j < m; j++)
+            sum += mon[k][j];
+
+          multipole[k] += sum;
+        }
+    }
+}
+
+static inline void _l2p_multiple (const gint p, const VsgVector3d *center,
+                                  const gdouble *local, guint n,
+                                  const gdouble *x, const gdouble *y,
+                                  const gdouble *z, gdouble *potentials,
+                                  gdouble *gx, gdouble *gy, gdouble *gz)
+{
+  gdouble h[3][_CHUNK];
+  gdouble mon[_NTERMS (p)][_CHUNK];
+  gdouble lx[_NTERMS (p)], ly[_NTERMS (p)], lz[_NTERMS (p)];
+  gboolean grad = p > 0 && (gx != NULL || gy != NULL || gz != NULL);
+  guint start, j, m;
+  gint k;
+
+  if (grad) _local_gradient (p, local, lx, ly, lz);
+
+  for (start = 0; start < n; start += _CHUNK)
+    {
+      m = MIN (_CHUNK, n - start);
+
+      for (j = 0; j < m; j++)
+        {
+          h[0][j] = x[start + j] - center->x;
+          h[1][j] = y[start + j] - center->y;
+          h[2][j] = z[start + j] - center->z;
+          mon[0][j] = 1.;
+        }
+
+      for (k = 1; k < _NTERMS (p); k++)
+        {
+          const gdouble *pred = mon[_pred[k]];
+          const gdouble *hd = h[_dim[k]];
+
+          for (j = 0; j < m; j++)
+            mon[k][j] = pred[j] * hd[j];
+        }
+
+      if (potentials != NULL)
+        for (k = 0; k < _NTERMS (p); k++)
+          {
+            gdouble *pot = potentials + start;
+
+            for (j = 0; j < m; j++)
+              pot[j] += local[k] * mon[k][j];
+          }
+
+      if (! grad) continue;
+
+      for (k = 0; k < _NTERMS (p - 1); k++)
+        {
+          if (gx != NULL)
+            for (j = 0; j < m; j++) gx[start + j] += lx[k] * mon[k][j];
+          if (gy != NULL)
+            for (j = 0; j < m; j++) gy[start + j] += ly[k] * mon[k][j];
+          if (gz != NULL)
+            for (j = 0; j < m; j++) gz[start + j] += lz[k] * mon[k][j];
+        }
+    }
+}
+
+/* functions */
+
+GType aran_cartesian_development3d_get_type ()
+{
+  static GType devtype = G_TYPE_NONE;
+
+  if (G_UNLIKELY (devtype == G_TYPE_NONE))
+    {
+      devtype =
+	g_boxed_type_register_static ("AranCartesianDevelopment3d",
+				      (GBoxedCopyFunc)
+                                      aran_cartesian_development3d_clone,
+				      (GBoxedFreeFunc)
+                                      aran_cartesian_development3d_free);
+    }
+
+  return devtype;
+}
+
+/**
+ * aran_cartesian_development3d_new:
+ * @order: expansions order. Must not exceed
+ * #ARAN_CARTESIAN_DEVELOPMENT3D_MAX_ORDER.
+ *
+ * Allocates a new #AranCartesianDevelopment3d structure with multipole and
+ * local expansions of order @order. Expansions are set to zero.
+ *
+ * Returns: newly allocated structure.
+ */
+AranCartesianDevelopment3d *aran_cartesian_development3d_new (guint8 order)
+{
+  AranCartesianDevelopment3d *result;
+
+  g_return_val_if_fail (order <= ARAN_CARTESIAN_DEVELOPMENT3D_MAX_ORDER,
+                        NULL);
+
+  result = g_new0 (AranCartesianDevelopment3d, 1);
+
+  result->order = order;
+
+  return result;
+}
+
+/**
+ * aran_cartesian_development3d_free:
+ * @acd: an #AranCartesianDevelopment3d.
+ *
+ * Deallocates @acd.
+ */
+void aran_cartesian_development3d_free (AranCartesianDevelopment3d *acd)
+{
+  g_free (acd);
+}
+
+/**
+ * aran_cartesian_development3d_copy:
+ * @src: an #AranCartesianDevelopment3d.
+ * @dst: an #AranCartesianDevelopment3d.
+ *
+ * Copies @src into @dst.
+ */
+void aran_cartesian_development3d_copy (const AranCartesianDevelopment3d *src,
+                                        AranCartesianDevelopment3d *dst)
+{
+  g_return_if_fail (src != NULL);
+  g_return_if_fail (dst != NULL);
+
+  memcpy (dst, src, sizeof (AranCartesianDevelopment3d));
+}
+
+/**
+ * aran_cartesian_development3d_clone:
+ * @src: an #AranCartesianDevelopment3d.
+ *
+ * Duplicates @src.
+ *
+ * Returns: newly allocated copy of @src.
+ */
+AranCartesianDevelopment3d *
+aran_cartesian_development3d_clone (AranCartesianDevelopment3d *src)
+{
+  AranCartesianDevelopment3d *dst;
+
+  g_return_val_if_fail (src != NULL, NULL);
+
+  dst = aran_cartesian_development3d_new (src->order);
+
+  aran_cartesian_development3d_copy (src, dst);
+
+  return dst;
+}
+
+/**
+ * aran_cartesian_development3d_set_zero:
+ * @acd: an #AranCartesianDevelopment3d.
+ *
+ * Sets @acd expansions to zero.
+ */
+void aran_cartesian_development3d_set_zero (AranCartesianDevelopment3d *acd)
+{
+  g_return_if_fail (acd != NULL);
+
+  memset (acd->multipole, 0, sizeof (acd->multipole));
+  memset (acd->local, 0, sizeof (acd->local));
+}
+
+/**
+ * aran_cartesian_development3d_get_order:
+ * @acd: an #AranCartesianDevelopment3d.
+ *
+ * Returns @acd expansions order.
+ *
+ * Returns: @acd order.
+ */
+guint8
+aran_cartesian_development3d_get_order (const AranCartesianDevelopment3d *acd)
+{
+  g_return_val_if_fail (acd != NULL, 0);
+
+  return acd->order;
+}
+
+/**
+ * aran_cartesian_development3d_get_multipole_term:
+ * @acd: an #AranCartesianDevelopment3d.
+ * @a: x exponent.
+ * @b: y exponent.
+ * @c: z exponent.
+ *
+ * Gives the address of the multipole coefficient of monomial x^@a y^@b z^@c.
+ *
+ * Returns: address of requested term.
+ */
+gdouble *
+aran_cartesian_development3d_get_multipole_term (AranCartesianDevelopment3d *acd,
+                                                 guint a, guint b, guint c)
+{
+  g_return_val_if_fail (acd != NULL, NULL);
+  g_return_val_if_fail (a + b + c <= acd->order, NULL);
+
+  return &acd->multipole[_index (a, b, c)];
+}
+
+/**
+ * aran_cartesian_development3d_get_local_term:
+ * @acd: an #AranCartesianDevelopment3d.
+ * @a: x exponent.
+ * @b: y exponent.
+ * @c: z exponent.
+ *
+ * Gives the address of the local coefficient of monomial x^@a y^@b z^@c.
+ *
+ * Returns: address of requested term.
+ */
+gdouble *
+aran_cartesian_development3d_get_local_term (AranCartesianDevelopment3d *acd,
+                                             guint a, guint b, guint c)
+{
+  g_return_val_if_fail (acd != NULL, NULL);
+  g_return_val_if_fail (a + b + c <= acd->order, NULL);
+
+  return &acd->local[_index (a, b, c)];
+}
+
+/**
+ * aran_cartesian_development3d_write:
+ * @acd: an #AranCartesianDevelopment3d.
+ * @file: output file.
+ *
+ * Writes @acd to @file.
+ */
+void aran_cartesian_development3d_write (AranCartesianDevelopment3d *acd,
+                                         FILE *file)
+{
+  guint k;
+
+  g_return_if_fail (acd != NULL);
+
+  fprintf (file, "{multipole= [");
+  for (k=0; k<_NTERMS (acd->order); k ++)
+    fprintf (file, "[%d,%d,%d]:%e, ", _exps[k][0], _exps[k][1], _exps[k][2],
+             acd->multipole[k]);
+
+  fprintf (file, "], local= [");
+  for (k=0; k<_NTERMS (acd->order); k ++)
+    fprintf (file, "[%d,%d,%d]:%e, ", _exps[k][0], _exps[k][1], _exps[k][2],
+             acd->local[k]);
+
+  fprintf (file, "]}");
+}
+
+/**
+ * aran_cartesian_development3d_p2m:
+ * @position: particle position.
+ * @charge: particle charge.
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranCartesianDevelopment3d.
+ *
+ * Accumulates the multipole expansion of a particle into @dst.
+ */
+void aran_cartesian_development3d_p2m (const VsgVector3d *position,
+                                       const gdouble charge,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranCartesianDevelopment3d *dst)
+{
+  gdouble h[3] = {position->x - dst_node->center.x,
+                  position->y - dst_node->center.y,
+                  position->z - dst_node->center.z};
+
+  _CARTESIAN_DISPATCH (dst->order, _p2m, h, charge, dst->multipole);
+}
+
+/**
+ * aran_cartesian_development3d_p2l:
+ * @position: particle position.
+ * @charge: particle charge.
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranCartesianDevelopment3d.
+ *
+ * Accumulates the local expansion of a distant particle into @dst.
+ */
+void aran_cartesian_development3d_p2l (const VsgVector3d *position,
+                                       const gdouble charge,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranCartesianDevelopment3d *dst)
+{
+  gdouble r[3] = {dst_node->center.x - position->x,
+                  dst_node->center.y - position->y,
+                  dst_node->center.z - position->z};
+
+  _CARTESIAN_DISPATCH (dst->order, _p2l, r, charge, dst->local);
+}
+
+/**
+ * aran_cartesian_development3d_m2m:
+ * @src_node: tree node info of @src.
+ * @src: an #AranCartesianDevelopment3d.
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranCartesianDevelopment3d.
+ *
+ * Translates and accumulates the multipole expansion of @src into @dst
+ * multipole expansion.
+ */
+void aran_cartesian_development3d_m2m (const VsgPRTree3dNodeInfo *src_node,
+                                       AranCartesianDevelopment3d *src,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranCartesianDevelopment3d *dst)
+{
+  gdouble d[3] = {src_node->center.x - dst_node->center.x,
+                  src_node->center.y - dst_node->center.y,
+                  src_node->center.z - dst_node->center.z};
+
+  g_return_if_fail (src->order == dst->order);
+
+  _CARTESIAN_DISPATCH (dst->order, _m2m, d, src->multipole, dst->multipole);
+}
+
+/**
+ * aran_cartesian_development3d_m2l:
+ * @src_node: tree node info of @src.
+ * @src: an #AranCartesianDevelopment3d.
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranCartesianDevelopment3d.
+ *
+ * Translates and accumulates the multipole expansion of @src into @dst
+ * local expansion. The translation is truncated to terms of total order
+ * less or equal to @dst order.
+ */
+void aran_cartesian_development3d_m2l (const VsgPRTree3dNodeInfo *src_node,
+                                       AranCartesianDevelopment3d *src,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranCartesianDevelopment3d *dst)
+{
+  gdouble r[3] = {dst_node->center.x - src_node->center.x,
+                  dst_node->center.y - src_node->center.y,
+                  dst_node->center.z - src_node->center.z};
+
+  g_return_if_fail (src->order == dst->order);
+
+  _CARTESIAN_DISPATCH (dst->order, _m2l, r, src->multipole, dst->local);
+}
+
+/**
+ * aran_cartesian_development3d_l2l:
+ * @src_node: tree node info of @src.
+ * @src: an #AranCartesianDevelopment3d.
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranCartesianDevelopment3d.
+ *
+ * Translates and accumulates the local expansion of @src into @dst local
+ * expansion.
+ */
+void aran_cartesian_development3d_l2l (const VsgPRTree3dNodeInfo *src_node,
+                                       AranCartesianDevelopment3d *src,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranCartesianDevelopment3d *dst)
+{
+  gdouble d[3] = {dst_node->center.x - src_node->center.x,
+                  dst_node->center.y - src_node->center.y,
+                  dst_node->center.z - src_node->center.z};
+
+  g_return_if_fail (src->order == dst->order);
+
+  _CARTESIAN_DISPATCH (dst->order, _l2l, d, src->local, dst->local);
+}
+
+/**
+ * aran_cartesian_development3d_m2p:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranCartesianDevelopment3d.
+ * @pos: evaluation position.
+ *
+ * Evaluates the multipole expansion of @devel at @pos.
+ *
+ * Returns: value of multipole expansion of @devel(@pos).
+ */
+gdouble aran_cartesian_development3d_m2p (const VsgPRTree3dNodeInfo *devel_node,
+                                          AranCartesianDevelopment3d *devel,
+                                          const VsgVector3d *pos)
+{
+  gdouble r[3] = {pos->x - devel_node->center.x,
+                  pos->y - devel_node->center.y,
+                  pos->z - devel_node->center.z};
+  gdouble res = 0.;
+
+  _CARTESIAN_DISPATCH (devel->order, _m2p, r, devel->multipole, &res);
+
+  return res;
+}
+
+/**
+ * aran_cartesian_development3d_l2p:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranCartesianDevelopment3d.
+ * @pos: evaluation position.
+ *
+ * Evaluates the local expansion of @devel at @pos.
+ *
+ * Returns: value of local expansion of @devel(@pos).
+ */
+gdouble aran_cartesian_development3d_l2p (const VsgPRTree3dNodeInfo *devel_node,
+                                          AranCartesianDevelopment3d *devel,
+                                          const VsgVector3d *pos)
+{
+  gdouble h[3] = {pos->x - devel_node->center.x,
+                  pos->y - devel_node->center.y,
+                  pos->z - devel_node->center.z};
+  gdouble res = 0.;
+
+  _CARTESIAN_DISPATCH (devel->order, _l2p, h, devel->local, &res);
+
+  return res;
+}
+
+/**
+ * aran_cartesian_development3d_m2pv:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranCartesianDevelopment3d.
+ * @pos: evaluation position.
+ * @grad: result gradient.
+ *
+ * Evaluates the gradient of @devel multipole expansion at @pos.
+ */
+void aran_cartesian_development3d_m2pv (const VsgPRTree3dNodeInfo *devel_node,
+                                        AranCartesianDevelopment3d *devel,
+                                        const VsgVector3d *pos,
+                                        VsgVector3d *grad)
+{
+  gdouble r[3] = {pos->x - devel_node->center.x,
+                  pos->y - devel_node->center.y,
+                  pos->z - devel_node->center.z};
+
+  _CARTESIAN_DISPATCH (devel->order, _m2pv, r, devel->multipole, grad);
+}
+
+/**
+ * aran_cartesian_development3d_l2pv:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranCartesianDevelopment3d.
+ * @pos: evaluation position.
+ * @grad: result gradient.
+ *
+ * Evaluates the gradient of @devel local expansion at @pos.
+ */
+void aran_cartesian_development3d_l2pv (const VsgPRTree3dNodeInfo *devel_node,
+                                        AranCartesianDevelopment3d *devel,
+                                        const VsgVector3d *pos,
+                                        VsgVector3d *grad)
+{
+  gdouble h[3] = {pos->x - devel_node->center.x,
+                  pos->y - devel_node->center.y,
+                  pos->z - devel_node->center.z};
+
+  _CARTESIAN_DISPATCH (devel->order, _l2pv, h, devel->local, grad);
+}
+
+/**
+ * aran_cartesian_development3d_p2m_multiple:
+ * @n: number of particles.
+ * @x: particles x coordinates.
+ * @y: particles y coordinates.
+ * @z: particles z coordinates.
+ * @charges: particles charges.
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranCartesianDevelopment3d.
+ *
+ * Accumulates the multipole expansions of @n particles into @dst. Particles
+ * are processed by packets with particle loops innermost, allowing the
+ * compiler to vectorize them.
+ */
+void
+aran_cartesian_development3d_p2m_multiple (guint n,
+                                           const gdouble *x,
+                                           const gdouble *y,
+                                           const gdouble *z,
+                                           const gdouble *charges,
+                                           const VsgPRTree3dNodeInfo *dst_node,
+                                           AranCartesianDevelopment3d *dst)
+{
+  g_return_if_fail (dst != NULL);
+
+  _CARTESIAN_DISPATCH (dst->order, _p2m_multiple, n, x, y, z, charges,
+                       &dst_node->center, dst->multipole);
+}
+
+/**
+ * aran_cartesian_development3d_l2p_multiple:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranCartesianDevelopment3d.
+ * @n: number of particles.
+ * @x: particles x coordinates.
+ * @y: particles y coordinates.
+ * @z: particles z coordinates.
+ * @potentials: potential accumulation array or %NULL.
+ * @gx: gradient x component accumulation array or %NULL.
+ * @gy: gradient y component accumulation array or %NULL.
+ * @gz: gradient z component accumulation array or %NULL.
+ *
+ * Accumulates the values of @devel local expansion and its gradient at @n
+ * positions. The gradient expansion is computed once for all particles,
+ * which are then processed by packets with particle loops innermost.
+ */
+void
+aran_cartesian_development3d_l2p_multiple (const VsgPRTree3dNodeInfo *devel_node,
+                                           AranCartesianDevelopment3d *devel,
+                                           guint n,
+                                           const gdouble *x,
+                                           const gdouble *y,
+                                           const gdouble *z,
+                                           gdouble *potentials,
+                                           gdouble *gx, gdouble *gy,
+                                           gdouble *gz)
+{
+  g_return_if_fail (devel != NULL);
+
+  _CARTESIAN_DISPATCH (devel->order, _l2p_multiple, &devel_node->center,
+                       devel->local, n, x, y, z, potentials, gx, gy, gz);
+}
+
+#ifdef VSG_HAVE_MPI
+
+void aran_cartesian_development3d_vtable_init (VsgParallelVTable *vtable,
+                                               guint8 order)
+{
+  vtable->alloc =
+    (VsgMigrableAllocDataFunc) aran_cartesian_development3d_alloc;
+  vtable->alloc_data = aran_cartesian_development3d_new (order);
+
+  vtable->destroy = aran_cartesian_development3d_destroy;
+  vtable->destroy_data = NULL;
+
+  vtable->migrate.pack =
+    (VsgMigrablePackDataFunc) aran_cartesian_development3d_migrate_pack;
+  vtable->migrate.pack_data = NULL;
+
+  vtable->migrate.unpack =
+    (VsgMigrablePackDataFunc) aran_cartesian_development3d_migrate_unpack;
+  vtable->migrate.unpack_data = NULL;
+
+  vtable->visit_forward.pack =
+    (VsgMigrablePackDataFunc) aran_cartesian_development3d_visit_fw_pack;
+  vtable->visit_forward.pack_data = NULL;
+
+  vtable->visit_forward.unpack =
+    (VsgMigrablePackDataFunc) aran_cartesian_development3d_visit_fw_unpack;
+  vtable->visit_forward.unpack_data = NULL;
+
+  vtable->visit_forward.reduce =
+    (VsgMigrableReductionDataFunc) aran_cartesian_development3d_visit_fw_reduce;
+  vtable->visit_forward.reduce_data = NULL;
+
+  vtable->visit_backward.pack =
+    (VsgMigrablePackDataFunc) aran_cartesian_development3d_visit_bw_pack;
+  vtable->visit_backward.pack_data = NULL;
+
+  vtable->visit_backward.unpack =
+    (VsgMigrablePackDataFunc) aran_cartesian_development3d_visit_bw_unpack;
+  vtable->visit_backward.unpack_data = NULL;
+
+  vtable->visit_backward.reduce =
+    (VsgMigrableReductionDataFunc) aran_cartesian_development3d_visit_bw_reduce;
+  vtable->visit_backward.reduce_data = NULL;
+}
+
+void aran_cartesian_development3d_vtable_clear (VsgParallelVTable *vtable)
+{
+  g_return_if_fail (vtable != NULL);
+  g_return_if_fail (vtable->alloc_data != NULL);
+
+  aran_cartesian_development3d_free (vtable->alloc_data);
+}
+
+/**
+ * aran_cartesian_development3d_alloc:
+ * @resident: unused.
+ * @src: an example #AranCartesianDevelopment3d to copy from.
+ *
+ * Allocates a new #AranCartesianDevelopment3d by clonig @src.
+ *
+ * Returns: a copy of @src.
+ */
+gpointer aran_cartesian_development3d_alloc (gboolean resident,
+                                             AranCartesianDevelopment3d *src)
+{
+  return g_boxed_copy (ARAN_TYPE_CARTESIAN_DEVELOPMENT3D, src);
+}
+
+/**
+ * aran_cartesian_development3d_destroy:
+ * @data: A #AranCartesianDevelopment3d.
+ * @resident: unused.
+ * @user_data: unused.
+ *
+ * Deletes @data from memory.
+ */
+void aran_cartesian_development3d_destroy (gpointer data, gboolean resident,
+                                           gpointer user_data)
+{
+  g_assert (data != NULL);
+  g_boxed_free (ARAN_TYPE_CARTESIAN_DEVELOPMENT3D, data);
+}
+
+/**
+ * aran_cartesian_development3d_migrate_pack:
+ * @devel: an #AranCartesianDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs complete packing of @devel into @pm for a migration
+ * between processors.
+ */
+void
+aran_cartesian_development3d_migrate_pack (AranCartesianDevelopment3d *devel,
+                                           VsgPackedMsg *pm,
+                                           gpointer user_data)
+{
+  vsg_packed_msg_send_append (pm, devel->multipole,
+                              _NTERMS (devel->order), MPI_DOUBLE);
+  vsg_packed_msg_send_append (pm, devel->local,
+                              _NTERMS (devel->order), MPI_DOUBLE);
+}
+
+/**
+ * aran_cartesian_development3d_migrate_unpack:
+ * @devel: an #AranCartesianDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm in a migration between processors and
+ * stores it in @devel.
+ */
+void
+aran_cartesian_development3d_migrate_unpack (AranCartesianDevelopment3d *devel,
+                                             VsgPackedMsg *pm,
+                                             gpointer user_data)
+{
+  vsg_packed_msg_recv_read (pm, devel->multipole,
+                            _NTERMS (devel->order), MPI_DOUBLE);
+  vsg_packed_msg_recv_read (pm, devel->local,
+                            _NTERMS (devel->order), MPI_DOUBLE);
+}
+
+/**
+ * aran_cartesian_development3d_visit_fw_pack:
+ * @devel: an #AranCartesianDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs packing of @devel into @pm for a near/far forward visit
+ * of a local node to another processor.
+ */
+void
+aran_cartesian_development3d_visit_fw_pack (AranCartesianDevelopment3d *devel,
+                                            VsgPackedMsg *pm,
+                                            gpointer user_data)
+{
+  vsg_packed_msg_send_append (pm, devel->multipole,
+                              _NTERMS (devel->order), MPI_DOUBLE);
+}
+
+/**
+ * aran_cartesian_development3d_visit_fw_unpack:
+ * @devel: an #AranCartesianDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm for a near/far forward visit of a
+ * remote node.
+ */
+void
+aran_cartesian_development3d_visit_fw_unpack (AranCartesianDevelopment3d *devel,
+                                              VsgPackedMsg *pm,
+                                              gpointer user_data)
+{
+  vsg_packed_msg_recv_read (pm, devel->multipole,
+                            _NTERMS (devel->order), MPI_DOUBLE);
+}
+
+/**
+ * aran_cartesian_development3d_visit_fw_reduce:
+ * @a: source #AranCartesianDevelopment3d.
+ * @b: destination #AranCartesianDevelopment3d.
+ * @user_data: unused.
+ *
+ * Forward visit reduction operator for #AranCartesianDevelopment3d.
+ */
+void
+aran_cartesian_development3d_visit_fw_reduce (AranCartesianDevelopment3d *a,
+                                              AranCartesianDevelopment3d *b,
+                                              gpointer user_data)
+{
+  guint k;
+
+  for (k = 0; k < _NTERMS (b->order); k++)
+    b->multipole[k] += a->multipole[k];
+}
+
+/**
+ * aran_cartesian_development3d_visit_bw_pack:
+ * @devel: an #AranCartesianDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs packing of @devel into @pm for a near/far backward visit
+ * of a remote node to its original processor.
+ */
+void
+aran_cartesian_development3d_visit_bw_pack (AranCartesianDevelopment3d *devel,
+                                            VsgPackedMsg *pm,
+                                            gpointer user_data)
+{
+  vsg_packed_msg_send_append (pm, devel->local,
+                              _NTERMS (devel->order), MPI_DOUBLE);
+}
+
+/**
+ * aran_cartesian_development3d_visit_bw_unpack:
+ * @devel: an #AranCartesianDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm for a near/far backward visit of a
+ * remote node.
+ */
+void
+aran_cartesian_development3d_visit_bw_unpack (AranCartesianDevelopment3d *devel,
+                                              VsgPackedMsg *pm,
+                                              gpointer user_data)
+{
+  vsg_packed_msg_recv_read (pm, devel->local,
+                            _NTERMS (devel->order), MPI_DOUBLE);
+}
+
+/**
+ * aran_cartesian_development3d_visit_bw_reduce:
+ * @a: source #AranCartesianDevelopment3d.
+ * @b: destination #AranCartesianDevelopment3d.
+ * @user_data: unused.
+ *
+ * Backward visit reduction operator for #AranCartesianDevelopment3d.
+ */
+void
+aran_cartesian_development3d_visit_bw_reduce (AranCartesianDevelopment3d *a,
+                                              AranCartesianDevelopment3d *b,
+                                              gpointer user_data)
+{
+  guint k;
+
+  for (k = 0; k < _NTERMS (b->order); k++)
+    b->local[k] += a->local[k];
+}
+
+#endif /* VSG_HAVE_MPI */
@@ -0,0 +1,204 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __ARAN_CARTESIAN_DEVELOPMENT3D_H__
+#define __ARAN_CARTESIAN_DEVELOPMENT3D_H__
+
+#include <stdio.h>
+
+#include <glib-object.h>
+
+#include <vsg/vsgd.h>
+#ifdef VSG_HAVE_MPI
+#include <vsg/vsgpackedmsg.h>
+#endif
+
+G_BEGIN_DECLS;
+
+/* macros */
+#define ARAN_TYPE_CARTESIAN_DEVELOPMENT3D \
+(aran_cartesian_development3d_get_type ())
+
+#define ARAN_CARTESIAN_DEVELOPMENT3D_MAX_ORDER (4)
+
+#define ARAN_CARTESIAN_DEVELOPMENT3D_SIZE(order) \
+((((order)+1) * ((order)+2) * ((order)+3)) / 6)
+
+/* typedefs */
+
+typedef struct _AranCartesianDevelopment3d AranCartesianDevelopment3d;
+
+struct _AranCartesianDevelopment3d
+{
+  guint8 order;
+
+  gdouble multipole[ARAN_CARTESIAN_DEVELOPMENT3D_SIZE (ARAN_CARTESIAN_DEVELOPMENT3D_MAX_ORDER)];
+  gdouble local[ARAN_CARTESIAN_DEVELOPMENT3D_SIZE (ARAN_CARTESIAN_DEVELOPMENT3D_MAX_ORDER)];
+};
+
+/* functions */
+GType aran_cartesian_development3d_get_type ();
+
+AranCartesianDevelopment3d *aran_cartesian_development3d_new (guint8 order);
+
+void aran_cartesian_development3d_free (AranCartesianDevelopment3d *acd);
+
+void aran_cartesian_development3d_copy (const AranCartesianDevelopment3d *src,
+                                        AranCartesianDevelopment3d *dst);
+
+AranCartesianDevelopment3d *
+aran_cartesian_development3d_clone (AranCartesianDevelopment3d *src);
+
+void aran_cartesian_development3d_set_zero (AranCartesianDevelopment3d *acd);
+
+guint8
+aran_cartesian_development3d_get_order (const AranCartesianDevelopment3d *acd);
+
+gdouble *
+aran_cartesian_development3d_get_multipole_term (AranCartesianDevelopment3d *acd,
+                                                 guint a, guint b, guint c);
+
+gdouble *
+aran_cartesian_development3d_get_local_term (AranCartesianDevelopment3d *acd,
+                                             guint a, guint b, guint c);
+
+void aran_cartesian_development3d_write (AranCartesianDevelopment3d *acd,
+                                         FILE *file);
+
+void aran_cartesian_development3d_p2m (const VsgVector3d *position,
+                                       const gdouble charge,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranCartesianDevelopment3d *dst);
+
+void aran_cartesian_development3d_p2l (const VsgVector3d *position,
+                                       const gdouble charge,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranCartesianDevelopment3d *dst);
+
+void aran_cartesian_development3d_m2m (const VsgPRTree3dNodeInfo *src_node,
+                                       AranCartesianDevelopment3d *src,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranCartesianDevelopment3d *dst);
+
+void aran_cartesian_development3d_m2l (const VsgPRTree3dNodeInfo *src_node,
+                                       AranCartesianDevelopment3d *src,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranCartesianDevelopment3d *dst);
+
+void aran_cartesian_development3d_l2l (const VsgPRTree3dNodeInfo *src_node,
+                                       AranCartesianDevelopment3d *src,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranCartesianDevelopment3d *dst);
+
+gdouble aran_cartesian_development3d_m2p (const VsgPRTree3dNodeInfo *devel_node,
+                                          AranCartesianDevelopment3d *devel,
+                                          const VsgVector3d *pos);
+
+gdouble aran_cartesian_development3d_l2p (const VsgPRTree3dNodeInfo *devel_node,
+                                          AranCartesianDevelopment3d *devel,
+                                          const VsgVector3d *pos);
+
+void aran_cartesian_development3d_m2pv (const VsgPRTree3dNodeInfo *devel_node,
+                                        AranCartesianDevelopment3d *devel,
+                                        const VsgVector3d *pos,
+                                        VsgVector3d *grad);
+
+void aran_cartesian_development3d_l2pv (const VsgPRTree3dNodeInfo *devel_node,
+                                        AranCartesianDevelopment3d *devel,
+                                        const VsgVector3d *pos,
+                                        VsgVector3d *grad);
+
+void
+aran_cartesian_development3d_p2m_multiple (guint n,
+                                           const gdouble *x,
+                                           const gdouble *y,
+                                           const gdouble *z,
+                                           const gdouble *charges,
+                                           const VsgPRTree3dNodeInfo *dst_node,
+                                           AranCartesianDevelopment3d *dst);
+
+void
+aran_cartesian_development3d_l2p_multiple (const VsgPRTree3dNodeInfo *devel_node,
+                                           AranCartesianDevelopment3d *devel,
+                                           guint n,
+                                           const gdouble *x,
+                                           const gdouble *y,
+                                           const gdouble *z,
+                                           gdouble *potentials,
+                                           gdouble *gx, gdouble *gy,
+                                           gdouble *gz);
+
+#ifdef VSG_HAVE_MPI
+
+void aran_cartesian_development3d_vtable_init (VsgParallelVTable *vtable,
+                                               guint8 order);
+
+void aran_cartesian_development3d_vtable_clear (VsgParallelVTable *vtable);
+
+gpointer aran_cartesian_development3d_alloc (gboolean resident,
+                                             AranCartesianDevelopment3d *src);
+
+void aran_cartesian_development3d_destroy (gpointer data, gboolean resident,
+                                           gpointer user_data);
+
+void
+aran_cartesian_development3d_migrate_pack (AranCartesianDevelopment3d *devel,
+                                           VsgPackedMsg *pm,
+                                           gpointer user_data);
+
+void
+aran_cartesian_development3d_migrate_unpack (AranCartesianDevelopment3d *devel,
+                                             VsgPackedMsg *pm,
+                                             gpointer user_data);
+
+void
+aran_cartesian_development3d_visit_fw_pack (AranCartesianDevelopment3d *devel,
+                                            VsgPackedMsg *pm,
+                                            gpointer user_data);
+
+void
+aran_cartesian_development3d_visit_fw_unpack (AranCartesianDevelopment3d *devel,
+                                              VsgPackedMsg *pm,
+                                              gpointer user_data);
+
+void
+aran_cartesian_development3d_visit_fw_reduce (AranCartesianDevelopment3d *a,
+                                              AranCartesianDevelopment3d *b,
+                                              gpointer user_data);
+
+void
+aran_cartesian_development3d_visit_bw_pack (AranCartesianDevelopment3d *devel,
+                                            VsgPackedMsg *pm,
+                                            gpointer user_data);
+
+void
+aran_cartesian_development3d_visit_bw_unpack (AranCartesianDevelopment3d *devel,
+                                              VsgPackedMsg *pm,
+                                              gpointer user_data);
+
+void
+aran_cartesian_development3d_visit_bw_reduce (AranCartesianDevelopment3d *a,
+                                              AranCartesianDevelopment3d *b,
+                                              gpointer user_data);
+
+#endif /* VSG_HAVE_MPI */
+
+G_END_DECLS;
+
+#endif /* __ARAN_CARTESIAN_DEVELOPMENT3D_H__ */
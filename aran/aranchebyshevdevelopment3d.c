@@ -0,0 +1,1356 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "aranchebyshevdevelopment3d.h"
+#include "aranlinear.h"
+#include "aranpoly1d.h"
+
+#include <string.h>
+#include <math.h>
+
+/**
+ * ARAN_TYPE_CHEBYSHEV_DEVELOPMENT3D:
+ *
+ * #AranChebyshevDevelopment3d #GBoxed #GType.
+ */
+
+/**
+ * ARAN_CHEBYSHEV3D_MAX_ORDER:
+ *
+ * Maximum number of Chebyshev nodes per dimension of an #AranChebyshev3d.
+ */
+
+/**
+ * AranChebyshev3d:
+ *
+ * An opaque structure holding a smooth #AranKernelFunc3d together with
+ * the Chebyshev interpolation operators of order n: the n cardinal
+ * polynomials, child to parent interpolation matrices and, for each
+ * #VsgPRTree3d level and M2L offset, a low rank factorization of the
+ * kernel matrix between interpolation nodes. M2L factorizations are
+ * built the first time they are needed, then cached.
+ */
+
+/**
+ * AranChebyshevDevelopment3d:
+ * @chebyshev: the #AranChebyshev3d of the development.
+ * @multipole: source weights at the node interpolation points.
+ * @local: potential values at the node interpolation points.
+ *
+ * A structure used as #VsgPRTree3d node_data within an #AranSolver3d for
+ * black box fast multipole computations: the kernel is interpolated on
+ * n^3 tensor Chebyshev points of each node, so that only kernel
+ * evaluations are needed. This suits smooth non oscillatory kernels.
+ */
+
+/* relative tolerance on nodes geometry comparisons */
+#define _GEOMETRY_TOLERANCE (1.e-6)
+
+/* M2L offsets range, in node widths */
+#define _M2L_RANGE (3)
+#define _M2L_WIDTH (2 * _M2L_RANGE + 1)
+#define _M2L_OFFSETS (_M2L_WIDTH * _M2L_WIDTH * _M2L_WIDTH)
+
+typedef struct _ChebyshevM2L ChebyshevM2L;
+
+/* kernel matrix ~= u * vt, u is size x rank and vt is rank x size */
+struct _ChebyshevM2L
+{
+  guint rank;
+
+  gdouble *u;
+  gdouble *vt;
+};
+
+typedef struct _ChebyshevLevel ChebyshevLevel;
+
+struct _ChebyshevLevel
+{
+  VsgVector3d half;
+
+  ChebyshevM2L *m2l[_M2L_OFFSETS];
+};
+
+struct _AranChebyshev3d
+{
+  guint ref_count;
+
+  AranKernelFunc3d func;
+  guint dim;
+  gpointer user_data;
+
+  guint order;
+  guint npoints;
+  guint size;
+
+  gdouble epsilon;
+
+  /* Chebyshev nodes and their cardinal polynomials */
+  gdouble *nodes;
+  AranPoly1d **cardinal;
+
+  /* cardinal polynomials at children nodes (lower and upper half) */
+  gdouble *child[2];
+
+  GPtrArray *levels;
+
+  guint64 rank_sum;
+  guint rank_count;
+};
+
+static void _chebyshev_m2l_free (ChebyshevM2L *m2l)
+{
+  if (m2l == NULL) return;
+
+  g_free (m2l->u);
+  g_free (m2l->vt);
+  g_free (m2l);
+}
+
+static void _chebyshev_level_free (ChebyshevLevel *level)
+{
+  gint i;
+
+  for (i=0; i<_M2L_OFFSETS; i++)
+    _chebyshev_m2l_free (level->m2l[i]);
+
+  g_free (level);
+}
+
+static gboolean _close (gdouble a, gdouble b, gdouble scale)
+{
+  return fabs (a - b) <= _GEOMETRY_TOLERANCE * scale;
+}
+
+static gboolean _half_equal (const VsgVector3d *a, const VsgVector3d *b)
+{
+  return _close (a->x, b->x, a->x) && _close (a->y, b->y, a->y) &&
+    _close (a->z, b->z, a->z);
+}
+
+static void _node_half (const VsgPRTree3dNodeInfo *node, VsgVector3d *half)
+{
+  vsg_vector3d_sub (&node->ubound, &node->lbound, half);
+  vsg_vector3d_scalp (half, 0.5, half);
+}
+
+static ChebyshevLevel *_chebyshev_level (AranChebyshev3d *chebyshev,
+                                         const VsgVector3d *half)
+{
+  ChebyshevLevel *level;
+  guint i;
+
+  for (i=0; i<chebyshev->levels->len; i++)
+    {
+      level = g_ptr_array_index (chebyshev->levels, i);
+
+      if (_half_equal (&level->half, half)) return level;
+    }
+
+  level = g_malloc0 (sizeof (ChebyshevLevel));
+  level->half = *half;
+
+  g_ptr_array_add (chebyshev->levels, level);
+
+  return level;
+}
+
+/* octant of child in parent or -1 when they are not child and parent */
+static gint _child_octant (const VsgPRTree3dNodeInfo *child,
+                           const VsgVector3d *chalf,
+                           const VsgPRTree3dNodeInfo *parent,
+                           const VsgVector3d *phalf)
+{
+  VsgVector3d d;
+
+  if (!_close (phalf->x, 2. * chalf->x, phalf->x) ||
+      !_close (phalf->y, 2. * chalf->y, phalf->y) ||
+      !_close (phalf->z, 2. * chalf->z, phalf->z))
+    return -1;
+
+  vsg_vector3d_sub (&child->center, &parent->center, &d);
+
+  if (!_close (fabs (d.x), chalf->x, chalf->x) ||
+      !_close (fabs (d.y), chalf->y, chalf->y) ||
+      !_close (fabs (d.z), chalf->z, chalf->z))
+    return -1;
+
+  return (d.x > 0. ? 1 : 0) | (d.y > 0. ? 2 : 0) | (d.z > 0. ? 4 : 0);
+}
+
+static gboolean _offset_component (gdouble d, gdouble width, gint *o)
+{
+  gdouble r = d / width;
+
+  *o = (gint) floor (r + 0.5);
+
+  return fabs (r - *o) <= _GEOMETRY_TOLERANCE &&
+    ABS (*o) <= _M2L_RANGE;
+}
+
+/* M2L operator index between same size nodes or -1 */
+static gint _m2l_index (const VsgPRTree3dNodeInfo *src_node,
+                        const VsgVector3d *shalf,
+                        const VsgPRTree3dNodeInfo *dst_node,
+                        const VsgVector3d *dhalf)
+{
+  VsgVector3d d;
+  gint ox, oy, oz;
+
+  if (!_half_equal (shalf, dhalf)) return -1;
+
+  vsg_vector3d_sub (&src_node->center, &dst_node->center, &d);
+
+  if (!_offset_component (d.x, 2. * dhalf->x, &ox) ||
+      !_offset_component (d.y, 2. * dhalf->y, &oy) ||
+      !_offset_component (d.z, 2. * dhalf->z, &oz))
+    return -1;
+
+  return ((ox + _M2L_RANGE) * _M2L_WIDTH + oy + _M2L_RANGE) * _M2L_WIDTH +
+    oz + _M2L_RANGE;
+}
+
+/* m-th interpolation point of the node (center, half) */
+static void _interpolation_point (const AranChebyshev3d *chebyshev, guint m,
+                                  const VsgVector3d *center,
+                                  const VsgVector3d *half,
+                                  VsgVector3d *result)
+{
+  guint n = chebyshev->order;
+
+  result->x = center->x + half->x * chebyshev->nodes[m / (n*n)];
+  result->y = center->y + half->y * chebyshev->nodes[(m / n) % n];
+  result->z = center->z + half->z * chebyshev->nodes[m % n];
+}
+
+/* cardinal polynomials values at pos, per dimension */
+static void _cardinal_evaluate (const AranChebyshev3d *chebyshev,
+                                const VsgVector3d *center,
+                                const VsgVector3d *half,
+                                const VsgVector3d *pos,
+                                gdouble *sx, gdouble *sy, gdouble *sz)
+{
+  gdouble ux = (pos->x - center->x) / half->x;
+  gdouble uy = (pos->y - center->y) / half->y;
+  gdouble uz = (pos->z - center->z) / half->z;
+  guint k;
+
+  for (k=0; k<chebyshev->order; k++)
+    {
+      sx[k] = aran_poly1d_eval (chebyshev->cardinal[k], ux);
+      sy[k] = aran_poly1d_eval (chebyshev->cardinal[k], uy);
+      sz[k] = aran_poly1d_eval (chebyshev->cardinal[k], uz);
+    }
+}
+
+/* kernel matrix between target and source interpolation points */
+static void _kernel_matrix (const AranChebyshev3d *chebyshev,
+                            const VsgVector3d *tcenter,
+                            const VsgVector3d *thalf,
+                            const VsgVector3d *scenter,
+                            const VsgVector3d *shalf,
+                            gdouble *mat)
+{
+  guint dim = chebyshev->dim, size = chebyshev->size;
+  gdouble values[dim * dim];
+  VsgVector3d t, s;
+  guint i, j, a, b;
+
+  for (i=0; i<chebyshev->npoints; i++)
+    {
+      _interpolation_point (chebyshev, i, tcenter, thalf, &t);
+
+      for (j=0; j<chebyshev->npoints; j++)
+        {
+          _interpolation_point (chebyshev, j, scenter, shalf, &s);
+
+          chebyshev->func (&t, &s, values, chebyshev->user_data);
+
+          for (a=0; a<dim; a++)
+            for (b=0; b<dim; b++)
+              mat[(i*dim + a) * size + j*dim + b] = values[a*dim + b];
+        }
+    }
+}
+
+/* compresses the M2L kernel matrix of an offset into low rank factors */
+static ChebyshevM2L *_m2l_operator (AranChebyshev3d *chebyshev,
+                                    ChebyshevLevel *level, gint index)
+{
+  ChebyshevM2L *m2l;
+  VsgVector3d origin = {0., 0., 0.};
+  VsgVector3d offset;
+  guint size = chebyshev->size;
+  gdouble *mat, *vdata;
+  gdouble *u[size], *v[size];
+  gdouble w[size], wmax = 0.;
+  guint kept[size];
+  guint i, j, r, rank = 0;
+
+  if (level->m2l[index] != NULL) return level->m2l[index];
+
+  offset.x = 2. * level->half.x *
+    (index / (_M2L_WIDTH * _M2L_WIDTH) - _M2L_RANGE);
+  offset.y = 2. * level->half.y *
+    ((index / _M2L_WIDTH) % _M2L_WIDTH - _M2L_RANGE);
+  offset.z = 2. * level->half.z * (index % _M2L_WIDTH - _M2L_RANGE);
+
+  mat = g_malloc (size * size * sizeof (gdouble));
+  vdata = g_malloc (size * size * sizeof (gdouble));
+
+  _kernel_matrix (chebyshev, &origin, &level->half, &offset, &level->half,
+                  mat);
+
+  for (i=0; i<size; i++)
+    {
+      u[i] = mat + i * size;
+      v[i] = vdata + i * size;
+    }
+
+  aran_svd (size, size, u, w, v);
+
+  for (j=0; j<size; j++)
+    if (w[j] > wmax) wmax = w[j];
+
+  /* singular values are not sorted */
+  for (j=0; j<size; j++)
+    if (w[j] > wmax * chebyshev->epsilon) kept[rank++] = j;
+
+  m2l = g_malloc (sizeof (ChebyshevM2L));
+  m2l->rank = rank;
+  m2l->u = g_malloc (size * rank * sizeof (gdouble));
+  m2l->vt = g_malloc (rank * size * sizeof (gdouble));
+
+  for (r=0; r<rank; r++)
+    {
+      for (i=0; i<size; i++)
+        m2l->u[i*rank + r] = u[i][kept[r]] * w[kept[r]];
+
+      for (j=0; j<size; j++)
+        m2l->vt[r*size + j] = v[j][kept[r]];
+    }
+
+  g_free (mat);
+  g_free (vdata);
+
+  chebyshev->rank_sum += rank;
+  chebyshev->rank_count ++;
+
+  level->m2l[index] = m2l;
+
+  return m2l;
+}
+
+/* out = 1D interpolation matrix applied along one axis of in */
+static void _apply_axis (const AranChebyshev3d *chebyshev,
+                         const gdouble *mat, gboolean transpose,
+                         guint stride, const gdouble *in, gdouble *out)
+{
+  guint n = chebyshev->order;
+  guint idx, k;
+
+  for (idx=0; idx<chebyshev->size; idx++)
+    {
+      guint i = (idx / stride) % n;
+      const gdouble *base = in + idx - i * stride;
+      gdouble sum = 0.;
+
+      if (transpose)
+        for (k=0; k<n; k++) sum += mat[k*n + i] * base[k * stride];
+      else
+        for (k=0; k<n; k++) sum += mat[i*n + k] * base[k * stride];
+
+      out[idx] = sum;
+    }
+}
+
+/* result += tensor product interpolation between a child and its parent */
+static void _child_interpolate (const AranChebyshev3d *chebyshev,
+                                gint octant, gboolean transpose,
+                                const gdouble *in, gdouble *result)
+{
+  guint n = chebyshev->order, dim = chebyshev->dim;
+  guint size = chebyshev->size;
+  gdouble t1[size], t2[size], t3[size];
+  guint i;
+
+  _apply_axis (chebyshev, chebyshev->child[(octant & 1) ? 1 : 0], transpose,
+               n * n * dim, in, t1);
+  _apply_axis (chebyshev, chebyshev->child[(octant & 2) ? 1 : 0], transpose,
+               n * dim, t1, t2);
+  _apply_axis (chebyshev, chebyshev->child[(octant & 4) ? 1 : 0], transpose,
+               dim, t2, t3);
+
+  for (i=0; i<size; i++)
+    result[i] += t3[i];
+}
+
+/* values = kernel interactions of node interpolation points with pos */
+static void _points_evaluate (AranChebyshev3d *chebyshev,
+                              const VsgVector3d *center,
+                              const VsgVector3d *half,
+                              const gdouble *weights,
+                              const VsgVector3d *pos, gdouble *values)
+{
+  guint dim = chebyshev->dim;
+  gdouble k[dim * dim];
+  VsgVector3d s;
+  guint j, a, b;
+
+  for (a=0; a<dim; a++)
+    values[a] = 0.;
+
+  for (j=0; j<chebyshev->npoints; j++)
+    {
+      _interpolation_point (chebyshev, j, center, half, &s);
+
+      chebyshev->func (pos, &s, k, chebyshev->user_data);
+
+      for (a=0; a<dim; a++)
+        for (b=0; b<dim; b++)
+          values[a] += k[a*dim + b] * weights[j*dim + b];
+    }
+}
+
+/**
+ * aran_chebyshev3d_new:
+ * @func: the kernel function.
+ * @dim: number of components of sources and targets.
+ * @user_data: user data passed to @func.
+ * @order: number of Chebyshev nodes per dimension.
+ * @epsilon: relative singular value threshold of M2L compression.
+ *
+ * Creates a new #AranChebyshev3d interpolating @func with @order^3
+ * points per node. Larger @order and smaller @epsilon improve accuracy
+ * at the expense of M2L rank, precomputation and memory.
+ *
+ * Returns: newly allocated #AranChebyshev3d.
+ */
+AranChebyshev3d *aran_chebyshev3d_new (AranKernelFunc3d func, guint dim,
+                                       gpointer user_data, guint order,
+                                       gdouble epsilon)
+{
+  AranChebyshev3d *chebyshev;
+  AranPoly1d **t;
+  guint n = order;
+  guint k, m, s;
+
+  g_return_val_if_fail (func != NULL, NULL);
+  g_return_val_if_fail (dim > 0, NULL);
+  g_return_val_if_fail (order >= 1 && order <= ARAN_CHEBYSHEV3D_MAX_ORDER,
+                        NULL);
+  g_return_val_if_fail (epsilon >= 0., NULL);
+
+  chebyshev = g_malloc (sizeof (AranChebyshev3d));
+
+  chebyshev->ref_count = 1;
+  chebyshev->func = func;
+  chebyshev->dim = dim;
+  chebyshev->user_data = user_data;
+  chebyshev->order = n;
+  chebyshev->npoints = n * n * n;
+  chebyshev->size = chebyshev->npoints * dim;
+  chebyshev->epsilon = epsilon;
+  chebyshev->levels = g_ptr_array_new ();
+  chebyshev->rank_sum = 0;
+  chebyshev->rank_count = 0;
+
+  chebyshev->nodes = g_malloc (n * sizeof (gdouble));
+
+  for (m=0; m<n; m++)
+    chebyshev->nodes[m] = cos ((2. * m + 1.) * G_PI / (2. * n));
+
+  /* S_m(x) = 1/n + 2/n sum_k=1^n-1 T_k(x_m) T_k(x) */
+  t = g_malloc (n * sizeof (AranPoly1d *));
+
+  for (k=0; k<n; k++)
+    t[k] = aran_poly1d_new_chebyshev (k);
+
+  chebyshev->cardinal = g_malloc (n * sizeof (AranPoly1d *));
+
+  for (m=0; m<n; m++)
+    {
+      AranPoly1d *tmp = aran_poly1d_new (n - 1);
+      AranPoly1d *sm = aran_poly1d_new (n - 1);
+
+      aran_poly1d_term (sm, 0) = 1. / n;
+
+      for (k=1; k<n; k++)
+        {
+          aran_poly1d_scalp (t[k],
+                             2. / n * aran_poly1d_eval (t[k],
+                                                        chebyshev->nodes[m]),
+                             tmp);
+          aran_poly1d_add (sm, tmp, sm);
+        }
+
+      chebyshev->cardinal[m] = sm;
+
+      aran_poly1d_free (tmp);
+    }
+
+  for (k=0; k<n; k++)
+    aran_poly1d_free (t[k]);
+  g_free (t);
+
+  /* child nodes in parent coordinates are (+/-1 + x_k) / 2 */
+  for (s=0; s<2; s++)
+    {
+      gdouble shift = s ? 0.5 : -0.5;
+
+      chebyshev->child[s] = g_malloc (n * n * sizeof (gdouble));
+
+      for (m=0; m<n; m++)
+        for (k=0; k<n; k++)
+          chebyshev->child[s][m*n + k] =
+            aran_poly1d_eval (chebyshev->cardinal[m],
+                              shift + 0.5 * chebyshev->nodes[k]);
+    }
+
+  return chebyshev;
+}
+
+/**
+ * aran_chebyshev3d_ref:
+ * @chebyshev: an #AranChebyshev3d.
+ *
+ * Increments @chebyshev reference count.
+ *
+ * Returns: @chebyshev.
+ */
+AranChebyshev3d *aran_chebyshev3d_ref (AranChebyshev3d *chebyshev)
+{
+  g_return_val_if_fail (chebyshev != NULL, NULL);
+
+  chebyshev->ref_count ++;
+
+  return chebyshev;
+}
+
+/**
+ * aran_chebyshev3d_unref:
+ * @chebyshev: an #AranChebyshev3d.
+ *
+ * Decrements @chebyshev reference count and deallocates it along with
+ * its cached operators when it drops to zero.
+ */
+void aran_chebyshev3d_unref (AranChebyshev3d *chebyshev)
+{
+  guint m;
+
+  g_return_if_fail (chebyshev != NULL);
+
+  chebyshev->ref_count --;
+
+  if (chebyshev->ref_count > 0) return;
+
+  aran_chebyshev3d_clear_cache (chebyshev);
+
+  for (m=0; m<chebyshev->order; m++)
+    aran_poly1d_free (chebyshev->cardinal[m]);
+
+  g_free (chebyshev->cardinal);
+  g_free (chebyshev->nodes);
+  g_free (chebyshev->child[0]);
+  g_free (chebyshev->child[1]);
+  g_ptr_array_free (chebyshev->levels, TRUE);
+  g_free (chebyshev);
+}
+
+/**
+ * aran_chebyshev3d_get_dim:
+ * @chebyshev: an #AranChebyshev3d.
+ *
+ * Returns: number of components of @chebyshev sources and targets.
+ */
+guint aran_chebyshev3d_get_dim (const AranChebyshev3d *chebyshev)
+{
+  g_return_val_if_fail (chebyshev != NULL, 0);
+
+  return chebyshev->dim;
+}
+
+/**
+ * aran_chebyshev3d_get_order:
+ * @chebyshev: an #AranChebyshev3d.
+ *
+ * Returns: number of Chebyshev nodes per dimension.
+ */
+guint aran_chebyshev3d_get_order (const AranChebyshev3d *chebyshev)
+{
+  g_return_val_if_fail (chebyshev != NULL, 0);
+
+  return chebyshev->order;
+}
+
+/**
+ * aran_chebyshev3d_get_size:
+ * @chebyshev: an #AranChebyshev3d.
+ *
+ * Returns: number of coefficients of a @chebyshev expansion.
+ */
+guint aran_chebyshev3d_get_size (const AranChebyshev3d *chebyshev)
+{
+  g_return_val_if_fail (chebyshev != NULL, 0);
+
+  return chebyshev->size;
+}
+
+/**
+ * aran_chebyshev3d_get_mean_rank:
+ * @chebyshev: an #AranChebyshev3d.
+ *
+ * Gives the mean rank of the M2L operators built so far, which helps
+ * tuning @chebyshev epsilon. Full rank is aran_chebyshev3d_get_size().
+ *
+ * Returns: mean M2L rank or 0 when no M2L operator was built.
+ */
+gdouble aran_chebyshev3d_get_mean_rank (const AranChebyshev3d *chebyshev)
+{
+  g_return_val_if_fail (chebyshev != NULL, 0.);
+
+  if (chebyshev->rank_count == 0) return 0.;
+
+  return chebyshev->rank_sum / (gdouble) chebyshev->rank_count;
+}
+
+/**
+ * aran_chebyshev3d_clear_cache:
+ * @chebyshev: an #AranChebyshev3d.
+ *
+ * Frees all M2L operators cached by @chebyshev. This is needed when
+ * @chebyshev kernel parameters change between two solves.
+ */
+void aran_chebyshev3d_clear_cache (AranChebyshev3d *chebyshev)
+{
+  guint i;
+
+  g_return_if_fail (chebyshev != NULL);
+
+  for (i=0; i<chebyshev->levels->len; i++)
+    _chebyshev_level_free (g_ptr_array_index (chebyshev->levels, i));
+
+  g_ptr_array_set_size (chebyshev->levels, 0);
+
+  chebyshev->rank_sum = 0;
+  chebyshev->rank_count = 0;
+}
+
+GType aran_chebyshev_development3d_get_type ()
+{
+  static GType devtype = G_TYPE_NONE;
+
+  if (G_UNLIKELY (devtype == G_TYPE_NONE))
+    {
+      devtype =
+	g_boxed_type_register_static ("AranChebyshevDevelopment3d",
+				      (GBoxedCopyFunc)
+                                      aran_chebyshev_development3d_clone,
+				      (GBoxedFreeFunc)
+                                      aran_chebyshev_development3d_free);
+    }
+
+  return devtype;
+}
+
+/**
+ * aran_chebyshev_development3d_new:
+ * @chebyshev: an #AranChebyshev3d.
+ *
+ * Allocates a new #AranChebyshevDevelopment3d for @chebyshev.
+ * Coefficients are set to zero.
+ *
+ * Returns: newly allocated structure.
+ */
+AranChebyshevDevelopment3d *
+aran_chebyshev_development3d_new (AranChebyshev3d *chebyshev)
+{
+  AranChebyshevDevelopment3d *result;
+
+  g_return_val_if_fail (chebyshev != NULL, NULL);
+
+  result = g_malloc (sizeof (AranChebyshevDevelopment3d));
+
+  result->chebyshev = aran_chebyshev3d_ref (chebyshev);
+
+  result->multipole = g_malloc0 (2 * chebyshev->size * sizeof (gdouble));
+  result->local = result->multipole + chebyshev->size;
+
+  return result;
+}
+
+/**
+ * aran_chebyshev_development3d_free:
+ * @acd: an #AranChebyshevDevelopment3d.
+ *
+ * Deallocates @acd and all associated memory.
+ */
+void aran_chebyshev_development3d_free (AranChebyshevDevelopment3d *acd)
+{
+  g_return_if_fail (acd != NULL);
+
+  aran_chebyshev3d_unref (acd->chebyshev);
+
+  g_free (acd->multipole);
+  g_free (acd);
+}
+
+/**
+ * aran_chebyshev_development3d_copy:
+ * @src: an #AranChebyshevDevelopment3d.
+ * @dst: an #AranChebyshevDevelopment3d.
+ *
+ * Copies @src into @dst. Both developments must share the same
+ * expansion size.
+ */
+void aran_chebyshev_development3d_copy (const AranChebyshevDevelopment3d *src,
+                                        AranChebyshevDevelopment3d *dst)
+{
+  g_return_if_fail (src != NULL);
+  g_return_if_fail (dst != NULL);
+  g_return_if_fail (src->chebyshev->size == dst->chebyshev->size);
+
+  memcpy (dst->multipole, src->multipole,
+          2 * src->chebyshev->size * sizeof (gdouble));
+}
+
+/**
+ * aran_chebyshev_development3d_clone:
+ * @src: an #AranChebyshevDevelopment3d.
+ *
+ * Duplicates @src.
+ *
+ * Returns: newly allocated copy of @src.
+ */
+AranChebyshevDevelopment3d *
+aran_chebyshev_development3d_clone (AranChebyshevDevelopment3d *src)
+{
+  AranChebyshevDevelopment3d *dst;
+
+  g_return_val_if_fail (src != NULL, NULL);
+
+  dst = aran_chebyshev_development3d_new (src->chebyshev);
+
+  aran_chebyshev_development3d_copy (src, dst);
+
+  return dst;
+}
+
+/**
+ * aran_chebyshev_development3d_set_zero:
+ * @acd: an #AranChebyshevDevelopment3d.
+ *
+ * Sets all @acd coefficients to zero.
+ */
+void aran_chebyshev_development3d_set_zero (AranChebyshevDevelopment3d *acd)
+{
+  g_return_if_fail (acd != NULL);
+
+  memset (acd->multipole, 0, 2 * acd->chebyshev->size * sizeof (gdouble));
+}
+
+/**
+ * aran_chebyshev_development3d_get_chebyshev:
+ * @acd: an #AranChebyshevDevelopment3d.
+ *
+ * Returns: the #AranChebyshev3d of @acd.
+ */
+AranChebyshev3d *
+aran_chebyshev_development3d_get_chebyshev (const AranChebyshevDevelopment3d *acd)
+{
+  g_return_val_if_fail (acd != NULL, NULL);
+
+  return acd->chebyshev;
+}
+
+static void _write_coefficients (const gchar *name, guint size,
+                                 const gdouble *coefs, FILE *file)
+{
+  guint i;
+
+  fprintf (file, "%s [", name);
+
+  for (i=0; i<size; i++)
+    fprintf (file, "%s%g", (i == 0) ? "" : ", ", coefs[i]);
+
+  fprintf (file, "]\n");
+}
+
+/**
+ * aran_chebyshev_development3d_write:
+ * @acd: an #AranChebyshevDevelopment3d.
+ * @file: a #FILE.
+ *
+ * Writes @acd to @file.
+ */
+void aran_chebyshev_development3d_write (AranChebyshevDevelopment3d *acd,
+                                         FILE *file)
+{
+  g_return_if_fail (acd != NULL);
+
+  _write_coefficients ("multipole", acd->chebyshev->size, acd->multipole,
+                       file);
+  _write_coefficients ("local", acd->chebyshev->size, acd->local, file);
+}
+
+/**
+ * aran_chebyshev_development3d_p2m:
+ * @position: particle position.
+ * @charges: particle charges (kernel dim components).
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranChebyshevDevelopment3d.
+ *
+ * Adds the contribution of a particle to the multipole part of @dst.
+ */
+void aran_chebyshev_development3d_p2m (const VsgVector3d *position,
+                                       const gdouble *charges,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranChebyshevDevelopment3d *dst)
+{
+  AranChebyshev3d *chebyshev = dst->chebyshev;
+  guint n = chebyshev->order, dim = chebyshev->dim;
+  gdouble sx[n], sy[n], sz[n];
+  VsgVector3d half;
+  guint mx, my, mz, a;
+  gdouble *w = dst->multipole;
+
+  _node_half (dst_node, &half);
+
+  _cardinal_evaluate (chebyshev, &dst_node->center, &half, position,
+                      sx, sy, sz);
+
+  for (mx=0; mx<n; mx++)
+    for (my=0; my<n; my++)
+      {
+        gdouble sxy = sx[mx] * sy[my];
+
+        for (mz=0; mz<n; mz++)
+          {
+            gdouble s = sxy * sz[mz];
+
+            for (a=0; a<dim; a++)
+              w[a] += s * charges[a];
+
+            w += dim;
+          }
+      }
+}
+
+/**
+ * aran_chebyshev_development3d_p2l:
+ * @position: particle position.
+ * @charges: particle charges (kernel dim components).
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranChebyshevDevelopment3d.
+ *
+ * Adds the contribution of a far particle to the local part of @dst.
+ */
+void aran_chebyshev_development3d_p2l (const VsgVector3d *position,
+                                       const gdouble *charges,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranChebyshevDevelopment3d *dst)
+{
+  AranChebyshev3d *chebyshev = dst->chebyshev;
+  guint dim = chebyshev->dim;
+  gdouble values[dim * dim];
+  VsgVector3d half, t;
+  guint i, a, b;
+
+  _node_half (dst_node, &half);
+
+  for (i=0; i<chebyshev->npoints; i++)
+    {
+      _interpolation_point (chebyshev, i, &dst_node->center, &half, &t);
+
+      chebyshev->func (&t, position, values, chebyshev->user_data);
+
+      for (a=0; a<dim; a++)
+        for (b=0; b<dim; b++)
+          dst->local[i*dim + a] += values[a*dim + b] * charges[b];
+    }
+}
+
+/**
+ * aran_chebyshev_development3d_m2m:
+ * @src_node: tree node info of @src.
+ * @src: an #AranChebyshevDevelopment3d.
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranChebyshevDevelopment3d.
+ *
+ * Translates the multipole part of @src (a child of @dst_node) into the
+ * multipole part of @dst.
+ */
+void aran_chebyshev_development3d_m2m (const VsgPRTree3dNodeInfo *src_node,
+                                       AranChebyshevDevelopment3d *src,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranChebyshevDevelopment3d *dst)
+{
+  AranChebyshev3d *chebyshev = src->chebyshev;
+  VsgVector3d shalf, dhalf, pos;
+  gint octant;
+  guint j;
+
+  _node_half (src_node, &shalf);
+  _node_half (dst_node, &dhalf);
+
+  octant = _child_octant (src_node, &shalf, dst_node, &dhalf);
+
+  if (octant >= 0)
+    {
+      _child_interpolate (chebyshev, octant, FALSE, src->multipole,
+                          dst->multipole);
+      return;
+    }
+
+  /* anterpolate each source weight as a particle */
+  for (j=0; j<chebyshev->npoints; j++)
+    {
+      _interpolation_point (chebyshev, j, &src_node->center, &shalf, &pos);
+
+      aran_chebyshev_development3d_p2m (&pos,
+                                        src->multipole + j * chebyshev->dim,
+                                        dst_node, dst);
+    }
+}
+
+/**
+ * aran_chebyshev_development3d_m2l:
+ * @src_node: tree node info of @src.
+ * @src: an #AranChebyshevDevelopment3d.
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranChebyshevDevelopment3d.
+ *
+ * Translates the multipole part of @src into the local part of @dst.
+ * Between same level nodes, low rank operators are computed once per
+ * relative position and cached.
+ */
+void aran_chebyshev_development3d_m2l (const VsgPRTree3dNodeInfo *src_node,
+                                       AranChebyshevDevelopment3d *src,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranChebyshevDevelopment3d *dst)
+{
+  AranChebyshev3d *chebyshev = src->chebyshev;
+  guint size = chebyshev->size;
+  VsgVector3d shalf, dhalf;
+  gint index;
+  guint i, j, r;
+
+  _node_half (src_node, &shalf);
+  _node_half (dst_node, &dhalf);
+
+  index = _m2l_index (src_node, &shalf, dst_node, &dhalf);
+
+  if (index >= 0)
+    {
+      ChebyshevM2L *m2l =
+        _m2l_operator (chebyshev, _chebyshev_level (chebyshev, &dhalf),
+                       index);
+      guint rank = m2l->rank;
+      gdouble tmp[rank];
+
+      for (r=0; r<rank; r++)
+        {
+          const gdouble *row = m2l->vt + r * size;
+          gdouble sum = 0.;
+
+          for (j=0; j<size; j++)
+            sum += row[j] * src->multipole[j];
+
+          tmp[r] = sum;
+        }
+
+      for (i=0; i<size; i++)
+        {
+          const gdouble *row = m2l->u + i * rank;
+          gdouble sum = 0.;
+
+          for (r=0; r<rank; r++)
+            sum += row[r] * tmp[r];
+
+          dst->local[i] += sum;
+        }
+
+      return;
+    }
+
+  /* uncached kernel evaluations */
+  {
+    gdouble *mat = g_malloc (size * size * sizeof (gdouble));
+
+    _kernel_matrix (chebyshev, &dst_node->center, &dhalf,
+                    &src_node->center, &shalf, mat);
+
+    for (i=0; i<size; i++)
+      {
+        const gdouble *row = mat + i * size;
+        gdouble sum = 0.;
+
+        for (j=0; j<size; j++)
+          sum += row[j] * src->multipole[j];
+
+        dst->local[i] += sum;
+      }
+
+    g_free (mat);
+  }
+}
+
+/**
+ * aran_chebyshev_development3d_l2l:
+ * @src_node: tree node info of @src.
+ * @src: an #AranChebyshevDevelopment3d.
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranChebyshevDevelopment3d.
+ *
+ * Translates the local part of @src into the local part of @dst (a
+ * child of @src_node).
+ */
+void aran_chebyshev_development3d_l2l (const VsgPRTree3dNodeInfo *src_node,
+                                       AranChebyshevDevelopment3d *src,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranChebyshevDevelopment3d *dst)
+{
+  AranChebyshev3d *chebyshev = src->chebyshev;
+  guint dim = chebyshev->dim;
+  VsgVector3d shalf, dhalf, pos;
+  gdouble values[dim];
+  gint octant;
+  guint i, a;
+
+  _node_half (src_node, &shalf);
+  _node_half (dst_node, &dhalf);
+
+  octant = _child_octant (dst_node, &dhalf, src_node, &shalf);
+
+  if (octant >= 0)
+    {
+      _child_interpolate (chebyshev, octant, TRUE, src->local, dst->local);
+      return;
+    }
+
+  /* interpolate at each destination point */
+  for (i=0; i<chebyshev->npoints; i++)
+    {
+      _interpolation_point (chebyshev, i, &dst_node->center, &dhalf, &pos);
+
+      aran_chebyshev_development3d_l2p (src_node, src, &pos, values);
+
+      for (a=0; a<dim; a++)
+        dst->local[i*dim + a] += values[a];
+    }
+}
+
+/**
+ * aran_chebyshev_development3d_m2p:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranChebyshevDevelopment3d.
+ * @pos: evaluation position.
+ * @values: result values (kernel dim components).
+ *
+ * Evaluates the multipole part of @devel at @pos.
+ */
+void aran_chebyshev_development3d_m2p (const VsgPRTree3dNodeInfo *devel_node,
+                                       AranChebyshevDevelopment3d *devel,
+                                       const VsgVector3d *pos,
+                                       gdouble *values)
+{
+  VsgVector3d half;
+
+  _node_half (devel_node, &half);
+
+  _points_evaluate (devel->chebyshev, &devel_node->center, &half,
+                    devel->multipole, pos, values);
+}
+
+/**
+ * aran_chebyshev_development3d_l2p:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranChebyshevDevelopment3d.
+ * @pos: evaluation position.
+ * @values: result values (kernel dim components).
+ *
+ * Evaluates the local part of @devel at @pos.
+ */
+void aran_chebyshev_development3d_l2p (const VsgPRTree3dNodeInfo *devel_node,
+                                       AranChebyshevDevelopment3d *devel,
+                                       const VsgVector3d *pos,
+                                       gdouble *values)
+{
+  AranChebyshev3d *chebyshev = devel->chebyshev;
+  guint n = chebyshev->order, dim = chebyshev->dim;
+  gdouble sx[n], sy[n], sz[n];
+  VsgVector3d half;
+  guint mx, my, mz, a;
+  const gdouble *f = devel->local;
+
+  _node_half (devel_node, &half);
+
+  _cardinal_evaluate (chebyshev, &devel_node->center, &half, pos,
+                      sx, sy, sz);
+
+  for (a=0; a<dim; a++)
+    values[a] = 0.;
+
+  for (mx=0; mx<n; mx++)
+    for (my=0; my<n; my++)
+      {
+        gdouble sxy = sx[mx] * sy[my];
+
+        for (mz=0; mz<n; mz++)
+          {
+            gdouble s = sxy * sz[mz];
+
+            for (a=0; a<dim; a++)
+              values[a] += s * f[a];
+
+            f += dim;
+          }
+      }
+}
+
+#ifdef VSG_HAVE_MPI
+
+void aran_chebyshev_development3d_vtable_init (VsgParallelVTable *vtable,
+                                               AranChebyshev3d *chebyshev)
+{
+  vtable->alloc =
+    (VsgMigrableAllocDataFunc) aran_chebyshev_development3d_alloc;
+  vtable->alloc_data = aran_chebyshev_development3d_new (chebyshev);
+
+  vtable->destroy = aran_chebyshev_development3d_destroy;
+  vtable->destroy_data = NULL;
+
+  vtable->migrate.pack =
+    (VsgMigrablePackDataFunc) aran_chebyshev_development3d_migrate_pack;
+  vtable->migrate.pack_data = NULL;
+
+  vtable->migrate.unpack =
+    (VsgMigrablePackDataFunc) aran_chebyshev_development3d_migrate_unpack;
+  vtable->migrate.unpack_data = NULL;
+
+  vtable->visit_forward.pack =
+    (VsgMigrablePackDataFunc) aran_chebyshev_development3d_visit_fw_pack;
+  vtable->visit_forward.pack_data = NULL;
+
+  vtable->visit_forward.unpack =
+    (VsgMigrablePackDataFunc) aran_chebyshev_development3d_visit_fw_unpack;
+  vtable->visit_forward.unpack_data = NULL;
+
+  vtable->visit_forward.reduce =
+    (VsgMigrableReductionDataFunc) aran_chebyshev_development3d_visit_fw_reduce;
+  vtable->visit_forward.reduce_data = NULL;
+
+  vtable->visit_backward.pack =
+    (VsgMigrablePackDataFunc) aran_chebyshev_development3d_visit_bw_pack;
+  vtable->visit_backward.pack_data = NULL;
+
+  vtable->visit_backward.unpack =
+    (VsgMigrablePackDataFunc) aran_chebyshev_development3d_visit_bw_unpack;
+  vtable->visit_backward.unpack_data = NULL;
+
+  vtable->visit_backward.reduce =
+    (VsgMigrableReductionDataFunc) aran_chebyshev_development3d_visit_bw_reduce;
+  vtable->visit_backward.reduce_data = NULL;
+}
+
+void aran_chebyshev_development3d_vtable_clear (VsgParallelVTable *vtable)
+{
+  g_return_if_fail (vtable != NULL);
+  g_return_if_fail (vtable->alloc_data != NULL);
+
+  aran_chebyshev_development3d_free (vtable->alloc_data);
+}
+
+/**
+ * aran_chebyshev_development3d_alloc:
+ * @resident: unused.
+ * @src: an example #AranChebyshevDevelopment3d to copy from.
+ *
+ * Allocates a new #AranChebyshevDevelopment3d by clonig @src.
+ *
+ * Returns: a copy of @src.
+ */
+gpointer aran_chebyshev_development3d_alloc (gboolean resident,
+                                             AranChebyshevDevelopment3d *src)
+{
+  return g_boxed_copy (ARAN_TYPE_CHEBYSHEV_DEVELOPMENT3D, src);
+}
+
+/**
+ * aran_chebyshev_development3d_destroy:
+ * @data: A #AranChebyshevDevelopment3d.
+ * @resident: unused.
+ * @user_data: unused.
+ *
+ * Deletes @data from memory.
+ */
+void aran_chebyshev_development3d_destroy (gpointer data, gboolean resident,
+                                           gpointer user_data)
+{
+  g_assert (data != NULL);
+  g_boxed_free (ARAN_TYPE_CHEBYSHEV_DEVELOPMENT3D, data);
+}
+
+/**
+ * aran_chebyshev_development3d_migrate_pack:
+ * @devel: an #AranChebyshevDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs complete packing of @devel into @pm for a migration
+ * between processors.
+ */
+void
+aran_chebyshev_development3d_migrate_pack (AranChebyshevDevelopment3d *devel,
+                                           VsgPackedMsg *pm,
+                                           gpointer user_data)
+{
+  vsg_packed_msg_send_append (pm, devel->multipole,
+                              2 * devel->chebyshev->size, MPI_DOUBLE);
+}
+
+/**
+ * aran_chebyshev_development3d_migrate_unpack:
+ * @devel: an #AranChebyshevDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm in a migration between processors and
+ * stores it in @devel.
+ */
+void
+aran_chebyshev_development3d_migrate_unpack (AranChebyshevDevelopment3d *devel,
+                                             VsgPackedMsg *pm,
+                                             gpointer user_data)
+{
+  vsg_packed_msg_recv_read (pm, devel->multipole,
+                            2 * devel->chebyshev->size, MPI_DOUBLE);
+}
+
+/**
+ * aran_chebyshev_development3d_visit_fw_pack:
+ * @devel: an #AranChebyshevDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs packing of @devel into @pm for a near/far forward visit
+ * of a local node to another processor.
+ */
+void
+aran_chebyshev_development3d_visit_fw_pack (AranChebyshevDevelopment3d *devel,
+                                            VsgPackedMsg *pm,
+                                            gpointer user_data)
+{
+  vsg_packed_msg_send_append (pm, devel->multipole,
+                              devel->chebyshev->size, MPI_DOUBLE);
+}
+
+/**
+ * aran_chebyshev_development3d_visit_fw_unpack:
+ * @devel: an #AranChebyshevDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm for a near/far forward visit of a
+ * remote node.
+ */
+void
+aran_chebyshev_development3d_visit_fw_unpack (AranChebyshevDevelopment3d *devel,
+                                              VsgPackedMsg *pm,
+                                              gpointer user_data)
+{
+  vsg_packed_msg_recv_read (pm, devel->multipole,
+                            devel->chebyshev->size, MPI_DOUBLE);
+}
+
+/**
+ * aran_chebyshev_development3d_visit_fw_reduce:
+ * @a: source #AranChebyshevDevelopment3d.
+ * @b: destination #AranChebyshevDevelopment3d.
+ * @user_data: unused.
+ *
+ * Forward visit reduction operator for #AranChebyshevDevelopment3d.
+ */
+void
+aran_chebyshev_development3d_visit_fw_reduce (AranChebyshevDevelopment3d *a,
+                                              AranChebyshevDevelopment3d *b,
+                                              gpointer user_data)
+{
+  guint k;
+
+  for (k = 0; k < b->chebyshev->size; k++)
+    b->multipole[k] += a->multipole[k];
+}
+
+/**
+ * aran_chebyshev_development3d_visit_bw_pack:
+ * @devel: an #AranChebyshevDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs packing of @devel into @pm for a near/far backward visit
+ * of a remote node to its original processor.
+ */
+void
+aran_chebyshev_development3d_visit_bw_pack (AranChebyshevDevelopment3d *devel,
+                                            VsgPackedMsg *pm,
+                                            gpointer user_data)
+{
+  vsg_packed_msg_send_append (pm, devel->local,
+                              devel->chebyshev->size, MPI_DOUBLE);
+}
+
+/**
+ * aran_chebyshev_development3d_visit_bw_unpack:
+ * @devel: an #AranChebyshevDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm for a near/far backward visit of a
+ * remote node.
+ */
+void
+aran_chebyshev_development3d_visit_bw_unpack (AranChebyshevDevelopment3d *devel,
+                                              VsgPackedMsg *pm,
+                                              gpointer user_data)
+{
+  vsg_packed_msg_recv_read (pm, devel->local,
+                            devel->chebyshev->size, MPI_DOUBLE);
+}
+
+/**
+ * aran_chebyshev_development3d_visit_bw_reduce:
+ * @a: source #AranChebyshevDevelopment3d.
+ * @b: destination #AranChebyshevDevelopment3d.
+ * @user_data: unused.
+ *
+ * Backward visit reduction operator for #AranChebyshevDevelopment3d.
+ */
+void
+aran_chebyshev_development3d_visit_bw_reduce (AranChebyshevDevelopment3d *a,
+                                              AranChebyshevDevelopment3d *b,
+                                              gpointer user_data)
+{
+  guint k;
+
+  for (k = 0; k < b->chebyshev->size; k++)
+    b->local[k] += a->local[k];
+}
+
+#endif /* VSG_HAVE_MPI */
@@ -0,0 +1,186 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __ARAN_CHEBYSHEV_DEVELOPMENT3D_H__
+#define __ARAN_CHEBYSHEV_DEVELOPMENT3D_H__
+
+#include <glib-object.h>
+
+#include <vsg/vsgd.h>
+#ifdef VSG_HAVE_MPI
+#include <vsg/vsgpackedmsg.h>
+#endif
+
+#include <aran/arankerneldevelopment3d.h>
+
+G_BEGIN_DECLS;
+
+/* macros */
+#define ARAN_TYPE_CHEBYSHEV_DEVELOPMENT3D \
+  (aran_chebyshev_development3d_get_type ())
+
+#define ARAN_CHEBYSHEV3D_MAX_ORDER (12)
+
+/* typedefs */
+
+typedef struct _AranChebyshev3d AranChebyshev3d;
+
+typedef struct _AranChebyshevDevelopment3d AranChebyshevDevelopment3d;
+
+struct _AranChebyshevDevelopment3d
+{
+  AranChebyshev3d *chebyshev;
+
+  gdouble *multipole;
+  gdouble *local;
+};
+
+/* functions */
+AranChebyshev3d *aran_chebyshev3d_new (AranKernelFunc3d func, guint dim,
+                                       gpointer user_data, guint order,
+                                       gdouble epsilon);
+
+AranChebyshev3d *aran_chebyshev3d_ref (AranChebyshev3d *chebyshev);
+
+void aran_chebyshev3d_unref (AranChebyshev3d *chebyshev);
+
+guint aran_chebyshev3d_get_dim (const AranChebyshev3d *chebyshev);
+
+guint aran_chebyshev3d_get_order (const AranChebyshev3d *chebyshev);
+
+guint aran_chebyshev3d_get_size (const AranChebyshev3d *chebyshev);
+
+gdouble aran_chebyshev3d_get_mean_rank (const AranChebyshev3d *chebyshev);
+
+void aran_chebyshev3d_clear_cache (AranChebyshev3d *chebyshev);
+
+GType aran_chebyshev_development3d_get_type ();
+
+AranChebyshevDevelopment3d *
+aran_chebyshev_development3d_new (AranChebyshev3d *chebyshev);
+
+void aran_chebyshev_development3d_free (AranChebyshevDevelopment3d *acd);
+
+void aran_chebyshev_development3d_copy (const AranChebyshevDevelopment3d *src,
+                                        AranChebyshevDevelopment3d *dst);
+
+AranChebyshevDevelopment3d *
+aran_chebyshev_development3d_clone (AranChebyshevDevelopment3d *src);
+
+void aran_chebyshev_development3d_set_zero (AranChebyshevDevelopment3d *acd);
+
+AranChebyshev3d *
+aran_chebyshev_development3d_get_chebyshev (const AranChebyshevDevelopment3d *acd);
+
+void aran_chebyshev_development3d_write (AranChebyshevDevelopment3d *acd,
+                                         FILE *file);
+
+void aran_chebyshev_development3d_p2m (const VsgVector3d *position,
+                                       const gdouble *charges,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranChebyshevDevelopment3d *dst);
+
+void aran_chebyshev_development3d_p2l (const VsgVector3d *position,
+                                       const gdouble *charges,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranChebyshevDevelopment3d *dst);
+
+void aran_chebyshev_development3d_m2m (const VsgPRTree3dNodeInfo *src_node,
+                                       AranChebyshevDevelopment3d *src,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranChebyshevDevelopment3d *dst);
+
+void aran_chebyshev_development3d_m2l (const VsgPRTree3dNodeInfo *src_node,
+                                       AranChebyshevDevelopment3d *src,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranChebyshevDevelopment3d *dst);
+
+void aran_chebyshev_development3d_l2l (const VsgPRTree3dNodeInfo *src_node,
+                                       AranChebyshevDevelopment3d *src,
+                                       const VsgPRTree3dNodeInfo *dst_node,
+                                       AranChebyshevDevelopment3d *dst);
+
+void aran_chebyshev_development3d_m2p (const VsgPRTree3dNodeInfo *devel_node,
+                                       AranChebyshevDevelopment3d *devel,
+                                       const VsgVector3d *pos,
+                                       gdouble *values);
+
+void aran_chebyshev_development3d_l2p (const VsgPRTree3dNodeInfo *devel_node,
+                                       AranChebyshevDevelopment3d *devel,
+                                       const VsgVector3d *pos,
+                                       gdouble *values);
+
+#ifdef VSG_HAVE_MPI
+
+void aran_chebyshev_development3d_vtable_init (VsgParallelVTable *vtable,
+                                               AranChebyshev3d *chebyshev);
+
+void aran_chebyshev_development3d_vtable_clear (VsgParallelVTable *vtable);
+
+gpointer aran_chebyshev_development3d_alloc (gboolean resident,
+                                             AranChebyshevDevelopment3d *src);
+
+void aran_chebyshev_development3d_destroy (gpointer data, gboolean resident,
+                                           gpointer user_data);
+
+void
+aran_chebyshev_development3d_migrate_pack (AranChebyshevDevelopment3d *devel,
+                                           VsgPackedMsg *pm,
+                                           gpointer user_data);
+
+void
+aran_chebyshev_development3d_migrate_unpack (AranChebyshevDevelopment3d *devel,
+                                             VsgPackedMsg *pm,
+                                             gpointer user_data);
+
+void
+aran_chebyshev_development3d_visit_fw_pack (AranChebyshevDevelopment3d *devel,
+                                            VsgPackedMsg *pm,
+                                            gpointer user_data);
+
+void
+aran_chebyshev_development3d_visit_fw_unpack (AranChebyshevDevelopment3d *devel,
+                                              VsgPackedMsg *pm,
+                                              gpointer user_data);
+
+void
+aran_chebyshev_development3d_visit_fw_reduce (AranChebyshevDevelopment3d *a,
+                                              AranChebyshevDevelopment3d *b,
+                                              gpointer user_data);
+
+void
+aran_chebyshev_development3d_visit_bw_pack (AranChebyshevDevelopment3d *devel,
+                                            VsgPackedMsg *pm,
+                                            gpointer user_data);
+
+void
+aran_chebyshev_development3d_visit_bw_unpack (AranChebyshevDevelopment3d *devel,
+                                              VsgPackedMsg *pm,
+                                              gpointer user_data);
+
+void
+aran_chebyshev_development3d_visit_bw_reduce (AranChebyshevDevelopment3d *a,
+                                              AranChebyshevDevelopment3d *b,
+                                              gpointer user_data);
+
+#endif /* VSG_HAVE_MPI */
+
+G_END_DECLS;
+
+#endif /* __ARAN_CHEBYSHEV_DEVELOPMENT3D_H__ */
@@ -19,6 +19,8 @@
 
 #include "arancoefficientbuffer@t@.h"
 
+#include <string.h>
+
 /**
  * AranCoefficientBuffer@t@: 
  *
@@ -26,11 +28,27 @@
  */
 
 struct _AranCoefficientBuffer@t@ {
-  guint n;
+  gint n;
   @type@ *buffer;
   AranCoefficientBuffer@t@Generator generator;
+  GSList *retired;
 };
 
+/* protects buffers growth. Superseded arrays are kept until the buffer is
+ * freed because other threads may still be reading them.
+ */
+G_LOCK_DEFINE_STATIC (coefficient_buffer@t@);
+
+static void _retired_free (GSList *retired)
+{
+  GSList *l;
+
+  for (l = retired; l != NULL; l = l->next)
+    g_free (l->data);
+
+  g_slist_free (retired);
+}
+
 /**
  * AranCoefficientBuffer@t@Generator: 
  * @n: order of term.
@@ -62,9 +80,10 @@ aran_coefficient_buffer@t@_new (AranCoefficientBuffer@t@Generator generator,
 
   ret = g_malloc (sizeof (AranCoefficientBuffer@t@));
 
-  ret->n = 0;
+  ret->n = -1;
   ret->generator = generator;
   ret->buffer = NULL;
+  ret->retired = NULL;
 
   aran_coefficient_buffer@t@_require (ret, n);
 
@@ -79,8 +98,12 @@ aran_coefficient_buffer@t@_new (AranCoefficientBuffer@t@Generator generator,
  */
 void aran_coefficient_buffer@t@_free (AranCoefficientBuffer@t@ *buf)
 {
-  g_free (buf->buffer);
-  g_free (buf);
+  if (buf != NULL)
+    {
+      g_free (buf->buffer);
+      _retired_free (buf->retired);
+      g_free (buf);
+    }
 }
 
 /**
@@ -88,31 +111,62 @@ void aran_coefficient_buffer@t@_free (AranCoefficientBuffer@t@ *buf)
  * @buf: an #AranCoefficientBuffer@t@.
  * @max: new size.
  *
- * Computes missing terms in @buf up to @max.
+ * Computes missing terms in @buf up to @max. This function is thread
+ * safe: growth is computed aside and terms already available are never
+ * moved for concurrent readers.
  */
 void aran_coefficient_buffer@t@_require (AranCoefficientBuffer@t@ *buf,
                                          guint max)
 {
-  guint size, i, oldn;
+  AranCoefficientBuffer@t@ tmp;
+  guint size, i;
+  gint oldn;
 
   g_return_if_fail (buf != NULL);
 
-  if (buf->n > max) return;
+  oldn = g_atomic_int_get (&buf->n);
 
-  size = MAX (buf->n+1, 1);
+  if (oldn >= (gint) max) return;
+
+  size = MAX (oldn+1, 1);
 
   while (size <= max) size *= 2;
 
-  buf->buffer = g_realloc (buf->buffer, size * sizeof (@type@));
+  /* @tmp is already sized for recursive generators */
+  tmp.n = size-1;
+  tmp.generator = buf->generator;
+  tmp.retired = NULL;
+  tmp.buffer = g_malloc (size * sizeof (@type@));
+
+  if (oldn >= 0)
+    memcpy (tmp.buffer, g_atomic_pointer_get (&buf->buffer),
+            (oldn+1) * sizeof (@type@));
+
+  for (i=oldn+1; i<size; i ++)
+    {
+      tmp.buffer[i] = tmp.generator (i, &tmp);
+    }
 
-  oldn = buf->n;
-  buf->n = size-1;
+  G_LOCK (coefficient_buffer@t@);
 
-  for (i=oldn; i<size; i ++)
+  if (buf->n < tmp.n)
+    {
+      if (buf->buffer != NULL)
+        buf->retired = g_slist_prepend (buf->retired, buf->buffer);
+
+      g_atomic_pointer_set (&buf->buffer, tmp.buffer);
+      buf->retired = g_slist_concat (tmp.retired, buf->retired);
+
+      g_atomic_int_set (&buf->n, tmp.n);
+    }
+  else
     {
-      buf->buffer[i] = buf->generator (i, buf);
+      /* another thread was faster */
+      g_free (tmp.buffer);
+      _retired_free (tmp.retired);
     }
 
+  G_UNLOCK (coefficient_buffer@t@);
 }
 
 /**
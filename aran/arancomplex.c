@@ -57,4 +57,67 @@ MPI_Datatype aran_gcomplex128_get_mpi_type (void)
 
   return gcomplex128_mpi_type;
 }
+
+/**
+ * AranPackCompression:
+ * @epsilon: relative magnitude under which trailing expansion degrees are
+ * not transmitted. 0. only skips zero degrees.
+ * @single: send coefficients as #gcomplex64.
+ *
+ * Wire format of the expansions exchanged during parallel near/far
+ * visits.
+ */
+
+/**
+ * aran_gcomplex128_pack_array:
+ * @pm: a #VsgPackedMsg.
+ * @array: coefficients to pack.
+ * @count: size of @array.
+ * @single: whether to convert @array to #gcomplex64.
+ *
+ * Appends @count coefficients of @array to @pm.
+ */
+void aran_gcomplex128_pack_array (VsgPackedMsg *pm, const gcomplex128 *array,
+                                  gint count, gboolean single)
+{
+  if (single)
+    {
+      gcomplex64 tmp[count];
+      gint i;
+
+      for (i=0; i<count; i ++)
+        tmp[i] = array[i];
+
+      vsg_packed_msg_send_append (pm, tmp, count, ARAN_MPI_TYPE_GCOMPLEX64);
+    }
+  else
+    vsg_packed_msg_send_append (pm, (gpointer) array, count,
+                                ARAN_MPI_TYPE_GCOMPLEX128);
+}
+
+/**
+ * aran_gcomplex128_unpack_array:
+ * @pm: a #VsgPackedMsg.
+ * @array: coefficients destination.
+ * @count: size of @array.
+ * @single: whether @pm holds #gcomplex64 coefficients.
+ *
+ * Reads @count coefficients from @pm into @array.
+ */
+void aran_gcomplex128_unpack_array (VsgPackedMsg *pm, gcomplex128 *array,
+                                    gint count, gboolean single)
+{
+  if (single)
+    {
+      gcomplex64 tmp[count];
+      gint i;
+
+      vsg_packed_msg_recv_read (pm, tmp, count, ARAN_MPI_TYPE_GCOMPLEX64);
+
+      for (i=0; i<count; i ++)
+        array[i] = tmp[i];
+    }
+  else
+    vsg_packed_msg_recv_read (pm, array, count, ARAN_MPI_TYPE_GCOMPLEX128);
+}
 #endif
@@ -26,6 +26,10 @@
 
 #include <vsg/vsgmpi.h>
 
+#ifdef VSG_HAVE_MPI
+#include <vsg/vsgpackedmsg.h>
+#endif
+
 G_BEGIN_DECLS;
 
 /* typedefs */
@@ -45,6 +49,19 @@ MPI_Datatype aran_gcomplex64_get_mpi_type (void) G_GNUC_CONST;
 #define ARAN_MPI_TYPE_GCOMPLEX128 (aran_gcomplex128_get_mpi_type ())
 MPI_Datatype aran_gcomplex128_get_mpi_type (void) G_GNUC_CONST;
 
+typedef struct _AranPackCompression AranPackCompression;
+
+struct _AranPackCompression {
+  gdouble epsilon;
+  gboolean single;
+};
+
+void aran_gcomplex128_pack_array (VsgPackedMsg *pm, const gcomplex128 *array,
+                                  gint count, gboolean single);
+
+void aran_gcomplex128_unpack_array (VsgPackedMsg *pm, gcomplex128 *array,
+                                    gint count, gboolean single);
+
 #endif
 
 G_END_DECLS;
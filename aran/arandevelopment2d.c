@@ -19,6 +19,8 @@
 
 #include "arandevelopment2d.h"
 
+#include <math.h>
+
 /**
  * ARAN_TYPE_DEVELOPMENT2D:
  *
@@ -33,6 +35,121 @@
  * A structure used as #VsgPRTree2d node_data within an #AranSolver2d.
  */
 
+/* cached M2L operators */
+
+#define M2L_OFFSET_EPSILON (1.e-9)
+
+typedef struct _M2LOperator2d M2LOperator2d;
+
+/* multipole to local operator for an offset (zd-zs)/size at unit scale:
+ * rows are local terms 0..posdeg, columns multipole terms -1..-negdeg. */
+struct _M2LOperator2d
+{
+  gdouble offset[2];
+  guint8 posdeg;
+  guint8 negdeg;
+
+  gdouble *re;
+  gdouble *im;
+};
+
+static GTree *m2l_cache = NULL;
+
+/* operators are shared by solvers threads */
+G_LOCK_DEFINE_STATIC (m2l_cache);
+
+static gint _m2l_operator_compare (gconstpointer pa, gconstpointer pb,
+                                   gpointer data)
+{
+  const M2LOperator2d *a = pa;
+  const M2LOperator2d *b = pb;
+  gdouble xdiff = a->offset[0] - b->offset[0];
+  gdouble ydiff = a->offset[1] - b->offset[1];
+
+  if (xdiff < -M2L_OFFSET_EPSILON) return -1;
+  if (xdiff > M2L_OFFSET_EPSILON) return 1;
+  if (ydiff < -M2L_OFFSET_EPSILON) return -1;
+  if (ydiff > M2L_OFFSET_EPSILON) return 1;
+
+  if (a->posdeg != b->posdeg) return (a->posdeg < b->posdeg) ? -1 : 1;
+  if (a->negdeg != b->negdeg) return (a->negdeg < b->negdeg) ? -1 : 1;
+
+  return 0;
+}
+
+static void _m2l_operator_free (M2LOperator2d *op)
+{
+  g_free (op->re);
+  g_free (op->im);
+  g_free (op);
+}
+
+static M2LOperator2d *_m2l_operator_new (gcomplex128 u, guint8 posdeg,
+                                         guint8 negdeg)
+{
+  M2LOperator2d *op = g_malloc (sizeof (M2LOperator2d));
+  gcomplex128 inv_u = 1. / u;
+  gcomplex128 rowpow = inv_u;
+  gint l, k;
+
+  op->offset[0] = creal (u);
+  op->offset[1] = cimag (u);
+  op->posdeg = posdeg;
+  op->negdeg = negdeg;
+  op->re = g_malloc ((posdeg+1) * negdeg * sizeof (gdouble));
+  op->im = g_malloc ((posdeg+1) * negdeg * sizeof (gdouble));
+
+  /* T(l,k) = (-1)^l binomial (k+l-1, k-1) / u^(k+l) */
+  for (l=0; l<=posdeg; l ++)
+    {
+      gcomplex128 pow = rowpow;
+      gdouble binomial = 1.;
+
+      for (k=1; k<=negdeg; k ++)
+        {
+          gcomplex128 t = binomial * pow;
+
+          op->re[l*negdeg + k-1] = creal (t);
+          op->im[l*negdeg + k-1] = cimag (t);
+
+          binomial *= (k + l) / (gdouble) k;
+          pow *= inv_u;
+        }
+
+      rowpow *= - inv_u;
+    }
+
+  return op;
+}
+
+static M2LOperator2d *_m2l_cache_lookup (gcomplex128 u, guint8 posdeg,
+                                         guint8 negdeg)
+{
+  M2LOperator2d key = {{creal (u), cimag (u)}, posdeg, negdeg, NULL, NULL};
+  M2LOperator2d *ret;
+
+  G_LOCK (m2l_cache);
+
+  if (m2l_cache == NULL)
+    {
+      m2l_cache = g_tree_new_full (_m2l_operator_compare, NULL, NULL,
+                                   (GDestroyNotify) _m2l_operator_free);
+      g_atexit (aran_development2d_m2l_cache_clear);
+    }
+
+  ret = g_tree_lookup (m2l_cache, &key);
+
+  if (ret == NULL)
+    {
+      ret = _m2l_operator_new (u, posdeg, negdeg);
+      g_tree_insert (m2l_cache, ret, ret);
+    }
+
+  G_UNLOCK (m2l_cache);
+
+  return ret;
+}
+
 /* functions */
 
 GType aran_development2d_get_type ()
@@ -280,6 +397,186 @@ void aran_development2d_l2l (const VsgPRTree2dNodeInfo *src_node,
   aran_laurent_seriesd_translate (src->local, zsrc, dst->local, zdst);
 }
 
+/**
+ * aran_development2d_m2m_scaled:
+ * @src_node: @src tree node info.
+ * @src: an #AranDevelopment2d.
+ * @dst_node: @dst tree node info.
+ * @dst: an #AranDevelopment2d.
+ *
+ * Performs multipole 2 multipole translation between @src and @dst with
+ * aran_laurent_seriesd_translate_scaled(). Faster alternative to
+ * aran_development2d_m2m() for high degrees.
+ */
+void aran_development2d_m2m_scaled (const VsgPRTree2dNodeInfo *src_node,
+                                    AranDevelopment2d *src,
+                                    const VsgPRTree2dNodeInfo *dst_node,
+                                    AranDevelopment2d *dst)
+{
+  gcomplex128 zsrc = src_node->center.x + G_I*src_node->center.y;
+  gcomplex128 zdst = dst_node->center.x + G_I*dst_node->center.y;
+
+  aran_laurent_seriesd_translate_scaled (src->multipole, zsrc,
+                                         dst->multipole, zdst);
+}
+
+/**
+ * aran_development2d_m2l_scaled:
+ * @src_node: @src tree node info.
+ * @src: an #AranDevelopment2d.
+ * @dst_node: @dst tree node info.
+ * @dst: an #AranDevelopment2d.
+ *
+ * Performs multipole 2 local translation between @src and @dst with
+ * aran_laurent_seriesd_to_taylor_scaled(). Faster alternative to
+ * aran_development2d_m2l() for high degrees.
+ */
+void aran_development2d_m2l_scaled (const VsgPRTree2dNodeInfo *src_node,
+                                    AranDevelopment2d *src,
+                                    const VsgPRTree2dNodeInfo *dst_node,
+                                    AranDevelopment2d *dst)
+{
+  gcomplex128 zsrc = src_node->center.x + G_I*src_node->center.y;
+  gcomplex128 zdst = dst_node->center.x + G_I*dst_node->center.y;
+
+  aran_laurent_seriesd_to_taylor_scaled (src->multipole, zsrc,
+                                         dst->local, zdst);
+}
+
+/**
+ * aran_development2d_m2l_cached:
+ * @src_node: @src tree node info.
+ * @src: an #AranDevelopment2d.
+ * @dst_node: @dst tree node info.
+ * @dst: an #AranDevelopment2d.
+ *
+ * Performs multipole 2 local translation between @src and @dst. Same as
+ * aran_development2d_m2l() but, since Laurent to Taylor transformation
+ * is scale invariant, it only applies the node size scaling to a unit
+ * scale operator that is computed once for each offset between nodes
+ * (at most 40 in a quadtree) and cached afterwards.
+ *
+ * Nodes of different sizes fall back to aran_development2d_m2l_scaled().
+ */
+void aran_development2d_m2l_cached (const VsgPRTree2dNodeInfo *src_node,
+                                    AranDevelopment2d *src,
+                                    const VsgPRTree2dNodeInfo *dst_node,
+                                    AranDevelopment2d *dst)
+{
+  gdouble size = dst_node->ubound.x - dst_node->lbound.x;
+  gdouble src_size = src_node->ubound.x - src_node->lbound.x;
+  guint8 posdeg = aran_laurent_seriesd_get_posdeg (dst->local);
+  guint8 negdeg = aran_laurent_seriesd_get_negdeg (src->multipole);
+  gcomplex128 *srcterm, *dstterm;
+  gcomplex128 zd_m_zs;
+  M2LOperator2d *op;
+  gdouble inv_size, pow;
+  gint l, k;
+
+  if (fabs (size - src_size) > M2L_OFFSET_EPSILON * size ||
+      aran_laurent_seriesd_get_posdeg (src->multipole) > 0)
+    {
+      aran_development2d_m2l_scaled (src_node, src, dst_node, dst);
+      return;
+    }
+
+  zd_m_zs = (dst_node->center.x - src_node->center.x) +
+    G_I * (dst_node->center.y - src_node->center.y);
+
+  op = _m2l_cache_lookup (zd_m_zs / size, posdeg, negdeg);
+
+  /* constant multipole term */
+  dstterm = aran_laurent_seriesd_get_term (dst->local, 0);
+  *dstterm += *aran_laurent_seriesd_get_term (src->multipole, 0);
+
+  if (negdeg == 0) return;
+
+  {
+    gdouble are[negdeg], aim[negdeg];
+    gdouble *tre = op->re, *tim = op->im;
+
+    /* multipole terms at unit scale */
+    inv_size = 1. / size;
+    pow = inv_size;
+    srcterm = aran_laurent_seriesd_get_term (src->multipole, -1);
+    for (k=0; k<negdeg; k ++)
+      {
+        are[k] = creal (*srcterm) * pow;
+        aim[k] = cimag (*srcterm) * pow;
+        pow *= inv_size;
+        srcterm ++;
+      }
+
+    pow = 1.;
+    for (l=0; l<=posdeg; l ++)
+      {
+        gdouble sre0 = 0., sim0 = 0., sre1 = 0., sim1 = 0.;
+
+        /* two independent accumulators per component */
+        for (k=0; k+1<negdeg; k += 2)
+          {
+            sre0 += tre[k] * are[k] - tim[k] * aim[k];
+            sim0 += tre[k] * aim[k] + tim[k] * are[k];
+            sre1 += tre[k+1] * are[k+1] - tim[k+1] * aim[k+1];
+            sim1 += tre[k+1] * aim[k+1] + tim[k+1] * are[k+1];
+          }
+
+        if (k < negdeg)
+          {
+            sre0 += tre[k] * are[k] - tim[k] * aim[k];
+            sim0 += tre[k] * aim[k] + tim[k] * are[k];
+          }
+
+        *dstterm += ((sre0 + sre1) + G_I * (sim0 + sim1)) * pow;
+
+        pow *= inv_size;
+        tre += negdeg;
+        tim += negdeg;
+        dstterm --;
+      }
+  }
+}
+
+/**
+ * aran_development2d_m2l_cache_clear:
+ *
+ * Destroys all operators cached by aran_development2d_m2l_cached(). Call
+ * this if you are done with cached translations and you want to free some
+ * memory.
+ */
+void aran_development2d_m2l_cache_clear ()
+{
+  G_LOCK (m2l_cache);
+  if (m2l_cache != NULL)
+    {
+      g_tree_destroy (m2l_cache);
+      m2l_cache = NULL;
+    }
+  G_UNLOCK (m2l_cache);
+}
+
+/**
+ * aran_development2d_l2l_scaled:
+ * @src_node: @src tree node info.
+ * @src: an #AranDevelopment2d.
+ * @dst_node: @dst tree node info.
+ * @dst: an #AranDevelopment2d.
+ *
+ * Performs local 2 local translation between @src and @dst with
+ * aran_laurent_seriesd_translate_scaled(). Faster alternative to
+ * aran_development2d_l2l() for high degrees.
+ */
+void aran_development2d_l2l_scaled (const VsgPRTree2dNodeInfo *src_node,
+                                    AranDevelopment2d *src,
+                                    const VsgPRTree2dNodeInfo *dst_node,
+                                    AranDevelopment2d *dst)
+{
+  gcomplex128 zsrc = src_node->center.x + G_I*src_node->center.y;
+  gcomplex128 zdst = dst_node->center.x + G_I*dst_node->center.y;
+
+  aran_laurent_seriesd_translate_scaled (src->local, zsrc, dst->local, zdst);
+}
+
 /**
  * aran_development2d_multipole_evaluate:
  * @devel_node: tree node info of @devel.
@@ -380,6 +677,29 @@ void aran_development2d_vtable_init (VsgParallelVTable *vtable, guint8 posdeg,
   vtable->visit_backward.reduce_data = NULL;
 }
 
+/**
+ * aran_development2d_vtable_set_compression:
+ * @vtable: a #VsgParallelVTable initialized with
+ * aran_development2d_vtable_init().
+ * @compression: wire format of visiting expansions or %NULL.
+ *
+ * Makes near/far visits of @vtable exchange their expansions with the
+ * compressed format of aran_laurent_seriesd_pack_compressed(). @compression
+ * is not copied and has to stay valid as long as @vtable is in use. Passing
+ * %NULL restores the full precision format.
+ */
+void
+aran_development2d_vtable_set_compression (VsgParallelVTable *vtable,
+                                           AranPackCompression *compression)
+{
+  g_return_if_fail (vtable != NULL);
+
+  vtable->visit_forward.pack_data = compression;
+  vtable->visit_forward.unpack_data = compression;
+  vtable->visit_backward.pack_data = compression;
+  vtable->visit_backward.unpack_data = compression;
+}
+
 void aran_development2d_vtable_clear (VsgParallelVTable *vtable)
 {
   g_return_if_fail (vtable != NULL);
@@ -462,7 +782,7 @@ void aran_development2d_migrate_unpack (AranDevelopment2d *devel,
  * aran_development2d_visit_fw_pack:
  * @devel: an #AranDevelopment2d.
  * @pm: a #VsgPackedMsg.
- * @user_data: unused.
+ * @user_data: an #AranPackCompression or %NULL.
  *
  * Performs packing of @devel into @pm for a near/far forward visit
  * of a local node to another processor.
@@ -471,14 +791,17 @@ void aran_development2d_visit_fw_pack (AranDevelopment2d *devel,
                                        VsgPackedMsg *pm,
                                        gpointer user_data)
 {
-  aran_laurent_seriesd_pack (devel->multipole, pm);
+  if (user_data != NULL)
+    aran_laurent_seriesd_pack_compressed (devel->multipole, pm, user_data);
+  else
+    aran_laurent_seriesd_pack (devel->multipole, pm);
 }
 
 /**
  * aran_development2d_visit_fw_unpack:
  * @devel: an #AranDevelopment2d.
  * @pm: a #VsgPackedMsg.
- * @user_data: unused.
+ * @user_data: an #AranPackCompression or %NULL.
  *
  * Unpacks information from @pm for a near/far forward visit of a
  * remote node.
@@ -487,7 +810,10 @@ void aran_development2d_visit_fw_unpack (AranDevelopment2d *devel,
                                          VsgPackedMsg *pm,
                                          gpointer user_data)
 {
-  aran_laurent_seriesd_unpack (devel->multipole, pm);
+  if (user_data != NULL)
+    aran_laurent_seriesd_unpack_compressed (devel->multipole, pm);
+  else
+    aran_laurent_seriesd_unpack (devel->multipole, pm);
 }
 
 /**
@@ -509,7 +835,7 @@ void aran_development2d_visit_fw_reduce (AranDevelopment2d *a,
  * aran_development2d_visit_bw_pack:
  * @devel: an #AranDevelopment2d.
  * @pm: a #VsgPackedMsg.
- * @user_data: unused.
+ * @user_data: an #AranPackCompression or %NULL.
  *
  * Performs packing of @devel into @pm for a near/far backward visit
  * of a remote node to its original processor.
@@ -519,14 +845,17 @@ void aran_development2d_visit_bw_pack (AranDevelopment2d *devel,
                                        gpointer user_data)
 
 {
-  aran_laurent_seriesd_pack (devel->local, pm);
+  if (user_data != NULL)
+    aran_laurent_seriesd_pack_compressed (devel->local, pm, user_data);
+  else
+    aran_laurent_seriesd_pack (devel->local, pm);
 }
 
 /**
  * aran_development2d_visit_bw_unpack:
  * @devel: an #AranDevelopment2d.
  * @pm: a #VsgPackedMsg.
- * @user_data: unused.
+ * @user_data: an #AranPackCompression or %NULL.
  *
  * Unpacks information from @pm for a near/far backward visit of a
  * remote node.
@@ -535,7 +864,10 @@ void aran_development2d_visit_bw_unpack (AranDevelopment2d *devel,
                                          VsgPackedMsg *pm,
                                          gpointer user_data)
 {
-  aran_laurent_seriesd_unpack (devel->local, pm);
+  if (user_data != NULL)
+    aran_laurent_seriesd_unpack_compressed (devel->local, pm);
+  else
+    aran_laurent_seriesd_unpack (devel->local, pm);
 }
 
 /**
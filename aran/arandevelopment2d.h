@@ -79,6 +79,28 @@ void aran_development2d_l2l (const VsgPRTree2dNodeInfo *src_node,
 			     const VsgPRTree2dNodeInfo *dst_node,
 			     AranDevelopment2d *dst);
 
+void aran_development2d_m2m_scaled (const VsgPRTree2dNodeInfo *src_node,
+                                    AranDevelopment2d *src,
+                                    const VsgPRTree2dNodeInfo *dst_node,
+                                    AranDevelopment2d *dst);
+
+void aran_development2d_m2l_scaled (const VsgPRTree2dNodeInfo *src_node,
+                                    AranDevelopment2d *src,
+                                    const VsgPRTree2dNodeInfo *dst_node,
+                                    AranDevelopment2d *dst);
+
+void aran_development2d_m2l_cached (const VsgPRTree2dNodeInfo *src_node,
+                                    AranDevelopment2d *src,
+                                    const VsgPRTree2dNodeInfo *dst_node,
+                                    AranDevelopment2d *dst);
+
+void aran_development2d_m2l_cache_clear ();
+
+void aran_development2d_l2l_scaled (const VsgPRTree2dNodeInfo *src_node,
+                                    AranDevelopment2d *src,
+                                    const VsgPRTree2dNodeInfo *dst_node,
+                                    AranDevelopment2d *dst);
+
 gcomplex128
 aran_development2d_multipole_evaluate (const VsgPRTree2dNodeInfo *devel_node,
                                        AranDevelopment2d *devel,
@@ -103,6 +125,10 @@ void aran_development2d_vtable_init (VsgParallelVTable *vtable, guint8 posdeg,
 
 void aran_development2d_vtable_clear (VsgParallelVTable *vtable);
 
+void
+aran_development2d_vtable_set_compression (VsgParallelVTable *vtable,
+                                           AranPackCompression *compression);
+
 gpointer aran_development2d_alloc (gboolean resident, AranDevelopment2d *src);
 
 void aran_development2d_destroy (gpointer data, gboolean resident,
@@ -68,10 +68,13 @@ AranDevelopment3d *aran_development3d_new (guint8 posdeg, guint8 negdeg)
 
   result->multipole = aran_spherical_seriesd_new (posdeg, negdeg);
   result->local = aran_spherical_seriesd_new (MAX (posdeg, negdeg), 0);
+  result->gradient = NULL;
 
   return result;
 }
 
+static void _gradient_free (AranDevelopment3dGradient *grad);
+
 /**
  * aran_development3d_free:
  * @ad: an #AranDevelopment3d.
@@ -82,6 +85,7 @@ void aran_development3d_free (AranDevelopment3d *ad)
 {
   aran_spherical_seriesd_free (ad->multipole);
   aran_spherical_seriesd_free (ad->local);
+  if (ad->gradient != NULL) _gradient_free (ad->gradient);
   g_free (ad);
 }
 
@@ -90,7 +94,8 @@ void aran_development3d_free (AranDevelopment3d *ad)
  * @src: an #AranDevelopment3d.
  * @dst: an #AranDevelopment3d.
  *
- * Copies @src into @dst. Development degrees must coincide.
+ * Copies @src into @dst. Development degrees must coincide. Prepared
+ * gradients are not copied.
  */
 void aran_development3d_copy (const AranDevelopment3d *src,
                               AranDevelopment3d *dst)
@@ -139,6 +144,59 @@ void aran_development3d_set_zero (AranDevelopment3d *ad)
   aran_spherical_seriesd_set_zero (ad->local);
 }
 
+/**
+ * aran_development3d_get_posdeg:
+ * @ad: an #AranDevelopment3d.
+ *
+ * Returns: the positive degree @ad was created (or resized) with.
+ */
+guint8 aran_development3d_get_posdeg (const AranDevelopment3d *ad)
+{
+  g_return_val_if_fail (ad != NULL, 0);
+
+  return aran_spherical_seriesd_get_posdeg (ad->multipole);
+}
+
+/**
+ * aran_development3d_get_negdeg:
+ * @ad: an #AranDevelopment3d.
+ *
+ * Returns: the multipole degree of @ad.
+ */
+guint8 aran_development3d_get_negdeg (const AranDevelopment3d *ad)
+{
+  g_return_val_if_fail (ad != NULL, 0);
+
+  return aran_spherical_seriesd_get_negdeg (ad->multipole);
+}
+
+/**
+ * aran_development3d_set_degrees:
+ * @ad: an #AranDevelopment3d.
+ * @posdeg: a #guint8.
+ * @negdeg: a #guint8.
+ *
+ * Changes @ad expansion degrees in place, as if it had been created by
+ * aran_development3d_new() with @posdeg and @negdeg. When degrees differ
+ * from the current ones, coefficients are reallocated and set to zero.
+ * Otherwise, @ad is left untouched.
+ */
+void aran_development3d_set_degrees (AranDevelopment3d *ad,
+                                     guint8 posdeg, guint8 negdeg)
+{
+  g_return_if_fail (ad != NULL);
+
+  if (aran_spherical_seriesd_get_posdeg (ad->multipole) == posdeg &&
+      aran_spherical_seriesd_get_negdeg (ad->multipole) == negdeg)
+    return;
+
+  aran_spherical_seriesd_free (ad->multipole);
+  aran_spherical_seriesd_free (ad->local);
+
+  ad->multipole = aran_spherical_seriesd_new (posdeg, negdeg);
+  ad->local = aran_spherical_seriesd_new (MAX (posdeg, negdeg), 0);
+}
+
 /**
  * aran_development3d_write:
  * @ad: an #AranDevelopment3d.
@@ -567,10 +625,317 @@ void aran_development3d_l2pv (const VsgPRTree3dNodeInfo *devel_node,
   aran_development3d_local_gradient_evaluate (devel_node, devel, pos, grad);
 }
 
+/**
+ * AranDevelopment3dGradient:
+ *
+ * Opaque structure holding the gradient of an #AranDevelopment3d local
+ * part, as three local expansions of lower degree. It is stored in the
+ * development by aran_development3d_gradient_prepare().
+ */
+struct _AranDevelopment3dGradient
+{
+  AranSphericalSeriesd *dx;
+  AranSphericalSeriesd *dy;
+  AranSphericalSeriesd *dz;
+};
+
+static void _gradient_alloc (AranDevelopment3dGradient *grad, guint8 posdeg)
+{
+  /* gradient of a degree p local expansion is of degree p-1 */
+  guint8 deg = (posdeg > 0) ? posdeg - 1 : 0;
+
+  grad->dx = aran_spherical_seriesd_new (deg, 0);
+  grad->dy = aran_spherical_seriesd_new (deg, 0);
+  grad->dz = aran_spherical_seriesd_new (deg, 0);
+}
+
+static void _gradient_dealloc (AranDevelopment3dGradient *grad)
+{
+  aran_spherical_seriesd_free (grad->dx);
+  aran_spherical_seriesd_free (grad->dy);
+  aran_spherical_seriesd_free (grad->dz);
+}
+
+static void _gradient_free (AranDevelopment3dGradient *grad)
+{
+  _gradient_dealloc (grad);
+  g_free (grad);
+}
+
+/**
+ * aran_development3d_gradient_prepare:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranDevelopment3d.
+ *
+ * Computes the gradient of @devel local part and stores it into @devel,
+ * where it stays valid until the local part changes. This is meant to be
+ * done once per leaf, after Local to Local translation, so that subsequent
+ * aran_development3d_gradient_l2pv() calls only have to evaluate series
+ * (see aran_solver3d_set_leaf_prepare()).
+ */
+void
+aran_development3d_gradient_prepare (const VsgPRTree3dNodeInfo *devel_node,
+                                     AranDevelopment3d *devel)
+{
+  AranDevelopment3dGradient *grad;
+  guint8 posdeg;
+
+  g_return_if_fail (devel != NULL);
+
+  posdeg = aran_spherical_seriesd_get_posdeg (devel->local);
+
+  if (devel->gradient == NULL)
+    {
+      devel->gradient = g_new (AranDevelopment3dGradient, 1);
+      _gradient_alloc (devel->gradient, posdeg);
+    }
+
+  grad = devel->gradient;
+
+  if (aran_spherical_seriesd_get_posdeg (grad->dx) + 1 != MAX (posdeg, 1))
+    {
+      _gradient_dealloc (grad);
+      _gradient_alloc (grad, posdeg);
+    }
+
+  aran_spherical_seriesd_local_gradient (devel->local,
+                                         grad->dx, grad->dy, grad->dz);
+}
+
+/**
+ * aran_development3d_gradient_l2pv:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranDevelopment3d with a prepared gradient.
+ * @pos: evaluation position.
+ * @result: result gradient.
+ *
+ * Evaluates the gradient prepared in @devel at @pos. This gives the same
+ * result as aran_development3d_l2pv().
+ */
+void aran_development3d_gradient_l2pv (const VsgPRTree3dNodeInfo *devel_node,
+                                       AranDevelopment3d *devel,
+                                       const VsgVector3d *pos,
+                                       VsgVector3d *result)
+{
+  AranDevelopment3dGradient *grad;
+  VsgVector3d tmp;
+
+  g_return_if_fail (devel != NULL && devel->gradient != NULL);
+
+  grad = devel->gradient;
+
+  vsg_vector3d_sub (pos, &devel_node->center, &tmp);
+
+  aran_spherical_seriesd_local_field_evaluate (NULL,
+                                               grad->dx, grad->dy, grad->dz,
+                                               &tmp, result);
+}
+
+/**
+ * aran_development3d_gradient_l2p:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranDevelopment3d with a prepared gradient.
+ * @pos: evaluation position.
+ * @result: result gradient.
+ *
+ * Evaluates both @devel local part and its prepared gradient at @pos,
+ * sharing spherical harmonics computations.
+ *
+ * Returns: value of local part of @devel(@pos).
+ */
+gcomplex128
+aran_development3d_gradient_l2p (const VsgPRTree3dNodeInfo *devel_node,
+                                 AranDevelopment3d *devel,
+                                 const VsgVector3d *pos,
+                                 VsgVector3d *result)
+{
+  AranDevelopment3dGradient *grad;
+  VsgVector3d tmp;
+
+  g_return_val_if_fail (devel != NULL && devel->gradient != NULL, 0.);
+
+  grad = devel->gradient;
+
+  vsg_vector3d_sub (pos, &devel_node->center, &tmp);
+
+  return aran_spherical_seriesd_local_field_evaluate (devel->local,
+                                                      grad->dx, grad->dy,
+                                                      grad->dz,
+                                                      &tmp, result);
+}
+
+/**
+ * AranDevelopment3dSchedule:
+ *
+ * Opaque structure holding #AranDevelopment3d degrees for each level
+ * of a #VsgPRTree3d.
+ */
+struct _AranDevelopment3dSchedule
+{
+  guint8 posdeg;
+  guint8 negdeg;
+
+  GArray *levels;
+};
+
+typedef struct _LevelDegrees LevelDegrees;
+
+struct _LevelDegrees
+{
+  guint8 posdeg;
+  guint8 negdeg;
+};
+
+/**
+ * aran_development3d_schedule_new:
+ * @posdeg: default positive degree.
+ * @negdeg: default negative degree.
+ *
+ * Creates a new per level degrees schedule. Levels not specified by
+ * aran_development3d_schedule_set_level() use @posdeg and @negdeg.
+ *
+ * Returns: newly allocated structure.
+ */
+AranDevelopment3dSchedule *aran_development3d_schedule_new (guint8 posdeg,
+                                                            guint8 negdeg)
+{
+  AranDevelopment3dSchedule *schedule = g_new (AranDevelopment3dSchedule, 1);
+
+  schedule->posdeg = posdeg;
+  schedule->negdeg = negdeg;
+  schedule->levels = g_array_new (FALSE, FALSE, sizeof (LevelDegrees));
+
+  return schedule;
+}
+
+/**
+ * aran_development3d_schedule_free:
+ * @schedule: an #AranDevelopment3dSchedule.
+ *
+ * Deallocates @schedule.
+ */
+void aran_development3d_schedule_free (AranDevelopment3dSchedule *schedule)
+{
+  g_return_if_fail (schedule != NULL);
+
+  g_array_free (schedule->levels, TRUE);
+  g_free (schedule);
+}
+
+/**
+ * aran_development3d_schedule_set_level:
+ * @schedule: an #AranDevelopment3dSchedule.
+ * @depth: tree level (root node has depth 0).
+ * @posdeg: positive degree at @depth.
+ * @negdeg: negative degree at @depth.
+ *
+ * Specifies expansion degrees of tree nodes at level @depth.
+ */
+void
+aran_development3d_schedule_set_level (AranDevelopment3dSchedule *schedule,
+                                       guint depth,
+                                       guint8 posdeg, guint8 negdeg)
+{
+  LevelDegrees ld;
+
+  g_return_if_fail (schedule != NULL);
+
+  ld.posdeg = schedule->posdeg;
+  ld.negdeg = schedule->negdeg;
+
+  while (schedule->levels->len <= depth)
+    g_array_append_val (schedule->levels, ld);
+
+  ld.posdeg = posdeg;
+  ld.negdeg = negdeg;
+
+  g_array_index (schedule->levels, LevelDegrees, depth) = ld;
+}
+
+/**
+ * aran_development3d_schedule_get_level:
+ * @schedule: an #AranDevelopment3dSchedule.
+ * @depth: tree level.
+ * @posdeg: result location for positive degree.
+ * @negdeg: result location for negative degree.
+ *
+ * Retrieves expansion degrees of tree nodes at level @depth.
+ */
+void
+aran_development3d_schedule_get_level (const AranDevelopment3dSchedule *schedule,
+                                       guint depth,
+                                       guint8 *posdeg, guint8 *negdeg)
+{
+  g_return_if_fail (schedule != NULL);
+
+  if (depth < schedule->levels->len)
+    {
+      LevelDegrees *ld = &g_array_index (schedule->levels, LevelDegrees,
+                                         depth);
+
+      *posdeg = ld->posdeg;
+      *negdeg = ld->negdeg;
+    }
+  else
+    {
+      *posdeg = schedule->posdeg;
+      *negdeg = schedule->negdeg;
+    }
+}
+
+/**
+ * aran_development3d_schedule_zero:
+ * @node_info: tree node info of @ad.
+ * @ad: an #AranDevelopment3d.
+ * @schedule: an #AranDevelopment3dSchedule.
+ *
+ * Resizes @ad to the degrees @schedule specifies for @node_info depth and
+ * sets all @ad coefficients to zero. Suitable as an #AranSolver3d node
+ * zeroing function (see aran_solver3d_set_node_zero()). Translation
+ * operators then convert between the degrees of different levels.
+ */
+void aran_development3d_schedule_zero (const VsgPRTree3dNodeInfo *node_info,
+                                       AranDevelopment3d *ad,
+                                       AranDevelopment3dSchedule *schedule)
+{
+  guint8 posdeg, negdeg;
+
+  aran_development3d_schedule_get_level (schedule, node_info->depth,
+                                         &posdeg, &negdeg);
+
+  aran_development3d_set_degrees (ad, posdeg, negdeg);
+  aran_development3d_set_zero (ad);
+}
+
 #ifdef VSG_HAVE_MPI
 
 #include <aran/aransphericalseriesd-private.h>
 
+/*
+ * developments carry their degrees in messages since they may differ from
+ * the receiving node ones when degrees depend on tree levels.
+ */
+static void _development3d_degrees_pack (AranDevelopment3d *devel,
+                                         VsgPackedMsg *pm)
+{
+  gint degrees[2];
+
+  degrees[0] = aran_spherical_seriesd_get_posdeg (devel->multipole);
+  degrees[1] = aran_spherical_seriesd_get_negdeg (devel->multipole);
+
+  vsg_packed_msg_send_append (pm, degrees, 2, MPI_INT);
+}
+
+static void _development3d_degrees_unpack (AranDevelopment3d *devel,
+                                           VsgPackedMsg *pm)
+{
+  gint degrees[2];
+
+  vsg_packed_msg_recv_read (pm, degrees, 2, MPI_INT);
+
+  aran_development3d_set_degrees (devel, degrees[0], degrees[1]);
+}
+
 void aran_development3d_vtable_init (VsgParallelVTable *vtable, guint8 posdeg,
                                      guint8 negdeg)
 {
@@ -623,6 +988,29 @@ void aran_development3d_vtable_init (VsgParallelVTable *vtable, guint8 posdeg,
 /*   } */
 }
 
+/**
+ * aran_development3d_vtable_set_compression:
+ * @vtable: a #VsgParallelVTable initialized with
+ * aran_development3d_vtable_init().
+ * @compression: wire format of visiting expansions or %NULL.
+ *
+ * Makes near/far visits of @vtable exchange their expansions with the
+ * compressed format of aran_spherical_seriesd_pack_compressed().
+ * @compression is not copied and has to stay valid as long as @vtable is in
+ * use. Passing %NULL restores the full precision format.
+ */
+void
+aran_development3d_vtable_set_compression (VsgParallelVTable *vtable,
+                                           AranPackCompression *compression)
+{
+  g_return_if_fail (vtable != NULL);
+
+  vtable->visit_forward.pack_data = compression;
+  vtable->visit_forward.unpack_data = compression;
+  vtable->visit_backward.pack_data = compression;
+  vtable->visit_backward.unpack_data = compression;
+}
+
 void aran_development3d_vtable_clear (VsgParallelVTable *vtable)
 {
   g_return_if_fail (vtable != NULL);
@@ -680,6 +1068,7 @@ void aran_development3d_migrate_pack (AranDevelopment3d *devel,
                                       VsgPackedMsg *pm,
                                       gpointer user_data)
 {
+  _development3d_degrees_pack (devel, pm);
   aran_spherical_seriesd_pack (devel->multipole, pm);
   aran_spherical_seriesd_pack (devel->local, pm);
 }
@@ -697,6 +1086,7 @@ void aran_development3d_migrate_unpack (AranDevelopment3d *devel,
                                         VsgPackedMsg *pm,
                                         gpointer user_data)
 {
+  _development3d_degrees_unpack (devel, pm);
   aran_spherical_seriesd_unpack (devel->multipole, pm);
   aran_spherical_seriesd_unpack (devel->local, pm);
 }
@@ -705,7 +1095,7 @@ void aran_development3d_migrate_unpack (AranDevelopment3d *devel,
  * aran_development3d_visit_fw_pack:
  * @devel: an #AranDevelopment3d.
  * @pm: a #VsgPackedMsg.
- * @user_data: unused.
+ * @user_data: an #AranPackCompression or %NULL.
  *
  * Performs packing of @devel into @pm for a near/far forward visit
  * of a local node to another processor.
@@ -714,14 +1104,18 @@ void aran_development3d_visit_fw_pack (AranDevelopment3d *devel,
                                        VsgPackedMsg *pm,
                                        gpointer user_data)
 {
-  aran_spherical_seriesd_pack (devel->multipole, pm);
+  _development3d_degrees_pack (devel, pm);
+  if (user_data != NULL)
+    aran_spherical_seriesd_pack_compressed (devel->multipole, pm, user_data);
+  else
+    aran_spherical_seriesd_pack (devel->multipole, pm);
 }
 
 /**
  * aran_development3d_visit_fw_unpack:
  * @devel: an #AranDevelopment3d.
  * @pm: a #VsgPackedMsg.
- * @user_data: unused.
+ * @user_data: an #AranPackCompression or %NULL.
  *
  * Unpacks information from @pm for a near/far forward visit of a
  * remote node.
@@ -730,7 +1124,11 @@ void aran_development3d_visit_fw_unpack (AranDevelopment3d *devel,
                                          VsgPackedMsg *pm,
                                          gpointer user_data)
 {
-  aran_spherical_seriesd_unpack (devel->multipole, pm);
+  _development3d_degrees_unpack (devel, pm);
+  if (user_data != NULL)
+    aran_spherical_seriesd_unpack_compressed (devel->multipole, pm);
+  else
+    aran_spherical_seriesd_unpack (devel->multipole, pm);
 }
 
 /**
@@ -752,7 +1150,7 @@ void aran_development3d_visit_fw_reduce (AranDevelopment3d *a,
  * aran_development3d_visit_bw_pack:
  * @devel: an #AranDevelopment3d.
  * @pm: a #VsgPackedMsg.
- * @user_data: unused.
+ * @user_data: an #AranPackCompression or %NULL.
  *
  * Performs packing of @devel into @pm for a near/far backward visit
  * of a remote node to its original processor.
@@ -762,14 +1160,18 @@ void aran_development3d_visit_bw_pack (AranDevelopment3d *devel,
                                        gpointer user_data)
 
 {
-  aran_spherical_seriesd_pack (devel->local, pm);
+  _development3d_degrees_pack (devel, pm);
+  if (user_data != NULL)
+    aran_spherical_seriesd_pack_compressed (devel->local, pm, user_data);
+  else
+    aran_spherical_seriesd_pack (devel->local, pm);
 }
 
 /**
  * aran_development3d_visit_bw_unpack:
  * @devel: an #AranDevelopment3d.
  * @pm: a #VsgPackedMsg.
- * @user_data: unused.
+ * @user_data: an #AranPackCompression or %NULL.
  *
  * Unpacks information from @pm for a near/far backward visit of a
  * remote node.
@@ -778,7 +1180,11 @@ void aran_development3d_visit_bw_unpack (AranDevelopment3d *devel,
                                          VsgPackedMsg *pm,
                                          gpointer user_data)
 {
-  aran_spherical_seriesd_unpack (devel->local, pm);
+  _development3d_degrees_unpack (devel, pm);
+  if (user_data != NULL)
+    aran_spherical_seriesd_unpack_compressed (devel->local, pm);
+  else
+    aran_spherical_seriesd_unpack (devel->local, pm);
 }
 
 /**
@@ -35,12 +35,19 @@ G_BEGIN_DECLS;
 
 typedef struct _AranDevelopment3d AranDevelopment3d;
 
+typedef struct _AranDevelopment3dGradient AranDevelopment3dGradient;
+
 struct _AranDevelopment3d
 {
   AranSphericalSeriesd *multipole;
   AranSphericalSeriesd *local;
+
+  /* local part gradient, see aran_development3d_gradient_prepare() */
+  AranDevelopment3dGradient *gradient;
 };
 
+typedef struct _AranDevelopment3dSchedule AranDevelopment3dSchedule;
+
 /* functions */
 GType aran_development3d_get_type ();
 
@@ -55,6 +62,13 @@ AranDevelopment3d *aran_development3d_clone (AranDevelopment3d *src);
 
 void aran_development3d_set_zero (AranDevelopment3d *ad);
 
+guint8 aran_development3d_get_posdeg (const AranDevelopment3d *ad);
+
+guint8 aran_development3d_get_negdeg (const AranDevelopment3d *ad);
+
+void aran_development3d_set_degrees (AranDevelopment3d *ad,
+                                     guint8 posdeg, guint8 negdeg);
+
 void aran_development3d_write (AranDevelopment3d *ad, FILE *file);
 
 void aran_development3d_p2m (const VsgVector3d *position, const gdouble charge,
@@ -119,6 +133,21 @@ void aran_development3d_l2pv (const VsgPRTree3dNodeInfo *devel_node,
                               const VsgVector3d *pos,
                               VsgVector3d *grad);
 
+void
+aran_development3d_gradient_prepare (const VsgPRTree3dNodeInfo *devel_node,
+                                     AranDevelopment3d *devel);
+
+void aran_development3d_gradient_l2pv (const VsgPRTree3dNodeInfo *devel_node,
+                                       AranDevelopment3d *devel,
+                                       const VsgVector3d *pos,
+                                       VsgVector3d *result);
+
+gcomplex128
+aran_development3d_gradient_l2p (const VsgPRTree3dNodeInfo *devel_node,
+                                 AranDevelopment3d *devel,
+                                 const VsgVector3d *pos,
+                                 VsgVector3d *result);
+
 void aran_development3d_m2m_kkylin (const VsgPRTree3dNodeInfo *src_node,
                                     AranDevelopment3d *src,
                                     const VsgPRTree3dNodeInfo *dst_node,
@@ -149,6 +178,25 @@ void aran_development3d_l2l_rotate (const VsgPRTree3dNodeInfo *src_node,
                                     const VsgPRTree3dNodeInfo *dst_node,
                                     AranDevelopment3d *dst);
 
+AranDevelopment3dSchedule *aran_development3d_schedule_new (guint8 posdeg,
+                                                            guint8 negdeg);
+
+void aran_development3d_schedule_free (AranDevelopment3dSchedule *schedule);
+
+void
+aran_development3d_schedule_set_level (AranDevelopment3dSchedule *schedule,
+                                       guint depth,
+                                       guint8 posdeg, guint8 negdeg);
+
+void
+aran_development3d_schedule_get_level (const AranDevelopment3dSchedule *schedule,
+                                       guint depth,
+                                       guint8 *posdeg, guint8 *negdeg);
+
+void aran_development3d_schedule_zero (const VsgPRTree3dNodeInfo *node_info,
+                                       AranDevelopment3d *ad,
+                                       AranDevelopment3dSchedule *schedule);
+
 #ifdef VSG_HAVE_MPI
 
 void aran_development3d_vtable_init (VsgParallelVTable *vtable, guint8 posdeg,
@@ -156,6 +204,10 @@ void aran_development3d_vtable_init (VsgParallelVTable *vtable, guint8 posdeg,
 
 void aran_development3d_vtable_clear (VsgParallelVTable *vtable);
 
+void
+aran_development3d_vtable_set_compression (VsgParallelVTable *vtable,
+                                           AranPackCompression *compression);
+
 gpointer aran_development3d_alloc (gboolean resident, AranDevelopment3d *src);
 
 void aran_development3d_destroy (gpointer data, gboolean resident,
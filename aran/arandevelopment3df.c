@@ -0,0 +1,997 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "arandevelopment3df.h"
+#include "aransphericalseriesd-private.h"
+
+#include <float.h>
+#include <math.h>
+
+/**
+ * ARAN_TYPE_DEVELOPMENT3DF:
+ *
+ * #AranDevelopment3df #GBoxed #GType.
+ */
+
+/**
+ * AranDevelopment3df:
+ * @multipole: single precision multipole expansion (%NULL when @wide is set).
+ * @local: single precision local expansion (%NULL when @wide is set).
+ * @wide: double precision storage (%NULL unless set by
+ * aran_development3df_set_wide()).
+ *
+ * A structure used as #VsgPRTree3d node_data within an #AranSolver3d. It
+ * stores expansions in single precision, halving the memory footprint
+ * and traffic of #AranDevelopment3d, unless switched to double precision
+ * with aran_development3df_set_wide(). Both storage modes can be mixed in
+ * the same tree (see aran_development3df_mixed_zero()).
+ */
+
+/* double precision work copy of a single precision series */
+#define _WIDEN(src, wide) { \
+  guint8 _pd = aran_spherical_seriesf_get_posdeg (src); \
+  guint8 _nd = aran_spherical_seriesf_get_negdeg (src); \
+  (wide) = (AranSphericalSeriesd *) \
+    g_alloca (ARAN_SPHERICAL_SERIESD_SIZE (_pd, _nd)); \
+  (wide)->posdeg = _pd; \
+  (wide)->negdeg = _nd; \
+  aran_spherical_seriesd_set_zero (wide); \
+  aran_spherical_seriesf_to_seriesd ((src), (wide)); \
+}
+
+/* zeroed double precision work series */
+#define _WORK(pd, nd, work) { \
+  (work) = (AranSphericalSeriesd *) \
+    g_alloca (ARAN_SPHERICAL_SERIESD_SIZE ((pd), (nd))); \
+  (work)->posdeg = (pd); \
+  (work)->negdeg = (nd); \
+  aran_spherical_seriesd_set_zero (work); \
+}
+
+/* functions */
+
+GType aran_development3df_get_type ()
+{
+  static GType devtype = G_TYPE_NONE;
+
+  if (G_UNLIKELY (devtype == G_TYPE_NONE))
+    {
+      devtype =
+	g_boxed_type_register_static ("AranDevelopment3df",
+				      (GBoxedCopyFunc) aran_development3df_clone,
+				      (GBoxedFreeFunc) aran_development3df_free);
+    }
+
+  return devtype;
+}
+
+/**
+ * aran_development3df_new:
+ * @posdeg: a #guint8.
+ * @negdeg: a #guint8.
+ *
+ * Allocates a new single precision #AranDeveloment3df structure.
+ *
+ * Returns: newly allocated structure.
+ */
+AranDevelopment3df *aran_development3df_new (guint8 posdeg, guint8 negdeg)
+{
+  AranDevelopment3df *result =
+    (AranDevelopment3df *) g_malloc (sizeof (AranDevelopment3df));
+
+  result->multipole = aran_spherical_seriesf_new (posdeg, negdeg);
+  result->local = aran_spherical_seriesf_new (MAX (posdeg, negdeg), 0);
+  result->wide = NULL;
+
+  return result;
+}
+
+/**
+ * aran_development3df_free:
+ * @ad: an #AranDevelopment3df.
+ *
+ * Deallocates @ad and all associated memory.
+ */
+void aran_development3df_free (AranDevelopment3df *ad)
+{
+  if (ad->wide != NULL)
+    aran_development3d_free (ad->wide);
+  else
+    {
+      aran_spherical_seriesf_free (ad->multipole);
+      aran_spherical_seriesf_free (ad->local);
+    }
+
+  g_free (ad);
+}
+
+/**
+ * aran_development3df_copy:
+ * @src: an #AranDevelopment3df.
+ * @dst: an #AranDevelopment3df.
+ *
+ * Copies @src into @dst, including its storage precision. Development
+ * degrees must coincide.
+ */
+void aran_development3df_copy (const AranDevelopment3df *src,
+                               AranDevelopment3df *dst)
+{
+  g_return_if_fail (src != NULL);
+  g_return_if_fail (dst != NULL);
+
+  aran_development3df_set_wide (dst, src->wide != NULL);
+
+  if (src->wide != NULL)
+    {
+      aran_development3d_copy (src->wide, dst->wide);
+    }
+  else
+    {
+      aran_spherical_seriesf_copy (src->multipole, dst->multipole);
+      aran_spherical_seriesf_copy (src->local, dst->local);
+    }
+}
+
+/**
+ * aran_development3df_clone:
+ * @src: an #AranDevelopment3df.
+ *
+ * Duplicates @src.
+ *
+ * Returns: newly allocated copy of @src.
+ */
+AranDevelopment3df *aran_development3df_clone (AranDevelopment3df *src)
+{
+  AranDevelopment3df *dst;
+
+  g_return_val_if_fail (src != NULL, NULL);
+
+  dst = aran_development3df_new (aran_development3df_get_posdeg (src),
+                                 aran_development3df_get_negdeg (src));
+
+  aran_development3df_copy (src, dst);
+
+  return dst;
+}
+
+/**
+ * aran_development3df_set_zero:
+ * @ad: an #AranDevelopment3df.
+ *
+ * Sets all @ad coefficients to zero.
+ */
+void aran_development3df_set_zero (AranDevelopment3df *ad)
+{
+  g_return_if_fail (ad != NULL);
+
+  if (ad->wide != NULL)
+    {
+      aran_development3d_set_zero (ad->wide);
+      return;
+    }
+
+  aran_spherical_seriesf_set_zero (ad->multipole);
+  aran_spherical_seriesf_set_zero (ad->local);
+}
+
+/**
+ * aran_development3df_get_posdeg:
+ * @ad: an #AranDevelopment3df.
+ *
+ * Returns: the positive degree @ad was created with.
+ */
+guint8 aran_development3df_get_posdeg (const AranDevelopment3df *ad)
+{
+  g_return_val_if_fail (ad != NULL, 0);
+
+  if (ad->wide != NULL)
+    return aran_development3d_get_posdeg (ad->wide);
+
+  return aran_spherical_seriesf_get_posdeg (ad->multipole);
+}
+
+/**
+ * aran_development3df_get_negdeg:
+ * @ad: an #AranDevelopment3df.
+ *
+ * Returns: the multipole degree of @ad.
+ */
+guint8 aran_development3df_get_negdeg (const AranDevelopment3df *ad)
+{
+  g_return_val_if_fail (ad != NULL, 0);
+
+  if (ad->wide != NULL)
+    return aran_development3d_get_negdeg (ad->wide);
+
+  return aran_spherical_seriesf_get_negdeg (ad->multipole);
+}
+
+/**
+ * aran_development3df_set_wide:
+ * @ad: an #AranDevelopment3df.
+ * @wide: whether @ad should be stored in double precision.
+ *
+ * Changes @ad storage precision, converting its coefficients when
+ * necessary. Translation operators accept any combination of single and
+ * double precision developments.
+ */
+void aran_development3df_set_wide (AranDevelopment3df *ad, gboolean wide)
+{
+  guint8 posdeg, negdeg;
+
+  g_return_if_fail (ad != NULL);
+
+  if (wide == (ad->wide != NULL)) return;
+
+  posdeg = aran_development3df_get_posdeg (ad);
+  negdeg = aran_development3df_get_negdeg (ad);
+
+  if (wide)
+    {
+      ad->wide = aran_development3d_new (posdeg, negdeg);
+      aran_development3d_set_zero (ad->wide);
+
+      aran_spherical_seriesf_to_seriesd (ad->multipole, ad->wide->multipole);
+      aran_spherical_seriesf_to_seriesd (ad->local, ad->wide->local);
+
+      aran_spherical_seriesf_free (ad->multipole);
+      aran_spherical_seriesf_free (ad->local);
+
+      ad->multipole = NULL;
+      ad->local = NULL;
+    }
+  else
+    {
+      ad->multipole = aran_spherical_seriesf_new (posdeg, negdeg);
+      ad->local = aran_spherical_seriesf_new (MAX (posdeg, negdeg), 0);
+
+      aran_spherical_seriesf_from_seriesd (ad->wide->multipole, ad->multipole);
+      aran_spherical_seriesf_from_seriesd (ad->wide->local, ad->local);
+
+      aran_development3d_free (ad->wide);
+      ad->wide = NULL;
+    }
+}
+
+/**
+ * aran_development3df_is_wide:
+ * @ad: an #AranDevelopment3df.
+ *
+ * Returns: %TRUE if @ad is stored in double precision.
+ */
+gboolean aran_development3df_is_wide (const AranDevelopment3df *ad)
+{
+  g_return_val_if_fail (ad != NULL, FALSE);
+
+  return ad->wide != NULL;
+}
+
+/**
+ * aran_development3df_write:
+ * @ad: an #AranDevelopment3df.
+ * @file: output file.
+ *
+ * Writes @ad to @file.
+ */
+void aran_development3df_write (AranDevelopment3df *ad, FILE *file)
+{
+  g_return_if_fail (ad != NULL);
+
+  if (ad->wide != NULL)
+    {
+      aran_development3d_write (ad->wide, file);
+      return;
+    }
+
+  fprintf (file, "{multipole= ");
+  aran_spherical_seriesf_write (ad->multipole, file);
+  fprintf (file, ", local= ");
+  aran_spherical_seriesf_write (ad->local, file);
+  fprintf (file, "}");
+}
+
+/**
+ * aran_development3df_p2m:
+ * @position: particle position
+ * @charge: particle charge
+ * @dst_node: @dst tree node info.
+ * @dst: an #AranDevelopment3df.
+ *
+ * compute some particle contribution to a Multipole expansion. Terms are
+ * computed in double precision and rounded once.
+ */
+void aran_development3df_p2m (const VsgVector3d *position,
+                              const gdouble charge,
+                              const VsgPRTree3dNodeInfo *dst_node,
+                              AranDevelopment3df *dst)
+{
+  VsgVector3d tmp;
+  guint deg;
+  gint l, m;
+  gdouble r, cost, sint, cosp, sinp;
+  gcomplex128 expp;
+  gdouble fact;
+
+  if (dst->wide != NULL)
+    {
+      aran_development3d_p2m (position, charge, dst_node, dst->wide);
+      return;
+    }
+
+  deg = aran_spherical_seriesf_get_negdeg (dst->multipole);
+
+  {
+    gcomplex128 harmonics[((deg+1)*(deg+2))/2];
+
+    vsg_vector3d_sub (position, &dst_node->center, &tmp);
+
+    vsg_vector3d_to_spherical_internal (&tmp, &r, &cost, &sint, &cosp, &sinp);
+    expp = cosp + G_I * sinp;
+
+    aran_spherical_harmonic_evaluate_multiple_internal (deg, cost, sint, expp,
+                                                        harmonics);
+
+    fact = charge;
+
+    for (l=0; l<deg; l ++)
+      {
+        gcomplex64 *ptr;
+        gcomplex128 *h = aran_spherical_harmonic_multiple_get_term (l, 0,
+                                                                    harmonics);
+        gdouble norm = fact * (4.*G_PI / (l+l+1.));
+
+        ptr = aran_spherical_seriesf_get_term (dst->multipole, -l-1, 0);
+
+        for (m=0; m<=l; m ++)
+          ptr[m] += (gcomplex64) conj (norm * h[m]);
+
+        fact *= r;
+      }
+  }
+}
+
+/**
+ * aran_development3df_p2l:
+ * @position: particle position
+ * @charge: particle charge
+ * @dst_node: @dst tree node info.
+ * @dst: an #AranDevelopment3df.
+ *
+ * compute some particle contribution to a Local expansion. Terms are
+ * computed in double precision and rounded once.
+ */
+void aran_development3df_p2l (const VsgVector3d *position,
+                              const gdouble charge,
+                              const VsgPRTree3dNodeInfo *dst_node,
+                              AranDevelopment3df *dst)
+{
+  VsgVector3d tmp;
+  guint deg;
+  gint l, m;
+  gdouble r, cost, sint, cosp, sinp;
+  gcomplex128 expp;
+  gdouble fact, inv_r;
+
+  if (dst->wide != NULL)
+    {
+      aran_development3d_p2l (position, charge, dst_node, dst->wide);
+      return;
+    }
+
+  deg = aran_spherical_seriesf_get_posdeg (dst->local);
+
+  {
+    gcomplex128 harmonics[((deg+1)*(deg+2))/2];
+
+    vsg_vector3d_sub (position, &dst_node->center, &tmp);
+
+    vsg_vector3d_to_spherical_internal (&tmp, &r, &cost, &sint, &cosp, &sinp);
+    expp = cosp + G_I * sinp;
+
+    aran_spherical_harmonic_evaluate_multiple_internal (deg, cost, sint, expp,
+                                                        harmonics);
+
+    inv_r = 1. / r;
+    fact = charge * inv_r;
+
+    for (l=0; l<=deg; l ++)
+      {
+        gcomplex64 *ptr;
+        gcomplex128 *h = aran_spherical_harmonic_multiple_get_term (l, 0,
+                                                                    harmonics);
+        gdouble norm = fact * (4.*G_PI / (l+l+1.));
+
+        ptr = aran_spherical_seriesf_get_term (dst->local, l, 0);
+
+        for (m=0; m<=l; m ++)
+          ptr[m] += (gcomplex64) conj (norm * h[m]);
+
+        fact *= inv_r;
+      }
+  }
+}
+
+/**
+ * aran_development3df_m2m:
+ * @src_node: @src tree node info.
+ * @src: an #AranDevelopment3df.
+ * @dst_node: @dst tree node info.
+ * @dst: an #AranDevelopment3df.
+ *
+ * Performs multipole 2 multipole translation between @src and @dst with
+ * the "Point and Shoot" technique. Translation is computed in double
+ * precision and accumulated into @dst storage precision.
+ */
+void aran_development3df_m2m (const VsgPRTree3dNodeInfo *src_node,
+                              AranDevelopment3df *src,
+                              const VsgPRTree3dNodeInfo *dst_node,
+                              AranDevelopment3df *dst)
+{
+  AranSphericalSeriesd *srcd, *work;
+
+  if (src->wide != NULL)
+    srcd = src->wide->multipole;
+  else
+    _WIDEN (src->multipole, srcd);
+
+  if (dst->wide != NULL)
+    {
+      aran_spherical_seriesd_translate_rotate (srcd, &src_node->center,
+                                               dst->wide->multipole,
+                                               &dst_node->center);
+      return;
+    }
+
+  _WORK (aran_spherical_seriesf_get_posdeg (dst->multipole),
+         aran_spherical_seriesf_get_negdeg (dst->multipole), work);
+
+  aran_spherical_seriesd_translate_rotate (srcd, &src_node->center,
+                                           work, &dst_node->center);
+
+  aran_spherical_seriesf_from_seriesd (work, dst->multipole);
+}
+
+/**
+ * aran_development3df_m2l:
+ * @src_node: @src tree node info.
+ * @src: an #AranDevelopment3df.
+ * @dst_node: @dst tree node info.
+ * @dst: an #AranDevelopment3df.
+ *
+ * Performs multipole 2 local translation between @src and @dst with the
+ * "Point and Shoot" technique. When both developments are stored in
+ * single precision, the translation itself is performed in single
+ * precision (see aran_spherical_seriesf_to_local_rotate()). Otherwise, it
+ * is computed in double precision.
+ */
+void aran_development3df_m2l (const VsgPRTree3dNodeInfo *src_node,
+                              AranDevelopment3df *src,
+                              const VsgPRTree3dNodeInfo *dst_node,
+                              AranDevelopment3df *dst)
+{
+  AranSphericalSeriesd *srcd, *work;
+
+  if (src->wide == NULL && dst->wide == NULL)
+    {
+      aran_spherical_seriesf_to_local_rotate (src->multipole,
+                                              &src_node->center,
+                                              dst->local, &dst_node->center);
+      return;
+    }
+
+  if (src->wide != NULL)
+    srcd = src->wide->multipole;
+  else
+    _WIDEN (src->multipole, srcd);
+
+  if (dst->wide != NULL)
+    {
+      aran_spherical_seriesd_to_local_rotate (srcd, &src_node->center,
+                                              dst->wide->local,
+                                              &dst_node->center);
+      return;
+    }
+
+  _WORK (aran_spherical_seriesf_get_posdeg (dst->local), 0, work);
+
+  aran_spherical_seriesd_to_local_rotate (srcd, &src_node->center,
+                                          work, &dst_node->center);
+
+  aran_spherical_seriesf_from_seriesd (work, dst->local);
+}
+
+/**
+ * aran_development3df_l2l:
+ * @src_node: @src tree node info.
+ * @src: an #AranDevelopment3df.
+ * @dst_node: @dst tree node info.
+ * @dst: an #AranDevelopment3df.
+ *
+ * Performs local 2 local translation between @src and @dst with the
+ * "Point and Shoot" technique. Translation is computed in double precision
+ * and accumulated into @dst storage precision.
+ */
+void aran_development3df_l2l (const VsgPRTree3dNodeInfo *src_node,
+                              AranDevelopment3df *src,
+                              const VsgPRTree3dNodeInfo *dst_node,
+                              AranDevelopment3df *dst)
+{
+  AranSphericalSeriesd *srcd, *work;
+
+  if (src->wide != NULL)
+    srcd = src->wide->local;
+  else
+    _WIDEN (src->local, srcd);
+
+  if (dst->wide != NULL)
+    {
+      aran_spherical_seriesd_translate_rotate (srcd, &src_node->center,
+                                               dst->wide->local,
+                                               &dst_node->center);
+      return;
+    }
+
+  _WORK (aran_spherical_seriesf_get_posdeg (dst->local), 0, work);
+
+  aran_spherical_seriesd_translate_rotate (srcd, &src_node->center,
+                                           work, &dst_node->center);
+
+  aran_spherical_seriesf_from_seriesd (work, dst->local);
+}
+
+/**
+ * aran_development3df_m2p:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranDevelopment3df.
+ * @pos: evaluation position.
+ *
+ * Evaluates the multipole part of @devel at @pos in double precision.
+ *
+ * Returns: value of multipole part of @devel(@pos).
+ */
+gcomplex128 aran_development3df_m2p (const VsgPRTree3dNodeInfo *devel_node,
+                                     AranDevelopment3df *devel,
+                                     const VsgVector3d *pos)
+{
+  VsgVector3d tmp;
+
+  if (devel->wide != NULL)
+    return aran_development3d_m2p (devel_node, devel->wide, pos);
+
+  vsg_vector3d_sub (pos, &devel_node->center, &tmp);
+
+  return aran_spherical_seriesf_evaluate (devel->multipole, &tmp);
+}
+
+/**
+ * aran_development3df_l2p:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranDevelopment3df.
+ * @pos: evaluation position.
+ *
+ * Evaluates the local part of @devel at @pos in double precision.
+ *
+ * Returns: value of local part of @devel(@pos).
+ */
+gcomplex128 aran_development3df_l2p (const VsgPRTree3dNodeInfo *devel_node,
+                                     AranDevelopment3df *devel,
+                                     const VsgVector3d *pos)
+{
+  VsgVector3d tmp;
+
+  if (devel->wide != NULL)
+    return aran_development3d_l2p (devel_node, devel->wide, pos);
+
+  vsg_vector3d_sub (pos, &devel_node->center, &tmp);
+
+  return aran_spherical_seriesf_evaluate (devel->local, &tmp);
+}
+
+/**
+ * aran_development3df_m2pv:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranDevelopment3df.
+ * @pos: evaluation position.
+ * @grad: result gradient.
+ *
+ * Evaluates the gradient of the multipole part of @devel at @pos in double
+ * precision.
+ */
+void aran_development3df_m2pv (const VsgPRTree3dNodeInfo *devel_node,
+                               AranDevelopment3df *devel,
+                               const VsgVector3d *pos,
+                               VsgVector3d *grad)
+{
+  VsgVector3d tmp;
+
+  if (devel->wide != NULL)
+    {
+      aran_development3d_m2pv (devel_node, devel->wide, pos, grad);
+      return;
+    }
+
+  vsg_vector3d_sub (pos, &devel_node->center, &tmp);
+
+  aran_spherical_seriesf_gradient_evaluate (devel->multipole, &tmp, grad);
+}
+
+/**
+ * aran_development3df_l2pv:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranDevelopment3df.
+ * @pos: evaluation position.
+ * @grad: result gradient.
+ *
+ * Evaluates the gradient of the local part of @devel at @pos in double
+ * precision.
+ */
+void aran_development3df_l2pv (const VsgPRTree3dNodeInfo *devel_node,
+                               AranDevelopment3df *devel,
+                               const VsgVector3d *pos,
+                               VsgVector3d *grad)
+{
+  VsgVector3d tmp;
+
+  if (devel->wide != NULL)
+    {
+      aran_development3d_l2pv (devel_node, devel->wide, pos, grad);
+      return;
+    }
+
+  vsg_vector3d_sub (pos, &devel_node->center, &tmp);
+
+  aran_spherical_seriesf_gradient_evaluate (devel->local, &tmp, grad);
+}
+
+/**
+ * aran_development3df_mixed_depth:
+ * @tolerance: requested relative accuracy.
+ * @posdeg: expansions degree.
+ * @tree_depth: depth of the solver tree (see aran_solver3d_depth()).
+ *
+ * Estimates how many tree levels, counted from the root, have to be
+ * stored in double precision for single precision rounding to stay
+ * below @tolerance. Each single precision level is assumed to add a
+ * relative rounding error of about 2 (@posdeg+1) FLT_EPSILON, on the
+ * upward and downward passes. The root and its children always stay in
+ * double precision: they only hold a handful of nodes but accumulate the
+ * largest sums.
+ *
+ * Returns: the depth above which nodes should be stored in double
+ * precision, suitable for aran_development3df_mixed_zero().
+ */
+guint aran_development3df_mixed_depth (gdouble tolerance, guint8 posdeg,
+                                       guint tree_depth)
+{
+  gdouble level_error = 2. * (posdeg + 1.) * FLT_EPSILON;
+  gdouble single_levels;
+
+  g_return_val_if_fail (tolerance > 0., tree_depth + 1);
+
+  single_levels = floor (tolerance / level_error);
+
+  if (single_levels >= tree_depth - 1.)
+    return 2;
+
+  return tree_depth + 1 - (guint) single_levels;
+}
+
+/**
+ * aran_development3df_mixed_zero:
+ * @node_info: a #VsgPRTree3dNodeInfo.
+ * @ad: an #AranDevelopment3df.
+ * @wide_depth: the depth above which @ad should be stored in double
+ * precision.
+ *
+ * Sets @ad storage to double precision when @node_info depth is lower than
+ * *@wide_depth, to single precision otherwise, and sets all @ad
+ * coefficients to zero. Suitable as an #AranSolver3d node zeroing function
+ * (see aran_solver3d_set_node_zero()) for a mixed precision solve where
+ * only near root levels need double precision.
+ */
+void aran_development3df_mixed_zero (const VsgPRTree3dNodeInfo *node_info,
+                                     AranDevelopment3df *ad,
+                                     guint *wide_depth)
+{
+  aran_development3df_set_wide (ad, node_info->depth < *wide_depth);
+  aran_development3df_set_zero (ad);
+}
+
+#ifdef VSG_HAVE_MPI
+
+/*
+ * developments carry their storage precision in messages since it may
+ * differ from the receiving node one.
+ */
+static void _development3df_wide_pack (AranDevelopment3df *devel,
+                                       VsgPackedMsg *pm)
+{
+  gint wide = devel->wide != NULL;
+
+  vsg_packed_msg_send_append (pm, &wide, 1, MPI_INT);
+}
+
+static void _development3df_wide_unpack (AranDevelopment3df *devel,
+                                         VsgPackedMsg *pm)
+{
+  gint wide;
+
+  vsg_packed_msg_recv_read (pm, &wide, 1, MPI_INT);
+
+  aran_development3df_set_wide (devel, wide);
+}
+
+static void _series_pack (AranSphericalSeriesf *single,
+                          AranSphericalSeriesd *wide, VsgPackedMsg *pm)
+{
+  if (single != NULL)
+    aran_spherical_seriesf_pack (single, pm);
+  else
+    aran_spherical_seriesd_pack (wide, pm);
+}
+
+static void _series_unpack (AranSphericalSeriesf *single,
+                            AranSphericalSeriesd *wide, VsgPackedMsg *pm)
+{
+  if (single != NULL)
+    aran_spherical_seriesf_unpack (single, pm);
+  else
+    aran_spherical_seriesd_unpack (wide, pm);
+}
+
+/* b += a, whatever their storage precisions */
+static void _series_reduce (AranSphericalSeriesf *asingle,
+                            AranSphericalSeriesd *awide,
+                            AranSphericalSeriesf *bsingle,
+                            AranSphericalSeriesd *bwide)
+{
+  if (bsingle != NULL)
+    {
+      if (asingle != NULL)
+        aran_spherical_seriesf_add (asingle, bsingle, bsingle);
+      else
+        aran_spherical_seriesf_from_seriesd (awide, bsingle);
+    }
+  else
+    {
+      if (asingle != NULL)
+        aran_spherical_seriesf_to_seriesd (asingle, bwide);
+      else
+        aran_spherical_seriesd_add (awide, bwide, bwide);
+    }
+}
+
+#define _MULTIPOLE_WIDE(ad) (((ad)->wide != NULL) ? (ad)->wide->multipole : NULL)
+#define _LOCAL_WIDE(ad) (((ad)->wide != NULL) ? (ad)->wide->local : NULL)
+
+void aran_development3df_vtable_init (VsgParallelVTable *vtable, guint8 posdeg,
+                                      guint8 negdeg)
+{
+  vtable->alloc = (VsgMigrableAllocDataFunc) aran_development3df_alloc;
+  vtable->alloc_data = aran_development3df_new ((posdeg), (negdeg));
+
+  vtable->destroy = aran_development3df_destroy;
+  vtable->destroy_data = NULL;
+
+  vtable->migrate.pack =
+    (VsgMigrablePackDataFunc) aran_development3df_migrate_pack;
+  vtable->migrate.pack_data = NULL;
+
+  vtable->migrate.unpack =
+    (VsgMigrablePackDataFunc) aran_development3df_migrate_unpack;
+  vtable->migrate.unpack_data = NULL;
+
+  vtable->visit_forward.pack =
+    (VsgMigrablePackDataFunc) aran_development3df_visit_fw_pack;
+  vtable->visit_forward.pack_data = NULL;
+
+  vtable->visit_forward.unpack =
+    (VsgMigrablePackDataFunc) aran_development3df_visit_fw_unpack;
+  vtable->visit_forward.unpack_data = NULL;
+
+  vtable->visit_forward.reduce =
+    (VsgMigrableReductionDataFunc) aran_development3df_visit_fw_reduce;
+  vtable->visit_forward.reduce_data = NULL;
+
+  vtable->visit_backward.pack =
+    (VsgMigrablePackDataFunc) aran_development3df_visit_bw_pack;
+  vtable->visit_backward.pack_data = NULL;
+
+  vtable->visit_backward.unpack =
+    (VsgMigrablePackDataFunc) aran_development3df_visit_bw_unpack;
+  vtable->visit_backward.unpack_data = NULL;
+
+  vtable->visit_backward.reduce =
+    (VsgMigrableReductionDataFunc) aran_development3df_visit_bw_reduce;
+  vtable->visit_backward.reduce_data = NULL;
+}
+
+void aran_development3df_vtable_clear (VsgParallelVTable *vtable)
+{
+  g_return_if_fail (vtable != NULL);
+  g_return_if_fail (vtable->alloc_data != NULL);
+
+  aran_development3df_free (vtable->alloc_data);
+}
+
+/**
+ * aran_development3df_alloc:
+ * @resident: unused.
+ * @src: an example #AranDevelopment3df to copy from.
+ *
+ * Allocates a new #AranDevelopment3df by clonig @src.
+ *
+ * Returns: a copy of @src.
+ */
+gpointer aran_development3df_alloc (gboolean resident, AranDevelopment3df *src)
+{
+  return g_boxed_copy (ARAN_TYPE_DEVELOPMENT3DF, src);
+}
+
+/**
+ * aran_development3df_destroy:
+ * @data: A #AranDevelopment3df.
+ * @resident: unused.
+ * @user_data: unused.
+ *
+ * Deletes @data from memory.
+ */
+void aran_development3df_destroy (gpointer data, gboolean resident,
+                                  gpointer user_data)
+{
+  g_assert (data != NULL);
+  g_boxed_free (ARAN_TYPE_DEVELOPMENT3DF, data);
+}
+
+/**
+ * aran_development3df_migrate_pack:
+ * @devel: an #AranDevelopment3df.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs complete packing of @devel into @pm for a migration
+ * between processors.
+ */
+void aran_development3df_migrate_pack (AranDevelopment3df *devel,
+                                       VsgPackedMsg *pm,
+                                       gpointer user_data)
+{
+  _development3df_wide_pack (devel, pm);
+  _series_pack (devel->multipole, _MULTIPOLE_WIDE (devel), pm);
+  _series_pack (devel->local, _LOCAL_WIDE (devel), pm);
+}
+
+/**
+ * aran_development3df_migrate_unpack:
+ * @devel: an #AranDevelopment3df.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm in a migration between processors and
+ * stores it in @devel.
+ */
+void aran_development3df_migrate_unpack (AranDevelopment3df *devel,
+                                         VsgPackedMsg *pm,
+                                         gpointer user_data)
+{
+  _development3df_wide_unpack (devel, pm);
+  _series_unpack (devel->multipole, _MULTIPOLE_WIDE (devel), pm);
+  _series_unpack (devel->local, _LOCAL_WIDE (devel), pm);
+}
+
+/**
+ * aran_development3df_visit_fw_pack:
+ * @devel: an #AranDevelopment3df.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs packing of @devel into @pm for a near/far forward visit
+ * of a local node to another processor.
+ */
+void aran_development3df_visit_fw_pack (AranDevelopment3df *devel,
+                                        VsgPackedMsg *pm,
+                                        gpointer user_data)
+{
+  _development3df_wide_pack (devel, pm);
+  _series_pack (devel->multipole, _MULTIPOLE_WIDE (devel), pm);
+}
+
+/**
+ * aran_development3df_visit_fw_unpack:
+ * @devel: an #AranDevelopment3df.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm for a near/far forward visit of a
+ * remote node.
+ */
+void aran_development3df_visit_fw_unpack (AranDevelopment3df *devel,
+                                          VsgPackedMsg *pm,
+                                          gpointer user_data)
+{
+  _development3df_wide_unpack (devel, pm);
+  _series_unpack (devel->multipole, _MULTIPOLE_WIDE (devel), pm);
+}
+
+/**
+ * aran_development3df_visit_fw_reduce:
+ * @a: source #AranDevelopment3df.
+ * @b: destination #AranDevelopment3df.
+ * @user_data: unused.
+ *
+ * Forward visit reduction operator for #AranDevelopment3df.
+ */
+void aran_development3df_visit_fw_reduce (AranDevelopment3df *a,
+                                          AranDevelopment3df *b,
+                                          gpointer user_data)
+{
+  _series_reduce (a->multipole, _MULTIPOLE_WIDE (a),
+                  b->multipole, _MULTIPOLE_WIDE (b));
+}
+
+/**
+ * aran_development3df_visit_bw_pack:
+ * @devel: an #AranDevelopment3df.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs packing of @devel into @pm for a near/far backward visit
+ * of a remote node to its original processor.
+ */
+void aran_development3df_visit_bw_pack (AranDevelopment3df *devel,
+                                        VsgPackedMsg *pm,
+                                        gpointer user_data)
+{
+  _development3df_wide_pack (devel, pm);
+  _series_pack (devel->local, _LOCAL_WIDE (devel), pm);
+}
+
+/**
+ * aran_development3df_visit_bw_unpack:
+ * @devel: an #AranDevelopment3df.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm for a near/far backward visit of a
+ * remote node.
+ */
+void aran_development3df_visit_bw_unpack (AranDevelopment3df *devel,
+                                          VsgPackedMsg *pm,
+                                          gpointer user_data)
+{
+  _development3df_wide_unpack (devel, pm);
+  _series_unpack (devel->local, _LOCAL_WIDE (devel), pm);
+}
+
+/**
+ * aran_development3df_visit_bw_reduce:
+ * @a: source #AranDevelopment3df.
+ * @b: destination #AranDevelopment3df.
+ * @user_data: unused.
+ *
+ * Backward visit reduction operator for #AranDevelopment3df.
+ */
+void aran_development3df_visit_bw_reduce (AranDevelopment3df *a,
+                                          AranDevelopment3df *b,
+                                          gpointer user_data)
+{
+  _series_reduce (a->local, _LOCAL_WIDE (a), b->local, _LOCAL_WIDE (b));
+}
+
+#endif /* VSG_HAVE_MPI */
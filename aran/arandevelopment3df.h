@@ -0,0 +1,168 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __ARAN_DEVELOPMENT3DF_H__
+#define __ARAN_DEVELOPMENT3DF_H__
+
+#include <glib-object.h>
+
+#include <vsg/vsgd.h>
+#include <aran/aransphericalseriesf.h>
+#include <aran/arandevelopment3d.h>
+
+G_BEGIN_DECLS;
+
+/* macros */
+#define ARAN_TYPE_DEVELOPMENT3DF (aran_development3df_get_type ())
+
+/* typedefs */
+
+typedef struct _AranDevelopment3df AranDevelopment3df;
+
+struct _AranDevelopment3df
+{
+  AranSphericalSeriesf *multipole;
+  AranSphericalSeriesf *local;
+
+  AranDevelopment3d *wide;
+};
+
+/* functions */
+GType aran_development3df_get_type ();
+
+AranDevelopment3df *aran_development3df_new (guint8 posdeg, guint8 negdeg);
+
+void aran_development3df_free (AranDevelopment3df *ad);
+
+void aran_development3df_copy (const AranDevelopment3df *src,
+                               AranDevelopment3df *dst);
+
+AranDevelopment3df *aran_development3df_clone (AranDevelopment3df *src);
+
+void aran_development3df_set_zero (AranDevelopment3df *ad);
+
+guint8 aran_development3df_get_posdeg (const AranDevelopment3df *ad);
+
+guint8 aran_development3df_get_negdeg (const AranDevelopment3df *ad);
+
+void aran_development3df_set_wide (AranDevelopment3df *ad, gboolean wide);
+
+gboolean aran_development3df_is_wide (const AranDevelopment3df *ad);
+
+void aran_development3df_write (AranDevelopment3df *ad, FILE *file);
+
+void aran_development3df_p2m (const VsgVector3d *position,
+                              const gdouble charge,
+                              const VsgPRTree3dNodeInfo *dst_node,
+                              AranDevelopment3df *dst);
+
+void aran_development3df_p2l (const VsgVector3d *position,
+                              const gdouble charge,
+                              const VsgPRTree3dNodeInfo *dst_node,
+                              AranDevelopment3df *dst);
+
+void aran_development3df_m2m (const VsgPRTree3dNodeInfo *src_node,
+                              AranDevelopment3df *src,
+                              const VsgPRTree3dNodeInfo *dst_node,
+                              AranDevelopment3df *dst);
+
+void aran_development3df_m2l (const VsgPRTree3dNodeInfo *src_node,
+                              AranDevelopment3df *src,
+                              const VsgPRTree3dNodeInfo *dst_node,
+                              AranDevelopment3df *dst);
+
+void aran_development3df_l2l (const VsgPRTree3dNodeInfo *src_node,
+                              AranDevelopment3df *src,
+                              const VsgPRTree3dNodeInfo *dst_node,
+                              AranDevelopment3df *dst);
+
+gcomplex128 aran_development3df_m2p (const VsgPRTree3dNodeInfo *devel_node,
+                                     AranDevelopment3df *devel,
+                                     const VsgVector3d *pos);
+
+gcomplex128 aran_development3df_l2p (const VsgPRTree3dNodeInfo *devel_node,
+                                     AranDevelopment3df *devel,
+                                     const VsgVector3d *pos);
+
+void aran_development3df_m2pv (const VsgPRTree3dNodeInfo *devel_node,
+                               AranDevelopment3df *devel,
+                               const VsgVector3d *pos,
+                               VsgVector3d *grad);
+
+void aran_development3df_l2pv (const VsgPRTree3dNodeInfo *devel_node,
+                               AranDevelopment3df *devel,
+                               const VsgVector3d *pos,
+                               VsgVector3d *grad);
+
+guint aran_development3df_mixed_depth (gdouble tolerance, guint8 posdeg,
+                                       guint tree_depth);
+
+void aran_development3df_mixed_zero (const VsgPRTree3dNodeInfo *node_info,
+                                     AranDevelopment3df *ad,
+                                     guint *wide_depth);
+
+#ifdef VSG_HAVE_MPI
+
+void aran_development3df_vtable_init (VsgParallelVTable *vtable, guint8 posdeg,
+                                      guint8 negdeg);
+
+void aran_development3df_vtable_clear (VsgParallelVTable *vtable);
+
+gpointer aran_development3df_alloc (gboolean resident, AranDevelopment3df *src);
+
+void aran_development3df_destroy (gpointer data, gboolean resident,
+                                  gpointer user_data);
+
+void aran_development3df_migrate_pack (AranDevelopment3df *devel,
+                                       VsgPackedMsg *pm,
+                                       gpointer user_data);
+
+void aran_development3df_migrate_unpack (AranDevelopment3df *devel,
+                                         VsgPackedMsg *pm,
+                                         gpointer user_data);
+
+void aran_development3df_visit_fw_pack (AranDevelopment3df *devel,
+                                        VsgPackedMsg *pm,
+                                        gpointer user_data);
+
+void aran_development3df_visit_fw_unpack (AranDevelopment3df *devel,
+                                          VsgPackedMsg *pm,
+                                          gpointer user_data);
+
+void aran_development3df_visit_fw_reduce (AranDevelopment3df *a,
+                                          AranDevelopment3df *b,
+                                          gpointer user_data);
+
+void aran_development3df_visit_bw_pack (AranDevelopment3df *devel,
+                                        VsgPackedMsg *pm,
+                                        gpointer user_data);
+
+void aran_development3df_visit_bw_unpack (AranDevelopment3df *devel,
+                                          VsgPackedMsg *pm,
+                                          gpointer user_data);
+
+void aran_development3df_visit_bw_reduce (AranDevelopment3df *a,
+                                          AranDevelopment3df *b,
+                                          gpointer user_data);
+
+#endif /* VSG_HAVE_MPI */
+
+G_END_DECLS;
+
+#endif /* __ARAN_DEVELOPMENT3DF_H__ */
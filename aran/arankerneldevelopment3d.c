@@ -0,0 +1,1416 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "arankerneldevelopment3d.h"
+#include "aranlinear.h"
+
+#include <string.h>
+#include <math.h>
+
+/**
+ * ARAN_TYPE_KERNEL_DEVELOPMENT3D:
+ *
+ * #AranKernelDevelopment3d #GBoxed #GType.
+ */
+
+/**
+ * AranKernelFunc3d:
+ * @target: target position.
+ * @source: source position.
+ * @values: @dim x @dim row major kernel matrix (output).
+ * @user_data: user data.
+ *
+ * A translation invariant interaction kernel K(@target - @source). Row
+ * a column b of @values is the contribution of source component b to
+ * target component a. Scalar kernels have @dim = 1.
+ */
+
+/**
+ * AranKernel3d:
+ *
+ * An opaque structure holding an #AranKernelFunc3d together with the
+ * equivalent density operators it induces on each #VsgPRTree3d level.
+ * Operators are built the first time a level (or a level and an M2L
+ * offset) is used, then cached for all subsequent solves.
+ */
+
+/**
+ * AranKernelDevelopment3d:
+ * @kernel: the #AranKernel3d of the development.
+ * @multipole: upward equivalent density.
+ * @local: downward equivalent density.
+ * @multipole_check: pending upward check potential.
+ * @local_check: pending downward check potential.
+ * @multipole_pending: tells if @multipole_check holds values.
+ * @local_pending: tells if @local_check holds values.
+ *
+ * A structure used as #VsgPRTree3d node_data within an #AranSolver3d for
+ * kernel independent fast multipole computations: far fields are
+ * represented by densities located on equivalent surfaces surrounding
+ * the node and fitted, in the least squares sense, to the field on a
+ * check surface. Only kernel evaluations are needed.
+ *
+ * Contributions (from particles or translations) are accumulated as
+ * potentials on check surfaces and are converted to equivalent densities
+ * once per node, when the development is first read.
+ */
+
+/* equivalent and check surfaces distances, in node half width units */
+#define _INNER (1.05)
+#define _OUTER (2.95)
+
+/* relative threshold of singular values in equivalent density fitting */
+#define _SVD_TOLERANCE (1.e-8)
+
+/* relative tolerance on nodes geometry comparisons */
+#define _GEOMETRY_TOLERANCE (1.e-6)
+
+/* M2L offsets range, in node widths */
+#define _M2L_RANGE (3)
+#define _M2L_WIDTH (2 * _M2L_RANGE + 1)
+#define _M2L_OFFSETS (_M2L_WIDTH * _M2L_WIDTH * _M2L_WIDTH)
+
+typedef struct _KernelLevel KernelLevel;
+
+/* operators associated to nodes of a given size */
+struct _KernelLevel
+{
+  VsgVector3d half;
+
+  /* check potentials to equivalent densities (pseudo inverses) */
+  gdouble *up_pinv;
+  gdouble *down_pinv;
+
+  /* kernel matrices between a child (of this level) and its parent,
+   * indexed by child octant */
+  gdouble *m2m[8];
+  gdouble *l2l[8];
+
+  /* M2L kernel matrices indexed by offset */
+  gdouble *m2l[_M2L_OFFSETS];
+};
+
+struct _AranKernel3d
+{
+  guint ref_count;
+
+  AranKernelFunc3d func;
+  guint dim;
+  gpointer user_data;
+
+  guint order;
+  guint npoints;
+  guint size;
+
+  /* unit cube surface points */
+  VsgVector3d *surface;
+
+  GPtrArray *levels;
+};
+
+static void _kernel_level_free (KernelLevel *level)
+{
+  gint i;
+
+  g_free (level->up_pinv);
+  g_free (level->down_pinv);
+
+  for (i=0; i<8; i++)
+    {
+      g_free (level->m2m[i]);
+      g_free (level->l2l[i]);
+    }
+
+  for (i=0; i<_M2L_OFFSETS; i++)
+    g_free (level->m2l[i]);
+
+  g_free (level);
+}
+
+static gboolean _close (gdouble a, gdouble b, gdouble scale)
+{
+  return fabs (a - b) <= _GEOMETRY_TOLERANCE * scale;
+}
+
+static gboolean _half_equal (const VsgVector3d *a, const VsgVector3d *b)
+{
+  return _close (a->x, b->x, a->x) && _close (a->y, b->y, a->y) &&
+    _close (a->z, b->z, a->z);
+}
+
+static void _node_half (const VsgPRTree3dNodeInfo *node, VsgVector3d *half)
+{
+  vsg_vector3d_sub (&node->ubound, &node->lbound, half);
+  vsg_vector3d_scalp (half, 0.5, half);
+}
+
+static KernelLevel *_kernel_level (AranKernel3d *kernel,
+                                   const VsgVector3d *half)
+{
+  KernelLevel *level;
+  guint i;
+
+  for (i=0; i<kernel->levels->len; i++)
+    {
+      level = g_ptr_array_index (kernel->levels, i);
+
+      if (_half_equal (&level->half, half)) return level;
+    }
+
+  level = g_malloc0 (sizeof (KernelLevel));
+  level->half = *half;
+
+  g_ptr_array_add (kernel->levels, level);
+
+  return level;
+}
+
+/* i-th point of the surface at distance radius around (center, half) */
+static void _surface_point (const AranKernel3d *kernel, guint i,
+                            const VsgVector3d *center,
+                            const VsgVector3d *half, gdouble radius,
+                            VsgVector3d *result)
+{
+  const VsgVector3d *s = &kernel->surface[i];
+
+  result->x = center->x + radius * half->x * s->x;
+  result->y = center->y + radius * half->y * s->y;
+  result->z = center->z + radius * half->z * s->z;
+}
+
+/* kernel matrix from source surface densities to target surface values */
+static void _kernel_matrix (const AranKernel3d *kernel,
+                            const VsgVector3d *tcenter,
+                            const VsgVector3d *thalf, gdouble tradius,
+                            const VsgVector3d *scenter,
+                            const VsgVector3d *shalf, gdouble sradius,
+                            gdouble *mat)
+{
+  guint dim = kernel->dim, size = kernel->size;
+  gdouble values[dim * dim];
+  VsgVector3d t, s;
+  guint i, j, a, b;
+
+  for (i=0; i<kernel->npoints; i++)
+    {
+      _surface_point (kernel, i, tcenter, thalf, tradius, &t);
+
+      for (j=0; j<kernel->npoints; j++)
+        {
+          _surface_point (kernel, j, scenter, shalf, sradius, &s);
+
+          kernel->func (&t, &s, values, kernel->user_data);
+
+          for (a=0; a<dim; a++)
+            for (b=0; b<dim; b++)
+              mat[(i*dim + a) * size + j*dim + b] = values[a*dim + b];
+        }
+    }
+}
+
+/* truncated pseudo inverse of a square matrix (destroys mat) */
+static gdouble *_pseudo_inverse (guint size, gdouble *mat)
+{
+  gdouble *pinv = g_malloc (size * size * sizeof (gdouble));
+  gdouble *vdata = g_malloc (size * size * sizeof (gdouble));
+  gdouble *u[size], *v[size];
+  gdouble w[size], rhs[size], sol[size];
+  gdouble wmax = 0.;
+  guint i, j;
+
+  for (i=0; i<size; i++)
+    {
+      u[i] = mat + i * size;
+      v[i] = vdata + i * size;
+    }
+
+  aran_svd (size, size, u, w, v);
+
+  for (j=0; j<size; j++)
+    if (w[j] > wmax) wmax = w[j];
+
+  for (j=0; j<size; j++)
+    if (w[j] <= wmax * _SVD_TOLERANCE) w[j] = 0.;
+
+  /* pseudo inverse columns are solutions for canonical right hand sides */
+  for (i=0; i<size; i++)
+    {
+      memset (rhs, 0, size * sizeof (gdouble));
+      rhs[i] = 1.;
+
+      aran_svd_solve (size, size, u, w, v, sol, rhs);
+
+      for (j=0; j<size; j++)
+        pinv[j*size + i] = sol[j];
+    }
+
+  g_free (vdata);
+
+  return pinv;
+}
+
+/* result += mat * x */
+static void _matrix_apply (guint size, const gdouble *mat, const gdouble *x,
+                           gdouble *result)
+{
+  guint i, j;
+
+  for (i=0; i<size; i++)
+    {
+      const gdouble *row = mat + i * size;
+      gdouble sum = 0.;
+
+      for (j=0; j<size; j++)
+        sum += row[j] * x[j];
+
+      result[i] += sum;
+    }
+}
+
+static const gdouble *_up_pinv (AranKernel3d *kernel, KernelLevel *level)
+{
+  if (level->up_pinv == NULL)
+    {
+      VsgVector3d origin = {0., 0., 0.};
+      gdouble *mat = g_malloc (kernel->size * kernel->size * sizeof (gdouble));
+
+      _kernel_matrix (kernel, &origin, &level->half, _OUTER,
+                      &origin, &level->half, _INNER, mat);
+
+      level->up_pinv = _pseudo_inverse (kernel->size, mat);
+
+      g_free (mat);
+    }
+
+  return level->up_pinv;
+}
+
+static const gdouble *_down_pinv (AranKernel3d *kernel, KernelLevel *level)
+{
+  if (level->down_pinv == NULL)
+    {
+      VsgVector3d origin = {0., 0., 0.};
+      gdouble *mat = g_malloc (kernel->size * kernel->size * sizeof (gdouble));
+
+      _kernel_matrix (kernel, &origin, &level->half, _INNER,
+                      &origin, &level->half, _OUTER, mat);
+
+      level->down_pinv = _pseudo_inverse (kernel->size, mat);
+
+      g_free (mat);
+    }
+
+  return level->down_pinv;
+}
+
+/* center offset of a child in octant, relative to its parent center */
+static void _octant_offset (const VsgVector3d *half, gint octant,
+                            VsgVector3d *offset)
+{
+  offset->x = (octant & 1) ? half->x : - half->x;
+  offset->y = (octant & 2) ? half->y : - half->y;
+  offset->z = (octant & 4) ? half->z : - half->z;
+}
+
+/* child upward density to parent upward check potential */
+static const gdouble *_m2m_operator (AranKernel3d *kernel,
+                                     KernelLevel *child, gint octant)
+{
+  if (child->m2m[octant] == NULL)
+    {
+      VsgVector3d origin = {0., 0., 0.};
+      VsgVector3d phalf, offset;
+
+      child->m2m[octant] =
+        g_malloc (kernel->size * kernel->size * sizeof (gdouble));
+
+      vsg_vector3d_scalp (&child->half, 2., &phalf);
+
+      _octant_offset (&child->half, octant, &offset);
+
+      _kernel_matrix (kernel, &origin, &phalf, _OUTER,
+                      &offset, &child->half, _INNER, child->m2m[octant]);
+    }
+
+  return child->m2m[octant];
+}
+
+/* parent downward density to child downward check potential */
+static const gdouble *_l2l_operator (AranKernel3d *kernel,
+                                     KernelLevel *child, gint octant)
+{
+  if (child->l2l[octant] == NULL)
+    {
+      VsgVector3d origin = {0., 0., 0.};
+      VsgVector3d phalf, offset;
+
+      child->l2l[octant] =
+        g_malloc (kernel->size * kernel->size * sizeof (gdouble));
+
+      vsg_vector3d_scalp (&child->half, 2., &phalf);
+
+      _octant_offset (&child->half, octant, &offset);
+
+      _kernel_matrix (kernel, &offset, &child->half, _INNER,
+                      &origin, &phalf, _OUTER, child->l2l[octant]);
+    }
+
+  return child->l2l[octant];
+}
+
+/* source upward density to target downward check potential */
+static const gdouble *_m2l_operator (AranKernel3d *kernel,
+                                     KernelLevel *level, gint index)
+{
+  if (level->m2l[index] == NULL)
+    {
+      VsgVector3d origin = {0., 0., 0.};
+      VsgVector3d offset;
+
+      level->m2l[index] =
+        g_malloc (kernel->size * kernel->size * sizeof (gdouble));
+
+      offset.x = 2. * level->half.x *
+        (index / (_M2L_WIDTH * _M2L_WIDTH) - _M2L_RANGE);
+      offset.y = 2. * level->half.y *
+        ((index / _M2L_WIDTH) % _M2L_WIDTH - _M2L_RANGE);
+      offset.z = 2. * level->half.z * (index % _M2L_WIDTH - _M2L_RANGE);
+
+      _kernel_matrix (kernel, &origin, &level->half, _INNER,
+                      &offset, &level->half, _INNER, level->m2l[index]);
+    }
+
+  return level->m2l[index];
+}
+
+/* octant of child in parent or -1 when they are not child and parent */
+static gint _child_octant (const VsgPRTree3dNodeInfo *child,
+                           const VsgVector3d *chalf,
+                           const VsgPRTree3dNodeInfo *parent,
+                           const VsgVector3d *phalf)
+{
+  VsgVector3d d;
+
+  if (!_close (phalf->x, 2. * chalf->x, phalf->x) ||
+      !_close (phalf->y, 2. * chalf->y, phalf->y) ||
+      !_close (phalf->z, 2. * chalf->z, phalf->z))
+    return -1;
+
+  vsg_vector3d_sub (&child->center, &parent->center, &d);
+
+  if (!_close (fabs (d.x), chalf->x, chalf->x) ||
+      !_close (fabs (d.y), chalf->y, chalf->y) ||
+      !_close (fabs (d.z), chalf->z, chalf->z))
+    return -1;
+
+  return (d.x > 0. ? 1 : 0) | (d.y > 0. ? 2 : 0) | (d.z > 0. ? 4 : 0);
+}
+
+static gboolean _offset_component (gdouble d, gdouble width, gint *o)
+{
+  gdouble r = d / width;
+
+  *o = (gint) floor (r + 0.5);
+
+  return fabs (r - *o) <= _GEOMETRY_TOLERANCE &&
+    ABS (*o) <= _M2L_RANGE;
+}
+
+/* M2L operator index between same size nodes or -1 */
+static gint _m2l_index (const VsgPRTree3dNodeInfo *src_node,
+                        const VsgVector3d *shalf,
+                        const VsgPRTree3dNodeInfo *dst_node,
+                        const VsgVector3d *dhalf)
+{
+  VsgVector3d d;
+  gint ox, oy, oz;
+
+  if (!_half_equal (shalf, dhalf)) return -1;
+
+  vsg_vector3d_sub (&src_node->center, &dst_node->center, &d);
+
+  if (!_offset_component (d.x, 2. * dhalf->x, &ox) ||
+      !_offset_component (d.y, 2. * dhalf->y, &oy) ||
+      !_offset_component (d.z, 2. * dhalf->z, &oz))
+    return -1;
+
+  return ((ox + _M2L_RANGE) * _M2L_WIDTH + oy + _M2L_RANGE) * _M2L_WIDTH +
+    oz + _M2L_RANGE;
+}
+
+/* accumulates the field of a surface density on a check surface */
+static void _surface_to_check (AranKernel3d *kernel,
+                               const VsgVector3d *scenter,
+                               const VsgVector3d *shalf, gdouble sradius,
+                               const gdouble *density,
+                               const VsgVector3d *tcenter,
+                               const VsgVector3d *thalf, gdouble tradius,
+                               gdouble *check)
+{
+  gdouble *mat = g_malloc (kernel->size * kernel->size * sizeof (gdouble));
+
+  _kernel_matrix (kernel, tcenter, thalf, tradius, scenter, shalf, sradius,
+                  mat);
+
+  _matrix_apply (kernel->size, mat, density, check);
+
+  g_free (mat);
+}
+
+/* accumulates the field of a particle on a check surface */
+static void _particle_to_check (AranKernel3d *kernel,
+                                const VsgVector3d *position,
+                                const gdouble *charges,
+                                const VsgVector3d *center,
+                                const VsgVector3d *half, gdouble radius,
+                                gdouble *check)
+{
+  guint dim = kernel->dim;
+  gdouble values[dim * dim];
+  VsgVector3d t;
+  guint i, a, b;
+
+  for (i=0; i<kernel->npoints; i++)
+    {
+      _surface_point (kernel, i, center, half, radius, &t);
+
+      kernel->func (&t, position, values, kernel->user_data);
+
+      for (a=0; a<dim; a++)
+        for (b=0; b<dim; b++)
+          check[i*dim + a] += values[a*dim + b] * charges[b];
+    }
+}
+
+/* evaluates a surface density at a particle position */
+static void _surface_evaluate (AranKernel3d *kernel,
+                               const VsgVector3d *center,
+                               const VsgVector3d *half, gdouble radius,
+                               const gdouble *density,
+                               const VsgVector3d *pos, gdouble *result)
+{
+  guint dim = kernel->dim;
+  gdouble values[dim * dim];
+  VsgVector3d s;
+  guint j, a, b;
+
+  for (a=0; a<dim; a++)
+    result[a] = 0.;
+
+  for (j=0; j<kernel->npoints; j++)
+    {
+      _surface_point (kernel, j, center, half, radius, &s);
+
+      kernel->func (pos, &s, values, kernel->user_data);
+
+      for (a=0; a<dim; a++)
+        for (b=0; b<dim; b++)
+          result[a] += values[a*dim + b] * density[j*dim + b];
+    }
+}
+
+/* converts pending check potentials into equivalent densities */
+static void _multipole_flush (const VsgPRTree3dNodeInfo *node,
+                              AranKernelDevelopment3d *akd)
+{
+  AranKernel3d *kernel = akd->kernel;
+  VsgVector3d half;
+
+  if (!akd->multipole_pending) return;
+
+  _node_half (node, &half);
+
+  _matrix_apply (kernel->size, _up_pinv (kernel, _kernel_level (kernel, &half)),
+                 akd->multipole_check, akd->multipole);
+
+  memset (akd->multipole_check, 0, kernel->size * sizeof (gdouble));
+  akd->multipole_pending = FALSE;
+}
+
+static void _local_flush (const VsgPRTree3dNodeInfo *node,
+                          AranKernelDevelopment3d *akd)
+{
+  AranKernel3d *kernel = akd->kernel;
+  VsgVector3d half;
+
+  if (!akd->local_pending) return;
+
+  _node_half (node, &half);
+
+  _matrix_apply (kernel->size,
+                 _down_pinv (kernel, _kernel_level (kernel, &half)),
+                 akd->local_check, akd->local);
+
+  memset (akd->local_check, 0, kernel->size * sizeof (gdouble));
+  akd->local_pending = FALSE;
+}
+
+/**
+ * aran_kernel3d_new:
+ * @func: the kernel function.
+ * @dim: number of components of sources and targets.
+ * @user_data: user data passed to @func.
+ * @order: number of equivalent surface points along a node edge.
+ *
+ * Creates a new #AranKernel3d for @func. Equivalent surfaces hold
+ * 6(@order-1)^2+2 points, which drives both accuracy and cost.
+ *
+ * Returns: newly allocated #AranKernel3d.
+ */
+AranKernel3d *aran_kernel3d_new (AranKernelFunc3d func, guint dim,
+                                 gpointer user_data, guint order)
+{
+  AranKernel3d *kernel;
+  gdouble step;
+  guint i, j, k, n = 0;
+
+  g_return_val_if_fail (func != NULL, NULL);
+  g_return_val_if_fail (dim > 0, NULL);
+  g_return_val_if_fail (order >= 2, NULL);
+
+  kernel = g_malloc (sizeof (AranKernel3d));
+
+  kernel->ref_count = 1;
+  kernel->func = func;
+  kernel->dim = dim;
+  kernel->user_data = user_data;
+  kernel->order = order;
+  kernel->npoints = 6 * (order - 1) * (order - 1) + 2;
+  kernel->size = kernel->npoints * dim;
+  kernel->surface = g_malloc (kernel->npoints * sizeof (VsgVector3d));
+  kernel->levels = g_ptr_array_new ();
+
+  step = 2. / (order - 1.);
+
+  for (i=0; i<order; i++)
+    for (j=0; j<order; j++)
+      for (k=0; k<order; k++)
+        {
+          if (i != 0 && i != order-1 && j != 0 && j != order-1 &&
+              k != 0 && k != order-1)
+            continue;
+
+          vsg_vector3d_set (&kernel->surface[n],
+                            i * step - 1., j * step - 1., k * step - 1.);
+          n ++;
+        }
+
+  g_assert (n == kernel->npoints);
+
+  return kernel;
+}
+
+/**
+ * aran_kernel3d_ref:
+ * @kernel: an #AranKernel3d.
+ *
+ * Increments @kernel reference count.
+ *
+ * Returns: @kernel.
+ */
+AranKernel3d *aran_kernel3d_ref (AranKernel3d *kernel)
+{
+  g_return_val_if_fail (kernel != NULL, NULL);
+
+  kernel->ref_count ++;
+
+  return kernel;
+}
+
+/**
+ * aran_kernel3d_unref:
+ * @kernel: an #AranKernel3d.
+ *
+ * Decrements @kernel reference count and deallocates it along with its
+ * cached operators when it drops to zero.
+ */
+void aran_kernel3d_unref (AranKernel3d *kernel)
+{
+  g_return_if_fail (kernel != NULL);
+
+  kernel->ref_count --;
+
+  if (kernel->ref_count > 0) return;
+
+  aran_kernel3d_clear_cache (kernel);
+
+  g_ptr_array_free (kernel->levels, TRUE);
+  g_free (kernel->surface);
+  g_free (kernel);
+}
+
+/**
+ * aran_kernel3d_get_dim:
+ * @kernel: an #AranKernel3d.
+ *
+ * Returns: number of components of @kernel sources and targets.
+ */
+guint aran_kernel3d_get_dim (const AranKernel3d *kernel)
+{
+  g_return_val_if_fail (kernel != NULL, 0);
+
+  return kernel->dim;
+}
+
+/**
+ * aran_kernel3d_get_order:
+ * @kernel: an #AranKernel3d.
+ *
+ * Returns: number of surface points along a node edge.
+ */
+guint aran_kernel3d_get_order (const AranKernel3d *kernel)
+{
+  g_return_val_if_fail (kernel != NULL, 0);
+
+  return kernel->order;
+}
+
+/**
+ * aran_kernel3d_get_size:
+ * @kernel: an #AranKernel3d.
+ *
+ * Returns: number of coefficients of a @kernel equivalent density.
+ */
+guint aran_kernel3d_get_size (const AranKernel3d *kernel)
+{
+  g_return_val_if_fail (kernel != NULL, 0);
+
+  return kernel->size;
+}
+
+/**
+ * aran_kernel3d_clear_cache:
+ * @kernel: an #AranKernel3d.
+ *
+ * Frees all operators cached by @kernel. This is needed when @kernel
+ * function parameters change between two solves. Developments of
+ * @kernel must not hold pending check potentials, which is the case
+ * after aran_kernel_development3d_set_zero().
+ */
+void aran_kernel3d_clear_cache (AranKernel3d *kernel)
+{
+  guint i;
+
+  g_return_if_fail (kernel != NULL);
+
+  for (i=0; i<kernel->levels->len; i++)
+    _kernel_level_free (g_ptr_array_index (kernel->levels, i));
+
+  g_ptr_array_set_size (kernel->levels, 0);
+}
+
+GType aran_kernel_development3d_get_type ()
+{
+  static GType devtype = G_TYPE_NONE;
+
+  if (G_UNLIKELY (devtype == G_TYPE_NONE))
+    {
+      devtype =
+	g_boxed_type_register_static ("AranKernelDevelopment3d",
+				      (GBoxedCopyFunc)
+                                      aran_kernel_development3d_clone,
+				      (GBoxedFreeFunc)
+                                      aran_kernel_development3d_free);
+    }
+
+  return devtype;
+}
+
+/**
+ * aran_kernel_development3d_new:
+ * @kernel: an #AranKernel3d.
+ *
+ * Allocates a new #AranKernelDevelopment3d for @kernel. Coefficients
+ * are set to zero.
+ *
+ * Returns: newly allocated structure.
+ */
+AranKernelDevelopment3d *aran_kernel_development3d_new (AranKernel3d *kernel)
+{
+  AranKernelDevelopment3d *result;
+  guint size;
+
+  g_return_val_if_fail (kernel != NULL, NULL);
+
+  size = kernel->size;
+
+  result = g_malloc (sizeof (AranKernelDevelopment3d));
+
+  result->kernel = aran_kernel3d_ref (kernel);
+
+  /* one block for all coefficients */
+  result->multipole = g_malloc0 (4 * size * sizeof (gdouble));
+  result->local = result->multipole + size;
+  result->multipole_check = result->local + size;
+  result->local_check = result->multipole_check + size;
+
+  result->multipole_pending = FALSE;
+  result->local_pending = FALSE;
+
+  return result;
+}
+
+/**
+ * aran_kernel_development3d_free:
+ * @akd: an #AranKernelDevelopment3d.
+ *
+ * Deallocates @akd and all associated memory.
+ */
+void aran_kernel_development3d_free (AranKernelDevelopment3d *akd)
+{
+  g_return_if_fail (akd != NULL);
+
+  aran_kernel3d_unref (akd->kernel);
+
+  g_free (akd->multipole);
+  g_free (akd);
+}
+
+/**
+ * aran_kernel_development3d_copy:
+ * @src: an #AranKernelDevelopment3d.
+ * @dst: an #AranKernelDevelopment3d.
+ *
+ * Copies @src into @dst. Both developments must share the same kernel
+ * size.
+ */
+void aran_kernel_development3d_copy (const AranKernelDevelopment3d *src,
+                                     AranKernelDevelopment3d *dst)
+{
+  g_return_if_fail (src != NULL);
+  g_return_if_fail (dst != NULL);
+  g_return_if_fail (src->kernel->size == dst->kernel->size);
+
+  memcpy (dst->multipole, src->multipole,
+          4 * src->kernel->size * sizeof (gdouble));
+
+  dst->multipole_pending = src->multipole_pending;
+  dst->local_pending = src->local_pending;
+}
+
+/**
+ * aran_kernel_development3d_clone:
+ * @src: an #AranKernelDevelopment3d.
+ *
+ * Duplicates @src.
+ *
+ * Returns: newly allocated copy of @src.
+ */
+AranKernelDevelopment3d *
+aran_kernel_development3d_clone (AranKernelDevelopment3d *src)
+{
+  AranKernelDevelopment3d *dst;
+
+  g_return_val_if_fail (src != NULL, NULL);
+
+  dst = aran_kernel_development3d_new (src->kernel);
+
+  aran_kernel_development3d_copy (src, dst);
+
+  return dst;
+}
+
+/**
+ * aran_kernel_development3d_set_zero:
+ * @akd: an #AranKernelDevelopment3d.
+ *
+ * Sets all @akd coefficients to zero.
+ */
+void aran_kernel_development3d_set_zero (AranKernelDevelopment3d *akd)
+{
+  g_return_if_fail (akd != NULL);
+
+  memset (akd->multipole, 0, 4 * akd->kernel->size * sizeof (gdouble));
+
+  akd->multipole_pending = FALSE;
+  akd->local_pending = FALSE;
+}
+
+/**
+ * aran_kernel_development3d_get_kernel:
+ * @akd: an #AranKernelDevelopment3d.
+ *
+ * Returns: the #AranKernel3d of @akd.
+ */
+AranKernel3d *
+aran_kernel_development3d_get_kernel (const AranKernelDevelopment3d *akd)
+{
+  g_return_val_if_fail (akd != NULL, NULL);
+
+  return akd->kernel;
+}
+
+static void _write_coefficients (const gchar *name, guint size,
+                                 const gdouble *coefs, FILE *file)
+{
+  guint i;
+
+  fprintf (file, "%s [", name);
+
+  for (i=0; i<size; i++)
+    fprintf (file, "%s%g", (i == 0) ? "" : ", ", coefs[i]);
+
+  fprintf (file, "]\n");
+}
+
+/**
+ * aran_kernel_development3d_write:
+ * @akd: an #AranKernelDevelopment3d.
+ * @file: a #FILE.
+ *
+ * Writes @akd to @file.
+ */
+void aran_kernel_development3d_write (AranKernelDevelopment3d *akd,
+                                      FILE *file)
+{
+  guint size;
+
+  g_return_if_fail (akd != NULL);
+
+  size = akd->kernel->size;
+
+  _write_coefficients ("multipole", size, akd->multipole, file);
+  _write_coefficients ("local", size, akd->local, file);
+
+  if (akd->multipole_pending)
+    _write_coefficients ("multipole check", size, akd->multipole_check, file);
+
+  if (akd->local_pending)
+    _write_coefficients ("local check", size, akd->local_check, file);
+}
+
+/**
+ * aran_kernel_development3d_p2m:
+ * @position: particle position.
+ * @charges: particle charges (kernel dim components).
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranKernelDevelopment3d.
+ *
+ * Adds the contribution of a particle to the multipole part of @dst.
+ */
+void aran_kernel_development3d_p2m (const VsgVector3d *position,
+                                    const gdouble *charges,
+                                    const VsgPRTree3dNodeInfo *dst_node,
+                                    AranKernelDevelopment3d *dst)
+{
+  VsgVector3d half;
+
+  _node_half (dst_node, &half);
+
+  _particle_to_check (dst->kernel, position, charges, &dst_node->center,
+                      &half, _OUTER, dst->multipole_check);
+
+  dst->multipole_pending = TRUE;
+}
+
+/**
+ * aran_kernel_development3d_p2l:
+ * @position: particle position.
+ * @charges: particle charges (kernel dim components).
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranKernelDevelopment3d.
+ *
+ * Adds the contribution of a far particle to the local part of @dst.
+ */
+void aran_kernel_development3d_p2l (const VsgVector3d *position,
+                                    const gdouble *charges,
+                                    const VsgPRTree3dNodeInfo *dst_node,
+                                    AranKernelDevelopment3d *dst)
+{
+  VsgVector3d half;
+
+  _node_half (dst_node, &half);
+
+  _particle_to_check (dst->kernel, position, charges, &dst_node->center,
+                      &half, _INNER, dst->local_check);
+
+  dst->local_pending = TRUE;
+}
+
+/**
+ * aran_kernel_development3d_m2m:
+ * @src_node: tree node info of @src.
+ * @src: an #AranKernelDevelopment3d.
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranKernelDevelopment3d.
+ *
+ * Translates the multipole part of @src (a child of @dst_node) into the
+ * multipole part of @dst.
+ */
+void aran_kernel_development3d_m2m (const VsgPRTree3dNodeInfo *src_node,
+                                    AranKernelDevelopment3d *src,
+                                    const VsgPRTree3dNodeInfo *dst_node,
+                                    AranKernelDevelopment3d *dst)
+{
+  AranKernel3d *kernel = src->kernel;
+  VsgVector3d shalf, dhalf;
+  gint octant;
+
+  _multipole_flush (src_node, src);
+
+  _node_half (src_node, &shalf);
+  _node_half (dst_node, &dhalf);
+
+  octant = _child_octant (src_node, &shalf, dst_node, &dhalf);
+
+  if (octant >= 0)
+    _matrix_apply (kernel->size,
+                   _m2m_operator (kernel, _kernel_level (kernel, &shalf),
+                                  octant),
+                   src->multipole, dst->multipole_check);
+  else
+    _surface_to_check (kernel, &src_node->center, &shalf, _INNER,
+                       src->multipole, &dst_node->center, &dhalf, _OUTER,
+                       dst->multipole_check);
+
+  dst->multipole_pending = TRUE;
+}
+
+/**
+ * aran_kernel_development3d_m2l:
+ * @src_node: tree node info of @src.
+ * @src: an #AranKernelDevelopment3d.
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranKernelDevelopment3d.
+ *
+ * Translates the multipole part of @src into the local part of @dst.
+ * Operators between same level nodes are cached for each relative
+ * position.
+ */
+void aran_kernel_development3d_m2l (const VsgPRTree3dNodeInfo *src_node,
+                                    AranKernelDevelopment3d *src,
+                                    const VsgPRTree3dNodeInfo *dst_node,
+                                    AranKernelDevelopment3d *dst)
+{
+  AranKernel3d *kernel = src->kernel;
+  VsgVector3d shalf, dhalf;
+  gint index;
+
+  _multipole_flush (src_node, src);
+
+  _node_half (src_node, &shalf);
+  _node_half (dst_node, &dhalf);
+
+  index = _m2l_index (src_node, &shalf, dst_node, &dhalf);
+
+  if (index >= 0)
+    _matrix_apply (kernel->size,
+                   _m2l_operator (kernel, _kernel_level (kernel, &dhalf),
+                                  index),
+                   src->multipole, dst->local_check);
+  else
+    _surface_to_check (kernel, &src_node->center, &shalf, _INNER,
+                       src->multipole, &dst_node->center, &dhalf, _INNER,
+                       dst->local_check);
+
+  dst->local_pending = TRUE;
+}
+
+/**
+ * aran_kernel_development3d_l2l:
+ * @src_node: tree node info of @src.
+ * @src: an #AranKernelDevelopment3d.
+ * @dst_node: tree node info of @dst.
+ * @dst: an #AranKernelDevelopment3d.
+ *
+ * Translates the local part of @src into the local part of @dst (a
+ * child of @src_node).
+ */
+void aran_kernel_development3d_l2l (const VsgPRTree3dNodeInfo *src_node,
+                                    AranKernelDevelopment3d *src,
+                                    const VsgPRTree3dNodeInfo *dst_node,
+                                    AranKernelDevelopment3d *dst)
+{
+  AranKernel3d *kernel = src->kernel;
+  VsgVector3d shalf, dhalf;
+  gint octant;
+
+  _local_flush (src_node, src);
+
+  _node_half (src_node, &shalf);
+  _node_half (dst_node, &dhalf);
+
+  octant = _child_octant (dst_node, &dhalf, src_node, &shalf);
+
+  if (octant >= 0)
+    _matrix_apply (kernel->size,
+                   _l2l_operator (kernel, _kernel_level (kernel, &dhalf),
+                                  octant),
+                   src->local, dst->local_check);
+  else
+    _surface_to_check (kernel, &src_node->center, &shalf, _OUTER,
+                       src->local, &dst_node->center, &dhalf, _INNER,
+                       dst->local_check);
+
+  dst->local_pending = TRUE;
+}
+
+/**
+ * aran_kernel_development3d_m2p:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranKernelDevelopment3d.
+ * @pos: evaluation position.
+ * @values: result values (kernel dim components).
+ *
+ * Evaluates the multipole part of @devel at @pos.
+ */
+void aran_kernel_development3d_m2p (const VsgPRTree3dNodeInfo *devel_node,
+                                    AranKernelDevelopment3d *devel,
+                                    const VsgVector3d *pos,
+                                    gdouble *values)
+{
+  VsgVector3d half;
+
+  _multipole_flush (devel_node, devel);
+
+  _node_half (devel_node, &half);
+
+  _surface_evaluate (devel->kernel, &devel_node->center, &half, _INNER,
+                     devel->multipole, pos, values);
+}
+
+/**
+ * aran_kernel_development3d_l2p:
+ * @devel_node: tree node info of @devel.
+ * @devel: an #AranKernelDevelopment3d.
+ * @pos: evaluation position.
+ * @values: result values (kernel dim components).
+ *
+ * Evaluates the local part of @devel at @pos.
+ */
+void aran_kernel_development3d_l2p (const VsgPRTree3dNodeInfo *devel_node,
+                                    AranKernelDevelopment3d *devel,
+                                    const VsgVector3d *pos,
+                                    gdouble *values)
+{
+  VsgVector3d half;
+
+  _local_flush (devel_node, devel);
+
+  _node_half (devel_node, &half);
+
+  _surface_evaluate (devel->kernel, &devel_node->center, &half, _OUTER,
+                     devel->local, pos, values);
+}
+
+#ifdef VSG_HAVE_MPI
+
+/* pending check potentials are sent along with equivalent densities,
+ * zero arrays (typically densities of remote copies) are skipped */
+#define _DENSITY_FLAG (1<<0)
+#define _CHECK_FLAG (1<<1)
+
+static void _coefficients_pack (guint size, gdouble *density, gdouble *check,
+                                gboolean pending, VsgPackedMsg *pm)
+{
+  gint flag = pending ? _CHECK_FLAG : 0;
+  guint k;
+
+  for (k = 0; k < size; k++)
+    {
+      if (density[k] != 0.)
+        {
+          flag |= _DENSITY_FLAG;
+          break;
+        }
+    }
+
+  vsg_packed_msg_send_append (pm, &flag, 1, MPI_INT);
+
+  if (flag & _DENSITY_FLAG)
+    vsg_packed_msg_send_append (pm, density, size, MPI_DOUBLE);
+
+  if (flag & _CHECK_FLAG)
+    vsg_packed_msg_send_append (pm, check, size, MPI_DOUBLE);
+}
+
+static void _coefficients_unpack (guint size, gdouble *density,
+                                  gdouble *check, gboolean *pending,
+                                  VsgPackedMsg *pm)
+{
+  gint flag;
+
+  vsg_packed_msg_recv_read (pm, &flag, 1, MPI_INT);
+
+  if (flag & _DENSITY_FLAG)
+    vsg_packed_msg_recv_read (pm, density, size, MPI_DOUBLE);
+  else
+    memset (density, 0, size * sizeof (gdouble));
+
+  if (flag & _CHECK_FLAG)
+    vsg_packed_msg_recv_read (pm, check, size, MPI_DOUBLE);
+  else
+    memset (check, 0, size * sizeof (gdouble));
+
+  *pending = (flag & _CHECK_FLAG) != 0;
+}
+
+static void _coefficients_reduce (guint size, const gdouble *adensity,
+                                  const gdouble *acheck, gboolean apending,
+                                  gdouble *bdensity, gdouble *bcheck,
+                                  gboolean *bpending)
+{
+  guint k;
+
+  for (k = 0; k < size; k++)
+    bdensity[k] += adensity[k];
+
+  if (!apending) return;
+
+  for (k = 0; k < size; k++)
+    bcheck[k] += acheck[k];
+
+  *bpending = TRUE;
+}
+
+void aran_kernel_development3d_vtable_init (VsgParallelVTable *vtable,
+                                            AranKernel3d *kernel)
+{
+  vtable->alloc =
+    (VsgMigrableAllocDataFunc) aran_kernel_development3d_alloc;
+  vtable->alloc_data = aran_kernel_development3d_new (kernel);
+
+  vtable->destroy = aran_kernel_development3d_destroy;
+  vtable->destroy_data = NULL;
+
+  vtable->migrate.pack =
+    (VsgMigrablePackDataFunc) aran_kernel_development3d_migrate_pack;
+  vtable->migrate.pack_data = NULL;
+
+  vtable->migrate.unpack =
+    (VsgMigrablePackDataFunc) aran_kernel_development3d_migrate_unpack;
+  vtable->migrate.unpack_data = NULL;
+
+  vtable->visit_forward.pack =
+    (VsgMigrablePackDataFunc) aran_kernel_development3d_visit_fw_pack;
+  vtable->visit_forward.pack_data = NULL;
+
+  vtable->visit_forward.unpack =
+    (VsgMigrablePackDataFunc) aran_kernel_development3d_visit_fw_unpack;
+  vtable->visit_forward.unpack_data = NULL;
+
+  vtable->visit_forward.reduce =
+    (VsgMigrableReductionDataFunc) aran_kernel_development3d_visit_fw_reduce;
+  vtable->visit_forward.reduce_data = NULL;
+
+  vtable->visit_backward.pack =
+    (VsgMigrablePackDataFunc) aran_kernel_development3d_visit_bw_pack;
+  vtable->visit_backward.pack_data = NULL;
+
+  vtable->visit_backward.unpack =
+    (VsgMigrablePackDataFunc) aran_kernel_development3d_visit_bw_unpack;
+  vtable->visit_backward.unpack_data = NULL;
+
+  vtable->visit_backward.reduce =
+    (VsgMigrableReductionDataFunc) aran_kernel_development3d_visit_bw_reduce;
+  vtable->visit_backward.reduce_data = NULL;
+}
+
+void aran_kernel_development3d_vtable_clear (VsgParallelVTable *vtable)
+{
+  g_return_if_fail (vtable != NULL);
+  g_return_if_fail (vtable->alloc_data != NULL);
+
+  aran_kernel_development3d_free (vtable->alloc_data);
+}
+
+/**
+ * aran_kernel_development3d_alloc:
+ * @resident: unused.
+ * @src: an example #AranKernelDevelopment3d to copy from.
+ *
+ * Allocates a new #AranKernelDevelopment3d by clonig @src.
+ *
+ * Returns: a copy of @src.
+ */
+gpointer aran_kernel_development3d_alloc (gboolean resident,
+                                          AranKernelDevelopment3d *src)
+{
+  return g_boxed_copy (ARAN_TYPE_KERNEL_DEVELOPMENT3D, src);
+}
+
+/**
+ * aran_kernel_development3d_destroy:
+ * @data: A #AranKernelDevelopment3d.
+ * @resident: unused.
+ * @user_data: unused.
+ *
+ * Deletes @data from memory.
+ */
+void aran_kernel_development3d_destroy (gpointer data, gboolean resident,
+                                        gpointer user_data)
+{
+  g_assert (data != NULL);
+  g_boxed_free (ARAN_TYPE_KERNEL_DEVELOPMENT3D, data);
+}
+
+/**
+ * aran_kernel_development3d_migrate_pack:
+ * @devel: an #AranKernelDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs complete packing of @devel into @pm for a migration
+ * between processors.
+ */
+void
+aran_kernel_development3d_migrate_pack (AranKernelDevelopment3d *devel,
+                                        VsgPackedMsg *pm,
+                                        gpointer user_data)
+{
+  guint size = devel->kernel->size;
+
+  _coefficients_pack (size, devel->multipole, devel->multipole_check,
+                      devel->multipole_pending, pm);
+  _coefficients_pack (size, devel->local, devel->local_check,
+                      devel->local_pending, pm);
+}
+
+/**
+ * aran_kernel_development3d_migrate_unpack:
+ * @devel: an #AranKernelDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm in a migration between processors and
+ * stores it in @devel.
+ */
+void
+aran_kernel_development3d_migrate_unpack (AranKernelDevelopment3d *devel,
+                                          VsgPackedMsg *pm,
+                                          gpointer user_data)
+{
+  guint size = devel->kernel->size;
+
+  _coefficients_unpack (size, devel->multipole, devel->multipole_check,
+                        &devel->multipole_pending, pm);
+  _coefficients_unpack (size, devel->local, devel->local_check,
+                        &devel->local_pending, pm);
+}
+
+/**
+ * aran_kernel_development3d_visit_fw_pack:
+ * @devel: an #AranKernelDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs packing of @devel into @pm for a near/far forward visit
+ * of a local node to another processor.
+ */
+void
+aran_kernel_development3d_visit_fw_pack (AranKernelDevelopment3d *devel,
+                                         VsgPackedMsg *pm,
+                                         gpointer user_data)
+{
+  _coefficients_pack (devel->kernel->size, devel->multipole,
+                      devel->multipole_check, devel->multipole_pending, pm);
+}
+
+/**
+ * aran_kernel_development3d_visit_fw_unpack:
+ * @devel: an #AranKernelDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm for a near/far forward visit of a
+ * remote node.
+ */
+void
+aran_kernel_development3d_visit_fw_unpack (AranKernelDevelopment3d *devel,
+                                           VsgPackedMsg *pm,
+                                           gpointer user_data)
+{
+  _coefficients_unpack (devel->kernel->size, devel->multipole,
+                        devel->multipole_check, &devel->multipole_pending,
+                        pm);
+}
+
+/**
+ * aran_kernel_development3d_visit_fw_reduce:
+ * @a: source #AranKernelDevelopment3d.
+ * @b: destination #AranKernelDevelopment3d.
+ * @user_data: unused.
+ *
+ * Forward visit reduction operator for #AranKernelDevelopment3d.
+ */
+void
+aran_kernel_development3d_visit_fw_reduce (AranKernelDevelopment3d *a,
+                                           AranKernelDevelopment3d *b,
+                                           gpointer user_data)
+{
+  _coefficients_reduce (b->kernel->size, a->multipole, a->multipole_check,
+                        a->multipole_pending, b->multipole,
+                        b->multipole_check, &b->multipole_pending);
+}
+
+/**
+ * aran_kernel_development3d_visit_bw_pack:
+ * @devel: an #AranKernelDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Performs packing of @devel into @pm for a near/far backward visit
+ * of a remote node to its original processor.
+ */
+void
+aran_kernel_development3d_visit_bw_pack (AranKernelDevelopment3d *devel,
+                                         VsgPackedMsg *pm,
+                                         gpointer user_data)
+{
+  _coefficients_pack (devel->kernel->size, devel->local, devel->local_check,
+                      devel->local_pending, pm);
+}
+
+/**
+ * aran_kernel_development3d_visit_bw_unpack:
+ * @devel: an #AranKernelDevelopment3d.
+ * @pm: a #VsgPackedMsg.
+ * @user_data: unused.
+ *
+ * Unpacks information from @pm for a near/far backward visit of a
+ * remote node.
+ */
+void
+aran_kernel_development3d_visit_bw_unpack (AranKernelDevelopment3d *devel,
+                                           VsgPackedMsg *pm,
+                                           gpointer user_data)
+{
+  _coefficients_unpack (devel->kernel->size, devel->local,
+                        devel->local_check, &devel->local_pending, pm);
+}
+
+/**
+ * aran_kernel_development3d_visit_bw_reduce:
+ * @a: source #AranKernelDevelopment3d.
+ * @b: destination #AranKernelDevelopment3d.
+ * @user_data: unused.
+ *
+ * Backward visit reduction operator for #AranKernelDevelopment3d.
+ */
+void
+aran_kernel_development3d_visit_bw_reduce (AranKernelDevelopment3d *a,
+                                           AranKernelDevelopment3d *b,
+                                           gpointer user_data)
+{
+  _coefficients_reduce (b->kernel->size, a->local, a->local_check,
+                        a->local_pending, b->local, b->local_check,
+                        &b->local_pending);
+}
+
+#endif /* VSG_HAVE_MPI */
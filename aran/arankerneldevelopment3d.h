@@ -0,0 +1,180 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __ARAN_KERNEL_DEVELOPMENT3D_H__
+#define __ARAN_KERNEL_DEVELOPMENT3D_H__
+
+#include <glib-object.h>
+
+#include <vsg/vsgd.h>
+#ifdef VSG_HAVE_MPI
+#include <vsg/vsgpackedmsg.h>
+#endif
+
+G_BEGIN_DECLS;
+
+/* macros */
+#define ARAN_TYPE_KERNEL_DEVELOPMENT3D (aran_kernel_development3d_get_type ())
+
+/* typedefs */
+
+typedef void (*AranKernelFunc3d) (const VsgVector3d *target,
+                                  const VsgVector3d *source,
+                                  gdouble *values,
+                                  gpointer user_data);
+
+typedef struct _AranKernel3d AranKernel3d;
+
+typedef struct _AranKernelDevelopment3d AranKernelDevelopment3d;
+
+struct _AranKernelDevelopment3d
+{
+  AranKernel3d *kernel;
+
+  gdouble *multipole;
+  gdouble *local;
+
+  gdouble *multipole_check;
+  gdouble *local_check;
+
+  gboolean multipole_pending;
+  gboolean local_pending;
+};
+
+/* functions */
+AranKernel3d *aran_kernel3d_new (AranKernelFunc3d func, guint dim,
+                                 gpointer user_data, guint order);
+
+AranKernel3d *aran_kernel3d_ref (AranKernel3d *kernel);
+
+void aran_kernel3d_unref (AranKernel3d *kernel);
+
+guint aran_kernel3d_get_dim (const AranKernel3d *kernel);
+
+guint aran_kernel3d_get_order (const AranKernel3d *kernel);
+
+guint aran_kernel3d_get_size (const AranKernel3d *kernel);
+
+void aran_kernel3d_clear_cache (AranKernel3d *kernel);
+
+GType aran_kernel_development3d_get_type ();
+
+AranKernelDevelopment3d *aran_kernel_development3d_new (AranKernel3d *kernel);
+
+void aran_kernel_development3d_free (AranKernelDevelopment3d *akd);
+
+void aran_kernel_development3d_copy (const AranKernelDevelopment3d *src,
+                                     AranKernelDevelopment3d *dst);
+
+AranKernelDevelopment3d *
+aran_kernel_development3d_clone (AranKernelDevelopment3d *src);
+
+void aran_kernel_development3d_set_zero (AranKernelDevelopment3d *akd);
+
+AranKernel3d *
+aran_kernel_development3d_get_kernel (const AranKernelDevelopment3d *akd);
+
+void aran_kernel_development3d_write (AranKernelDevelopment3d *akd,
+                                      FILE *file);
+
+void aran_kernel_development3d_p2m (const VsgVector3d *position,
+                                    const gdouble *charges,
+                                    const VsgPRTree3dNodeInfo *dst_node,
+                                    AranKernelDevelopment3d *dst);
+
+void aran_kernel_development3d_p2l (const VsgVector3d *position,
+                                    const gdouble *charges,
+                                    const VsgPRTree3dNodeInfo *dst_node,
+                                    AranKernelDevelopment3d *dst);
+
+void aran_kernel_development3d_m2m (const VsgPRTree3dNodeInfo *src_node,
+                                    AranKernelDevelopment3d *src,
+                                    const VsgPRTree3dNodeInfo *dst_node,
+                                    AranKernelDevelopment3d *dst);
+
+void aran_kernel_development3d_m2l (const VsgPRTree3dNodeInfo *src_node,
+                                    AranKernelDevelopment3d *src,
+                                    const VsgPRTree3dNodeInfo *dst_node,
+                                    AranKernelDevelopment3d *dst);
+
+void aran_kernel_development3d_l2l (const VsgPRTree3dNodeInfo *src_node,
+                                    AranKernelDevelopment3d *src,
+                                    const VsgPRTree3dNodeInfo *dst_node,
+                                    AranKernelDevelopment3d *dst);
+
+void aran_kernel_development3d_m2p (const VsgPRTree3dNodeInfo *devel_node,
+                                    AranKernelDevelopment3d *devel,
+                                    const VsgVector3d *pos,
+                                    gdouble *values);
+
+void aran_kernel_development3d_l2p (const VsgPRTree3dNodeInfo *devel_node,
+                                    AranKernelDevelopment3d *devel,
+                                    const VsgVector3d *pos,
+                                    gdouble *values);
+
+#ifdef VSG_HAVE_MPI
+
+void aran_kernel_development3d_vtable_init (VsgParallelVTable *vtable,
+                                            AranKernel3d *kernel);
+
+void aran_kernel_development3d_vtable_clear (VsgParallelVTable *vtable);
+
+gpointer aran_kernel_development3d_alloc (gboolean resident,
+                                          AranKernelDevelopment3d *src);
+
+void aran_kernel_development3d_destroy (gpointer data, gboolean resident,
+                                        gpointer user_data);
+
+void aran_kernel_development3d_migrate_pack (AranKernelDevelopment3d *devel,
+                                             VsgPackedMsg *pm,
+                                             gpointer user_data);
+
+void aran_kernel_development3d_migrate_unpack (AranKernelDevelopment3d *devel,
+                                               VsgPackedMsg *pm,
+                                               gpointer user_data);
+
+void aran_kernel_development3d_visit_fw_pack (AranKernelDevelopment3d *devel,
+                                              VsgPackedMsg *pm,
+                                              gpointer user_data);
+
+void aran_kernel_development3d_visit_fw_unpack (AranKernelDevelopment3d *devel,
+                                                VsgPackedMsg *pm,
+                                                gpointer user_data);
+
+void aran_kernel_development3d_visit_fw_reduce (AranKernelDevelopment3d *a,
+                                                AranKernelDevelopment3d *b,
+                                                gpointer user_data);
+
+void aran_kernel_development3d_visit_bw_pack (AranKernelDevelopment3d *devel,
+                                              VsgPackedMsg *pm,
+                                              gpointer user_data);
+
+void aran_kernel_development3d_visit_bw_unpack (AranKernelDevelopment3d *devel,
+                                                VsgPackedMsg *pm,
+                                                gpointer user_data);
+
+void aran_kernel_development3d_visit_bw_reduce (AranKernelDevelopment3d *a,
+                                                AranKernelDevelopment3d *b,
+                                                gpointer user_data);
+
+#endif /* VSG_HAVE_MPI */
+
+G_END_DECLS;
+
+#endif /* __ARAN_KERNEL_DEVELOPMENT3D_H__ */
@@ -22,6 +22,7 @@
 #include "aranbinomial.h"
 
 #include <string.h>
+#include <math.h>
 
 /**
  * AranLaurentSeriesd:
@@ -90,6 +91,84 @@ void aran_laurent_seriesd_unpack (AranLaurentSeriesd *als, VsgPackedMsg *pm)
                             ARAN_MPI_TYPE_GCOMPLEX128);
 }
 
+static inline gdouble _term_abs (const gcomplex128 *z)
+{
+  return MAX (fabs (creal (*z)), fabs (cimag (*z)));
+}
+
+/**
+ * aran_laurent_seriesd_pack_compressed:
+ * @als: an #AranLaurentSeriesd.
+ * @pm: a #VsgPackedMsg.
+ * @compression: wire format parameters.
+ *
+ * Packs @als into @pm, leaving out the trailing degrees (positive and
+ * negative) whose coefficients are smaller than @compression->epsilon times
+ * the largest coefficient of @als. A zero series is reduced to its header.
+ */
+void aran_laurent_seriesd_pack_compressed (AranLaurentSeriesd *als,
+                                           VsgPackedMsg *pm,
+                                           const AranPackCompression *
+                                           compression)
+{
+  gdouble maxabs = 0., thr;
+  gint header[3];
+  gint i;
+
+  for (i=-als->negdeg; i<=als->posdeg; i ++)
+    maxabs = MAX (maxabs, _term_abs (ARAN_LAURENT_SERIESD_TERM (als, i)));
+
+  thr = compression->epsilon * maxabs;
+
+  /* kept degrees: header[1]-1 down to -header[2] */
+  header[0] = compression->single;
+  header[1] = als->posdeg + 1;
+  while (header[1] > 0 &&
+         _term_abs (ARAN_LAURENT_SERIESD_TERM (als, header[1]-1)) <= thr)
+    header[1] --;
+
+  header[2] = als->negdeg;
+  while (header[2] > 0 &&
+         _term_abs (ARAN_LAURENT_SERIESD_TERM (als, -header[2])) <= thr)
+    header[2] --;
+
+  vsg_packed_msg_send_append (pm, header, 3, MPI_INT);
+
+  /* terms are stored from highest to lowest degree */
+  if (header[1] + header[2] > 0)
+    aran_gcomplex128_pack_array (pm,
+                                 ARAN_LAURENT_SERIESD_TERM (als,
+                                                            header[1]-1),
+                                 header[1] + header[2], header[0]);
+}
+
+/**
+ * aran_laurent_seriesd_unpack_compressed:
+ * @als: an #AranLaurentSeriesd.
+ * @pm: a #VsgPackedMsg.
+ *
+ * Unpacks a series packed by aran_laurent_seriesd_pack_compressed(). Left
+ * out coefficients are set to zero.
+ */
+void aran_laurent_seriesd_unpack_compressed (AranLaurentSeriesd *als,
+                                             VsgPackedMsg *pm)
+{
+  gint header[3];
+
+  vsg_packed_msg_recv_read (pm, header, 3, MPI_INT);
+
+  g_return_if_fail (header[1] <= als->posdeg + 1);
+  g_return_if_fail (header[2] <= als->negdeg);
+
+  aran_laurent_seriesd_set_zero (als);
+
+  if (header[1] + header[2] > 0)
+    aran_gcomplex128_unpack_array (pm,
+                                   ARAN_LAURENT_SERIESD_TERM (als,
+                                                              header[1]-1),
+                                   header[1] + header[2], header[0]);
+}
+
 #endif
 
 /**
@@ -451,3 +530,187 @@ void aran_laurent_seriesd_to_taylor (AranLaurentSeriesd *src,
     }
 }
  
+
+/* shifts the Taylor part of @src by @h in coefficients scaled by powers
+ * of @h: the binomial sums become Pascal triangle additions. */
+static inline
+void aran_taylor_translate_scaled (AranLaurentSeriesd *src,
+                                   AranLaurentSeriesd *dst,
+                                   gcomplex128 h)
+{
+  gint16 n = src->posdeg;
+  gint16 m = MIN (n, dst->posdeg);
+  gcomplex128 work[n+1];
+  gcomplex128 *srcterm, *dstterm;
+  gcomplex128 pow;
+  gint16 i, j;
+
+  if (src->posdeg > dst->posdeg)
+    g_warning ("could loose precision in \"%s\"\n", __PRETTY_FUNCTION__);
+
+  srcterm = ARAN_LAURENT_SERIESD_TERM (src, 0);
+  pow = 1.;
+  for (j=0; j<=n; j ++)
+    {
+      work[j] = *srcterm * pow;
+      pow *= h;
+      srcterm --;
+    }
+
+  for (i=0; i<MIN (n, m+1); i ++)
+    for (j=n-1; j>=i; j --)
+      work[j] += work[j+1];
+
+  dstterm = ARAN_LAURENT_SERIESD_TERM (dst, 0);
+  pow = 1.;
+  h = 1. / h;
+  for (i=0; i<=m; i ++)
+    {
+      *dstterm += work[i] * pow;
+      pow *= h;
+      dstterm --;
+    }
+}
+
+/**
+ * aran_laurent_seriesd_translate_scaled:
+ * @src: an #AranLaurentSeriesd.
+ * @zsrc: @src center.
+ * @dst: an #AranLaurentSeriesd.
+ * @zdst: @dst center.
+ *
+ * Computes the translation of @src to @zdst and accumulates it into
+ * @dst. Same as aran_laurent_seriesd_translate(), except terms are
+ * scaled by powers of @zdst-@zsrc so that the binomial sums reduce to
+ * Pascal triangle additions (no binomial lookup nor complex product in
+ * inner loops). This is significantly faster for high degrees.
+ */
+void aran_laurent_seriesd_translate_scaled (AranLaurentSeriesd *src,
+                                            gcomplex128 zsrc,
+                                            AranLaurentSeriesd *dst,
+                                            gcomplex128 zdst)
+{
+  gcomplex128 zd_m_zs = zdst-zsrc;
+
+  g_return_if_fail (src != NULL);
+  g_return_if_fail (dst != NULL);
+
+  if (zd_m_zs == 0.)
+    {
+      aran_laurent_seriesd_translate (src, zsrc, dst, zdst);
+      return;
+    }
+
+  aran_taylor_translate_scaled (src, dst, zd_m_zs);
+
+  if (src->negdeg > 0 && dst->negdeg > 0)
+    {
+      gint16 n = dst->negdeg;
+      gint16 k = MIN (src->negdeg, n);
+      gcomplex128 zs_m_zd = -zd_m_zs;
+      gcomplex128 inv = 1. / zs_m_zd;
+      gcomplex128 work[n];
+      gcomplex128 *srcterm, *dstterm;
+      gcomplex128 pow;
+      gint16 i, j;
+
+      if (src->negdeg > dst->negdeg)
+	g_warning ("could loose precision in \"%s\"\n", __PRETTY_FUNCTION__);
+
+      /* work[j] = src[-(j+1)] / (zs-zd)^(j+1) */
+      srcterm = ARAN_LAURENT_SERIESD_TERM (src, -1);
+      pow = inv;
+      for (j=0; j<k; j ++)
+        {
+          work[j] = *srcterm * pow;
+          pow *= inv;
+          srcterm ++;
+        }
+      for (j=k; j<n; j ++)
+        work[j] = 0.;
+
+      /* work[i] = sum_j binomial (i, j) work[j] */
+      for (i=1; i<n; i ++)
+        for (j=n-1; j>=i; j --)
+          work[j] += work[j-1];
+
+      dstterm = ARAN_LAURENT_SERIESD_TERM (dst, -1);
+      pow = zs_m_zd;
+      for (i=0; i<n; i ++)
+        {
+          *dstterm += work[i] * pow;
+          pow *= zs_m_zd;
+          dstterm ++;
+        }
+    }
+}
+
+/**
+ * aran_laurent_seriesd_to_taylor_scaled:
+ * @src: an #AranLaurentSeriesd.
+ * @zsrc: @src center.
+ * @dst: an #AranLaurentSeriesd.
+ * @zdst: @dst center.
+ *
+ * Computes the transformation of @src to a Taylor series at @zdst and
+ * accumulates it into @dst. Same as aran_laurent_seriesd_to_taylor(),
+ * with terms scaled by powers of @zdst-@zsrc: the transformation then
+ * reduces to a Horner scheme of prefix sums.
+ */
+void aran_laurent_seriesd_to_taylor_scaled (AranLaurentSeriesd *src,
+                                            gcomplex128 zsrc,
+                                            AranLaurentSeriesd *dst,
+                                            gcomplex128 zdst)
+{
+  gcomplex128 zd_m_zs = zdst-zsrc;
+
+  g_return_if_fail (src != NULL);
+  g_return_if_fail (dst != NULL);
+  g_return_if_fail (zd_m_zs != 0.);
+
+  aran_taylor_translate_scaled (src, dst, zd_m_zs);
+
+  if (src->negdeg > 0)
+    {
+      gint16 n = dst->posdeg;
+      gcomplex128 inv = 1. / zd_m_zs;
+      gcomplex128 work[n+1];
+      gcomplex128 *srcterm, *dstterm;
+      gcomplex128 pow;
+      gint16 i, j;
+
+      if (src->negdeg > dst->posdeg)
+	g_warning ("could loose precision in \"%s\"\n", __PRETTY_FUNCTION__);
+
+      for (i=0; i<=n; i ++)
+        work[i] = 0.;
+
+      /* sum_l work[l] x^l = sum_k src[-k] / (zd-zs)^k / (1-x)^k */
+      pow = 1.;
+      for (j=0; j<src->negdeg; j ++)
+        pow *= inv;
+
+      srcterm = ARAN_LAURENT_SERIESD_TERM (src, -src->negdeg);
+      for (j=src->negdeg; j>=1; j --)
+        {
+          work[0] += *srcterm * pow;
+
+          /* multiply by 1/(1-x) */
+          for (i=1; i<=n; i ++)
+            work[i] += work[i-1];
+
+          pow *= zd_m_zs;
+          srcterm --;
+        }
+
+      dstterm = ARAN_LAURENT_SERIESD_TERM (dst, 0);
+      pow = 1.;
+      inv = -inv;
+      for (i=0; i<=n; i ++)
+        {
+          *dstterm += work[i] * pow;
+          pow *= inv;
+          dstterm --;
+        }
+    }
+}
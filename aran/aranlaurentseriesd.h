@@ -64,6 +64,12 @@ void aran_laurent_seriesd_write (AranLaurentSeriesd *als, FILE *file);
 #ifdef VSG_HAVE_MPI
 void aran_laurent_seriesd_pack (AranLaurentSeriesd *als, VsgPackedMsg *pm);
 void aran_laurent_seriesd_unpack (AranLaurentSeriesd *als, VsgPackedMsg *pm);
+void aran_laurent_seriesd_pack_compressed (AranLaurentSeriesd *als,
+                                           VsgPackedMsg *pm,
+                                           const AranPackCompression *
+                                           compression);
+void aran_laurent_seriesd_unpack_compressed (AranLaurentSeriesd *als,
+                                             VsgPackedMsg *pm);
 #endif
 
 gcomplex128 aran_laurent_seriesd_evaluate (AranLaurentSeriesd *als,
@@ -79,6 +85,16 @@ void aran_laurent_seriesd_to_taylor (AranLaurentSeriesd *src,
 				     AranLaurentSeriesd *dst,
 				     gcomplex128 zdst);
 
+void aran_laurent_seriesd_translate_scaled (AranLaurentSeriesd *src,
+                                            gcomplex128 zsrc,
+                                            AranLaurentSeriesd *dst,
+                                            gcomplex128 zdst);
+
+void aran_laurent_seriesd_to_taylor_scaled (AranLaurentSeriesd *src,
+                                            gcomplex128 zsrc,
+                                            AranLaurentSeriesd *dst,
+                                            gcomplex128 zdst);
+
 G_END_DECLS;
 
 #endif /* __ARAN_LAURENT_SERIESD_H__ */
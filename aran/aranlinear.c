@@ -251,7 +251,7 @@ static gdouble pythag (gdouble a, gdouble b)
   return (absb == 0. ? 0. : absb*sqrt (1. + frac*frac));
 }
 
-#define SVD_MAXITER 30
+#define SVD_MAXITER 75
 
 void aran_svd (guint m, guint n, gdouble **a, gdouble *w, 
                gdouble **v)
@@ -22,6 +22,39 @@ AranPoly1d *aran_poly1d_new_with_terms (int degree, const double *terms)
   return ap1d;
 }
 
+/* Chebyshev polynomial of the first kind T_n, in monomial basis */
+AranPoly1d *aran_poly1d_new_chebyshev (guint n)
+{
+  AranPoly1d *ret = aran_poly1d_new (n);
+  gdouble prev[n+1], cur[n+1];
+  gint i, k;
+
+  memset (prev, 0, (n+1) * sizeof (gdouble));
+  memset (cur, 0, (n+1) * sizeof (gdouble));
+
+  /* T_0 = 1, T_1 = x */
+  prev[0] = 1.;
+  if (n > 0) cur[1] = 1.;
+  else cur[0] = 1.;
+
+  /* T_k+1 = 2x T_k - T_k-1 */
+  for (k=1; k<n; k++)
+    {
+      gdouble next[n+1];
+
+      next[0] = - prev[0];
+      for (i=1; i<=n; i++)
+        next[i] = 2. * cur[i-1] - prev[i];
+
+      memcpy (prev, cur, (n+1) * sizeof (gdouble));
+      memcpy (cur, next, (n+1) * sizeof (gdouble));
+    }
+
+  memcpy (ret->terms, cur, (n+1) * sizeof (gdouble));
+
+  return ret;
+}
+
 void aran_poly1d_free (AranPoly1d *ap1d)
 {
   if (ap1d->terms != NULL)
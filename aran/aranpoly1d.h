@@ -40,6 +40,8 @@ AranPoly1d *aran_poly1d_new (guint deg);
 
 AranPoly1d *aran_poly1d_new_with_terms (int degree, const double *terms);
 
+AranPoly1d *aran_poly1d_new_chebyshev (guint n);
+
 void aran_poly1d_free (AranPoly1d *ap1d);
 
 void aran_poly1d_write (AranPoly1d *ap1d, FILE *file);
@@ -0,0 +1,53 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __ARAN_SHARED_REDUCE_PRIVATE_H__
+#define __ARAN_SHARED_REDUCE_PRIVATE_H__
+
+#include <glib.h>
+
+#include <vsg/vsgd.h>
+
+#ifdef VSG_HAVE_MPI
+
+#include <vsg/vsgpackedmsg.h>
+
+G_BEGIN_DECLS;
+
+/* non blocking reduction of shared nodes data, for pipelined solvers */
+typedef struct _AranSharedReduce AranSharedReduce;
+
+AranSharedReduce *aran_shared_reduce_new (MPI_Comm communicator,
+                                          VsgParallelVTable *vtable);
+
+void aran_shared_reduce_add (AranSharedReduce *reduce, gpointer data);
+
+void aran_shared_reduce_start (AranSharedReduce *reduce);
+
+gboolean aran_shared_reduce_test (AranSharedReduce *reduce);
+
+void aran_shared_reduce_wait (AranSharedReduce *reduce);
+
+void aran_shared_reduce_free (AranSharedReduce *reduce);
+
+G_END_DECLS;
+
+#endif /* VSG_HAVE_MPI */
+
+#endif /* __ARAN_SHARED_REDUCE_PRIVATE_H__ */
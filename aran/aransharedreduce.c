@@ -0,0 +1,263 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "aran-config.h"
+
+#include "aransharedreduce-private.h"
+
+#ifdef VSG_HAVE_MPI
+
+/*
+ * Shared nodes data are summed with a binomial tree reduction towards
+ * rank 0 followed by a binomial tree broadcast. Every step is a single
+ * message holding all shared nodes data, packed with the forward visit
+ * functions. Messages are only received once MPI_Iprobe tells they
+ * arrived, so that aran_shared_reduce_test() never blocks and can be
+ * called from inside the near/far traversal to make progress.
+ */
+
+#define REDUCE_TAG (0x4152)
+#define BCAST_TAG (0x4153)
+
+typedef enum _SharedReducePhase SharedReducePhase;
+enum _SharedReducePhase {
+  PHASE_REDUCE,
+  PHASE_BCAST,
+  PHASE_DONE,
+};
+
+struct _AranSharedReduce
+{
+  MPI_Comm communicator;
+  gint rk;
+  gint sz;
+
+  VsgParallelVTable *vtable;
+  GPtrArray *data;
+
+  SharedReducePhase phase;
+  gint mask;
+
+  gpointer tmp;
+
+  VsgPackedMsg reduce_msg;
+  VsgPackedMsg bcast_msg;
+  GArray *requests;
+};
+
+AranSharedReduce *aran_shared_reduce_new (MPI_Comm communicator,
+                                          VsgParallelVTable *vtable)
+{
+  AranSharedReduce *reduce = g_malloc (sizeof (AranSharedReduce));
+
+  reduce->communicator = communicator;
+  MPI_Comm_rank (communicator, &reduce->rk);
+  MPI_Comm_size (communicator, &reduce->sz);
+
+  reduce->vtable = vtable;
+  reduce->data = g_ptr_array_new ();
+
+  reduce->phase = PHASE_REDUCE;
+  reduce->mask = 1;
+
+  reduce->tmp = NULL;
+
+  vsg_packed_msg_init (&reduce->reduce_msg, communicator);
+  vsg_packed_msg_init (&reduce->bcast_msg, communicator);
+  reduce->requests = g_array_new (FALSE, FALSE, sizeof (MPI_Request));
+
+  return reduce;
+}
+
+/* data must be added in the same order on every processor */
+void aran_shared_reduce_add (AranSharedReduce *reduce, gpointer data)
+{
+  g_ptr_array_add (reduce->data, data);
+}
+
+static void _pack_all (AranSharedReduce *reduce, VsgPackedMsg *pm)
+{
+  VsgParallelMigrateVTable *fw = &reduce->vtable->visit_forward;
+  guint i;
+
+  for (i=0; i<reduce->data->len; i ++)
+    fw->pack (g_ptr_array_index (reduce->data, i), pm, fw->pack_data);
+}
+
+static void _isend (AranSharedReduce *reduce, VsgPackedMsg *pm, gint dst,
+                    gint tag)
+{
+  MPI_Request request;
+
+  vsg_packed_msg_isend (pm, dst, tag, &request);
+  g_array_append_val (reduce->requests, request);
+}
+
+/* receives a message from @src if it is already there */
+static gboolean _try_recv (AranSharedReduce *reduce, VsgPackedMsg *pm,
+                           gint src, gint tag, gboolean blocking)
+{
+  MPI_Status status;
+  gint flag = 1;
+
+  if (blocking)
+    MPI_Probe (src, tag, reduce->communicator, &status);
+  else
+    MPI_Iprobe (src, tag, reduce->communicator, &flag, &status);
+
+  if (! flag) return FALSE;
+
+  vsg_packed_msg_recv (pm, src, tag);
+
+  return TRUE;
+}
+
+static gboolean _progress (AranSharedReduce *reduce, gboolean blocking)
+{
+  VsgParallelMigrateVTable *fw = &reduce->vtable->visit_forward;
+  guint i;
+
+  while (reduce->phase == PHASE_REDUCE)
+    {
+      if (reduce->mask >= reduce->sz)
+        {
+          /* rank 0 holds the complete sums */
+          reduce->phase = PHASE_BCAST;
+        }
+      else if (reduce->rk & reduce->mask)
+        {
+          /* send partial sums to the parent and wait for the result */
+          _pack_all (reduce, &reduce->reduce_msg);
+          _isend (reduce, &reduce->reduce_msg, reduce->rk - reduce->mask,
+                  REDUCE_TAG);
+
+          reduce->phase = PHASE_BCAST;
+        }
+      else
+        {
+          gint child = reduce->rk + reduce->mask;
+
+          if (child < reduce->sz)
+            {
+              VsgPackedMsg pm = VSG_PACKED_MSG_STATIC_INIT (reduce->communicator);
+
+              if (! _try_recv (reduce, &pm, child, REDUCE_TAG, blocking))
+                return FALSE;
+
+              if (reduce->tmp == NULL)
+                reduce->tmp =
+                  reduce->vtable->alloc (FALSE, reduce->vtable->alloc_data);
+
+              for (i=0; i<reduce->data->len; i ++)
+                {
+                  gpointer data = g_ptr_array_index (reduce->data, i);
+
+                  fw->unpack (reduce->tmp, &pm, fw->unpack_data);
+                  fw->reduce (reduce->tmp, data, fw->reduce_data);
+                }
+
+              vsg_packed_msg_drop_buffer (&pm);
+            }
+
+          reduce->mask <<= 1;
+        }
+    }
+
+  if (reduce->phase == PHASE_BCAST)
+    {
+      gint mask;
+
+      if (reduce->rk != 0)
+        {
+          /* reduce->mask is the lowest bit of rk: rk - mask is the parent */
+          VsgPackedMsg pm = VSG_PACKED_MSG_STATIC_INIT (reduce->communicator);
+
+          if (! _try_recv (reduce, &pm, reduce->rk - reduce->mask, BCAST_TAG,
+                           blocking))
+            return FALSE;
+
+          for (i=0; i<reduce->data->len; i ++)
+            fw->unpack (g_ptr_array_index (reduce->data, i), &pm,
+                        fw->unpack_data);
+
+          vsg_packed_msg_drop_buffer (&pm);
+        }
+
+      /* forward complete sums to children */
+      mask = reduce->mask >> 1;
+
+      if (mask > 0 && reduce->rk + 1 < reduce->sz)
+        _pack_all (reduce, &reduce->bcast_msg);
+
+      for (; mask > 0; mask >>= 1)
+        {
+          if (reduce->rk + mask < reduce->sz)
+            _isend (reduce, &reduce->bcast_msg, reduce->rk + mask,
+                    BCAST_TAG);
+        }
+
+      reduce->phase = PHASE_DONE;
+    }
+
+  return TRUE;
+}
+
+/* posts the first messages of the reduction */
+void aran_shared_reduce_start (AranSharedReduce *reduce)
+{
+  _progress (reduce, FALSE);
+}
+
+/* makes the reduction progress without blocking. Returns TRUE when
+ * shared nodes hold the complete sums. */
+gboolean aran_shared_reduce_test (AranSharedReduce *reduce)
+{
+  if (reduce->phase == PHASE_DONE) return TRUE;
+
+  return _progress (reduce, FALSE);
+}
+
+void aran_shared_reduce_wait (AranSharedReduce *reduce)
+{
+  if (reduce->phase != PHASE_DONE)
+    _progress (reduce, TRUE);
+}
+
+/* completes pending sends and frees @reduce */
+void aran_shared_reduce_free (AranSharedReduce *reduce)
+{
+  aran_shared_reduce_wait (reduce);
+
+  if (reduce->requests->len > 0)
+    MPI_Waitall (reduce->requests->len,
+                 (MPI_Request *) reduce->requests->data, MPI_STATUSES_IGNORE);
+
+  if (reduce->tmp != NULL)
+    reduce->vtable->destroy (reduce->tmp, FALSE,
+                             reduce->vtable->destroy_data);
+
+  vsg_packed_msg_drop_buffer (&reduce->reduce_msg);
+  vsg_packed_msg_drop_buffer (&reduce->bcast_msg);
+  g_array_free (reduce->requests, TRUE);
+  g_ptr_array_free (reduce->data, TRUE);
+
+  g_free (reduce);
+}
+
+#endif /* VSG_HAVE_MPI */
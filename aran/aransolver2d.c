@@ -20,6 +20,7 @@
 #include "aran-config.h"
 
 #include <string.h>
+#include <math.h>
 
 #include <glib-object.h>
 /* #include <vsg/vsgd-inline.h> */
@@ -29,6 +30,8 @@
 #include "aransolver2d.h"
 #include "aranprofile.h"
 #include "aranprofiledb.h"
+#include "aransharedreduce-private.h"
+#include "aranworkers-private.h"
 
 /**
  * AranSolver2d:
@@ -55,6 +58,24 @@ struct _AranSolver2d
 
   guint semifar_threshold;
 
+  AranParticleWeightFunc2d weight;
+  gdouble prune_epsilon;
+  GHashTable *weights;
+
+#ifdef VSG_HAVE_MPI
+  gboolean pipelined;
+  gboolean solving;
+  gboolean migrate_structure;
+  VsgParallelMigrateVTable node_migrate;
+  MPI_Comm pipeline_base;
+  MPI_Comm pipeline_comm;
+  AranSharedReduce *shared_reduce;
+  GArray *deferred_far;
+  VsgPRTree2dFarInteractionFunc pipeline_far;
+  VsgPRTree2dInteractionFunc pipeline_near;
+  VsgPRTree2dSemifarInteractionFunc pipeline_semifar;
+#endif
+
   glong zero_counter;
   glong p2p_counter, p2p_remote_counter;
   glong p2m_counter;
@@ -73,6 +94,8 @@ struct _AranSolver2d
   gdouble l2p_time;
   gdouble p2l_time;
   gdouble m2p_time;
+
+  AranWorkers *workers;
 };
 
 #define ARAN_SOLVER2D_PREALLOC 4
@@ -146,6 +169,17 @@ struct _AranSolver2d
  * particle @dst.
  */
 
+/**
+ * AranParticleWeightFunc2d:
+ * @particle: a particle.
+ *
+ * Function provided to bound the strength of @particle as a field source
+ * (the absolute value of its charge for instance). Particles with a zero
+ * weight must produce no field.
+ *
+ * Returns: @particle source weight.
+ */
+
 #define _USE_G_SLICES GLIB_CHECK_VERSION (2, 10, 0)
 
 #if ! _USE_G_SLICES
@@ -201,6 +235,24 @@ static AranSolver2d *_solver2d_alloc ()
 
   solver->semifar_threshold = 0;
 
+  solver->weight = NULL;
+  solver->prune_epsilon = 0.;
+  solver->weights = NULL;
+
+#ifdef VSG_HAVE_MPI
+  solver->pipelined = FALSE;
+  solver->solving = FALSE;
+  solver->migrate_structure = FALSE;
+  memset (&solver->node_migrate, 0, sizeof (VsgParallelMigrateVTable));
+  solver->pipeline_base = MPI_COMM_NULL;
+  solver->pipeline_comm = MPI_COMM_NULL;
+  solver->shared_reduce = NULL;
+  solver->deferred_far = NULL;
+  solver->pipeline_far = NULL;
+  solver->pipeline_near = NULL;
+  solver->pipeline_semifar = NULL;
+#endif
+
   aran_solver2d_reinit_stats (solver);
 
   solver->p2p_time = -1.;
@@ -212,11 +264,21 @@ static AranSolver2d *_solver2d_alloc ()
   solver->p2l_time = -1.;
   solver->m2p_time = -1.;
 
+  solver->workers = NULL;
+
   return solver;
 }
 
 static void _solver2d_dealloc (AranSolver2d *solver)
 {
+#ifdef VSG_HAVE_MPI
+  if (solver->pipeline_comm != MPI_COMM_NULL)
+    MPI_Comm_free (&solver->pipeline_comm);
+#endif
+
+  if (solver->workers != NULL)
+    aran_workers_free (solver->workers);
+
 #if _USE_G_SLICES
   g_slice_free (AranSolver2d, solver);
 #else
@@ -314,10 +376,111 @@ static void near_func_reflexive (const VsgPRTree2dNodeInfo *one_info,
     solver->p2p_remote_counter +=one_info->point_count * other_info->point_count;
 }
 
+/*
+ * Sparsity pruning: see aransolver3d.c. Node weights bound the sources
+ * weight of their subtree and are never pruned when infinite.
+ */
+typedef struct _NodeWeight NodeWeight;
+
+struct _NodeWeight {
+  VsgPRTreeKey2d id;
+  gdouble weight;
+};
+
+static guint _key2d_hash (const VsgPRTreeKey2d *key)
+{
+  return (guint) (key->x ^ (key->y * 31) ^ ((gulong) key->depth << 24));
+}
+
+static gboolean _key2d_equal (const VsgPRTreeKey2d *a,
+                              const VsgPRTreeKey2d *b)
+{
+  return vsg_prtree_key2d_equals (a, b);
+}
+
+static gdouble _node_weight (AranSolver2d *solver,
+                             const VsgPRTree2dNodeInfo *node_info)
+{
+  NodeWeight *nw;
+
+  if (solver->weights == NULL) return G_MAXDOUBLE;
+
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE2D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return G_MAXDOUBLE;
+#endif
+
+  nw = g_hash_table_lookup (solver->weights, &node_info->id);
+
+  return (nw != NULL) ? nw->weight : G_MAXDOUBLE;
+}
+
+static void _node_weight_add (AranSolver2d *solver,
+                              const VsgPRTree2dNodeInfo *node_info,
+                              gdouble weight)
+{
+  NodeWeight *nw;
+
+  if (solver->weights == NULL || node_info == NULL) return;
+
+  nw = g_hash_table_lookup (solver->weights, &node_info->id);
+
+  if (nw != NULL) nw->weight = MIN (nw->weight + weight, G_MAXDOUBLE);
+}
+
+static void weight_init_func (const VsgPRTree2dNodeInfo *node_info,
+                              AranSolver2d *solver)
+{
+  NodeWeight *nw;
+
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE2D_NODE_INFO_IS_PRIVATE_REMOTE (node_info))
+    {
+      _node_weight_add (solver, node_info->father_info, G_MAXDOUBLE);
+      return;
+    }
+#endif
+
+  nw = g_malloc (sizeof (NodeWeight));
+  nw->id = node_info->id;
+  nw->weight = 0.;
+
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE2D_NODE_INFO_IS_SHARED (node_info)) nw->weight = G_MAXDOUBLE;
+#endif
+
+  g_hash_table_insert (solver->weights, &nw->id, nw);
+}
+
+/* tells if the far field of @src is negligible in @dst */
+static gboolean _far_pruned (AranSolver2d *solver,
+                             const VsgPRTree2dNodeInfo *src,
+                             const VsgPRTree2dNodeInfo *dst)
+{
+  gdouble weight, dist;
+
+  if (solver->weights == NULL) return FALSE;
+
+  weight = _node_weight (solver, src);
+
+  if (weight == 0.) return TRUE;
+  if (weight >= G_MAXDOUBLE) return FALSE;
+
+  dist = vsg_vector2d_dist (&src->center, &dst->center) -
+    0.5 * vsg_vector2d_dist (&src->lbound, &src->ubound) -
+    0.5 * vsg_vector2d_dist (&dst->lbound, &dst->ubound);
+
+  return dist > 0. && weight < solver->prune_epsilon * dist;
+}
+
 static void near_func (const VsgPRTree2dNodeInfo *one_info,
                        const VsgPRTree2dNodeInfo *other_info,
                        AranSolver2d *solver)
 {
+  /* no source on both sides */
+  if (solver->weights != NULL && _node_weight (solver, one_info) == 0. &&
+      _node_weight (solver, other_info) == 0.)
+    return;
+
   if (vsg_prtree_key2d_equals (&one_info->id, &other_info->id))
     near_func_reflexive (one_info, other_info, solver);
   else
@@ -341,18 +504,26 @@ static void far_func (const VsgPRTree2dNodeInfo *one_info,
       gpointer one_dev = one_info->user_data;
       gpointer other_dev = other_info->user_data;
 
-      /* both ways in order to get symmetric exchange */
-      solver->m2l (one_info, one_dev, other_info, other_dev);
+      glong count = 0;
 
-      solver->m2l_counter ++;
+      /* both ways in order to get symmetric exchange */
+      if (! _far_pruned (solver, one_info, other_info))
+        {
+          solver->m2l (one_info, one_dev, other_info, other_dev);
+          count ++;
+        }
 
-      solver->m2l (other_info, other_dev, one_info, one_dev);
+      if (! _far_pruned (solver, other_info, one_info))
+        {
+          solver->m2l (other_info, other_dev, one_info, one_dev);
+          count ++;
+        }
 
-      solver->m2l_counter ++;
+      solver->m2l_counter += count;
 
       if (VSG_PRTREE2D_NODE_INFO_IS_PRIVATE_REMOTE (one_info) ||
           VSG_PRTREE2D_NODE_INFO_IS_PRIVATE_REMOTE (other_info))
-        solver->m2l_remote_counter += 2;
+        solver->m2l_remote_counter += count;
     }
 }
 
@@ -363,7 +534,8 @@ static void semifar_func (const VsgPRTree2dNodeInfo *one_info,
   const VsgPRTree2dNodeInfo *info;
   GSList *list;
   gpointer dev = one_info->user_data;
-  guint point_count = 0;
+  guint p2l_count = 0, m2p_count = 0;
+  gboolean m2p;
 
   if (one_info->depth > other_info->depth)
     {
@@ -382,24 +554,212 @@ static void semifar_func (const VsgPRTree2dNodeInfo *one_info,
   /*             one_info->id.x, one_info->id.y, one_info->depth, */
   /*             other_info->id.x, other_info->id.y, other_info->depth); */
 
+  m2p = _node_weight (solver, info) != 0.;
+
   while (list)
     {
       VsgPoint2 point = (VsgPoint2) list->data;
 
-      solver->p2l (point, info, dev);
-      solver->m2p (info, dev, point);
+      if (solver->weight == NULL || solver->weight (point) != 0.)
+        {
+          solver->p2l (point, info, dev);
+          p2l_count ++;
+        }
+
+      if (m2p)
+        {
+          solver->m2p (info, dev, point);
+          m2p_count ++;
+        }
 
-      point_count ++;
       list = g_slist_next (list);
     }
 
-  solver->p2l_counter += point_count;
-  solver->m2p_counter += point_count;
+  solver->p2l_counter += p2l_count;
+  solver->m2p_counter += m2p_count;
 }
 
 
-static void clear_func (const VsgPRTree2dNodeInfo *node_info,
-                        AranSolver2d *solver)
+#ifdef VSG_HAVE_MPI
+/*
+ * Pipelined solve: see aransolver3d.c. Far pairs between local nodes that
+ * need a shared multipole are deferred until the reduction completes.
+ */
+typedef struct _DeferredNode DeferredNode;
+
+/* the node info fields used by far interactions: point and region lists or
+ * father info only stay valid during the traversal visit */
+struct _DeferredNode {
+  VsgVector2d center;
+  VsgVector2d lbound;
+  VsgVector2d ubound;
+  guint point_count;
+  guint region_count;
+  gboolean isleaf;
+  gpointer user_data;
+  VsgPRTreeKey2d id;
+  guint8 depth;
+  VsgParallelStatus parallel_status;
+};
+
+typedef struct _DeferredFar DeferredFar;
+
+struct _DeferredFar {
+  DeferredNode one;
+  DeferredNode other;
+};
+
+static void _deferred_node_set (DeferredNode *dn,
+                                const VsgPRTree2dNodeInfo *info)
+{
+  dn->center = info->center;
+  dn->lbound = info->lbound;
+  dn->ubound = info->ubound;
+  dn->point_count = info->point_count;
+  dn->region_count = info->region_count;
+  dn->isleaf = info->isleaf;
+  dn->user_data = info->user_data;
+  dn->id = info->id;
+  dn->depth = info->depth;
+  dn->parallel_status = info->parallel_status;
+}
+
+static void _deferred_node_info (const DeferredNode *dn,
+                                 VsgPRTree2dNodeInfo *info)
+{
+  memset (info, 0, sizeof (VsgPRTree2dNodeInfo));
+
+  info->center = dn->center;
+  info->lbound = dn->lbound;
+  info->ubound = dn->ubound;
+  info->point_count = dn->point_count;
+  info->region_count = dn->region_count;
+  info->isleaf = dn->isleaf;
+  info->user_data = dn->user_data;
+  info->id = dn->id;
+  info->depth = dn->depth;
+  info->parallel_status = dn->parallel_status;
+}
+
+static void pipelined_near_func (const VsgPRTree2dNodeInfo *one_info,
+                                 const VsgPRTree2dNodeInfo *other_info,
+                                 AranSolver2d *solver)
+{
+  aran_shared_reduce_test (solver->shared_reduce);
+
+  solver->pipeline_near (one_info, other_info, solver);
+}
+
+static void pipelined_far_func (const VsgPRTree2dNodeInfo *one_info,
+                                const VsgPRTree2dNodeInfo *other_info,
+                                AranSolver2d *solver)
+{
+  if (! aran_shared_reduce_test (solver->shared_reduce) &&
+      (VSG_PRTREE2D_NODE_INFO_IS_SHARED (one_info) ||
+       VSG_PRTREE2D_NODE_INFO_IS_SHARED (other_info)))
+    {
+      if (! VSG_PRTREE2D_NODE_INFO_IS_PRIVATE_REMOTE (one_info) &&
+          ! VSG_PRTREE2D_NODE_INFO_IS_PRIVATE_REMOTE (other_info))
+        {
+          DeferredFar df;
+
+          _deferred_node_set (&df.one, one_info);
+          _deferred_node_set (&df.other, other_info);
+
+          g_array_append_val (solver->deferred_far, df);
+          return;
+        }
+
+      aran_shared_reduce_wait (solver->shared_reduce);
+    }
+
+  solver->pipeline_far (one_info, other_info, solver);
+}
+
+static void pipelined_semifar_func (const VsgPRTree2dNodeInfo *one_info,
+                                    const VsgPRTree2dNodeInfo *other_info,
+                                    AranSolver2d *solver)
+{
+  if (VSG_PRTREE2D_NODE_INFO_IS_SHARED (one_info) ||
+      VSG_PRTREE2D_NODE_INFO_IS_SHARED (other_info))
+    aran_shared_reduce_wait (solver->shared_reduce);
+
+  solver->pipeline_semifar (one_info, other_info, solver);
+}
+
+static void shared_add_func (const VsgPRTree2dNodeInfo *node_info,
+                             AranSolver2d *solver)
+{
+  if (VSG_PRTREE2D_NODE_INFO_IS_SHARED (node_info))
+    aran_shared_reduce_add (solver->shared_reduce, node_info->user_data);
+}
+
+/*
+ * Node data migration wrappers: between two solves, expansions are about
+ * to be cleared, so only the tree structure needs to move.
+ */
+static void _node_migrate_pack (gpointer node_data, VsgPackedMsg *pm,
+                                AranSolver2d *solver)
+{
+  if (solver->migrate_structure && ! solver->solving) return;
+
+  solver->node_migrate.pack (node_data, pm, solver->node_migrate.pack_data);
+}
+
+static void _node_migrate_unpack (gpointer node_data, VsgPackedMsg *pm,
+                                  AranSolver2d *solver)
+{
+  if (solver->migrate_structure && ! solver->solving)
+    {
+      solver->zero (node_data);
+      return;
+    }
+
+  solver->node_migrate.unpack (node_data, pm,
+                               solver->node_migrate.unpack_data);
+}
+
+static MPI_Comm _pipeline_communicator (AranSolver2d *solver)
+{
+  MPI_Comm comm = vsg_prtree2d_get_communicator (solver->prtree);
+
+  if (comm != solver->pipeline_base)
+    {
+      if (solver->pipeline_comm != MPI_COMM_NULL)
+        MPI_Comm_free (&solver->pipeline_comm);
+
+      /* private communicator: no interference with vsg's own messages */
+      MPI_Comm_dup (comm, &solver->pipeline_comm);
+      solver->pipeline_base = comm;
+    }
+
+  return solver->pipeline_comm;
+}
+#endif /* VSG_HAVE_MPI */
+
+/* operators counts of a local pass */
+typedef struct _PassCounters PassCounters;
+
+struct _PassCounters
+{
+  glong zero;
+  glong p2m;
+  glong m2m;
+  glong l2l;
+  glong l2p;
+};
+
+static void _pass_counters_merge (AranSolver2d *solver, PassCounters *counters)
+{
+  solver->zero_counter += counters->zero;
+  solver->p2m_counter += counters->p2m;
+  solver->m2m_counter += counters->m2m;
+  solver->l2l_counter += counters->l2l;
+  solver->l2p_counter += counters->l2p;
+}
+
+static void _clear_node (const VsgPRTree2dNodeInfo *node_info,
+                         AranSolver2d *solver, PassCounters *counters)
 {
   gpointer node_dev = node_info->user_data;
 
@@ -408,51 +768,88 @@ static void clear_func (const VsgPRTree2dNodeInfo *node_info,
 #endif
 
   solver->zero (node_dev);
-  solver->zero_counter ++;
+  counters->zero ++;
 }
 
-static void up_func (const VsgPRTree2dNodeInfo *node_info,
-                     AranSolver2d *solver)
+static void clear_func (const VsgPRTree2dNodeInfo *node_info,
+                        AranSolver2d *solver)
 {
-  gpointer node_dev = node_info->user_data;
+  PassCounters counters = {0, 0, 0, 0, 0};
 
-#ifdef VSG_HAVE_MPI
-  if (VSG_PRTREE2D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
-#endif
+  _clear_node (node_info, solver, &counters);
+  _pass_counters_merge (solver, &counters);
+}
 
-  if (node_info->isleaf)
+static void _up_p2m (const VsgPRTree2dNodeInfo *node_info,
+                     AranSolver2d *solver, PassCounters *counters)
+{
+  gpointer node_dev = node_info->user_data;
+  gdouble node_weight = 0.;
+
+  if (solver->p2m != NULL)
     {
-      if (solver->p2m != NULL)
+      GSList *node_list = node_info->point_list;
+
+      while (node_list)
         {
-          GSList *node_list = node_info->point_list;
+          VsgPoint2 node_point = (VsgPoint2) node_list->data;
+          gdouble weight = (solver->weight != NULL) ?
+            solver->weight (node_point) : 1.;
 
-          while (node_list)
-            {
-              VsgPoint2 node_point = (VsgPoint2) node_list->data;
+          node_weight += weight;
 
-              /* Particle to Multipole gathering */
+          /* Particle to Multipole gathering */
+          if (weight != 0.)
+            {
               solver->p2m (node_point, node_info, node_dev);
-              solver->p2m_counter ++;
-
-              node_list = node_list->next;
+              counters->p2m ++;
             }
+
+          node_list = node_list->next;
         }
     }
 
+  _node_weight_add (solver, node_info, node_weight);
+}
+
+static void _up_m2m (const VsgPRTree2dNodeInfo *node_info,
+                     AranSolver2d *solver, PassCounters *counters)
+{
   if (solver->m2m != NULL && node_info->point_count != 0 &&
-      node_info->father_info)
+      node_info->father_info && _node_weight (solver, node_info) != 0.)
     {
       /* Multipole to Multipole translation */
       solver->m2m (node_info,
-                   node_dev,
+                   node_info->user_data,
                    node_info->father_info,
                    node_info->father_info->user_data);
-      solver->m2m_counter ++;
+      counters->m2m ++;
     }
 }
 
-static void down_func (const VsgPRTree2dNodeInfo *node_info,
-                       AranSolver2d *solver)
+static void up_func (const VsgPRTree2dNodeInfo *node_info,
+                     AranSolver2d *solver)
+{
+  PassCounters counters = {0, 0, 0, 0, 0};
+
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE2D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
+#endif
+
+  if (node_info->isleaf)
+    _up_p2m (node_info, solver, &counters);
+
+  /* propagate source weights towards the root */
+  _node_weight_add (solver, node_info->father_info,
+                    _node_weight (solver, node_info));
+
+  _up_m2m (node_info, solver, &counters);
+
+  _pass_counters_merge (solver, &counters);
+}
+
+static void _down_node (const VsgPRTree2dNodeInfo *node_info,
+                        AranSolver2d *solver, PassCounters *counters)
 {
   gpointer node_dev = node_info->user_data;
 
@@ -468,7 +865,7 @@ static void down_func (const VsgPRTree2dNodeInfo *node_info,
                    node_info->father_info->user_data,
                    node_info,
                    node_dev);
-      solver->l2l_counter ++;
+      counters->l2l ++;
     }
 
   if ((node_info->isleaf))
@@ -483,7 +880,7 @@ static void down_func (const VsgPRTree2dNodeInfo *node_info,
 
               /* Local to Particle distribution */
               solver->l2p (node_info, node_dev, node_point);
-              solver->l2p_counter ++;
+              counters->l2p ++;
 
               node_list = node_list->next;
             }
@@ -491,6 +888,159 @@ static void down_func (const VsgPRTree2dNodeInfo *node_info,
     }
 }
 
+static void down_func (const VsgPRTree2dNodeInfo *node_info,
+                       AranSolver2d *solver)
+{
+  PassCounters counters = {0, 0, 0, 0, 0};
+
+  _down_node (node_info, solver, &counters);
+  _pass_counters_merge (solver, &counters);
+}
+
+/*
+ * Threaded local passes: same scheme as AranSolver3d. The tree is copied
+ * level by level into TaskNodes and every level is handed to the workers.
+ * Upward, a node gathers the multipoles of its children. Downward, a node
+ * reads its father's local development, complete since the previous level.
+ */
+typedef struct _TaskNode TaskNode;
+
+struct _TaskNode
+{
+  VsgPRTree2dNodeInfo info;
+  TaskNode *children[4];
+  guint nchildren;
+};
+
+typedef struct _TaskTree TaskTree;
+
+struct _TaskTree
+{
+  AranSolver2d *solver;
+  GPtrArray *levels;
+  GPtrArray *last;
+  PassCounters *counters;
+};
+
+static void _task_tree_add (const VsgPRTree2dNodeInfo *node_info,
+                            TaskTree *tt)
+{
+  TaskNode *node = g_malloc (sizeof (TaskNode));
+  guint depth = node_info->depth;
+
+  node->info = *node_info;
+  node->nchildren = 0;
+
+  /* pre-order: the father is the last node seen one level above */
+  if (node_info->father_info != NULL)
+    {
+      TaskNode *father = g_ptr_array_index (tt->last, depth-1);
+
+      node->info.father_info = &father->info;
+      father->children[father->nchildren ++] = node;
+    }
+
+  while (tt->levels->len <= depth)
+    {
+      g_ptr_array_add (tt->levels, g_ptr_array_new ());
+      g_ptr_array_add (tt->last, NULL);
+    }
+
+  g_ptr_array_add (g_ptr_array_index (tt->levels, depth), node);
+  g_ptr_array_index (tt->last, depth) = node;
+}
+
+static TaskTree *_task_tree_new (AranSolver2d *solver)
+{
+  TaskTree *tt = g_malloc (sizeof (TaskTree));
+
+  tt->solver = solver;
+  tt->levels = g_ptr_array_new ();
+  tt->last = g_ptr_array_new ();
+  tt->counters = g_malloc0 (aran_workers_count (solver->workers) *
+                            sizeof (PassCounters));
+
+  vsg_prtree2d_traverse (solver->prtree, G_PRE_ORDER,
+                         (VsgPRTree2dFunc) _task_tree_add, tt);
+
+  return tt;
+}
+
+/* accounts the operators of the threaded passes and frees @tt */
+static void _task_tree_free (TaskTree *tt)
+{
+  guint i, j;
+
+  for (i=0; i<aran_workers_count (tt->solver->workers); i ++)
+    _pass_counters_merge (tt->solver, &tt->counters[i]);
+
+  for (i=0; i<tt->levels->len; i ++)
+    {
+      GPtrArray *level = g_ptr_array_index (tt->levels, i);
+
+      for (j=0; j<level->len; j ++)
+        g_free (g_ptr_array_index (level, j));
+
+      g_ptr_array_free (level, TRUE);
+    }
+
+  g_ptr_array_free (tt->levels, TRUE);
+  g_ptr_array_free (tt->last, TRUE);
+  g_free (tt->counters);
+  g_free (tt);
+}
+
+static void _clear_task (TaskNode *node, guint worker, TaskTree *tt)
+{
+  _clear_node (&node->info, tt->solver, &tt->counters[worker]);
+}
+
+static void _up_task (TaskNode *node, guint worker, TaskTree *tt)
+{
+  guint i;
+
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE2D_NODE_INFO_IS_PRIVATE_REMOTE (&node->info)) return;
+#endif
+
+  if (node->info.isleaf)
+    _up_p2m (&node->info, tt->solver, &tt->counters[worker]);
+
+  for (i=0; i<node->nchildren; i ++)
+    {
+      TaskNode *child = node->children[i];
+
+#ifdef VSG_HAVE_MPI
+      if (VSG_PRTREE2D_NODE_INFO_IS_PRIVATE_REMOTE (&child->info)) continue;
+#endif
+
+      _node_weight_add (tt->solver, &node->info,
+                        _node_weight (tt->solver, &child->info));
+
+      _up_m2m (&child->info, tt->solver, &tt->counters[worker]);
+    }
+}
+
+static void _down_task (TaskNode *node, guint worker, TaskTree *tt)
+{
+  _down_node (&node->info, tt->solver, &tt->counters[worker]);
+}
+
+static void _task_tree_foreach (TaskTree *tt, GTraverseType order,
+                                AranWorkerFunc func)
+{
+  guint i, n = tt->levels->len;
+
+  for (i=0; i<n; i ++)
+    {
+      guint depth = (order == G_PRE_ORDER) ? i : n-1-i;
+
+      aran_workers_foreach (tt->solver->workers,
+                            g_ptr_array_index (tt->levels, depth),
+                            func, tt);
+    }
+}
+
 
 
 /* public functions */
@@ -1128,6 +1678,200 @@ guint aran_solver2d_optimal_semifar_threshold (AranSolver2d *solver)
   return semifar_threshold;
 }
 
+/**
+ * AranSolver2dConfig:
+ * @order: multipole expansion degree (as in aran_development2d_new()).
+ * @maxbox: maximum number of particles per tree leaf.
+ * @m2m: multipole to multipole translation function.
+ * @m2l: multipole to local translation function.
+ * @l2l: local to local translation function.
+ * @error: a priori relative error bound for @order.
+ * @time: predicted solve time.
+ *
+ * Solver configuration computed by aran_solver2d_auto_config().
+ */
+
+typedef struct _Translations2d Translations2d;
+
+struct _Translations2d
+{
+  AranMultipole2MultipoleFunc2d m2m;
+  AranMultipole2LocalFunc2d m2l;
+  AranLocal2LocalFunc2d l2l;
+};
+
+static const Translations2d _translations2d[] = {
+  {(AranMultipole2MultipoleFunc2d) aran_development2d_m2m,
+   (AranMultipole2LocalFunc2d) aran_development2d_m2l,
+   (AranLocal2LocalFunc2d) aran_development2d_l2l},
+};
+
+/*
+ * ratio between a square radius and the distance from a well separated
+ * square center to its nearest point: sqrt(2)/2 / (2 - sqrt(2)/2)
+ */
+#define ARAN_SOLVER2D_SEPARATION_RATIO (G_SQRT2 / (4. - G_SQRT2))
+
+/* near and far interaction lists sizes in an uniform quadtree */
+#define ARAN_SOLVER2D_NEAR_SIZE (9.)
+#define ARAN_SOLVER2D_FAR_SIZE (27.)
+
+/**
+ * aran_solver2d_error_bound:
+ * @order: multipole expansion degree.
+ *
+ * Computes an a priori bound for the relative truncation error of
+ * Laurent series of degree @order between well separated quadtree nodes.
+ *
+ * Returns: relative error bound.
+ */
+gdouble aran_solver2d_error_bound (guint order)
+{
+  gdouble rho = ARAN_SOLVER2D_SEPARATION_RATIO;
+
+  return pow (rho, order) / (1. - rho);
+}
+
+/* uniform quadtree model of a solve cost */
+static gdouble _predicted_time2d (guint np, guint maxbox,
+                                  gdouble p2p_time,
+                                  gdouble p2m_time, gdouble l2p_time,
+                                  gdouble m2m_time, gdouble m2l_time,
+                                  gdouble l2l_time)
+{
+  gdouble leaves = MAX (1., ceil ((gdouble) np / maxbox));
+  gdouble nodes = (4. * leaves - 1.) / 3.;
+  gdouble far = MIN (ARAN_SOLVER2D_FAR_SIZE, nodes - 1.);
+
+  return 0.5 * ARAN_SOLVER2D_NEAR_SIZE * np * maxbox * p2p_time +
+    np * (p2m_time + l2p_time) +
+    nodes * (m2m_time + l2l_time + far * m2l_time);
+}
+
+/* profile db evaluation of an operator. Unknown operators cost nothing */
+static gdouble _operator_time (gpointer op, gdouble order)
+{
+  gdouble t;
+
+  if (op == NULL) return 0.;
+
+  t = aran_profile_db_address_eval (op, order);
+
+  return isnan (t) ? 0. : t;
+}
+
+/**
+ * aran_solver2d_auto_config:
+ * @solver: an #AranSolver2d.
+ * @epsilon: target relative error.
+ * @np: number of particles of the problem. If 0, the number of particles
+ * of @solver is used.
+ * @config: result location.
+ *
+ * Selects the lowest expansion degree whose a priori error bound (see
+ * aran_solver2d_error_bound()) is below @epsilon. Then, with operators costs
+ * taken from the profile database (see aran_profile_db_read_file()), chooses
+ * the leaf size and the #AranDevelopment2d translation functions of minimal
+ * predicted time. When @solver p2p cost is unknown (neither in the database
+ * nor measured by aran_solver2d_profile_operators()), @solver current leaf
+ * size is kept.
+ *
+ * @solver particles are only used as a sample: the caller is expected to
+ * create the actual solver from @config (ie. a #VsgPRTree2d with
+ * @config->maxbox, aran_development2d_new (0, @config->order) and
+ * @config translation functions).
+ *
+ * Returns: %TRUE if a configuration meeting @epsilon was found.
+ */
+gboolean aran_solver2d_auto_config (AranSolver2d *solver, gdouble epsilon,
+                                    guint np, AranSolver2dConfig *config)
+{
+  guint order, maxbox, maxbox_min, maxbox_max;
+  gdouble p2p_time, p2m_time, l2p_time;
+  gboolean found = FALSE;
+  gint i;
+
+  g_return_val_if_fail (solver != NULL, FALSE);
+  g_return_val_if_fail (epsilon > 0., FALSE);
+  g_return_val_if_fail (config != NULL, FALSE);
+
+  for (order = 1; order <= ARAN_SOLVER2D_AUTO_MAX_ORDER; order ++)
+    if (aran_solver2d_error_bound (order) <= epsilon) break;
+
+  if (order > ARAN_SOLVER2D_AUTO_MAX_ORDER) return FALSE;
+
+  if (np == 0)
+    {
+      np = aran_solver2d_point_count (solver);
+
+#ifdef VSG_HAVE_MPI
+      {
+        MPI_Comm communicator = vsg_prtree2d_get_communicator (solver->prtree);
+
+        if (communicator != MPI_COMM_NULL)
+          {
+            guint tmp;
+
+            MPI_Allreduce (&np, &tmp, 1, MPI_UNSIGNED, MPI_SUM, communicator);
+            np = tmp;
+          }
+      }
+#endif
+    }
+
+  p2p_time = (solver->p2p != NULL) ?
+    aran_profile_db_address_eval (solver->p2p, 0.) : NAN;
+  if (isnan (p2p_time)) p2p_time = solver->p2p_time;
+
+  if (p2p_time < 0.)
+    {
+      maxbox_min = vsg_prtree2d_get_max_point (solver->prtree);
+      maxbox_max = maxbox_min;
+      p2p_time = 0.;
+    }
+  else
+    {
+      maxbox_min = 1;
+      maxbox_max = ARAN_SOLVER2D_AUTO_MAX_MAXBOX;
+    }
+
+  p2m_time = _operator_time (solver->p2m, order);
+  l2p_time = _operator_time (solver->l2p, order);
+
+  for (i = 0; i < G_N_ELEMENTS (_translations2d); i ++)
+    {
+      const Translations2d *tr = &_translations2d[i];
+      gdouble m2m_time = aran_profile_db_address_eval (tr->m2m, order);
+      gdouble m2l_time = aran_profile_db_address_eval (tr->m2l, order);
+      gdouble l2l_time = aran_profile_db_address_eval (tr->l2l, order);
+
+      if (isnan (m2m_time) || isnan (m2l_time) || isnan (l2l_time))
+        continue;
+
+      for (maxbox = maxbox_min; maxbox <= maxbox_max; maxbox ++)
+        {
+          gdouble t = _predicted_time2d (np, maxbox, p2p_time,
+                                         p2m_time, l2p_time,
+                                         m2m_time, m2l_time, l2l_time);
+
+          if (! found || t < config->time)
+            {
+              found = TRUE;
+
+              config->order = order;
+              config->maxbox = maxbox;
+              config->m2m = tr->m2m;
+              config->m2l = tr->m2l;
+              config->l2l = tr->l2l;
+              config->error = aran_solver2d_error_bound (order);
+              config->time = t;
+            }
+        }
+    }
+
+  return found;
+}
+
 /**
  * aran_solver2d_solve:
  * @solver: an #AranSolver2d.
@@ -1139,11 +1883,16 @@ void aran_solver2d_solve (AranSolver2d *solver)
   VsgPRTree2dFarInteractionFunc far;
   VsgPRTree2dInteractionFunc near;
   VsgPRTree2dSemifarInteractionFunc semifar;
+  TaskTree *tasks = NULL;
 
   g_return_if_fail (solver != NULL);
 
   VSG_TIMING_START (solve, vsg_prtree2d_get_communicator (solver->prtree));
 
+#ifdef VSG_HAVE_MPI
+  solver->solving = TRUE;
+#endif
+
   /*set interaction functions from solevr configuration */
   far = (VsgPRTree2dFarInteractionFunc)
     ((solver->m2l != NULL) ? far_func : nop_far_func);
@@ -1162,17 +1911,37 @@ void aran_solver2d_solve (AranSolver2d *solver)
       g_printerr ("semifar threshold: %u\n", solver->semifar_threshold);
     }
 
+  if (solver->weight != NULL)
+    {
+      solver->weights =
+        g_hash_table_new_full ((GHashFunc) _key2d_hash,
+                               (GEqualFunc) _key2d_equal, NULL, g_free);
+
+      vsg_prtree2d_traverse (solver->prtree, G_PRE_ORDER,
+                             (VsgPRTree2dFunc) weight_init_func,
+                             solver);
+    }
+
+  if (solver->workers != NULL)
+    tasks = _task_tree_new (solver);
+
   /* clear multipole and local developments before the big work */
-  vsg_prtree2d_traverse (solver->prtree, G_POST_ORDER,
-                         (VsgPRTree2dFunc) clear_func,
-                         solver);
+  if (tasks != NULL)
+    _task_tree_foreach (tasks, G_POST_ORDER, (AranWorkerFunc) _clear_task);
+  else
+    vsg_prtree2d_traverse (solver->prtree, G_POST_ORDER,
+                           (VsgPRTree2dFunc) clear_func,
+                           solver);
 
   VSG_TIMING_START (up, vsg_prtree2d_get_communicator (solver->prtree));
 
   /* gather information in Multipole development */
-  vsg_prtree2d_traverse (solver->prtree, G_POST_ORDER,
-                         (VsgPRTree2dFunc) up_func,
-                         solver);
+  if (tasks != NULL)
+    _task_tree_foreach (tasks, G_POST_ORDER, (AranWorkerFunc) _up_task);
+  else
+    vsg_prtree2d_traverse (solver->prtree, G_POST_ORDER,
+                           (VsgPRTree2dFunc) up_func,
+                           solver);
 
 #ifdef VSG_HAVE_MPI
   /* gather shared in_counts */
@@ -1180,8 +1949,34 @@ void aran_solver2d_solve (AranSolver2d *solver)
     VsgPRTreeParallelConfig pc;
 
     vsg_prtree2d_get_parallel (solver->prtree, &pc);
-    vsg_prtree2d_shared_nodes_allreduce (solver->prtree,
-                                         &pc.node_data.visit_forward);
+
+    if (solver->pipelined)
+      {
+        solver->shared_reduce =
+          aran_shared_reduce_new (_pipeline_communicator (solver),
+                                  &pc.node_data);
+
+        /* same order on every processor */
+        vsg_prtree2d_traverse (solver->prtree, G_PRE_ORDER,
+                               (VsgPRTree2dFunc) shared_add_func,
+                               solver);
+
+        aran_shared_reduce_start (solver->shared_reduce);
+        solver->deferred_far = g_array_new (FALSE, FALSE,
+                                            sizeof (DeferredFar));
+
+        solver->pipeline_far = far;
+        solver->pipeline_near = near;
+        solver->pipeline_semifar = semifar;
+
+        far = (VsgPRTree2dFarInteractionFunc) pipelined_far_func;
+        near = (VsgPRTree2dInteractionFunc) pipelined_near_func;
+        if (semifar != NULL)
+          semifar = (VsgPRTree2dSemifarInteractionFunc) pipelined_semifar_func;
+      }
+    else
+      vsg_prtree2d_shared_nodes_allreduce (solver->prtree,
+                                           &pc.node_data.visit_forward);
   }
 #endif /* VSG_HAVE_MPI */
 
@@ -1191,15 +1986,58 @@ void aran_solver2d_solve (AranSolver2d *solver)
   vsg_prtree2d_near_far_traversal_full (solver->prtree, far, near, semifar,
                                         solver->semifar_threshold, solver);
 
+#ifdef VSG_HAVE_MPI
+  if (solver->pipelined)
+    {
+      guint i;
+
+      aran_shared_reduce_wait (solver->shared_reduce);
+
+      for (i=0; i<solver->deferred_far->len; i ++)
+        {
+          DeferredFar *df = &g_array_index (solver->deferred_far,
+                                            DeferredFar, i);
+          VsgPRTree2dNodeInfo one, other;
+
+          _deferred_node_info (&df->one, &one);
+          _deferred_node_info (&df->other, &other);
+
+          solver->pipeline_far (&one, &other, solver);
+        }
+
+      g_array_free (solver->deferred_far, TRUE);
+      solver->deferred_far = NULL;
+
+      aran_shared_reduce_free (solver->shared_reduce);
+      solver->shared_reduce = NULL;
+    }
+#endif /* VSG_HAVE_MPI */
+
   VSG_TIMING_START (down, vsg_prtree2d_get_communicator (solver->prtree));
 
   /* distribute information through Local developments towards particles */
-  vsg_prtree2d_traverse (solver->prtree, G_PRE_ORDER,
-                         (VsgPRTree2dFunc) down_func,
-                         solver);
+  if (tasks != NULL)
+    {
+      _task_tree_foreach (tasks, G_PRE_ORDER, (AranWorkerFunc) _down_task);
+      _task_tree_free (tasks);
+    }
+  else
+    vsg_prtree2d_traverse (solver->prtree, G_PRE_ORDER,
+                           (VsgPRTree2dFunc) down_func,
+                           solver);
 
   VSG_TIMING_END (down, stderr);
 
+  if (solver->weights != NULL)
+    {
+      g_hash_table_destroy (solver->weights);
+      solver->weights = NULL;
+    }
+
+#ifdef VSG_HAVE_MPI
+  solver->solving = FALSE;
+#endif
+
   VSG_TIMING_END (solve, stderr);
 }
 
@@ -1232,9 +2070,27 @@ aran_solver2d_get_communicator (AranSolver2d *solver)
 void aran_solver2d_set_parallel (AranSolver2d *solver,
                                  VsgPRTreeParallelConfig *pconfig)
 {
+  VsgPRTreeParallelConfig pc;
+
   g_return_if_fail (solver != NULL);
+  g_return_if_fail (pconfig != NULL);
+
+  pc = *pconfig;
+
+  /* node data migration goes through the solver (see
+   * aran_solver2d_set_migrate_structure()) */
+  solver->node_migrate = pconfig->node_data.migrate;
+
+  if (pc.node_data.migrate.pack != NULL && pc.node_data.migrate.unpack != NULL)
+    {
+      pc.node_data.migrate.pack = (VsgMigrablePackDataFunc) _node_migrate_pack;
+      pc.node_data.migrate.pack_data = solver;
+      pc.node_data.migrate.unpack =
+        (VsgMigrablePackDataFunc) _node_migrate_unpack;
+      pc.node_data.migrate.unpack_data = solver;
+    }
 
-  vsg_prtree2d_set_parallel (solver->prtree, pconfig);
+  vsg_prtree2d_set_parallel (solver->prtree, &pc);
 }
 
 void aran_solver2d_get_parallel (AranSolver2d *solver,
@@ -1243,6 +2099,10 @@ void aran_solver2d_get_parallel (AranSolver2d *solver,
   g_return_if_fail (solver != NULL);
 
   vsg_prtree2d_get_parallel (solver->prtree, pconfig);
+
+  if (pconfig->node_data.migrate.pack ==
+      (VsgMigrablePackDataFunc) _node_migrate_pack)
+    pconfig->node_data.migrate = solver->node_migrate;
 }
 
 void aran_solver2d_migrate_flush (AranSolver2d *solver)
@@ -1268,6 +2128,44 @@ void aran_solver2d_distribute_contiguous_leaves (AranSolver2d *solver)
   vsg_prtree2d_distribute_contiguous_leaves (solver->prtree);
 }
 
+/**
+ * aran_solver2d_set_pipelined:
+ * @solver: an #AranSolver2d.
+ * @pipelined: whether to overlap shared nodes reduction with computations.
+ *
+ * When @pipelined is %TRUE, aran_solver2d_solve() sums the multipoles of
+ * shared nodes with non blocking communications instead of a blocking
+ * allreduce. Near interactions and far interactions between unshared nodes
+ * proceed meanwhile and local far interactions that need a shared multipole
+ * are deferred until the reduction completes.
+ */
+void aran_solver2d_set_pipelined (AranSolver2d *solver, gboolean pipelined)
+{
+  g_return_if_fail (solver != NULL);
+
+  solver->pipelined = pipelined;
+}
+
+/**
+ * aran_solver2d_set_migrate_structure:
+ * @solver: an #AranSolver2d.
+ * @structure_only: whether node migrations outside of
+ * aran_solver2d_solve() skip the expansions.
+ *
+ * Expansions are cleared at the beginning of every solve. When
+ * @structure_only is %TRUE, nodes moved between two solves (by
+ * aran_solver2d_distribute_nodes() for instance) are sent without their
+ * expansions and receivers only zero a fresh development. Migrations
+ * happening during a solve still carry the complete node data.
+ */
+void aran_solver2d_set_migrate_structure (AranSolver2d *solver,
+                                          gboolean structure_only)
+{
+  g_return_if_fail (solver != NULL);
+
+  solver->migrate_structure = structure_only;
+}
+
 #endif
 
 void aran_solver2d_set_nf_isleaf (AranSolver2d *solver,
@@ -1279,3 +2177,54 @@ void aran_solver2d_set_nf_isleaf (AranSolver2d *solver,
   vsg_prtree2d_set_nf_isleaf (solver->prtree, isleaf, user_data);
 }
 
+/**
+ * aran_solver2d_set_threads:
+ * @solver: an #AranSolver2d.
+ * @nthreads: number of threads.
+ *
+ * Runs the local passes of aran_solver2d_solve() (developments clearing,
+ * upward and downward passes) with @nthreads threads, the calling one
+ * included. Unlike #AranSolver3d, near/far interactions are not threaded:
+ * the near/far traversal runs single-threaded in the calling thread, as do
+ * all communications, so that a parallel program only needs
+ * MPI_THREAD_FUNNELED support. Particle functions given to @solver (p2m,
+ * l2p) must be safe to call concurrently on different leaves.
+ */
+void aran_solver2d_set_threads (AranSolver2d *solver, guint nthreads)
+{
+  g_return_if_fail (solver != NULL);
+
+  if (solver->workers != NULL)
+    {
+      aran_workers_free (solver->workers);
+      solver->workers = NULL;
+    }
+
+  if (nthreads > 1)
+    solver->workers = aran_workers_new (nthreads);
+}
+
+/**
+ * aran_solver2d_set_prune:
+ * @solver: an #AranSolver2d.
+ * @weight: particle source weight function or %NULL.
+ * @epsilon: far field pruning threshold.
+ *
+ * Makes @solver skip the work of sources that produce a negligible field.
+ * Subtrees weights are summed from @weight during the upward pass. p2m,
+ * m2m, p2l and m2p are skipped for zero weights and near interactions
+ * between leaves without any weight. M2L is skipped when the source weight
+ * over the distance between both nodes is below @epsilon. Zero @epsilon only
+ * prunes empty sources. Remote and shared nodes are never pruned. Passing
+ * %NULL @weight disables pruning.
+ */
+void aran_solver2d_set_prune (AranSolver2d *solver,
+                              AranParticleWeightFunc2d weight,
+                              gdouble epsilon)
+{
+  g_return_if_fail (solver != NULL);
+  g_return_if_fail (epsilon >= 0.);
+
+  solver->weight = weight;
+  solver->prune_epsilon = epsilon;
+}
@@ -35,6 +35,8 @@ typedef struct _AranSolver2d AranSolver2d;
 /* Particle functions */
 typedef void (*AranParticleInitFunc2d) (VsgPoint2 particle);
 
+typedef gdouble (*AranParticleWeightFunc2d) (VsgPoint2 particle);
+
 typedef void (*AranParticle2ParticleFunc2d) (VsgPoint2 src, VsgPoint2 dst);
 
 typedef void (*AranParticle2MultipoleFunc2d) (VsgPoint2 src,
@@ -76,6 +78,25 @@ typedef void (*AranLocal2LocalFunc2d) (const VsgPRTree2dNodeInfo *src_node,
                                         gpointer dst);
 
 
+/* automatic configuration */
+#define ARAN_SOLVER2D_AUTO_MAX_ORDER (64)
+#define ARAN_SOLVER2D_AUTO_MAX_MAXBOX (512)
+
+typedef struct _AranSolver2dConfig AranSolver2dConfig;
+
+struct _AranSolver2dConfig
+{
+  guint order;
+  guint maxbox;
+
+  AranMultipole2MultipoleFunc2d m2m;
+  AranMultipole2LocalFunc2d m2l;
+  AranLocal2LocalFunc2d l2l;
+
+  gdouble error;
+  gdouble time;
+};
+
 /* functions */
 
 AranSolver2d *aran_solver2d_new (VsgPRTree2d *prtree,
@@ -128,6 +149,11 @@ void aran_solver2d_profile_operators (AranSolver2d *solver,
 
 guint aran_solver2d_optimal_semifar_threshold (AranSolver2d *solver);
 
+gdouble aran_solver2d_error_bound (guint order);
+
+gboolean aran_solver2d_auto_config (AranSolver2d *solver, gdouble epsilon,
+                                    guint np, AranSolver2dConfig *config);
+
 void aran_solver2d_reinit_stats (AranSolver2d *solver);
 void aran_solver2d_get_stats (AranSolver2d *solver, glong *zero_count,
 			      glong *p2p_count, glong *p2m_count,
@@ -202,12 +228,23 @@ void aran_solver2d_distribute_nodes (AranSolver2d *solver,
 
 void aran_solver2d_distribute_contiguous_leaves (AranSolver2d *solver);
 
+void aran_solver2d_set_pipelined (AranSolver2d *solver, gboolean pipelined);
+
+void aran_solver2d_set_migrate_structure (AranSolver2d *solver,
+                                          gboolean structure_only);
+
 #endif /* VSG_HAVE_MPI */
 
 void aran_solver2d_set_nf_isleaf (AranSolver2d *solver,
                                   VsgPRTree2dNFIsleafFunc isleaf,
                                   gpointer user_data);
 
+void aran_solver2d_set_threads (AranSolver2d *solver, guint nthreads);
+
+void aran_solver2d_set_prune (AranSolver2d *solver,
+                              AranParticleWeightFunc2d weight,
+                              gdouble epsilon);
+
 G_END_DECLS;
 
 #endif /* __ARAN_SOLVER2D_H__ */
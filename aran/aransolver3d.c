@@ -19,7 +19,9 @@
 
 #include "aran-config.h"
 
+#include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 #include <glib-object.h>
 /* #include <vsg/vsgd-inline.h> */
@@ -29,6 +31,28 @@
 #include "aransolver3d.h"
 #include "aranprofile.h"
 #include "aranprofiledb.h"
+#include "aransharedreduce-private.h"
+#include "aranworkers-private.h"
+
+typedef struct _LatticeCache LatticeCache;
+
+/* periodic lattice sum as a real linear map from the root multipole terms
+ * to its local terms, for one box and degree */
+struct _LatticeCache
+{
+  VsgVector3d lbound;
+  VsgVector3d ubound;
+  guint levels;
+  guint8 degrees[4];
+  AranMultipole2MultipoleFunc3d m2m;
+  AranMultipole2LocalFunc3d m2l;
+  AranNodeZeroFunc3d node_zero;
+  gpointer node_zero_data;
+
+  guint nin;
+  guint nout;
+  gdouble *matrix; /* built when the same lattice comes back */
+};
 
 /**
  * AranSolver3d:
@@ -38,11 +62,31 @@
 struct _AranSolver3d
 {
  VsgPRTree3d *prtree;
+  VsgPoint3dLocFunc point_loc;
 
   GType devel_type;
   gpointer devel;
   AranZeroFunc zero;
 
+  AranNodeZeroFunc3d node_zero;
+  gpointer node_zero_data;
+
+  AranParticleRoleFunc3d role;
+  AranParticle2ParticleFunc3d p2p_one_way;
+  GHashTable *source_nodes;
+  GHashTable *target_nodes;
+
+  AranParticleWeightFunc3d weight;
+  gdouble prune_epsilon;
+  GHashTable *weights;
+
+  guint far_period;
+  guint far_age;
+  GHashTable *far_leaves;
+
+  AranLeafPrepareFunc3d leaf_prepare;
+  gpointer leaf_prepare_data;
+
   AranParticle2ParticleFunc3d p2p;
 
   AranParticle2MultipoleFunc3d p2m;
@@ -54,16 +98,37 @@ struct _AranSolver3d
   AranMultipole2ParticleFunc3d m2p;
 
   guint semifar_threshold;
+  gboolean adaptive_semifar;
+
+  VsgPRTree3dNFIsleafFunc nf_isleaf;
+  gpointer nf_isleaf_data;
+
+  AranParticle2ParticleShiftFunc3d p2p_shift;
+  guint lattice_levels;
+  LatticeCache *lattice_cache;
+  AranParticleDipoleFunc3d dipole;
+  AranParticleDipoleCorrectionFunc3d dipole_correction;
+
+#ifdef VSG_HAVE_MPI
+  gboolean pipelined;
+  gboolean let;
+  gboolean solving;
+  gboolean migrate_structure;
+  VsgParallelMigrateVTable node_migrate;
+  MPI_Comm pipeline_base;
+  MPI_Comm pipeline_comm;
+  AranSharedReduce *shared_reduce;
+  GArray *deferred_far;
+  VsgPRTree3dFarInteractionFunc pipeline_far;
+  VsgPRTree3dInteractionFunc pipeline_near;
+  VsgPRTree3dSemifarInteractionFunc pipeline_semifar;
+#endif
+
+  AranStats *stats;
+  GHashTable *node_costs;
+  gdouble solve_work;
 
-  glong zero_counter;
-  glong p2p_counter, p2p_remote_counter;
-  glong p2m_counter;
-  glong m2m_counter;
-  glong m2l_counter, m2l_remote_counter;
-  glong l2l_counter;
-  glong l2p_counter;
-  glong p2l_counter;
-  glong m2p_counter;
+  AranWorkers *workers;
 
   gdouble p2p_time;
   gdouble p2m_time;
@@ -77,6 +142,9 @@ struct _AranSolver3d
 
 #define ARAN_SOLVER3D_PREALLOC 4
 
+/* statistics accumulation block of the calling thread */
+#define _SOLVER3D_STATS_BLOCK(solver) (aran_stats_get_block ((solver)->stats, 0))
+
 /**
  * AranParticle2ParticleFunc3d:
  * @src: source particle.
@@ -85,6 +153,71 @@ struct _AranSolver3d
  * Function provided to compute the particle/particle direct interaction.
  */
 
+/**
+ * AranParticle2ParticleShiftFunc3d:
+ * @src: source particle.
+ * @shift: translation of @src.
+ * @dst: destination particle.
+ *
+ * Function provided to accumulate into @dst the direct interaction of
+ * @src periodic image located at @src position + @shift.
+ */
+
+/**
+ * AranParticleDipoleFunc3d:
+ * @particle: a particle.
+ * @origin: dipole moment origin.
+ * @dipole: dipole moment accumulator.
+ *
+ * Function provided to add @particle contribution (ie. charge * (position -
+ * @origin)) to @dipole.
+ */
+
+/**
+ * AranParticleDipoleCorrectionFunc3d:
+ * @particle: a particle.
+ * @origin: @dipole origin.
+ * @dipole: dipole moment of the periodic cell.
+ * @volume: volume of the periodic cell.
+ *
+ * Function provided to correct @particle field for the surface term of the
+ * periodic lattice summation (ie. for a Coulomb potential, subtract
+ * 4*pi/(3*@volume) @dipole.(position - @origin) to get "tin foil" boundary
+ * conditions as in Ewald summation).
+ */
+
+/**
+ * AranParticleRoleFunc3d:
+ * @particle: a particle.
+ *
+ * Function provided to tell whether @particle is a field source, a field
+ * target or both.
+ *
+ * Returns: @particle #AranParticleRole flags.
+ */
+
+/**
+ * AranParticleWeightFunc3d:
+ * @particle: a particle.
+ *
+ * Function provided to bound the strength of @particle as a field source
+ * (the absolute value of its charge for instance). Particles with a zero
+ * weight must produce no field.
+ *
+ * Returns: @particle source weight.
+ */
+
+/**
+ * AranLeafPrepareFunc3d:
+ * @leaf_info: leaf node info.
+ * @devel: @leaf_info development.
+ * @user_data: user data.
+ *
+ * Function called once per leaf after Local to Local translation and before
+ * distribution of @devel to the leaf particles. Prepared data is to be
+ * stored into @devel, where the Local to Particle function finds it.
+ */
+
 /**
  * AranParticle2MultipoleFunc3d:
  * @src: source particle.
@@ -145,6 +278,28 @@ struct _AranSolver3d
  * particle @dst.
  */
 
+/**
+ * AranNodeZeroFunc3d:
+ * @node_info: tree node info of @devel.
+ * @devel: a node development.
+ * @user_data: user provided data.
+ *
+ * Function provided to reset @devel before a solve when its initialization
+ * depends on tree node properties (ie. level dependent expansion degrees).
+ */
+
+/**
+ * AranParticleMoveFunc3d:
+ * @particle: a particle.
+ * @updated: position selector.
+ * @user_data: user provided data.
+ *
+ * Function provided to place @particle at its new position when @updated is
+ * %TRUE or back at its previous position when @updated is %FALSE. Both
+ * positions have to stay available until aran_solver3d_update_positions()
+ * returns.
+ */
+
 #define _USE_G_SLICES GLIB_CHECK_VERSION (2, 10, 0)
 
 #if ! _USE_G_SLICES
@@ -187,6 +342,26 @@ static AranSolver3d *_solver3d_alloc ()
 
   solver->devel = NULL;
   solver->zero = NULL;
+  solver->node_zero = NULL;
+  solver->node_zero_data = NULL;
+
+  solver->role = NULL;
+  solver->p2p_one_way = NULL;
+  solver->source_nodes = NULL;
+  solver->target_nodes = NULL;
+
+  solver->weight = NULL;
+  solver->prune_epsilon = 0.;
+  solver->weights = NULL;
+
+  solver->point_loc = (VsgPoint3dLocFunc) vsg_vector3d_vector3d_locfunc;
+
+  solver->far_period = 1;
+  solver->far_age = 0;
+  solver->far_leaves = NULL;
+
+  solver->leaf_prepare = NULL;
+  solver->leaf_prepare_data = NULL;
 
   solver->p2p = NULL;
 
@@ -199,8 +374,37 @@ static AranSolver3d *_solver3d_alloc ()
   solver->m2p = NULL;
 
   solver->semifar_threshold = 0;
+  solver->adaptive_semifar = FALSE;
+
+  solver->nf_isleaf = NULL;
+  solver->nf_isleaf_data = NULL;
+
+  solver->p2p_shift = NULL;
+  solver->lattice_levels = 0;
+  solver->lattice_cache = NULL;
+  solver->dipole = NULL;
+  solver->dipole_correction = NULL;
+
+#ifdef VSG_HAVE_MPI
+  solver->pipelined = FALSE;
+  solver->let = FALSE;
+  solver->solving = FALSE;
+  solver->migrate_structure = FALSE;
+  memset (&solver->node_migrate, 0, sizeof (VsgParallelMigrateVTable));
+  solver->pipeline_base = MPI_COMM_NULL;
+  solver->pipeline_comm = MPI_COMM_NULL;
+  solver->shared_reduce = NULL;
+  solver->deferred_far = NULL;
+  solver->pipeline_far = NULL;
+  solver->pipeline_near = NULL;
+  solver->pipeline_semifar = NULL;
+#endif
+
+  solver->stats = aran_stats_new ();
+  solver->node_costs = NULL;
+  solver->solve_work = 0.;
 
-  aran_solver3d_reinit_stats (solver);
+  solver->workers = NULL;
 
   solver->p2p_time = -1.;
   solver->p2m_time = -1.;
@@ -214,8 +418,34 @@ static AranSolver3d *_solver3d_alloc ()
   return solver;
 }
 
+static void _lattice_cache_free (LatticeCache *lc)
+{
+  if (lc == NULL) return;
+
+  g_free (lc->matrix);
+  g_free (lc);
+}
+
 static void _solver3d_dealloc (AranSolver3d *solver)
 {
+#ifdef VSG_HAVE_MPI
+  if (solver->pipeline_comm != MPI_COMM_NULL)
+    MPI_Comm_free (&solver->pipeline_comm);
+#endif
+
+  aran_stats_free (solver->stats);
+
+  if (solver->node_costs != NULL)
+    g_hash_table_destroy (solver->node_costs);
+
+  if (solver->far_leaves != NULL)
+    g_hash_table_destroy (solver->far_leaves);
+
+  _lattice_cache_free (solver->lattice_cache);
+
+  if (solver->workers != NULL)
+    aran_workers_free (solver->workers);
+
 #if _USE_G_SLICES
   g_slice_free (AranSolver3d, solver);
 #else
@@ -242,6 +472,20 @@ void aran_solver3d_init ()
 #endif /* ! _USE_G_SLICES */
 }
 
+/* tells if @solver tree is spread over several processors */
+static gboolean _distributed (AranSolver3d *solver)
+{
+#ifdef VSG_HAVE_MPI
+  MPI_Comm communicator = vsg_prtree3d_get_communicator (solver->prtree);
+  gint sz = 1;
+
+  if (communicator != MPI_COMM_NULL) MPI_Comm_size (communicator, &sz);
+
+  return sz > 1;
+#else
+  return FALSE;
+#endif
+}
 
 /*----------------------------------------------------*/
 static void nop_near_func (const VsgPRTree3dNodeInfo *one_info,
@@ -250,12 +494,83 @@ static void nop_near_func (const VsgPRTree3dNodeInfo *one_info,
 {
 }
 
+/*
+ * Per node measured costs of the last solve, used by
+ * aran_solver3d_distribute_cost().
+ */
+typedef struct _NodeCost NodeCost;
+
+struct _NodeCost {
+  VsgPRTreeKey3d id;
+  gdouble cost;  /* operators time measured on this node */
+  gdouble np;    /* local particles in the subtree */
+  gdouble rate;  /* ancestors cost per particle */
+};
+
+static NodeCost *_node_cost_get (GHashTable *costs,
+                                 const VsgPRTree3dNodeInfo *node_info)
+{
+  NodeCost *nc = g_hash_table_lookup (costs, &node_info->id);
+
+  if (nc == NULL)
+    {
+      nc = g_malloc0 (sizeof (NodeCost));
+      nc->id = node_info->id;
+      g_hash_table_insert (costs, &nc->id, nc);
+    }
+
+  return nc;
+}
+
+static void _node_cost_add (AranSolver3d *solver,
+                            const VsgPRTree3dNodeInfo *node_info, gdouble t)
+{
+  if (solver->node_costs == NULL ||
+      VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
+
+  _node_cost_get (solver->node_costs, node_info)->cost += t;
+}
+
+/* pair interactions are charged to the local nodes */
+static void _pair_cost_add (AranSolver3d *solver,
+                            const VsgPRTree3dNodeInfo *one_info,
+                            const VsgPRTree3dNodeInfo *other_info, gdouble t)
+{
+  if (solver->node_costs == NULL) return;
+
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (one_info) ||
+      VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (other_info))
+    {
+      _node_cost_add (solver, one_info, t);
+      _node_cost_add (solver, other_info, t);
+    }
+  else
+    {
+      _node_cost_add (solver, one_info, 0.5 * t);
+      _node_cost_add (solver, other_info, 0.5 * t);
+    }
+}
+
+/*
+ * Interactions of a pair of nodes. They account their operators into
+ * @block and return the time spent, which the caller charges to the nodes
+ * with _pair_cost_add() (see _near_far_run()).
+ */
+typedef gdouble (*PairFunc) (AranSolver3d *solver,
+                             const VsgPRTree3dNodeInfo *one_info,
+                             const VsgPRTree3dNodeInfo *other_info,
+                             AranStatsBlock *block);
+
 /* general case near_func algorithm */
-static void near_func_default (const VsgPRTree3dNodeInfo *one_info,
-                               const VsgPRTree3dNodeInfo *other_info,
-                               AranSolver3d *solver)
+static gdouble _near_default (AranSolver3d *solver,
+                              const VsgPRTree3dNodeInfo *one_info,
+                              const VsgPRTree3dNodeInfo *other_info,
+                              AranStatsBlock *block)
 {
   GSList *one_list = one_info->point_list;
+  guint depth = MAX (one_info->depth, other_info->depth);
+  glong count = one_info->point_count * other_info->point_count;
+  gdouble t0 = ARAN_STATS_BLOCK_TIME (block);
 
   while (one_list)
     {
@@ -275,18 +590,24 @@ static void near_func_default (const VsgPRTree3dNodeInfo *one_info,
       one_list = one_list->next;
     }
 
-  solver->p2p_counter +=one_info->point_count * other_info->point_count;
+  t0 = ARAN_STATS_BLOCK_TIME (block) - t0;
+  ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_P2P, depth, count, t0);
+
   if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (one_info) ||
       VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (other_info))
-    solver->p2p_remote_counter +=one_info->point_count * other_info->point_count;
+    ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_P2P_REMOTE, depth, count, 0.);
+
+  return t0;
 }
 
 /* near_func algorithm for reflexive interaction (one_info == other_info) */
-static void near_func_reflexive (const VsgPRTree3dNodeInfo *one_info,
-                                 const VsgPRTree3dNodeInfo *other_info,
-                                 AranSolver3d *solver)
+static gdouble _near_reflexive (AranSolver3d *solver,
+                                const VsgPRTree3dNodeInfo *one_info,
+                                const VsgPRTree3dNodeInfo *other_info,
+                                AranStatsBlock *block)
 {
   GSList *one_list = one_info->point_list;
+  gdouble t0 = ARAN_STATS_BLOCK_TIME (block);
 
   while (one_list)
     {
@@ -306,727 +627,3830 @@ static void near_func_reflexive (const VsgPRTree3dNodeInfo *one_info,
       one_list = one_list->next;
     }
 
-  solver->p2p_counter +=
-    (one_info->point_count * (one_info->point_count+1)) / 2;
+  t0 = ARAN_STATS_BLOCK_TIME (block) - t0;
+  ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_P2P, one_info->depth,
+                        (one_info->point_count * (one_info->point_count+1)) / 2,
+                        t0);
 
   if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (one_info))
-    solver->p2p_remote_counter +=one_info->point_count * other_info->point_count;
-}
+    ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_P2P_REMOTE, one_info->depth,
+                          one_info->point_count * other_info->point_count, 0.);
 
-static void near_func (const VsgPRTree3dNodeInfo *one_info,
-                       const VsgPRTree3dNodeInfo *other_info,
-                       AranSolver3d *solver)
-{
-  if (vsg_prtree_key3d_equals (&one_info->id, &other_info->id))
-    near_func_reflexive (one_info, other_info, solver);
-  else
-    near_func_default (one_info, other_info, solver);
+  return t0;
 }
 
+/*
+ * Sparsity pruning (see aran_solver3d_set_prune()): every local node
+ * records a bound on the weight of the sources in its subtree. Nodes whose
+ * subtree is not entirely known here (remote and shared nodes, fathers of
+ * remote nodes) get an infinite weight and are never pruned.
+ */
+typedef struct _NodeWeight NodeWeight;
 
-static void nop_far_func (const VsgPRTree3dNodeInfo *one_info,
-                          const VsgPRTree3dNodeInfo *other_info,
-                          AranSolver3d *solver)
-{
-}
+struct _NodeWeight {
+  VsgPRTreeKey3d id;
+  gdouble weight;
+};
 
-static void far_func (const VsgPRTree3dNodeInfo *one_info,
-                      const VsgPRTree3dNodeInfo *other_info,
-                      AranSolver3d *solver)
+static gdouble _node_weight (AranSolver3d *solver,
+                             const VsgPRTree3dNodeInfo *node_info)
 {
-  /* Multipole to Local transformation */
-  if (solver->m2l != NULL)
-    {
-      gpointer one_dev = one_info->user_data;
-      gpointer other_dev = other_info->user_data;
+  NodeWeight *nw;
 
-      /* both ways in order to get symmetric exchange */
-      solver->m2l (one_info, one_dev, other_info, other_dev);
+  if (solver->weights == NULL) return G_MAXDOUBLE;
 
-      solver->m2l (other_info, other_dev, one_info, one_dev);
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return G_MAXDOUBLE;
+#endif
 
-      solver->m2l_counter += 2;
+  nw = g_hash_table_lookup (solver->weights, &node_info->id);
 
-      if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (one_info) ||
-          VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (other_info))
-        solver->m2l_remote_counter += 2;
-    }
+  return (nw != NULL) ? nw->weight : G_MAXDOUBLE;
 }
 
+static void _node_weight_add (AranSolver3d *solver,
+                              const VsgPRTree3dNodeInfo *node_info,
+                              gdouble weight)
+{
+  NodeWeight *nw;
 
-static void semifar_func (const VsgPRTree3dNodeInfo *one_info,
-                          const VsgPRTree3dNodeInfo *other_info,
-                          AranSolver3d *solver)
+  if (solver->weights == NULL || node_info == NULL) return;
+
+  nw = g_hash_table_lookup (solver->weights, &node_info->id);
+
+  if (nw != NULL) nw->weight = MIN (nw->weight + weight, G_MAXDOUBLE);
+}
+
+/* registers every node before the passes, which then only update them */
+static void weight_init_func (const VsgPRTree3dNodeInfo *node_info,
+                              AranSolver3d *solver)
 {
-  const VsgPRTree3dNodeInfo *info;
-  GSList *list;
-  gpointer dev = one_info->user_data;
-  guint point_count = 0;
+  NodeWeight *nw;
 
-  if (one_info->depth > other_info->depth)
-    {
-      list = other_info->point_list;
-      info = one_info;
-      dev = one_info->user_data;
-    }
-  else
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info))
     {
-      list = one_info->point_list;
-      info = other_info;
-      dev = other_info->user_data;
+      _node_weight_add (solver, node_info->father_info, G_MAXDOUBLE);
+      return;
     }
+#endif
 
-  /* g_printerr ("semifar one[%#lx %#lx %#lx %d] other[%#lx %#lx %#lx %d]\n", */
-  /*             one_info->id.x, one_info->id.y, one_info->id.z, one_info->depth, */
-  /*             other_info->id.x, other_info->id.y, other_info->id.z, other_info->depth); */
+  nw = g_malloc (sizeof (NodeWeight));
+  nw->id = node_info->id;
+  nw->weight = 0.;
 
-  while (list)
-    {
-      VsgPoint3 point = (VsgPoint3) list->data;
+#ifdef VSG_HAVE_MPI
+  /* other processors sources are unknown */
+  if (VSG_PRTREE3D_NODE_INFO_IS_SHARED (node_info)) nw->weight = G_MAXDOUBLE;
+#endif
+
+  g_hash_table_insert (solver->weights, &nw->id, nw);
+}
+
+/* tells if the far field of @src is negligible in @dst */
+static gboolean _far_pruned (AranSolver3d *solver,
+                             const VsgPRTree3dNodeInfo *src,
+                             const VsgPRTree3dNodeInfo *dst)
+{
+  gdouble weight, dist;
 
-      solver->p2l (point, info, dev);
-      solver->m2p (info, dev, point);
+  if (solver->weights == NULL) return FALSE;
 
-      point_count ++;
-      list = g_slist_next (list);
-    }
+  weight = _node_weight (solver, src);
 
-  solver->p2l_counter += point_count;
-  solver->m2p_counter += point_count;
+  if (weight == 0.) return TRUE;
+  if (weight >= G_MAXDOUBLE) return FALSE;
+
+  /* distance between any two points of @src and @dst */
+  dist = vsg_vector3d_dist (&src->center, &dst->center) -
+    0.5 * vsg_vector3d_dist (&src->lbound, &src->ubound) -
+    0.5 * vsg_vector3d_dist (&dst->lbound, &dst->ubound);
+
+  return dist > 0. && weight < solver->prune_epsilon * dist;
 }
 
+/* tells if neither @one nor @other holds a source */
+static gboolean _near_pruned (AranSolver3d *solver,
+                              const VsgPRTree3dNodeInfo *one_info,
+                              const VsgPRTree3dNodeInfo *other_info)
+{
+  return solver->weights != NULL && _node_weight (solver, one_info) == 0. &&
+    _node_weight (solver, other_info) == 0.;
+}
 
-static void clear_func (const VsgPRTree3dNodeInfo *node_info,
-                        AranSolver3d *solver)
+static gdouble _near (AranSolver3d *solver,
+                      const VsgPRTree3dNodeInfo *one_info,
+                      const VsgPRTree3dNodeInfo *other_info,
+                      AranStatsBlock *block)
 {
-  gpointer node_dev = node_info->user_data;
+  if (_near_pruned (solver, one_info, other_info)) return 0.;
 
-#ifdef VSG_HAVE_MPI
-  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
-#endif
+  if (vsg_prtree_key3d_equals (&one_info->id, &other_info->id))
+    return _near_reflexive (solver, one_info, other_info, block);
 
-  solver->zero (node_dev);
-  solver->zero_counter ++;
+  return _near_default (solver, one_info, other_info, block);
 }
 
-static void up_func (const VsgPRTree3dNodeInfo *node_info,
-                     AranSolver3d *solver)
+static void near_func (const VsgPRTree3dNodeInfo *one_info,
+                       const VsgPRTree3dNodeInfo *other_info,
+                       AranSolver3d *solver)
 {
-  gpointer node_dev = node_info->user_data;
+  _pair_cost_add (solver, one_info, other_info,
+                  _near (solver, one_info, other_info,
+                         _SOLVER3D_STATS_BLOCK (solver)));
+}
+
+static guint _key3d_hash (const VsgPRTreeKey3d *key)
+{
+  return (guint) (key->x ^ (key->y * 31) ^ (key->z * 131) ^
+                  ((gulong) key->depth << 24));
+}
+
+static gboolean _key3d_equal (const VsgPRTreeKey3d *a,
+                              const VsgPRTreeKey3d *b)
+{
+  return vsg_prtree_key3d_equals (a, b);
+}
+
+static void _node_set_insert (GHashTable *set,
+                              const VsgPRTree3dNodeInfo *node_info)
+{
+  if (g_hash_table_lookup (set, &node_info->id) == NULL)
+    {
+      VsgPRTreeKey3d *key = g_memdup (&node_info->id, sizeof (VsgPRTreeKey3d));
+
+      g_hash_table_insert (set, key, key);
+    }
+}
+
+/* tells if the subtree of @node_info holds particles registered in @set */
+static gboolean _node_has_role (const VsgPRTree3dNodeInfo *node_info,
+                                GHashTable *set)
+{
+  if (set == NULL) return TRUE;
 
 #ifdef VSG_HAVE_MPI
-  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
+  /* other processors particles are unknown here */
+  if (! VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_LOCAL (node_info)) return TRUE;
 #endif
 
-  if (node_info->isleaf)
+  return g_hash_table_lookup (set, &node_info->id) != NULL;
+}
+
+/* forgets local developments kept for far field reuse */
+static void _far_reuse_reset (AranSolver3d *solver)
+{
+  if (solver->far_leaves != NULL)
     {
-      if (solver->p2m != NULL)
-        {
-          GSList *node_list = node_info->point_list;
+      g_hash_table_destroy (solver->far_leaves);
+      solver->far_leaves = NULL;
+    }
 
-          while (node_list)
-            {
-              VsgPoint3 node_point = (VsgPoint3) node_list->data;
+  solver->far_age = 0;
+}
 
-              /* Particle to Multipole gathering */
-              solver->p2m (node_point, node_info, node_dev);
-              solver->p2m_counter ++;
+/* particle/particle interaction restricted to the required outputs */
+static void _p2p_roles (AranSolver3d *solver,
+                        VsgPoint3 one, AranParticleRole one_role,
+                        VsgPoint3 other, AranParticleRole other_role)
+{
+  gboolean one_out = (one_role & ARAN_PARTICLE_TARGET) &&
+    (other_role & ARAN_PARTICLE_SOURCE);
+  gboolean other_out = (other_role & ARAN_PARTICLE_TARGET) &&
+    (one_role & ARAN_PARTICLE_SOURCE);
 
-              node_list = node_list->next;
-            }
-        }
+  if (one == other)
+    {
+      if (one_out) solver->p2p (one, other);
     }
-
-  if (solver->m2m != NULL && node_info->point_count != 0 &&
-      node_info->father_info)
+  else if (one_out && other_out)
+    solver->p2p (one, other);
+  else if (solver->p2p_one_way == NULL)
     {
-      /* Multipole to Multipole translation */
-      solver->m2m (node_info,
-                   node_dev,
-                   node_info->father_info,
-                   node_info->father_info->user_data);
-      solver->m2m_counter ++;
+      if (one_out || other_out) solver->p2p (one, other);
     }
+  else if (one_out)
+    solver->p2p_one_way (other, one);
+  else if (other_out)
+    solver->p2p_one_way (one, other);
 }
 
-static void down_func (const VsgPRTree3dNodeInfo *node_info,
-                       AranSolver3d *solver)
+/* near_func algorithm with particles roles */
+static gdouble _near_roles (AranSolver3d *solver,
+                            const VsgPRTree3dNodeInfo *one_info,
+                            const VsgPRTree3dNodeInfo *other_info,
+                            AranStatsBlock *block)
 {
-  gpointer node_dev = node_info->user_data;
+  gboolean reflexive =
+    vsg_prtree_key3d_equals (&one_info->id, &other_info->id);
+  GSList *one_list = one_info->point_list;
+  guint depth = MAX (one_info->depth, other_info->depth);
+  glong count = 0;
+  gdouble t0;
 
-#ifdef VSG_HAVE_MPI
-  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
-#endif
+  if (_near_pruned (solver, one_info, other_info)) return 0.;
 
-  if (solver->l2l != NULL && node_info->point_count != 0 &&
-      node_info->father_info)
-    {
-      /* Local to Local translation */
-      solver->l2l (node_info->father_info,
-                   node_info->father_info->user_data,
-                   node_info,
-                   node_dev);
-      solver->l2l_counter ++;
-    }
+  t0 = ARAN_STATS_BLOCK_TIME (block);
 
-  if ((node_info->isleaf))
+  while (one_list)
     {
-      if (solver->l2p != NULL)
-        {
-          GSList *node_list = node_info->point_list;
+      VsgPoint3 one_point = (VsgPoint3) one_list->data;
+      AranParticleRole one_role = solver->role (one_point);
+      GSList *other_list =
+        reflexive ? one_list : other_info->point_list;
 
-          while (node_list)
-            {
-              VsgPoint3 node_point = (VsgPoint3) node_list->data;
+      while (other_list)
+	{
+	  VsgPoint3 other_point = (VsgPoint3) other_list->data;
 
-              /* Local to Particle distribution */
-              solver->l2p (node_info, node_dev, node_point);
-              solver->l2p_counter ++;
+	  _p2p_roles (solver, one_point, one_role,
+                      other_point, solver->role (other_point));
+          count ++;
 
-              node_list = node_list->next;
-            }
-        }
+	  other_list = other_list->next;
+	}
+
+      one_list = one_list->next;
     }
-}
 
+  t0 = ARAN_STATS_BLOCK_TIME (block) - t0;
+  ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_P2P, depth, count, t0);
 
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (one_info) ||
+      VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (other_info))
+    ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_P2P_REMOTE, depth, count, 0.);
 
-/* public functions */
+  return t0;
+}
 
-/**
- * aran_solver3d_new:
- * @prtree: a #VsgPRTree3d.
- * @devel_type: #GType of development to be used by the solver.
- * @devel: instance of type @devel_type for cloning.
- * @zero: @devel_type zeroing function.
- *
+static void near_func_roles (const VsgPRTree3dNodeInfo *one_info,
+                             const VsgPRTree3dNodeInfo *other_info,
+                             AranSolver3d *solver)
+{
+  _pair_cost_add (solver, one_info, other_info,
+                  _near_roles (solver, one_info, other_info,
+                               _SOLVER3D_STATS_BLOCK (solver)));
+}
+
+
+static void nop_far_func (const VsgPRTree3dNodeInfo *one_info,
+                          const VsgPRTree3dNodeInfo *other_info,
+                          AranSolver3d *solver)
+{
+}
+
+static gdouble _far (AranSolver3d *solver,
+                     const VsgPRTree3dNodeInfo *one_info,
+                     const VsgPRTree3dNodeInfo *other_info,
+                     AranStatsBlock *block)
+{
+  /* Multipole to Local transformation */
+  if (solver->m2l != NULL)
+    {
+      gpointer one_dev = one_info->user_data;
+      gpointer other_dev = other_info->user_data;
+      guint depth = MAX (one_info->depth, other_info->depth);
+      gdouble t0 = ARAN_STATS_BLOCK_TIME (block);
+      glong count = 0;
+
+      /* both ways in order to get symmetric exchange */
+      if (_node_has_role (one_info, solver->source_nodes) &&
+          _node_has_role (other_info, solver->target_nodes) &&
+          ! _far_pruned (solver, one_info, other_info))
+        {
+          solver->m2l (one_info, one_dev, other_info, other_dev);
+          count ++;
+        }
+
+      if (_node_has_role (other_info, solver->source_nodes) &&
+          _node_has_role (one_info, solver->target_nodes) &&
+          ! _far_pruned (solver, other_info, one_info))
+        {
+          solver->m2l (other_info, other_dev, one_info, one_dev);
+          count ++;
+        }
+
+      t0 = ARAN_STATS_BLOCK_TIME (block) - t0;
+      ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_M2L, depth, count, t0);
+
+      if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (one_info) ||
+          VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (other_info))
+        ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_M2L_REMOTE, depth, count, 0.);
+
+      return t0;
+    }
+
+  return 0.;
+}
+
+static void far_func (const VsgPRTree3dNodeInfo *one_info,
+                      const VsgPRTree3dNodeInfo *other_info,
+                      AranSolver3d *solver)
+{
+  _pair_cost_add (solver, one_info, other_info,
+                  _far (solver, one_info, other_info,
+                        _SOLVER3D_STATS_BLOCK (solver)));
+}
+
+
+/* @leaf_info particles to @info local development (if @p2l) and @info
+ * multipole to @leaf_info particles (if @m2p). Returns the time spent */
+static gdouble _semifar (AranSolver3d *solver,
+                         const VsgPRTree3dNodeInfo *leaf_info,
+                         const VsgPRTree3dNodeInfo *info,
+                         gboolean p2l, gboolean m2p, AranStatsBlock *block)
+{
+  GSList *list;
+  gpointer dev = info->user_data;
+  glong p2l_count = 0, m2p_count = 0;
+  gdouble t0, p2l_time = 0., m2p_time = 0.;
+
+  /* g_printerr ("semifar leaf[%#lx %#lx %#lx %d] node[%#lx %#lx %#lx %d]\n", */
+  /*             leaf_info->id.x, leaf_info->id.y, leaf_info->id.z, leaf_info->depth, */
+  /*             info->id.x, info->id.y, info->id.z, info->depth); */
+
+  /* one timing per operator pass, not per particle */
+  if (p2l)
+    {
+      t0 = ARAN_STATS_BLOCK_TIME (block);
+
+      for (list = leaf_info->point_list; list; list = g_slist_next (list))
+        {
+          VsgPoint3 point = (VsgPoint3) list->data;
+
+          if (solver->role != NULL &&
+              ! (solver->role (point) & ARAN_PARTICLE_SOURCE)) continue;
+
+          if (solver->weight != NULL && solver->weight (point) == 0.)
+            continue;
+
+          solver->p2l (point, info, dev);
+          p2l_count ++;
+        }
+
+      p2l_time = ARAN_STATS_BLOCK_TIME (block) - t0;
+
+      ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_P2L, info->depth, p2l_count,
+                            p2l_time);
+    }
+
+  if (m2p && _node_weight (solver, info) != 0.)
+    {
+      t0 = ARAN_STATS_BLOCK_TIME (block);
+
+      for (list = leaf_info->point_list; list; list = g_slist_next (list))
+        {
+          VsgPoint3 point = (VsgPoint3) list->data;
+
+          if (solver->role != NULL &&
+              ! (solver->role (point) & ARAN_PARTICLE_TARGET)) continue;
+
+          solver->m2p (info, dev, point);
+          m2p_count ++;
+        }
+
+      m2p_time = ARAN_STATS_BLOCK_TIME (block) - t0;
+
+      ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_M2P, info->depth, m2p_count,
+                            m2p_time);
+    }
+
+  return p2l_time + m2p_time;
+}
+
+static void semifar_func (const VsgPRTree3dNodeInfo *one_info,
+                          const VsgPRTree3dNodeInfo *other_info,
+                          AranSolver3d *solver)
+{
+  AranStatsBlock *block = _SOLVER3D_STATS_BLOCK (solver);
+
+  /* the leaf is the biggest node */
+  if (one_info->depth > other_info->depth)
+    _pair_cost_add (solver, other_info, one_info,
+                    _semifar (solver, other_info, one_info, TRUE, TRUE,
+                              block));
+  else
+    _pair_cost_add (solver, one_info, other_info,
+                    _semifar (solver, one_info, other_info, TRUE, TRUE,
+                              block));
+}
+
+
+#ifdef VSG_HAVE_MPI
+/*
+ * Pipelined solve: shared nodes multipoles are summed with a non blocking
+ * reduction while the near/far traversal proceeds. Interactions that need
+ * a complete shared multipole are either deferred (local pairs) or wait for
+ * the reduction to complete (pairs with a remote node, since remote copies
+ * are only valid during the visit).
+ */
+typedef struct _DeferredNode DeferredNode;
+
+/* the node info fields used by far interactions: point and region lists or
+ * father info only stay valid during the traversal visit */
+struct _DeferredNode {
+  VsgVector3d center;
+  VsgVector3d lbound;
+  VsgVector3d ubound;
+  guint point_count;
+  guint region_count;
+  gboolean isleaf;
+  gpointer user_data;
+  VsgPRTreeKey3d id;
+  guint8 depth;
+  VsgParallelStatus parallel_status;
+};
+
+typedef struct _DeferredFar DeferredFar;
+
+struct _DeferredFar {
+  DeferredNode one;
+  DeferredNode other;
+};
+
+static void _deferred_node_set (DeferredNode *dn,
+                                const VsgPRTree3dNodeInfo *info)
+{
+  dn->center = info->center;
+  dn->lbound = info->lbound;
+  dn->ubound = info->ubound;
+  dn->point_count = info->point_count;
+  dn->region_count = info->region_count;
+  dn->isleaf = info->isleaf;
+  dn->user_data = info->user_data;
+  dn->id = info->id;
+  dn->depth = info->depth;
+  dn->parallel_status = info->parallel_status;
+}
+
+static void _deferred_node_info (const DeferredNode *dn,
+                                 VsgPRTree3dNodeInfo *info)
+{
+  memset (info, 0, sizeof (VsgPRTree3dNodeInfo));
+
+  info->center = dn->center;
+  info->lbound = dn->lbound;
+  info->ubound = dn->ubound;
+  info->point_count = dn->point_count;
+  info->region_count = dn->region_count;
+  info->isleaf = dn->isleaf;
+  info->user_data = dn->user_data;
+  info->id = dn->id;
+  info->depth = dn->depth;
+  info->parallel_status = dn->parallel_status;
+}
+
+static void pipelined_near_func (const VsgPRTree3dNodeInfo *one_info,
+                                 const VsgPRTree3dNodeInfo *other_info,
+                                 AranSolver3d *solver)
+{
+  aran_shared_reduce_test (solver->shared_reduce);
+
+  solver->pipeline_near (one_info, other_info, solver);
+}
+
+static void pipelined_far_func (const VsgPRTree3dNodeInfo *one_info,
+                                const VsgPRTree3dNodeInfo *other_info,
+                                AranSolver3d *solver)
+{
+  if (! aran_shared_reduce_test (solver->shared_reduce) &&
+      (VSG_PRTREE3D_NODE_INFO_IS_SHARED (one_info) ||
+       VSG_PRTREE3D_NODE_INFO_IS_SHARED (other_info)))
+    {
+      if (! VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (one_info) &&
+          ! VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (other_info))
+        {
+          DeferredFar df;
+
+          _deferred_node_set (&df.one, one_info);
+          _deferred_node_set (&df.other, other_info);
+
+          g_array_append_val (solver->deferred_far, df);
+          return;
+        }
+
+      aran_shared_reduce_wait (solver->shared_reduce);
+    }
+
+  solver->pipeline_far (one_info, other_info, solver);
+}
+
+static void pipelined_semifar_func (const VsgPRTree3dNodeInfo *one_info,
+                                    const VsgPRTree3dNodeInfo *other_info,
+                                    AranSolver3d *solver)
+{
+  if (VSG_PRTREE3D_NODE_INFO_IS_SHARED (one_info) ||
+      VSG_PRTREE3D_NODE_INFO_IS_SHARED (other_info))
+    aran_shared_reduce_wait (solver->shared_reduce);
+
+  solver->pipeline_semifar (one_info, other_info, solver);
+}
+
+static void shared_add_func (const VsgPRTree3dNodeInfo *node_info,
+                             AranSolver3d *solver)
+{
+  if (VSG_PRTREE3D_NODE_INFO_IS_SHARED (node_info))
+    aran_shared_reduce_add (solver->shared_reduce, node_info->user_data);
+}
+
+/*
+ * Node data migration wrappers: between two solves, expansions are about
+ * to be cleared, so only the tree structure needs to move.
+ */
+static void _node_migrate_pack (gpointer node_data, VsgPackedMsg *pm,
+                                AranSolver3d *solver)
+{
+  if (solver->migrate_structure && ! solver->solving) return;
+
+  solver->node_migrate.pack (node_data, pm, solver->node_migrate.pack_data);
+}
+
+static void _node_migrate_unpack (gpointer node_data, VsgPackedMsg *pm,
+                                  AranSolver3d *solver)
+{
+  if (solver->migrate_structure && ! solver->solving)
+    {
+      solver->zero (node_data);
+      return;
+    }
+
+  solver->node_migrate.unpack (node_data, pm,
+                               solver->node_migrate.unpack_data);
+}
+
+/*
+ * Cost balanced distribution. Private subtrees hanging from shared nodes
+ * (or the root) appear in the same order on every processor, so that their
+ * costs can be summed with an allreduce in order to place every local leaf
+ * along the space filling curve.
+ */
+typedef struct _CostDistData CostDistData;
+
+struct _CostDistData {
+  AranSolver3d *solver;
+  gboolean measured;
+  gint root;          /* index of the current private subtree */
+  gboolean local;     /* whether the current private subtree is local */
+  GArray *roots_cost; /* gdouble, local cost of each private subtree */
+  GArray *leaves;     /* NodeCost: cost of each local leaf */
+  GArray *leaves_root; /* gint: private subtree of each local leaf */
+  GHashTable *dest;
+};
+
+static void _reset_np (gpointer key, NodeCost *nc, gpointer data)
+{
+  nc->np = 0.;
+  nc->rate = 0.;
+}
+
+static void _cost_np_func (const VsgPRTree3dNodeInfo *node_info,
+                           CostDistData *cdd)
+{
+  GHashTable *costs = cdd->solver->node_costs;
+  NodeCost *nc;
+
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
+
+  nc = _node_cost_get (costs, node_info);
+
+  if (node_info->isleaf)
+    nc->np += node_info->point_count;
+
+  if (node_info->father_info != NULL && nc->np > 0.)
+    _node_cost_get (costs, node_info->father_info)->np += nc->np;
+}
+
+static void _cost_leaves_func (const VsgPRTree3dNodeInfo *node_info,
+                               CostDistData *cdd)
+{
+  GHashTable *costs = cdd->solver->node_costs;
+  NodeCost *nc;
+  gdouble zero = 0.;
+
+  if (! VSG_PRTREE3D_NODE_INFO_IS_SHARED (node_info) &&
+      (node_info->father_info == NULL ||
+       VSG_PRTREE3D_NODE_INFO_IS_SHARED (node_info->father_info)))
+    {
+      /* a new private subtree starts here */
+      cdd->root = cdd->roots_cost->len;
+      cdd->local = ! VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info);
+      g_array_append_val (cdd->roots_cost, zero);
+    }
+
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
+
+  nc = _node_cost_get (costs, node_info);
+
+  if (node_info->father_info != NULL)
+    {
+      NodeCost *fc = _node_cost_get (costs, node_info->father_info);
+
+      if (fc->np > 0.)
+        nc->rate = fc->rate + fc->cost / fc->np;
+    }
+
+  if (node_info->isleaf && cdd->local &&
+      VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_LOCAL (node_info))
+    {
+      NodeCost leaf = *nc;
+
+      leaf.cost = cdd->measured ? nc->cost + nc->np * nc->rate :
+        node_info->point_count;
+
+      g_array_append_val (cdd->leaves, leaf);
+      g_array_append_val (cdd->leaves_root, cdd->root);
+      g_array_index (cdd->roots_cost, gdouble, cdd->root) += leaf.cost;
+    }
+}
+
+static gint _cost_dist (VsgPRTree3dNodeInfo *node_info, CostDistData *cdd)
+{
+  gpointer dst = g_hash_table_lookup (cdd->dest, &node_info->id);
+
+  if (dst != NULL) return GPOINTER_TO_INT (dst) - 1;
+
+  return node_info->parallel_status.proc;
+}
+
+static MPI_Comm _pipeline_communicator (AranSolver3d *solver)
+{
+  MPI_Comm comm = vsg_prtree3d_get_communicator (solver->prtree);
+
+  if (comm != solver->pipeline_base)
+    {
+      if (solver->pipeline_comm != MPI_COMM_NULL)
+        MPI_Comm_free (&solver->pipeline_comm);
+
+      /* private communicator: no interference with vsg's own messages */
+      MPI_Comm_dup (comm, &solver->pipeline_comm);
+      solver->pipeline_base = comm;
+    }
+
+  return solver->pipeline_comm;
+}
+#endif /* VSG_HAVE_MPI */
+
+static void _clear_node (const VsgPRTree3dNodeInfo *node_info,
+                         AranSolver3d *solver, AranStatsBlock *block)
+{
+  gpointer node_dev = node_info->user_data;
+  gdouble t0;
+
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
+#endif
+
+  t0 = ARAN_STATS_BLOCK_TIME (block);
+
+  if (solver->node_zero != NULL)
+    solver->node_zero (node_info, node_dev, solver->node_zero_data);
+  else
+    solver->zero (node_dev);
+
+  ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_ZERO, node_info->depth, 1,
+                        ARAN_STATS_BLOCK_TIME (block) - t0);
+}
+
+static void clear_func (const VsgPRTree3dNodeInfo *node_info,
+                        AranSolver3d *solver)
+{
+  _clear_node (node_info, solver, _SOLVER3D_STATS_BLOCK (solver));
+}
+
+/* gathers leaf particles into its multipole. Returns the time spent */
+static gdouble _up_p2m (const VsgPRTree3dNodeInfo *node_info,
+                        AranSolver3d *solver, AranStatsBlock *block)
+{
+  gpointer node_dev = node_info->user_data;
+  GSList *node_list = node_info->point_list;
+  glong count = 0;
+  gdouble node_weight = 0.;
+  gdouble t0;
+
+  t0 = ARAN_STATS_BLOCK_TIME (block);
+
+  while (node_list)
+    {
+      VsgPoint3 node_point = (VsgPoint3) node_list->data;
+      AranParticleRole role = (solver->role != NULL) ?
+        solver->role (node_point) : ARAN_PARTICLE_SOURCE_TARGET;
+      gdouble weight = (solver->weight != NULL && (role & ARAN_PARTICLE_SOURCE)) ?
+        solver->weight (node_point) : 0.;
+
+      node_weight += weight;
+
+      /* Particle to Multipole gathering */
+      if (solver->p2m != NULL && (role & ARAN_PARTICLE_SOURCE) &&
+          (solver->weight == NULL || weight != 0.))
+        {
+          solver->p2m (node_point, node_info, node_dev);
+          count ++;
+        }
+
+      node_list = node_list->next;
+    }
+
+  t0 = ARAN_STATS_BLOCK_TIME (block) - t0;
+  ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_P2M, node_info->depth,
+                        count, t0);
+
+  _node_weight_add (solver, node_info, node_weight);
+
+  return t0;
+}
+
+/* translates @node_info multipole into its father's. Returns the time
+ * spent */
+static gdouble _up_m2m (const VsgPRTree3dNodeInfo *node_info,
+                        AranSolver3d *solver, AranStatsBlock *block)
+{
+  gdouble t0;
+
+  if (solver->m2m == NULL || node_info->point_count == 0 ||
+      node_info->father_info == NULL ||
+      ! _node_has_role (node_info, solver->source_nodes) ||
+      _node_weight (solver, node_info) == 0.)
+    return 0.;
+
+  t0 = ARAN_STATS_BLOCK_TIME (block);
+
+  /* Multipole to Multipole translation */
+  solver->m2m (node_info,
+               node_info->user_data,
+               node_info->father_info,
+               node_info->father_info->user_data);
+
+  t0 = ARAN_STATS_BLOCK_TIME (block) - t0;
+  ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_M2M, node_info->depth, 1, t0);
+
+  return t0;
+}
+
+/* registers the nodes holding sources and targets, before the upward pass
+ * which then only reads the roles sets */
+static void roles_func (const VsgPRTree3dNodeInfo *node_info,
+                        AranSolver3d *solver)
+{
+  GSList *node_list = node_info->point_list;
+  AranParticleRole node_role = 0;
+
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
+#endif
+
+  if (node_info->isleaf)
+    {
+      while (node_list)
+        {
+          node_role |= solver->role ((VsgPoint3) node_list->data);
+          node_list = node_list->next;
+        }
+
+      if (node_role & ARAN_PARTICLE_SOURCE)
+        _node_set_insert (solver->source_nodes, node_info);
+      if (node_role & ARAN_PARTICLE_TARGET)
+        _node_set_insert (solver->target_nodes, node_info);
+    }
+
+  if (node_info->father_info != NULL)
+    {
+      /* propagate roles towards the root */
+      if (_node_has_role (node_info, solver->source_nodes))
+        _node_set_insert (solver->source_nodes, node_info->father_info);
+      if (_node_has_role (node_info, solver->target_nodes))
+        _node_set_insert (solver->target_nodes, node_info->father_info);
+    }
+}
+
+static void up_func (const VsgPRTree3dNodeInfo *node_info,
+                     AranSolver3d *solver)
+{
+  AranStatsBlock *block;
+  gdouble cost = 0.;
+
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
+#endif
+
+  block = _SOLVER3D_STATS_BLOCK (solver);
+
+  if (node_info->isleaf)
+    cost += _up_p2m (node_info, solver, block);
+
+  /* propagate source weights towards the root */
+  _node_weight_add (solver, node_info->father_info,
+                    _node_weight (solver, node_info));
+
+  cost += _up_m2m (node_info, solver, block);
+
+  _node_cost_add (solver, node_info, cost);
+}
+
+/* evaluates @leaf_info local development at its particles. Returns the
+ * time spent */
+static gdouble _down_l2p (const VsgPRTree3dNodeInfo *leaf_info,
+                          AranSolver3d *solver, AranStatsBlock *block,
+                          gboolean prepare)
+{
+  gpointer node_dev = leaf_info->user_data;
+  GSList *node_list = leaf_info->point_list;
+  glong count = 0;
+  gdouble t0;
+
+  if (solver->l2p == NULL) return 0.;
+
+  t0 = ARAN_STATS_BLOCK_TIME (block);
+
+  if (prepare && solver->leaf_prepare != NULL && node_list != NULL)
+    solver->leaf_prepare (leaf_info, node_dev, solver->leaf_prepare_data);
+
+  while (node_list)
+    {
+      VsgPoint3 node_point = (VsgPoint3) node_list->data;
+
+      /* Local to Particle distribution */
+      if (solver->role == NULL ||
+          (solver->role (node_point) & ARAN_PARTICLE_TARGET))
+        {
+          solver->l2p (leaf_info, node_dev, node_point);
+          count ++;
+        }
+
+      node_list = node_list->next;
+    }
+
+  t0 = ARAN_STATS_BLOCK_TIME (block) - t0;
+  ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_L2P, leaf_info->depth, count, t0);
+
+  return t0;
+}
+
+/* distributes @node_info local development to its particles. Returns the
+ * time spent */
+static gdouble _down_node (const VsgPRTree3dNodeInfo *node_info,
+                           AranSolver3d *solver, AranStatsBlock *block)
+{
+  gpointer node_dev = node_info->user_data;
+  gdouble cost = 0.;
+  gdouble t0;
+
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return 0.;
+#endif
+
+  /* nothing to distribute in subtrees without targets */
+  if (! _node_has_role (node_info, solver->target_nodes)) return 0.;
+
+  if (solver->l2l != NULL && node_info->point_count != 0 &&
+      node_info->father_info)
+    {
+      t0 = ARAN_STATS_BLOCK_TIME (block);
+
+      /* Local to Local translation */
+      solver->l2l (node_info->father_info,
+                   node_info->father_info->user_data,
+                   node_info,
+                   node_dev);
+
+      t0 = ARAN_STATS_BLOCK_TIME (block) - t0;
+      ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_L2L, node_info->depth, 1, t0);
+      cost += t0;
+    }
+
+  if ((node_info->isleaf))
+    cost += _down_l2p (node_info, solver, block, TRUE);
+
+  return cost;
+}
+
+static void down_func (const VsgPRTree3dNodeInfo *node_info,
+                       AranSolver3d *solver)
+{
+  gdouble cost = _down_node (node_info, solver,
+                             _SOLVER3D_STATS_BLOCK (solver));
+
+  _node_cost_add (solver, node_info, cost);
+}
+
+/*
+ * The tree is copied level by level into TaskNodes (vsg node infos only
+ * live during a traversal callback), with their father and children links.
+ * Threaded local passes hand every level to the workers. Upward, a node
+ * gathers the multipoles of its children so that no two threads write the
+ * same development. Downward, a node reads its father's local development,
+ * complete since the previous level. Periodic images and points evaluation
+ * walk the same copy.
+ */
+typedef struct _TaskNode TaskNode;
+
+struct _TaskNode
+{
+  VsgPRTree3dNodeInfo info;
+  TaskNode *children[8];
+  guint nchildren;
+  gdouble cost;
+  guint dev_round;    /* first near/far round free for the development */
+  guint points_round; /* and for the particles */
+};
+
+typedef struct _TaskTree TaskTree;
+
+struct _TaskTree
+{
+  GPtrArray *levels;
+  GPtrArray *last;
+};
+
+static void _task_tree_add (const VsgPRTree3dNodeInfo *node_info,
+                            TaskTree *tt)
+{
+  TaskNode *node = g_malloc (sizeof (TaskNode));
+  guint depth = node_info->depth;
+
+  node->info = *node_info;
+  node->nchildren = 0;
+  node->cost = 0.;
+  node->dev_round = 0;
+  node->points_round = 0;
+
+  /* pre-order: the father is the last node seen one level above */
+  if (node_info->father_info != NULL)
+    {
+      TaskNode *father = g_ptr_array_index (tt->last, depth-1);
+
+      node->info.father_info = &father->info;
+      father->children[father->nchildren ++] = node;
+    }
+
+  while (tt->levels->len <= depth)
+    {
+      g_ptr_array_add (tt->levels, g_ptr_array_new ());
+      g_ptr_array_add (tt->last, NULL);
+    }
+
+  g_ptr_array_add (g_ptr_array_index (tt->levels, depth), node);
+  g_ptr_array_index (tt->last, depth) = node;
+}
+
+static TaskTree *_task_tree_new (AranSolver3d *solver)
+{
+  TaskTree *tt = g_malloc (sizeof (TaskTree));
+
+  tt->levels = g_ptr_array_new ();
+  tt->last = g_ptr_array_new ();
+
+  vsg_prtree3d_traverse (solver->prtree, G_PRE_ORDER,
+                         (VsgPRTree3dFunc) _task_tree_add, tt);
+
+  return tt;
+}
+
+/* records the costs of the threaded passes into @solver (when not %NULL)
+ * and frees @tt */
+static void _task_tree_free (TaskTree *tt, AranSolver3d *solver)
+{
+  guint i, j;
+
+  for (i=0; i<tt->levels->len; i ++)
+    {
+      GPtrArray *level = g_ptr_array_index (tt->levels, i);
+
+      for (j=0; j<level->len; j ++)
+        {
+          TaskNode *node = g_ptr_array_index (level, j);
+
+          if (solver != NULL)
+            _node_cost_add (solver, &node->info, node->cost);
+
+          g_free (node);
+        }
+
+      g_ptr_array_free (level, TRUE);
+    }
+
+  g_ptr_array_free (tt->levels, TRUE);
+  g_ptr_array_free (tt->last, TRUE);
+  g_free (tt);
+}
+
+static void _clear_task (TaskNode *node, guint worker, AranSolver3d *solver)
+{
+  _clear_node (&node->info, solver, aran_stats_get_block (solver->stats,
+                                                          worker));
+}
+
+static void _up_task (TaskNode *node, guint worker, AranSolver3d *solver)
+{
+  AranStatsBlock *block = aran_stats_get_block (solver->stats, worker);
+  guint i;
+
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (&node->info)) return;
+#endif
+
+  if (node->info.isleaf)
+    node->cost += _up_p2m (&node->info, solver, block);
+
+  for (i=0; i<node->nchildren; i ++)
+    {
+      TaskNode *child = node->children[i];
+
+#ifdef VSG_HAVE_MPI
+      if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (&child->info)) continue;
+#endif
+
+      _node_weight_add (solver, &node->info,
+                        _node_weight (solver, &child->info));
+
+      child->cost += _up_m2m (&child->info, solver, block);
+    }
+}
+
+static void _down_task (TaskNode *node, guint worker, AranSolver3d *solver)
+{
+  node->cost += _down_node (&node->info, solver,
+                            aran_stats_get_block (solver->stats, worker));
+}
+
+static void _task_tree_foreach (TaskTree *tt, AranSolver3d *solver,
+                                GTraverseType order, AranWorkerFunc func)
+{
+  guint i, n = tt->levels->len;
+
+  for (i=0; i<n; i ++)
+    {
+      guint depth = (order == G_PRE_ORDER) ? i : n-1-i;
+
+      aran_workers_foreach (solver->workers,
+                            g_ptr_array_index (tt->levels, depth),
+                            func, solver);
+    }
+}
+
+/* tells if box [@alb, @aub] and box [@blb, @bub] translated by @shift (when
+ * not %NULL) share a face, an edge or a corner */
+static gboolean _box_touch (const VsgVector3d *alb, const VsgVector3d *aub,
+                            const VsgVector3d *blb, const VsgVector3d *bub,
+                            const VsgVector3d *shift)
+{
+  gdouble eps = 1.e-10 * MAX (aub->x - alb->x, bub->x - blb->x);
+  VsgVector3d lb = *blb, ub = *bub;
+
+  if (shift != NULL)
+    {
+      vsg_vector3d_add (&lb, shift, &lb);
+      vsg_vector3d_add (&ub, shift, &ub);
+
+      /* rounding errors of the translation */
+      eps += 1.e-14 * (fabs (shift->x) + fabs (shift->y) + fabs (shift->z));
+    }
+
+  return alb->x <= ub.x + eps && lb.x <= aub->x + eps &&
+    alb->y <= ub.y + eps && lb.y <= aub->y + eps &&
+    alb->z <= ub.z + eps && lb.z <= aub->z + eps;
+}
+
+/* tells if the near/far traversal stops at @info, a leaf or a virtual leaf
+ * (see aran_solver3d_set_nf_isleaf()) */
+static gboolean _nf_leaf (AranSolver3d *solver,
+                          const VsgPRTree3dNodeInfo *info)
+{
+  return info->isleaf ||
+    (solver->nf_isleaf != NULL &&
+     solver->nf_isleaf (info, solver->nf_isleaf_data));
+}
+
+/*
+ * Near/far traversal of the TaskTree, used for adaptive semifar
+ * interactions (see aran_solver3d_set_adaptive_semifar()), for the local
+ * essential tree and with threads. It mimics the vsg one: nodes of the same
+ * level that do not touch are far and the biggest node of a near pair is
+ * opened. A leaf bigger than an internal node it does not touch may instead
+ * interact with it through p2l/m2p (semifar), which is decided for each
+ * pair. Two near virtual leaves get the near interactions of all the leaves
+ * below them.
+ *
+ * With threads, the traversal only records the pairs. Each pair then gets
+ * the first round after the previous ones writing the same development or
+ * the same leaf particles, and rounds are run one after the other by the
+ * workers. Every development and particle thus receives its contributions
+ * in the traversal order, whatever the number of threads.
+ */
+typedef struct _NearFar NearFar;
+
+typedef void (*TaskPairFunc) (NearFar *nf, TaskNode *one, TaskNode *other);
+
+struct _NearFar {
+  AranSolver3d *solver;
+  TaskPairFunc far;
+  TaskPairFunc semifar; /* leaf first */
+  PairFunc near_func;   /* %NULL without p2p */
+  gboolean with_far;
+  gboolean with_semifar;
+  gboolean adaptive;
+  gdouble p2p_time;     /* both ways */
+  gdouble semifar_time; /* p2l + m2p */
+  GArray *pairs;        /* recorded pairs, with threads */
+};
+
+typedef enum {
+  TASK_PAIR_NEAR,
+  TASK_PAIR_FAR,
+  TASK_PAIR_SEMIFAR, /* leaf first */
+  TASK_PAIR_M2L      /* remote source first */
+} TaskPairKind;
+
+typedef struct _TaskPair TaskPair;
+
+struct _TaskPair {
+  TaskNode *one;
+  TaskNode *other;
+  TaskPairKind kind;
+  gboolean p2l, m2p; /* semifar sides */
+  guint round;
+  gdouble cost;
+};
+
+static void _near_far_init (NearFar *nf, AranSolver3d *solver,
+                            gboolean far, gboolean semifar)
+{
+  gdouble times[3] = {solver->p2p_time, solver->p2l_time, solver->m2p_time};
+
+#ifdef VSG_HAVE_MPI
+  /* decisions are to be consistent across all processors */
+  {
+    MPI_Comm communicator = vsg_prtree3d_get_communicator (solver->prtree);
+
+    if (communicator != MPI_COMM_NULL)
+      MPI_Allreduce (MPI_IN_PLACE, times, 3, MPI_DOUBLE, MPI_MAX,
+                     communicator);
+  }
+#endif
+
+  nf->solver = solver;
+  nf->near_func = (solver->p2p == NULL) ? NULL :
+    (solver->role != NULL) ? _near_roles : _near;
+  nf->with_far = far && solver->m2l != NULL;
+  nf->with_semifar = semifar && solver->p2l != NULL && solver->m2p != NULL;
+  nf->p2p_time = times[0];
+  nf->semifar_time = times[1] + times[2];
+
+  /* unprofiled operators fall back to semifar_threshold */
+  nf->adaptive = solver->adaptive_semifar && nf->with_semifar &&
+    times[0] > 0. && times[1] >= 0. && times[2] >= 0.;
+
+  nf->pairs = (solver->workers != NULL) ?
+    g_array_new (FALSE, FALSE, sizeof (TaskPair)) : NULL;
+}
+
+/* remote multipole to local development (local essential tree) */
+static gdouble _let_m2l (AranSolver3d *solver,
+                         const VsgPRTree3dNodeInfo *src,
+                         const VsgPRTree3dNodeInfo *dst,
+                         AranStatsBlock *block)
+{
+  gdouble t0;
+
+  if (solver->m2l == NULL ||
+      ! _node_has_role (dst, solver->target_nodes)) return 0.;
+
+  t0 = ARAN_STATS_BLOCK_TIME (block);
+
+  solver->m2l (src, src->user_data, dst, dst->user_data);
+
+  t0 = ARAN_STATS_BLOCK_TIME (block) - t0;
+  ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_M2L, dst->depth, 1, t0);
+  ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_M2L_REMOTE, dst->depth, 1, 0.);
+
+  return t0;
+}
+
+static void _pair_run (TaskPair *pair, NearFar *nf, AranStatsBlock *block)
+{
+  const VsgPRTree3dNodeInfo *one = &pair->one->info;
+  const VsgPRTree3dNodeInfo *other = &pair->other->info;
+
+  switch (pair->kind)
+    {
+    case TASK_PAIR_NEAR:
+      pair->cost = nf->near_func (nf->solver, one, other, block);
+      break;
+    case TASK_PAIR_FAR:
+      pair->cost = _far (nf->solver, one, other, block);
+      break;
+    case TASK_PAIR_SEMIFAR:
+      pair->cost = _semifar (nf->solver, one, other, pair->p2l, pair->m2p,
+                             block);
+      break;
+    case TASK_PAIR_M2L:
+      pair->cost = _let_m2l (nf->solver, one, other, block);
+      break;
+    }
+}
+
+/* runs the interaction of @one and @other, or records it with threads */
+static void _pair_add (NearFar *nf, TaskPairKind kind,
+                       TaskNode *one, TaskNode *other,
+                       gboolean p2l, gboolean m2p)
+{
+  TaskPair pair = {one, other, kind, p2l, m2p, 0, 0.};
+
+  if (nf->pairs != NULL)
+    {
+      g_array_append_val (nf->pairs, pair);
+      return;
+    }
+
+  _pair_run (&pair, nf, _SOLVER3D_STATS_BLOCK (nf->solver));
+  _pair_cost_add (nf->solver, &one->info, &other->info, pair.cost);
+}
+
+/* delays @pair after the previous writer of a data whose first free round
+ * is @round */
+static void _pair_round (TaskPair *pair, guint *round, guint *n)
+{
+  pair->round = MAX (pair->round, *round);
+  *n = MAX (*n, pair->round + 1);
+}
+
+static void _pair_task (TaskPair *pair, guint worker, NearFar *nf)
+{
+  _pair_run (pair, nf, aran_stats_get_block (nf->solver->stats, worker));
+}
+
+/* runs the pairs recorded by the traversal on the workers */
+static void _near_far_run (NearFar *nf)
+{
+  GPtrArray *rounds;
+  guint i, n = 0;
+
+  if (nf->pairs == NULL) return;
+
+  for (i=0; i<nf->pairs->len; i ++)
+    {
+      TaskPair *pair = &g_array_index (nf->pairs, TaskPair, i);
+      TaskNode *one = pair->one, *other = pair->other;
+
+      /* written data: particles for p2p and m2p, developments for m2l and
+       * p2l. Multipoles are only read */
+      switch (pair->kind)
+        {
+        case TASK_PAIR_NEAR:
+          _pair_round (pair, &one->points_round, &n);
+          _pair_round (pair, &other->points_round, &n);
+          one->points_round = other->points_round = pair->round + 1;
+          break;
+        case TASK_PAIR_FAR:
+          _pair_round (pair, &one->dev_round, &n);
+          _pair_round (pair, &other->dev_round, &n);
+          one->dev_round = other->dev_round = pair->round + 1;
+          break;
+        case TASK_PAIR_SEMIFAR:
+          if (pair->m2p) _pair_round (pair, &one->points_round, &n);
+          if (pair->p2l) _pair_round (pair, &other->dev_round, &n);
+          if (pair->m2p) one->points_round = pair->round + 1;
+          if (pair->p2l) other->dev_round = pair->round + 1;
+          break;
+        case TASK_PAIR_M2L:
+          _pair_round (pair, &other->dev_round, &n);
+          other->dev_round = pair->round + 1;
+          break;
+        }
+    }
+
+  rounds = g_ptr_array_new ();
+  for (i=0; i<n; i ++)
+    g_ptr_array_add (rounds, g_ptr_array_new ());
+
+  for (i=0; i<nf->pairs->len; i ++)
+    {
+      TaskPair *pair = &g_array_index (nf->pairs, TaskPair, i);
+
+      g_ptr_array_add (g_ptr_array_index (rounds, pair->round), pair);
+    }
+
+  for (i=0; i<n; i ++)
+    {
+      aran_workers_foreach (nf->solver->workers,
+                            g_ptr_array_index (rounds, i),
+                            (AranWorkerFunc) _pair_task, nf);
+      g_ptr_array_free (g_ptr_array_index (rounds, i), TRUE);
+    }
+
+  g_ptr_array_free (rounds, TRUE);
+
+  /* node costs are not shared with the workers */
+  for (i=0; i<nf->pairs->len; i ++)
+    {
+      TaskPair *pair = &g_array_index (nf->pairs, TaskPair, i);
+
+      _pair_cost_add (nf->solver, &pair->one->info, &pair->other->info,
+                      pair->cost);
+    }
+
+  g_array_free (nf->pairs, TRUE);
+  nf->pairs = NULL;
+}
+
+static void _task_far (NearFar *nf, TaskNode *one, TaskNode *other)
+{
+  if (nf->with_far)
+    _pair_add (nf, TASK_PAIR_FAR, one, other, TRUE, TRUE);
+}
+
+static void _task_semifar (NearFar *nf, TaskNode *leaf, TaskNode *node)
+{
+  _pair_add (nf, TASK_PAIR_SEMIFAR, leaf, node, TRUE, TRUE);
+}
+
+/* tells if @one/@other interactions are computed on two processors */
+static gboolean _pair_remote (const VsgPRTree3dNodeInfo *one,
+                              const VsgPRTree3dNodeInfo *other)
+{
+#ifdef VSG_HAVE_MPI
+  return VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (one) ||
+    VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (other);
+#else
+  return FALSE;
+#endif
+}
+
+/* estimated cost of the best interaction between @leaf and @node
+ * particles. @semifar tells if it is reached by a semifar interaction */
+static gdouble _pair_cost (NearFar *nf, TaskNode *leaf, TaskNode *node,
+                           gboolean *semifar)
+{
+  gdouble nl = leaf->info.point_count;
+  gdouble cost, semifar_cost;
+  gboolean child_semifar;
+  guint i;
+
+  *semifar = FALSE;
+
+  if (node->info.isleaf)
+    {
+      cost = nl * node->info.point_count * nf->p2p_time;
+
+      /* p2p is done by each processor, semifar one way on each */
+      return _pair_remote (&leaf->info, &node->info) ? 2. * cost : cost;
+    }
+
+  /* particles of @leaf may lie next to a touching @node: p2l/m2p would
+   * not converge */
+  semifar_cost = _box_touch (&leaf->info.lbound, &leaf->info.ubound,
+                             &node->info.lbound, &node->info.ubound, NULL) ?
+    G_MAXDOUBLE : nl * nf->semifar_time;
+
+  cost = 0.;
+  for (i=0; i<node->nchildren && cost < semifar_cost; i ++)
+    cost += _pair_cost (nf, leaf, node->children[i], &child_semifar);
+
+  if (semifar_cost < cost)
+    {
+      *semifar = TRUE;
+      return semifar_cost;
+    }
+
+  return cost;
+}
+
+/* tells if @leaf and the smaller internal @node are to interact by semifar
+ * rather than by opening @node */
+static gboolean _pair_semifar (NearFar *nf, TaskNode *leaf, TaskNode *node)
+{
+  gboolean semifar;
+
+  if (! nf->with_semifar || leaf->info.point_count == 0 ||
+      node->info.point_count == 0)
+    return FALSE;
+
+#ifdef VSG_HAVE_MPI
+  /* shared nodes are not known the same way on every processor */
+  if (VSG_PRTREE3D_NODE_INFO_IS_SHARED (&leaf->info) ||
+      VSG_PRTREE3D_NODE_INFO_IS_SHARED (&node->info))
+    return FALSE;
+#endif
+
+  if (_box_touch (&leaf->info.lbound, &leaf->info.ubound,
+                  &node->info.lbound, &node->info.ubound, NULL))
+    return FALSE;
+
+  if (! nf->adaptive)
+    return node->info.point_count > nf->solver->semifar_threshold;
+
+  _pair_cost (nf, leaf, node, &semifar);
+
+  return semifar;
+}
+
+/* near interactions of the leaves below @one and @other */
+static void _task_near (NearFar *nf, TaskNode *one, TaskNode *other)
+{
+  guint i, j;
+
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (&one->info) &&
+      VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (&other->info)) return;
+#endif
+
+  if (one == other && ! one->info.isleaf)
+    {
+      for (i=0; i<one->nchildren; i ++)
+        for (j=i; j<one->nchildren; j ++)
+          _task_near (nf, one->children[i], one->children[j]);
+    }
+  else if (one->info.isleaf && other->info.isleaf)
+    {
+      if (nf->near_func != NULL)
+        _pair_add (nf, TASK_PAIR_NEAR, one, other, FALSE, FALSE);
+    }
+  else if (! one->info.isleaf)
+    {
+      g_assert (one->nchildren > 0);
+
+      for (i=0; i<one->nchildren; i ++)
+        _task_near (nf, one->children[i], other);
+    }
+  else
+    {
+      g_assert (other->nchildren > 0);
+
+      for (i=0; i<other->nchildren; i ++)
+        _task_near (nf, one, other->children[i]);
+    }
+}
+
+static void _task_near_far (NearFar *nf, TaskNode *one, TaskNode *other)
+{
+  gboolean one_leaf, other_leaf;
+  guint i, j;
+
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (&one->info) &&
+      VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (&other->info)) return;
+#endif
+
+  one_leaf = _nf_leaf (nf->solver, &one->info);
+
+  if (one == other)
+    {
+      if (one_leaf)
+        _task_near (nf, one, one);
+      else
+        for (i=0; i<one->nchildren; i ++)
+          for (j=i; j<one->nchildren; j ++)
+            _task_near_far (nf, one->children[i], one->children[j]);
+
+      return;
+    }
+
+  if (one->info.depth == other->info.depth &&
+      ! _box_touch (&one->info.lbound, &one->info.ubound,
+                    &other->info.lbound, &other->info.ubound, NULL))
+    {
+      nf->far (nf, one, other);
+      return;
+    }
+
+  other_leaf = _nf_leaf (nf->solver, &other->info);
+
+  if (one_leaf && other_leaf)
+    {
+      _task_near (nf, one, other);
+      return;
+    }
+
+  if (one->info.isleaf && one->info.depth < other->info.depth &&
+      _pair_semifar (nf, one, other))
+    {
+      nf->semifar (nf, one, other);
+      return;
+    }
+
+  if (other->info.isleaf && other->info.depth < one->info.depth &&
+      _pair_semifar (nf, other, one))
+    {
+      nf->semifar (nf, other, one);
+      return;
+    }
+
+  /* open the biggest node. Closed nodes of the local essential tree have
+   * no children and are never to be opened */
+  if (! one_leaf && (other_leaf || one->info.depth <= other->info.depth))
+    {
+      g_assert (one->nchildren > 0);
+
+      for (i=0; i<one->nchildren; i ++)
+        _task_near_far (nf, one->children[i], other);
+    }
+  else
+    {
+      g_assert (other->nchildren > 0);
+
+      for (i=0; i<other->nchildren; i ++)
+        _task_near_far (nf, one, other->children[i]);
+    }
+}
+
+static void _task_near_far_roots (NearFar *nf, TaskTree *tt)
+{
+  guint i;
+
+  if (tt->levels->len > 0)
+    {
+      GPtrArray *level = g_ptr_array_index (tt->levels, 0);
+
+      for (i=0; i<level->len; i ++)
+        _task_near_far (nf, g_ptr_array_index (level, i),
+                        g_ptr_array_index (level, i));
+    }
+}
+
+static void _task_near_far_solve (AranSolver3d *solver, TaskTree *tt,
+                                  gboolean far, gboolean semifar)
+{
+  NearFar nf;
+
+  _near_far_init (&nf, solver, far, semifar);
+  nf.far = _task_far;
+  nf.semifar = _task_semifar;
+
+  _task_near_far_roots (&nf, tt);
+  _near_far_run (&nf);
+}
+
+#ifdef VSG_HAVE_MPI
+/*
+ * Local essential tree exchange (see aran_solver3d_set_let()). Every
+ * processor publishes, level by level, the bounding box of its local and
+ * shared nodes and the one of its local leaves. Each other processor sends
+ * it its private subtrees in one message, every node with its multipole.
+ * A node that does not touch the nodes box of its level is closed, other
+ * ones are opened and leaves carry their particles. A node touching a
+ * leaf of the same level or above is opened down to the leaves. Received
+ * subtrees are grafted under the remote placeholders of the TaskTree and
+ * the near/far traversal then runs without any communication, interactions
+ * being accumulated into local nodes only.
+ */
+#define LET_TAG (0x4154)
+
+#define LET_OPEN (1<<0)
+#define LET_LEAF (1<<1)
+
+/* per level region boxes: nodes lbound/ubound, leaves lbound/ubound */
+#define LET_REGION_SIZE (4)
+
+typedef struct _LetData LetData;
+
+struct _LetData {
+  NearFar nf;
+  AranSolver3d *solver;
+  VsgPRTreeParallelConfig pc;
+  gint rk;
+  GHashTable *placeholders;
+  GPtrArray *nodes;   /* received nodes */
+  GPtrArray *devs;    /* received multipoles */
+  GPtrArray *points;  /* received particles */
+};
+
+static void _box_extend (VsgVector3d *box, const VsgPRTree3dNodeInfo *info)
+{
+  box[0].x = MIN (box[0].x, info->lbound.x);
+  box[0].y = MIN (box[0].y, info->lbound.y);
+  box[0].z = MIN (box[0].z, info->lbound.z);
+  box[1].x = MAX (box[1].x, info->ubound.x);
+  box[1].y = MAX (box[1].y, info->ubound.y);
+  box[1].z = MAX (box[1].z, info->ubound.z);
+}
+
+static void _let_region (AranSolver3d *solver, TaskTree *tt, guint nlev,
+                         VsgVector3d *region)
+{
+  guint i, j;
+
+  for (i=0; i<nlev * LET_REGION_SIZE; i += 2)
+    {
+      vsg_vector3d_set (&region[i], G_MAXDOUBLE, G_MAXDOUBLE, G_MAXDOUBLE);
+      vsg_vector3d_set (&region[i+1], -G_MAXDOUBLE, -G_MAXDOUBLE,
+                        -G_MAXDOUBLE);
+    }
+
+  for (i=0; i<tt->levels->len; i ++)
+    {
+      GPtrArray *level = g_ptr_array_index (tt->levels, i);
+
+      for (j=0; j<level->len; j ++)
+        {
+          TaskNode *node = g_ptr_array_index (level, j);
+          VsgVector3d *box = &region[i * LET_REGION_SIZE];
+
+          if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (&node->info)) continue;
+
+          _box_extend (box, &node->info);
+          if (_nf_leaf (solver, &node->info)) _box_extend (box+2, &node->info);
+        }
+    }
+
+  /* leaves also count for deeper levels */
+  for (i=1; i<nlev; i ++)
+    {
+      VsgVector3d *box = &region[i * LET_REGION_SIZE];
+
+      vsg_vector3d_set (&box[2], MIN (box[2].x, box[2-LET_REGION_SIZE].x),
+                        MIN (box[2].y, box[2-LET_REGION_SIZE].y),
+                        MIN (box[2].z, box[2-LET_REGION_SIZE].z));
+      vsg_vector3d_set (&box[3], MAX (box[3].x, box[3-LET_REGION_SIZE].x),
+                        MAX (box[3].y, box[3-LET_REGION_SIZE].y),
+                        MAX (box[3].z, box[3-LET_REGION_SIZE].z));
+    }
+}
+
+static void _let_pack (LetData *ld, TaskNode *node, const VsgVector3d *region,
+                       gboolean open, VsgPackedMsg *pm)
+{
+  VsgParallelMigrateVTable *nfw = &ld->pc.node_data.visit_forward;
+  VsgParallelMigrateVTable *pfw = &ld->pc.point.visit_forward;
+  const VsgVector3d *box = &region[node->info.depth * LET_REGION_SIZE];
+  gint depth = node->info.depth;
+  gint count = node->info.point_count;
+  gint flags = 0;
+  gint i, n;
+
+  /* particles near a leaf of the receiver go to it whatever their depth */
+  if (! open)
+    open = _box_touch (&node->info.lbound, &node->info.ubound,
+                       &box[2], &box[3], NULL);
+
+  if (open || _box_touch (&node->info.lbound, &node->info.ubound,
+                          &box[0], &box[1], NULL))
+    flags |= LET_OPEN;
+
+  if (node->info.isleaf) flags |= LET_LEAF;
+
+  vsg_packed_msg_send_append (pm, &node->info.id, sizeof (VsgPRTreeKey3d),
+                              MPI_BYTE);
+  vsg_packed_msg_send_append (pm, &depth, 1, MPI_INT);
+  vsg_packed_msg_send_append (pm, &node->info.center, 1,
+                              VSG_MPI_TYPE_VECTOR3D);
+  vsg_packed_msg_send_append (pm, &node->info.lbound, 1,
+                              VSG_MPI_TYPE_VECTOR3D);
+  vsg_packed_msg_send_append (pm, &node->info.ubound, 1,
+                              VSG_MPI_TYPE_VECTOR3D);
+  vsg_packed_msg_send_append (pm, &flags, 1, MPI_INT);
+  vsg_packed_msg_send_append (pm, &count, 1, MPI_INT);
+
+  nfw->pack (node->info.user_data, pm, nfw->pack_data);
+
+  if (! (flags & LET_OPEN)) return;
+
+  if (flags & LET_LEAF)
+    {
+      GSList *list = node->info.point_list;
+
+      n = node->info.point_count;
+      vsg_packed_msg_send_append (pm, &n, 1, MPI_INT);
+
+      for (; list != NULL; list = g_slist_next (list))
+        pfw->pack (list->data, pm, pfw->pack_data);
+    }
+  else
+    {
+      n = node->nchildren;
+      vsg_packed_msg_send_append (pm, &n, 1, MPI_INT);
+
+      for (i=0; i<n; i ++)
+        _let_pack (ld, node->children[i], region, open, pm);
+    }
+}
+
+static void _let_unpack (LetData *ld, TaskNode *father, gint src,
+                         VsgPackedMsg *pm)
+{
+  VsgParallelMigrateVTable *nfw = &ld->pc.node_data.visit_forward;
+  VsgParallelMigrateVTable *pfw = &ld->pc.point.visit_forward;
+  TaskNode *node = NULL;
+  VsgPRTreeKey3d id;
+  gint depth, flags, count, i, n;
+
+  vsg_packed_msg_recv_read (pm, &id, sizeof (VsgPRTreeKey3d), MPI_BYTE);
+
+  /* subtree roots replace their placeholder, only once */
+  if (father == NULL)
+    {
+      node = g_hash_table_lookup (ld->placeholders, &id);
+
+      if (node != NULL)
+        g_hash_table_remove (ld->placeholders, &id);
+      else
+        g_critical ("local essential tree: no placeholder for a subtree "
+                    "of processor %d", src);
+    }
+
+  if (node == NULL)
+    {
+      node = g_malloc0 (sizeof (TaskNode));
+      g_ptr_array_add (ld->nodes, node);
+    }
+
+  node->info.id = id;
+  vsg_packed_msg_recv_read (pm, &depth, 1, MPI_INT);
+  node->info.depth = depth;
+  vsg_packed_msg_recv_read (pm, &node->info.center, 1, VSG_MPI_TYPE_VECTOR3D);
+  vsg_packed_msg_recv_read (pm, &node->info.lbound, 1, VSG_MPI_TYPE_VECTOR3D);
+  vsg_packed_msg_recv_read (pm, &node->info.ubound, 1, VSG_MPI_TYPE_VECTOR3D);
+  vsg_packed_msg_recv_read (pm, &flags, 1, MPI_INT);
+  vsg_packed_msg_recv_read (pm, &count, 1, MPI_INT);
+
+  /* closed nodes are internal nodes without children */
+  node->info.isleaf = (flags & LET_OPEN) && (flags & LET_LEAF);
+  node->info.point_list = NULL;
+  node->info.point_count = count; /* for semifar decisions */
+  node->info.region_list = NULL;
+  node->info.region_count = 0;
+  node->info.parallel_status.storage = VSG_PARALLEL_REMOTE;
+  node->info.parallel_status.proc = src;
+  node->nchildren = 0;
+
+  if (father != NULL)
+    {
+      node->info.father_info = &father->info;
+      father->children[father->nchildren ++] = node;
+    }
+
+  node->info.user_data = ld->pc.node_data.alloc (FALSE,
+                                                 ld->pc.node_data.alloc_data);
+  nfw->unpack (node->info.user_data, pm, nfw->unpack_data);
+  g_ptr_array_add (ld->devs, node->info.user_data);
+
+  if (! (flags & LET_OPEN)) return;
+
+  if (flags & LET_LEAF)
+    {
+      vsg_packed_msg_recv_read (pm, &n, 1, MPI_INT);
+
+      for (i=0; i<n; i ++)
+        {
+          gpointer point = ld->pc.point.alloc (FALSE, ld->pc.point.alloc_data);
+
+          pfw->unpack (point, pm, pfw->unpack_data);
+          g_ptr_array_add (ld->points, point);
+          node->info.point_list = g_slist_prepend (node->info.point_list,
+                                                   point);
+        }
+
+      node->info.point_count = n;
+    }
+  else
+    {
+      vsg_packed_msg_recv_read (pm, &n, 1, MPI_INT);
+
+      for (i=0; i<n; i ++)
+        _let_unpack (ld, node, src, pm);
+    }
+}
+
+/* local nodes hanging from a shared node or root of the tree */
+static gboolean _let_private_root (TaskNode *node)
+{
+  return VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_LOCAL (&node->info) &&
+    (node->info.father_info == NULL ||
+     VSG_PRTREE3D_NODE_INFO_IS_SHARED (node->info.father_info));
+}
+
+/* tells if a shared ancestor of @node touches a leaf of the receiver */
+static gboolean _let_ancestors_open (TaskNode *node, const VsgVector3d *region)
+{
+  const VsgPRTree3dNodeInfo *info = node->info.father_info;
+
+  for (; info != NULL; info = info->father_info)
+    {
+      const VsgVector3d *box = &region[info->depth * LET_REGION_SIZE];
+
+      if (_box_touch (&info->lbound, &info->ubound, &box[2], &box[3],
+                      NULL))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* sends local private subtrees to every other processor and grafts theirs */
+static void _let_exchange (LetData *ld, TaskTree *tt, MPI_Comm comm)
+{
+  VsgPackedMsg *msgs;
+  MPI_Request *requests;
+  VsgVector3d *regions;
+  gint sz, nlev, rklev = tt->levels->len;
+  gint i, src, nroots = 0;
+  guint j, k;
+
+  MPI_Comm_size (comm, &sz);
+  MPI_Allreduce (&rklev, &nlev, 1, MPI_INT, MPI_MAX, comm);
+
+  regions = g_malloc (sz * nlev * LET_REGION_SIZE * sizeof (VsgVector3d));
+  _let_region (ld->solver, tt, nlev,
+               &regions[ld->rk * nlev * LET_REGION_SIZE]);
+
+  MPI_Allgather (MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, regions,
+                 nlev * LET_REGION_SIZE, VSG_MPI_TYPE_VECTOR3D, comm);
+
+  msgs = g_malloc (sz * sizeof (VsgPackedMsg));
+  requests = g_malloc (sz * sizeof (MPI_Request));
+
+  for (j=0; j<tt->levels->len; j ++)
+    {
+      GPtrArray *level = g_ptr_array_index (tt->levels, j);
+
+      for (k=0; k<level->len; k ++)
+        if (_let_private_root (g_ptr_array_index (level, k))) nroots ++;
+    }
+
+  for (i=0; i<sz; i ++)
+    {
+      requests[i] = MPI_REQUEST_NULL;
+      if (i == ld->rk) continue;
+
+      vsg_packed_msg_init (&msgs[i], comm);
+
+      vsg_packed_msg_send_append (&msgs[i], &nroots, 1, MPI_INT);
+
+      for (j=0; j<tt->levels->len; j ++)
+        {
+          GPtrArray *level = g_ptr_array_index (tt->levels, j);
+
+          for (k=0; k<level->len; k ++)
+            {
+              TaskNode *node = g_ptr_array_index (level, k);
+
+              if (_let_private_root (node))
+                {
+                  VsgVector3d *region = &regions[i * nlev * LET_REGION_SIZE];
+
+                  _let_pack (ld, node, region,
+                             _let_ancestors_open (node, region), &msgs[i]);
+                }
+            }
+        }
+
+      vsg_packed_msg_isend (&msgs[i], i, LET_TAG, &requests[i]);
+    }
+
+  /* graft subtrees in arrival order */
+  for (src=0; src<sz-1; src ++)
+    {
+      VsgPackedMsg pm = VSG_PACKED_MSG_STATIC_INIT (comm);
+      MPI_Status status;
+      gint nrecv;
+
+      MPI_Probe (MPI_ANY_SOURCE, LET_TAG, comm, &status);
+      vsg_packed_msg_recv (&pm, status.MPI_SOURCE, LET_TAG);
+
+      vsg_packed_msg_recv_read (&pm, &nrecv, 1, MPI_INT);
+
+      for (i=0; i<nrecv; i ++)
+        _let_unpack (ld, NULL, status.MPI_SOURCE, &pm);
+
+      vsg_packed_msg_drop_buffer (&pm);
+    }
+
+  MPI_Waitall (sz, requests, MPI_STATUSES_IGNORE);
+
+  for (i=0; i<sz; i ++)
+    if (i != ld->rk) vsg_packed_msg_drop_buffer (&msgs[i]);
+
+  g_free (requests);
+  g_free (msgs);
+  g_free (regions);
+}
+
+static void _let_far (NearFar *nf, TaskNode *one, TaskNode *other)
+{
+  LetData *ld = (LetData *) nf;
+  const VsgPRTree3dNodeInfo *a = &one->info;
+  const VsgPRTree3dNodeInfo *b = &other->info;
+
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (a))
+    {
+      const VsgPRTree3dNodeInfo *tmp = a;
+      a = b;
+      b = tmp;
+    }
+
+  if (! VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (b))
+    {
+      /* every processor holds shared multipoles: one does the work */
+      if (VSG_PRTREE3D_NODE_INFO_IS_SHARED (a) &&
+          VSG_PRTREE3D_NODE_INFO_IS_SHARED (b) && ld->rk != 0) return;
+
+      _task_far (nf, one, other);
+    }
+  else if (! VSG_PRTREE3D_NODE_INFO_IS_SHARED (a) && nf->with_far)
+    {
+      /* shared targets get remote contributions from their owner */
+      if (a == &one->info)
+        _pair_add (nf, TASK_PAIR_M2L, other, one, FALSE, FALSE);
+      else
+        _pair_add (nf, TASK_PAIR_M2L, one, other, FALSE, FALSE);
+    }
+}
+
+/* private pairs only (see _pair_semifar()): each processor updates its
+ * own side */
+static void _let_semifar (NearFar *nf, TaskNode *leaf, TaskNode *node)
+{
+  _pair_add (nf, TASK_PAIR_SEMIFAR, leaf, node,
+             ! VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (&node->info),
+             ! VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (&leaf->info));
+}
+
+static void _let_solve (AranSolver3d *solver, TaskTree *tt,
+                        gboolean far, gboolean semifar)
+{
+  MPI_Comm comm = _pipeline_communicator (solver);
+  LetData ld;
+  guint i, j;
+
+  ld.solver = solver;
+  vsg_prtree3d_get_parallel (solver->prtree, &ld.pc);
+  MPI_Comm_rank (comm, &ld.rk);
+  ld.placeholders = g_hash_table_new ((GHashFunc) _key3d_hash,
+                                      (GEqualFunc) _key3d_equal);
+  ld.nodes = g_ptr_array_new ();
+  ld.devs = g_ptr_array_new ();
+  ld.points = g_ptr_array_new ();
+
+  for (i=0; i<tt->levels->len; i ++)
+    {
+      GPtrArray *level = g_ptr_array_index (tt->levels, i);
+
+      for (j=0; j<level->len; j ++)
+        {
+          TaskNode *node = g_ptr_array_index (level, j);
+
+          if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (&node->info))
+            g_hash_table_insert (ld.placeholders, &node->info.id, node);
+        }
+    }
+
+  _let_exchange (&ld, tt, comm);
+
+  _near_far_init (&ld.nf, solver, far, semifar);
+  ld.nf.far = _let_far;
+  ld.nf.semifar = _let_semifar;
+
+  _task_near_far_roots (&ld.nf, tt);
+  _near_far_run (&ld.nf);
+
+  /* sum the contributions of every processor to shared local developments */
+  if (ld.nf.with_far)
+    vsg_prtree3d_shared_nodes_allreduce (solver->prtree,
+                                         &ld.pc.node_data.visit_backward);
+
+  for (i=0; i<ld.points->len; i ++)
+    ld.pc.point.destroy (g_ptr_array_index (ld.points, i), FALSE,
+                         ld.pc.point.destroy_data);
+
+  for (i=0; i<ld.devs->len; i ++)
+    ld.pc.node_data.destroy (g_ptr_array_index (ld.devs, i), FALSE,
+                             ld.pc.node_data.destroy_data);
+
+  for (i=0; i<ld.nodes->len; i ++)
+    g_free (g_ptr_array_index (ld.nodes, i));
+
+  g_ptr_array_free (ld.points, TRUE);
+  g_ptr_array_free (ld.devs, TRUE);
+  g_ptr_array_free (ld.nodes, TRUE);
+  g_hash_table_destroy (ld.placeholders);
+}
+#endif /* VSG_HAVE_MPI */
+
+typedef struct _UpdateData UpdateData;
+
+struct _UpdateData {
+  VsgPRTree3d *prtree;
+  AranParticleMoveFunc3d move;
+  gpointer user_data;
+  GSList *crossing;
+};
+
+static void update_func (const VsgPRTree3dNodeInfo *node_info,
+                         UpdateData *ud)
+{
+  GSList *node_list;
+
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
+#endif
+
+  if (! node_info->isleaf) return;
+
+  node_list = node_info->point_list;
+
+  while (node_list)
+    {
+      VsgPoint3 node_point = (VsgPoint3) node_list->data;
+
+      ud->move (node_point, TRUE, ud->user_data);
+
+      /* the tree routes @node_point to its new leaf with its own point
+       * localization function */
+      if (vsg_prtree3d_find_point (ud->prtree, node_point) != node_point)
+        ud->crossing = g_slist_prepend (ud->crossing, node_point);
+
+      node_list = node_list->next;
+    }
+}
+
+typedef struct _PeriodicData PeriodicData;
+
+struct _PeriodicData {
+  AranSolver3d *solver;
+  VsgVector3d shift;
+};
+
+static void _node_info_shift (const VsgPRTree3dNodeInfo *node_info,
+                              const VsgVector3d *shift,
+                              VsgPRTree3dNodeInfo *result)
+{
+  *result = *node_info;
+
+  vsg_vector3d_add (&node_info->center, shift, &result->center);
+  vsg_vector3d_add (&node_info->lbound, shift, &result->lbound);
+  vsg_vector3d_add (&node_info->ubound, shift, &result->ubound);
+}
+
+static gboolean _periodic_is_source (AranSolver3d *solver, VsgPoint3 point)
+{
+  return solver->role == NULL ||
+    (solver->role (point) & ARAN_PARTICLE_SOURCE);
+}
+
+static gboolean _periodic_is_target (AranSolver3d *solver, VsgPoint3 point)
+{
+  return solver->role == NULL ||
+    (solver->role (point) & ARAN_PARTICLE_TARGET);
+}
+
+/* interactions of @dst with the image of @src translated by pd->shift */
+static void _periodic_interact (PeriodicData *pd, TaskNode *dst,
+                                TaskNode *src)
+{
+  AranSolver3d *solver = pd->solver;
+  AranStatsBlock *block = _SOLVER3D_STATS_BLOCK (solver);
+  const VsgPRTree3dNodeInfo *dinfo = &dst->info;
+  const VsgPRTree3dNodeInfo *sinfo = &src->info;
+  guint depth = MAX (dinfo->depth, sinfo->depth);
+  gdouble t0;
+  guint i;
+
+  if (dinfo->point_count == 0 || sinfo->point_count == 0) return;
+
+  if (! _node_has_role (dinfo, solver->target_nodes) ||
+      ! _node_has_role (sinfo, solver->source_nodes))
+    return;
+
+  if (! _box_touch (&dinfo->lbound, &dinfo->ubound,
+                    &sinfo->lbound, &sinfo->ubound, &pd->shift))
+    {
+      VsgPRTree3dNodeInfo image;
+      GSList *list;
+      glong count = 0;
+
+      t0 = ARAN_STATS_BLOCK_TIME (block);
+
+      if (dinfo->depth == sinfo->depth && solver->m2l != NULL)
+        {
+          _node_info_shift (sinfo, &pd->shift, &image);
+
+          solver->m2l (&image, sinfo->user_data, dinfo, dinfo->user_data);
+
+          ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_M2L, depth, 1,
+                                ARAN_STATS_BLOCK_TIME (block) - t0);
+          return;
+        }
+
+      /* @dst is a bigger leaf. An internal @dst is refined below */
+      if (dinfo->isleaf && dinfo->depth < sinfo->depth &&
+          solver->m2p != NULL)
+        {
+          _node_info_shift (sinfo, &pd->shift, &image);
+
+          for (list = dinfo->point_list; list != NULL; list = list->next)
+            {
+              if (! _periodic_is_target (solver, list->data)) continue;
+
+              solver->m2p (&image, sinfo->user_data, list->data);
+              count ++;
+            }
+
+          ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_M2P, sinfo->depth, count,
+                                ARAN_STATS_BLOCK_TIME (block) - t0);
+          return;
+        }
+
+      /* @src is a bigger leaf: move @dst instead of @src particles */
+      if (sinfo->isleaf && sinfo->depth < dinfo->depth &&
+          solver->p2l != NULL)
+        {
+          VsgVector3d back;
+
+          vsg_vector3d_scalp (&pd->shift, -1., &back);
+          _node_info_shift (dinfo, &back, &image);
+
+          for (list = sinfo->point_list; list != NULL; list = list->next)
+            {
+              if (! _periodic_is_source (solver, list->data)) continue;
+
+              solver->p2l (list->data, &image, dinfo->user_data);
+              count ++;
+            }
+
+          ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_P2L, dinfo->depth, count,
+                                ARAN_STATS_BLOCK_TIME (block) - t0);
+          return;
+        }
+    }
+
+  if (dinfo->isleaf && sinfo->isleaf)
+    {
+      GSList *dlist, *slist;
+      glong count = 0;
+
+      t0 = ARAN_STATS_BLOCK_TIME (block);
+
+      for (dlist = dinfo->point_list; dlist != NULL; dlist = dlist->next)
+        {
+          if (! _periodic_is_target (solver, dlist->data)) continue;
+
+          for (slist = sinfo->point_list; slist != NULL; slist = slist->next)
+            {
+              if (! _periodic_is_source (solver, slist->data)) continue;
+
+              solver->p2p_shift (slist->data, &pd->shift, dlist->data);
+              count ++;
+            }
+        }
+
+      ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_P2P, depth, count,
+                            ARAN_STATS_BLOCK_TIME (block) - t0);
+      return;
+    }
+
+  /* refine the biggest node (or the only one that can be) */
+  if (! sinfo->isleaf && (dinfo->isleaf || sinfo->depth <= dinfo->depth))
+    {
+      for (i=0; i<src->nchildren; i++)
+        _periodic_interact (pd, dst, src->children[i]);
+    }
+  else
+    {
+      for (i=0; i<dst->nchildren; i++)
+        _periodic_interact (pd, dst->children[i], src);
+    }
+}
+
+static void _periodic_zero (AranSolver3d *solver,
+                            const VsgPRTree3dNodeInfo *node_info,
+                            gpointer devel)
+{
+  if (solver->node_zero != NULL)
+    solver->node_zero (node_info, devel, solver->node_zero_data);
+  else
+    solver->zero (devel);
+}
+
+/* far images of the periodic lattice: supercells of 3^l cells, beyond the
+ * neighbors of the central supercell, are translated from @src multipole
+ * into @dst local expansion (both at @root) */
+static void _periodic_lattice_sum (AranSolver3d *solver,
+                                   const VsgPRTree3dNodeInfo *root,
+                                   gpointer src, gpointer dst)
+{
+  AranStatsBlock *block = _SOLVER3D_STATS_BLOCK (solver);
+  VsgPRTree3dNodeInfo cell = *root, image, super;
+  gpointer multipole, tmp;
+  VsgVector3d size, shift;
+  glong m2l_count = 0, m2m_count = 0;
+  gdouble t0, m2l_time = 0., m2m_time = 0.;
+  guint l;
+  gint i, j, k;
+
+  multipole = g_boxed_copy (solver->devel_type, src);
+  tmp = g_boxed_copy (solver->devel_type, solver->devel);
+
+  vsg_vector3d_sub (&root->ubound, &root->lbound, &size);
+
+  for (l=0; l<solver->lattice_levels; l++)
+    {
+      t0 = ARAN_STATS_BLOCK_TIME (block);
+
+      for (i=-4; i<=4; i++)
+        for (j=-4; j<=4; j++)
+          for (k=-4; k<=4; k++)
+            {
+              if (ABS (i) <= 1 && ABS (j) <= 1 && ABS (k) <= 1) continue;
+
+              vsg_vector3d_set (&shift, i * size.x, j * size.y, k * size.z);
+              _node_info_shift (&cell, &shift, &image);
+
+              solver->m2l (&image, multipole, root, dst);
+              m2l_count ++;
+            }
+
+      m2l_time += ARAN_STATS_BLOCK_TIME (block) - t0;
+
+      if (l+1 == solver->lattice_levels) break;
+
+      t0 = ARAN_STATS_BLOCK_TIME (block);
+
+      /* gather the 27 cells into the next supercell */
+      super = cell;
+      vsg_vector3d_sub (&super.lbound, &size, &super.lbound);
+      vsg_vector3d_add (&super.ubound, &size, &super.ubound);
+
+      _periodic_zero (solver, &super, tmp);
+
+      for (i=-1; i<=1; i++)
+        for (j=-1; j<=1; j++)
+          for (k=-1; k<=1; k++)
+            {
+              vsg_vector3d_set (&shift, i * size.x, j * size.y, k * size.z);
+              _node_info_shift (&cell, &shift, &image);
+
+              solver->m2m (&image, multipole, &super, tmp);
+              m2m_count ++;
+            }
+
+      m2m_time += ARAN_STATS_BLOCK_TIME (block) - t0;
+
+      cell = super;
+      vsg_vector3d_scalp (&size, 3., &size);
+
+      image.user_data = multipole;
+      multipole = tmp;
+      tmp = image.user_data;
+    }
+
+  g_boxed_free (solver->devel_type, multipole);
+  g_boxed_free (solver->devel_type, tmp);
+
+  ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_M2L, root->depth, m2l_count,
+                        m2l_time);
+  ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_M2M, root->depth, m2m_count,
+                        m2m_time);
+}
+
+static guint _lattice_terms (AranSphericalSeriesd *ass, gcomplex128 **terms)
+{
+  gint posdeg = aran_spherical_seriesd_get_posdeg (ass);
+  gint negdeg = aran_spherical_seriesd_get_negdeg (ass);
+  guint n = 0;
+  gint l, m;
+
+  for (l=-negdeg; l<=posdeg; l++)
+    for (m=0; m<=((l < 0) ? -l-1 : l); m++)
+      {
+        if (terms != NULL)
+          terms[n] = aran_spherical_seriesd_get_term (ass, l, m);
+        n ++;
+      }
+
+  return n;
+}
+
+static void _lattice_cache_key (AranSolver3d *solver,
+                                const VsgPRTree3dNodeInfo *root,
+                                LatticeCache *lc)
+{
+  AranDevelopment3d *ad = root->user_data;
+
+  lc->lbound = root->lbound;
+  lc->ubound = root->ubound;
+  lc->levels = solver->lattice_levels;
+  lc->degrees[0] = aran_spherical_seriesd_get_posdeg (ad->multipole);
+  lc->degrees[1] = aran_spherical_seriesd_get_negdeg (ad->multipole);
+  lc->degrees[2] = aran_spherical_seriesd_get_posdeg (ad->local);
+  lc->degrees[3] = aran_spherical_seriesd_get_negdeg (ad->local);
+  lc->m2m = solver->m2m;
+  lc->m2l = solver->m2l;
+  lc->node_zero = solver->node_zero;
+  lc->node_zero_data = solver->node_zero_data;
+}
+
+static gboolean _lattice_cache_match (AranSolver3d *solver,
+                                      const VsgPRTree3dNodeInfo *root)
+{
+  LatticeCache *lc = solver->lattice_cache, key;
+
+  if (lc == NULL) return FALSE;
+
+  _lattice_cache_key (solver, root, &key);
+
+  return vsg_vector3d_dist (&lc->lbound, &key.lbound) == 0. &&
+    vsg_vector3d_dist (&lc->ubound, &key.ubound) == 0. &&
+    lc->levels == key.levels &&
+    memcmp (lc->degrees, key.degrees, sizeof (key.degrees)) == 0 &&
+    lc->m2m == key.m2m && lc->m2l == key.m2l &&
+    lc->node_zero == key.node_zero &&
+    lc->node_zero_data == key.node_zero_data;
+}
+
+/* probes the lattice sum with each real and imaginary unit multipole term */
+static void _lattice_cache_build (AranSolver3d *solver,
+                                  const VsgPRTree3dNodeInfo *root)
+{
+  LatticeCache *lc = solver->lattice_cache;
+  AranDevelopment3d *src, *dst;
+  gcomplex128 **in, **out;
+  guint c, r, ncols;
+
+  src = g_boxed_copy (solver->devel_type, root->user_data);
+  dst = g_boxed_copy (solver->devel_type, root->user_data);
+
+  lc->nin = _lattice_terms (src->multipole, NULL);
+  lc->nout = _lattice_terms (dst->local, NULL);
+
+  in = g_new (gcomplex128 *, lc->nin);
+  out = g_new (gcomplex128 *, lc->nout);
+
+  _lattice_terms (src->multipole, in);
+  _lattice_terms (dst->local, out);
+
+  ncols = 2 * lc->nin;
+  lc->matrix = g_new (gdouble, 2 * lc->nout * ncols);
+
+  for (c=0; c<ncols; c++)
+    {
+      aran_development3d_set_zero (src);
+      aran_development3d_set_zero (dst);
+
+      *in[c/2] = (c%2 == 0) ? 1. : G_I;
+
+      _periodic_lattice_sum (solver, root, src, dst);
+
+      for (r=0; r<lc->nout; r++)
+        {
+          lc->matrix[2*r*ncols + c] = creal (*out[r]);
+          lc->matrix[(2*r+1)*ncols + c] = cimag (*out[r]);
+        }
+    }
+
+  g_free (in);
+  g_free (out);
+
+  g_boxed_free (solver->devel_type, src);
+  g_boxed_free (solver->devel_type, dst);
+}
+
+static void _lattice_cache_apply (AranSolver3d *solver,
+                                  const VsgPRTree3dNodeInfo *root)
+{
+  AranStatsBlock *block = _SOLVER3D_STATS_BLOCK (solver);
+  LatticeCache *lc = solver->lattice_cache;
+  AranDevelopment3d *ad = root->user_data;
+  gcomplex128 **in, **out;
+  gdouble *x, *row, re, im;
+  gdouble t0 = ARAN_STATS_BLOCK_TIME (block);
+  guint c, r, ncols = 2 * lc->nin;
+
+  in = g_new (gcomplex128 *, lc->nin);
+  out = g_new (gcomplex128 *, lc->nout);
+  x = g_new (gdouble, ncols);
+
+  _lattice_terms (ad->multipole, in);
+  _lattice_terms (ad->local, out);
+
+  for (c=0; c<lc->nin; c++)
+    {
+      x[2*c] = creal (*in[c]);
+      x[2*c+1] = cimag (*in[c]);
+    }
+
+  for (r=0; r<lc->nout; r++)
+    {
+      re = 0.;
+      im = 0.;
+
+      row = lc->matrix + 2*r*ncols;
+      for (c=0; c<ncols; c++)
+        {
+          re += row[c] * x[c];
+          im += row[ncols + c] * x[c];
+        }
+
+      *out[r] += re + im * G_I;
+    }
+
+  g_free (in);
+  g_free (out);
+  g_free (x);
+
+  ARAN_STATS_BLOCK_ADD (block, ARAN_STATS_M2L, root->depth, 1,
+                        ARAN_STATS_BLOCK_TIME (block) - t0);
+}
+
+/* adds the far lattice images into @root local expansion. With
+ * #AranDevelopment3d, the sum is a linear map of the root multipole that
+ * only depends on the box and the degrees: it is computed term by term once
+ * a solve repeats the lattice of the previous one, then applied as a
+ * matrix */
+static void _periodic_lattice (AranSolver3d *solver,
+                               const VsgPRTree3dNodeInfo *root)
+{
+  if (solver->m2l == NULL || solver->m2m == NULL) return;
+
+  if (solver->devel_type != ARAN_TYPE_DEVELOPMENT3D)
+    {
+      _periodic_lattice_sum (solver, root, root->user_data, root->user_data);
+      return;
+    }
+
+  if (! _lattice_cache_match (solver, root))
+    {
+      _lattice_cache_free (solver->lattice_cache);
+
+      solver->lattice_cache = g_new0 (LatticeCache, 1);
+      _lattice_cache_key (solver, root, solver->lattice_cache);
+
+      _periodic_lattice_sum (solver, root, root->user_data, root->user_data);
+      return;
+    }
+
+  if (solver->lattice_cache->matrix == NULL)
+    _lattice_cache_build (solver, root);
+
+  _lattice_cache_apply (solver, root);
+}
+
+static void _periodic_dipole_sum (VsgPoint3 point, gpointer *data)
+{
+  AranSolver3d *solver = data[0];
+
+  if (! _periodic_is_source (solver, point)) return;
+
+  solver->dipole (point, data[1], data[2]);
+}
+
+static void _periodic_dipole_correct (VsgPoint3 point, gpointer *data)
+{
+  AranSolver3d *solver = data[0];
+
+  if (! _periodic_is_target (solver, point)) return;
+
+  solver->dipole_correction (point, data[1], data[2], *(gdouble *) data[3]);
+}
+
+/* periodic images contributions: neighbor cells through a dual traversal
+ * of the tree and its translated copies, then far lattice cells */
+static void _periodic_solve (AranSolver3d *solver)
+{
+  PeriodicData pd;
+  TaskTree *tt;
+  TaskNode *root;
+  VsgVector3d size;
+  gint i, j, k;
+
+  pd.solver = solver;
+
+  tt = _task_tree_new (solver);
+  root = g_ptr_array_index ((GPtrArray *) g_ptr_array_index (tt->levels, 0),
+                            0);
+
+  vsg_vector3d_sub (&root->info.ubound, &root->info.lbound, &size);
+
+  for (i=-1; i<=1; i++)
+    for (j=-1; j<=1; j++)
+      for (k=-1; k<=1; k++)
+        {
+          if (i == 0 && j == 0 && k == 0) continue;
+
+          vsg_vector3d_set (&pd.shift, i * size.x, j * size.y, k * size.z);
+
+          _periodic_interact (&pd, root, root);
+        }
+
+  if (root->info.point_count != 0 &&
+      _node_has_role (&root->info, solver->source_nodes) &&
+      _node_has_role (&root->info, solver->target_nodes))
+    _periodic_lattice (solver, &root->info);
+
+  _task_tree_free (tt, NULL);
+}
+
+/* surface term correction of the lattice summation */
+static void _periodic_dipole (AranSolver3d *solver)
+{
+  VsgVector3d lbound, ubound, origin, dipole = {0., 0., 0.};
+  gdouble volume;
+  gpointer data[4];
+
+  aran_solver3d_get_bounds (solver, &lbound, &ubound);
+
+  vsg_vector3d_add (&lbound, &ubound, &origin);
+  vsg_vector3d_scalp (&origin, 0.5, &origin);
+
+  volume = (ubound.x - lbound.x) * (ubound.y - lbound.y) *
+    (ubound.z - lbound.z);
+
+  data[0] = solver;
+  data[1] = &origin;
+  data[2] = &dipole;
+  data[3] = &volume;
+
+  vsg_prtree3d_foreach_point (solver->prtree,
+                              (GFunc) _periodic_dipole_sum, data);
+
+  vsg_prtree3d_foreach_point (solver->prtree,
+                              (GFunc) _periodic_dipole_correct, data);
+}
+
+/* public functions */
+
+/**
+ * aran_solver3d_new:
+ * @prtree: a #VsgPRTree3d.
+ * @devel_type: #GType of development to be used by the solver.
+ * @devel: instance of type @devel_type for cloning.
+ * @zero: @devel_type zeroing function.
+ *
  * Creates a new #AranSolver3d from @prtree and a development type. @prtree
  * is considered as owned by the new #AranSolver3d (ie. #VsgPRTree3d cannot be
  * shared between different #AranSolver3d nor being reused elsewhere).
  *
- * Returns: newly allocated structure.
+ * Returns: newly allocated structure.
+ */
+AranSolver3d *aran_solver3d_new (VsgPRTree3d *prtree,
+                                 GType devel_type,
+                                 gpointer devel,
+                                 AranZeroFunc zero)
+{
+  VsgVector3d lbound = {-1., -1., -1.};
+  VsgVector3d ubound = {1., 1., 1.};
+  AranSolver3d *solver;
+
+  solver = _solver3d_alloc ();
+
+  if (prtree == NULL)
+    solver->prtree = vsg_prtree3d_new (&lbound, &ubound, NULL, 0);
+  else
+    solver->prtree = prtree;
+
+  aran_solver3d_set_development (solver, devel_type, devel, zero);
+
+  return solver;
+}
+
+/**
+ * aran_solver3d_free:
+ * @solver: an #AranSolver3d.
+ *
+ * Deallocates all memory associated with @solver (Even the #VsgPRTree3d is
+ * freed).
+ */
+void aran_solver3d_free (AranSolver3d *solver)
+{
+  if (solver == NULL) return;
+
+  vsg_prtree3d_free (solver->prtree);
+
+  if (solver->devel != NULL)
+    g_boxed_free (solver->devel_type, solver->devel);
+
+  _solver3d_dealloc (solver);
+}
+
+/**
+ * aran_solver3d_set_development:
+ * @solver: an #AranSolver3d.
+ * @devel_type: #GType of development to be used by the solver.
+ * @devel: instance of type @devel_type for cloning.
+ * @zero: @devel_type zeroing function.
+ *
+ * Associates @solver with a new development definition.
+ */
+void aran_solver3d_set_development (AranSolver3d *solver,
+                                    GType devel_type,
+                                    gpointer devel,
+                                    AranZeroFunc zero)
+{
+  g_return_if_fail (solver != NULL);
+
+  g_return_if_fail ((devel_type == G_TYPE_NONE) ||
+                    G_TYPE_IS_BOXED (devel_type));
+
+  if (solver->devel != NULL)
+    g_boxed_free (solver->devel_type, solver->devel);
+
+  solver->devel_type = devel_type;
+  solver->devel = devel;
+  solver->zero = zero;
+
+  _far_reuse_reset (solver);
+
+  if (devel != NULL)
+    {
+      vsg_prtree3d_set_node_data (solver->prtree, devel_type, devel);
+    }
+  else
+    {
+      vsg_prtree3d_set_node_data (solver->prtree,
+                                  G_TYPE_NONE,
+                                  NULL);
+    }
+}
+
+/**
+ * aran_solver3d_set_node_zero:
+ * @solver: an #AranSolver3d.
+ * @node_zero: node development zeroing function.
+ * @user_data: user data passed to @node_zero.
+ *
+ * Replaces @solver development zeroing function by @node_zero before each
+ * solve. Contrary to the #AranZeroFunc given in aran_solver3d_new(),
+ * @node_zero receives tree node info and may thus adapt each node
+ * development to its level (see aran_development3d_schedule_zero()).
+ * Passing %NULL restores default zeroing.
+ */
+void aran_solver3d_set_node_zero (AranSolver3d *solver,
+                                  AranNodeZeroFunc3d node_zero,
+                                  gpointer user_data)
+{
+  g_return_if_fail (solver != NULL);
+
+  solver->node_zero = node_zero;
+  solver->node_zero_data = user_data;
+}
+
+/**
+ * aran_solver3d_set_roles:
+ * @solver: an #AranSolver3d.
+ * @role: particle role function or %NULL.
+ * @p2p_one_way: particle to particle function that only updates its
+ * destination particle, or %NULL.
+ *
+ * Tells @solver which particles are field sources and which are field
+ * targets. Solves then skip p2m and p2l for pure targets, l2p and m2p for
+ * pure sources, as well as m2m, m2l, l2l and down passes in subtrees
+ * lacking sources or targets. Near interactions between a pure source and
+ * a target use @p2p_one_way when available (called with the source first).
+ * Passing %NULL @role makes every particle both a source and a target.
+ */
+void aran_solver3d_set_roles (AranSolver3d *solver,
+                              AranParticleRoleFunc3d role,
+                              AranParticle2ParticleFunc3d p2p_one_way)
+{
+  g_return_if_fail (solver != NULL);
+
+  solver->role = role;
+  solver->p2p_one_way = p2p_one_way;
+
+  _far_reuse_reset (solver);
+}
+
+/**
+ * aran_solver3d_set_prune:
+ * @solver: an #AranSolver3d.
+ * @weight: particle source weight function or %NULL.
+ * @epsilon: far field pruning threshold.
+ *
+ * Makes @solver skip the work of sources that produce a negligible field.
+ * Subtrees weights are summed from @weight during the upward pass. p2m,
+ * m2m, p2l and m2p are skipped for zero weights and near interactions
+ * between leaves without any weight. M2L is skipped when the source weight
+ * over the distance between both nodes is below @epsilon, which bounds a
+ * 1/r potential. Zero @epsilon only prunes empty sources. Remote and
+ * shared nodes are never pruned. Target side pruning is obtained with
+ * aran_solver3d_set_roles(). Passing %NULL @weight disables pruning.
+ */
+void aran_solver3d_set_prune (AranSolver3d *solver,
+                              AranParticleWeightFunc3d weight,
+                              gdouble epsilon)
+{
+  g_return_if_fail (solver != NULL);
+  g_return_if_fail (epsilon >= 0.);
+
+  solver->weight = weight;
+  solver->prune_epsilon = epsilon;
+
+  _far_reuse_reset (solver);
+}
+
+/**
+ * aran_solver3d_set_far_period:
+ * @solver: an #AranSolver3d.
+ * @period: number of solves sharing one far field computation.
+ *
+ * Makes only one call out of @period to aran_solver3d_solve() compute the
+ * far field, which suits multiple time stepping schemes where particles
+ * move little between successive solves. Other calls only compute near
+ * interactions and evaluate the leaves local developments kept from the
+ * last complete solve at the new particle positions. A complete solve is
+ * forced whenever a target particle falls into a leaf whose local
+ * development was not computed (the tree leaves changed or the leaf was
+ * empty) or when periodic or semifar interactions are used. @period lower
+ * than 2 disables far field reuse.
+ *
+ * Reuse steps skip the upward pass, the far interactions and the
+ * translations of the downward pass, and keep the leaves preparation (see
+ * aran_solver3d_set_leaf_prepare()). They still evaluate the local
+ * development at every target particle, so that their cost is the near
+ * field one plus the Local to Particle one, which grows with the
+ * development order.
+ */
+void aran_solver3d_set_far_period (AranSolver3d *solver, guint period)
+{
+  g_return_if_fail (solver != NULL);
+
+  solver->far_period = period;
+
+  _far_reuse_reset (solver);
+}
+
+/**
+ * aran_solver3d_set_leaf_prepare:
+ * @solver: an #AranSolver3d.
+ * @prepare: leaf preparation function or %NULL.
+ * @user_data: user data passed to @prepare.
+ *
+ * Makes @solver call @prepare on each non empty leaf right before its
+ * Local to Particle distribution. This allows to precompute, once per leaf,
+ * data shared by all the leaf particles such as the local expansion
+ * gradient (see aran_development3d_gradient_prepare()). With threaded
+ * passes (see aran_solver3d_set_threads()), @prepare is called concurrently
+ * on different leaves and must only modify the leaf development.
+ */
+void aran_solver3d_set_leaf_prepare (AranSolver3d *solver,
+                                     AranLeafPrepareFunc3d prepare,
+                                     gpointer user_data)
+{
+  g_return_if_fail (solver != NULL);
+
+  solver->leaf_prepare = prepare;
+  solver->leaf_prepare_data = user_data;
+}
+
+/**
+ * aran_solver3d_set_periodic:
+ * @solver: an #AranSolver3d.
+ * @p2p_shift: particle to particle function with translated source or
+ * %NULL.
+ * @lattice_levels: number of supercell levels for far periodic images.
+ *
+ * Makes @solver consider its tree bounds as one cell of a periodic
+ * lattice, or come back to free space when @p2p_shift is %NULL. Each
+ * solve then adds the contributions of the images of the particles:
+ *
+ * The 26 neighbor cells are handled through a traversal of the tree
+ * against its translated copies: near leaves interact through @p2p_shift
+ * and far nodes through the solver m2l (or m2p and p2l between different
+ * levels when available).
+ *
+ * Further images are gathered into supercells of 3^l cells whose
+ * multipole expansions are built from the root one with the solver m2m,
+ * then translated into the root local expansion with m2l. This amounts to
+ * the cubic summation of the lattice up to 3^(@lattice_levels + 1) cells
+ * wide. Its cost does not depend on the number of particles. With
+ * #AranDevelopment3d, this sum is cached as a linear map of the root
+ * multipole for the tree bounds and degrees, and applied directly from
+ * the second solve on.
+ *
+ * The lattice sum only converges for globally neutral cells. Its surface
+ * term can be removed with aran_solver3d_set_periodic_dipole(). Particles
+ * are expected to stay inside the tree bounds (which should be a cube)
+ * and the tree must not be distributed: aran_solver3d_solve() refuses to
+ * run otherwise.
+ */
+void aran_solver3d_set_periodic (AranSolver3d *solver,
+                                 AranParticle2ParticleShiftFunc3d p2p_shift,
+                                 guint lattice_levels)
+{
+  g_return_if_fail (solver != NULL);
+  g_return_if_fail (p2p_shift == NULL || ! _distributed (solver));
+
+  solver->p2p_shift = p2p_shift;
+  solver->lattice_levels = lattice_levels;
+}
+
+/**
+ * aran_solver3d_set_periodic_dipole:
+ * @solver: an #AranSolver3d.
+ * @dipole: particle dipole moment function or %NULL.
+ * @correction: particle dipole correction function or %NULL.
+ *
+ * Asks periodic @solver to compute, after each solve, the dipole moment
+ * of the periodic cell with @dipole and to call @correction on each
+ * target particle. This allows to remove the surface term of the lattice
+ * summation (see aran_solver3d_set_periodic()).
+ */
+void aran_solver3d_set_periodic_dipole (AranSolver3d *solver,
+                                        AranParticleDipoleFunc3d dipole,
+                                        AranParticleDipoleCorrectionFunc3d correction)
+{
+  g_return_if_fail (solver != NULL);
+  g_return_if_fail ((dipole == NULL) == (correction == NULL));
+
+  solver->dipole = dipole;
+  solver->dipole_correction = correction;
+}
+
+/**
+ * aran_solver3d_set_functions:
+ * @solver: an #AranSolver3d.
+ * @p2p: particle 2 particle function.
+ * @p2m: particle 2 multipole function.
+ * @m2m: multipole 2 multipole function.
+ * @m2l: multipole 2 local function.
+ * @l2l: local 2 local function.
+ * @l2p: local 2 particle function.
+ *
+ * Associates @solver with a minimal set of FMM functions.
+ */
+void aran_solver3d_set_functions (AranSolver3d *solver,
+                                  AranParticle2ParticleFunc3d p2p,
+                                  AranParticle2MultipoleFunc3d p2m,
+                                  AranMultipole2MultipoleFunc3d m2m,
+                                  AranMultipole2LocalFunc3d m2l,
+                                  AranLocal2LocalFunc3d l2l,
+                                  AranLocal2ParticleFunc3d l2p)
+{
+  aran_solver3d_set_functions_full (solver, p2p, p2m, m2m, m2l, l2l, l2p,
+                                    NULL, NULL, 0);
+}
+
+/**
+ * aran_solver3d_set_functions_full:
+ * @solver: an #AranSolver3d.
+ * @p2p: particle 2 particle function.
+ * @p2m: particle 2 multipole function.
+ * @m2m: multipole 2 multipole function.
+ * @m2l: multipole 2 local function.
+ * @l2l: local 2 local function.
+ * @l2p: local 2 particle function.
+ * @p2l: particle 2 local function.
+ * @m2p: multipole 2 particle function.
+ * @semifar_threshold: beyond this number of particles, @p2l and @m2p
+ * can be called instead of @p2p. If @semifar_threshold is #G_MAXUINT,
+ * @p2p will always be called.
+ *
+ * Associates @solver with a complete set of FMM functions.
+ */
+void aran_solver3d_set_functions_full (AranSolver3d *solver,
+                                       AranParticle2ParticleFunc3d p2p,
+                                       AranParticle2MultipoleFunc3d p2m,
+                                       AranMultipole2MultipoleFunc3d m2m,
+                                       AranMultipole2LocalFunc3d m2l,
+                                       AranLocal2LocalFunc3d l2l,
+                                       AranLocal2ParticleFunc3d l2p,
+                                       AranParticle2LocalFunc3d p2l,
+                                       AranMultipole2ParticleFunc3d m2p,
+                                       guint semifar_threshold)
+{
+  g_return_if_fail (solver != NULL);
+
+  if (solver->p2p != p2p) solver->p2p_time = -1.;
+  if (solver->p2m != p2m) solver->p2m_time = -1.;
+  if (solver->m2m != m2m) solver->m2m_time = -1.;
+  if (solver->m2l != m2l) solver->m2l_time = -1.;
+  if (solver->l2l != l2l) solver->l2l_time = -1.;
+  if (solver->l2p != l2p) solver->l2p_time = -1.;
+  if (solver->p2l != p2l) solver->p2l_time = -1.;
+  if (solver->m2p != m2p) solver->m2p_time = -1.;
+
+  solver->p2p = p2p;
+
+  solver->p2m = p2m;
+  solver->m2m = m2m;
+  solver->m2l = m2l;
+  solver->l2l = l2l;
+  solver->l2p = l2p;
+  solver->p2l = p2l;
+  solver->m2p = m2p;
+
+  solver->semifar_threshold = semifar_threshold;
+
+  _far_reuse_reset (solver);
+}
+
+void aran_solver3d_get_functions_full (AranSolver3d *solver,
+                                       AranParticle2ParticleFunc3d *p2p,
+                                       AranParticle2MultipoleFunc3d *p2m,
+                                       AranMultipole2MultipoleFunc3d *m2m,
+                                       AranMultipole2LocalFunc3d *m2l,
+                                       AranLocal2LocalFunc3d *l2l,
+                                       AranLocal2ParticleFunc3d *l2p,
+                                       AranParticle2LocalFunc3d *p2l,
+                                       AranMultipole2ParticleFunc3d *m2p,
+                                       guint *semifar_threshold)
+{
+  g_return_if_fail (solver != NULL);
+
+  if (p2m) *p2m = solver->p2m;
+  if (m2m) *m2m = solver->m2m;
+  if (m2l) *m2l = solver->m2l;
+  if (l2l) *l2l = solver->l2l;
+  if (l2p) *l2p = solver->l2p;
+  if (p2l) *p2l = solver->p2l;
+  if (m2p) *m2p = solver->m2p;
+
+  if (semifar_threshold) *semifar_threshold = solver->semifar_threshold;
+}
+
+void aran_solver3d_db_profile_operators (AranSolver3d *solver, gdouble order)
+{
+  g_return_if_fail (solver != NULL);
+
+  if (solver->p2p)
+    {
+      solver->p2p_time = aran_profile_db_address_eval (solver->p2p, 0.);
+    }
+
+  if (solver->p2m)
+    {
+      solver->p2m_time = aran_profile_db_address_eval (solver->p2m, order);
+    }
+
+  if (solver->p2l)
+    {
+      solver->p2l_time = aran_profile_db_address_eval (solver->p2l, order);
+    }
+
+  if (solver->l2p)
+    {
+      solver->l2p_time = aran_profile_db_address_eval (solver->p2p, order);
+    }
+
+  if (solver->m2p)
+    {
+      solver->m2p_time = aran_profile_db_address_eval (solver->m2p, order);
+    }
+
+  if (solver->m2m)
+    {
+      solver->m2m_time = aran_profile_db_address_eval (solver->m2m, order);
+    }
+
+  if (solver->m2l)
+    {
+      solver->m2l_time = aran_profile_db_address_eval (solver->m2l, order);
+    }
+
+  if (solver->l2l)
+    {
+      solver->l2l_time = aran_profile_db_address_eval (solver->l2l, order);
+    }
+
+  g_printerr ("db_p2p_time %p = %g\n", solver->p2p, solver->p2p_time);
+  g_printerr ("db_p2m_time %p = %g\n", solver->p2m, solver->p2m_time);
+  g_printerr ("db_p2l_time %p = %g\n", solver->p2l, solver->p2l_time);
+  g_printerr ("db_m2m_time %p = %g\n", solver->m2m, solver->m2m_time);
+  g_printerr ("db_m2l_time %p = %g\n", solver->m2l, solver->m2l_time);
+  g_printerr ("db_l2l_time %p = %g\n", solver->l2l, solver->l2l_time);
+  g_printerr ("db_l2p_time %p = %g\n", solver->l2p, solver->l2p_time);
+  g_printerr ("db_m2p_time %p = %g\n", solver->m2p, solver->m2p_time);
+
+}
+void aran_solver3d_profile_operators (AranSolver3d *solver,
+                                      AranParticleInitFunc3d point_init,
+                                      gpointer p1, gpointer p2)
+{
+  gdouble t;
+  guint maxbox;
+  VsgPRTree3dNodeInfo nodeinfo1 = {{0., 0., 0.},};
+  VsgPRTree3dNodeInfo nodeinfo2 = {{1., 1., 1.},};
+  gpointer dev1, dev2;
+
+  g_return_if_fail (solver != NULL);
+
+  maxbox = vsg_prtree3d_get_max_point (solver->prtree);
+
+  if (solver->p2p)
+    {
+      t = aran_profile_nearfunc_3d (solver->p2p, point_init, p1, p2, maxbox);
+      solver->p2p_time = t / (maxbox * maxbox);;
+    }
+
+  dev1 = g_boxed_copy (solver->devel_type, solver->devel);
+
+  if (solver->p2m)
+    {
+      t = aran_profile_p2m_3d (solver->p2m, solver->zero, p1, &nodeinfo1, dev1);
+      solver->p2m_time = t;
+    }
+
+  if (solver->l2p)
+    {
+      t = aran_profile_l2p_3d (solver->l2p, point_init, &nodeinfo1, dev1, p1);
+      solver->l2p_time = t;
+    }
+  if (solver->p2l)
+    {
+      t = aran_profile_p2l_3d (solver->p2l, solver->zero, p1, &nodeinfo1, dev1);
+      solver->p2l_time = t;
+    }
+
+  if (solver->m2p)
+    {
+      t = aran_profile_m2p_3d (solver->m2p, point_init, &nodeinfo1, dev1, p1);
+      solver->m2p_time = t;
+    }
+
+  dev2 = g_boxed_copy (solver->devel_type, solver->devel);
+
+  if (solver->m2m)
+    {
+      t = aran_profile_m2m_3d (solver->m2m, solver->zero, &nodeinfo1, dev1,
+                               &nodeinfo2, dev2);
+      solver->m2m_time = t;
+    }
+
+  if (solver->m2l)
+    {
+      t = aran_profile_m2l_3d (solver->m2l, solver->zero, &nodeinfo1, dev1,
+                               &nodeinfo2, dev2);
+      solver->m2l_time = t;
+    }
+
+  if (solver->l2l)
+    {
+      t = aran_profile_l2l_3d (solver->l2l, solver->zero, &nodeinfo1, dev1,
+                               &nodeinfo2, dev2);
+      solver->l2l_time = t;
+    }
+
+  g_boxed_free (solver->devel_type, dev1);
+  g_boxed_free (solver->devel_type, dev2);
+
+  /* g_printerr ("p2p_time = %g\n", solver->p2p_time); */
+  /* g_printerr ("p2m_time = %g\n", solver->p2m_time); */
+  /* g_printerr ("p2l_time = %g\n", solver->p2l_time); */
+  /* g_printerr ("m2m_time = %g\n", solver->m2m_time); */
+  /* g_printerr ("m2l_time = %g\n", solver->m2l_time); */
+  /* g_printerr ("l2l_time = %g\n", solver->l2l_time); */
+  /* g_printerr ("l2p_time = %g\n", solver->l2p_time); */
+  /* g_printerr ("m2p_time = %g\n", solver->m2p_time); */
+
+}
+
+/**
+ * aran_solver3d_reinit_stats:
+ * @solver: an #AranSolver3d.
+ *
+ * Resets @solver statistics (operators counters and timings, phases
+ * timings) to zero.
+ */
+void aran_solver3d_reinit_stats (AranSolver3d *solver)
+{
+  g_return_if_fail (solver != NULL);
+
+  aran_stats_reset (solver->stats);
+}
+
+/**
+ * aran_solver3d_get_stats:
+ * @solver: an #AranSolver3d.
+ * @zero: Clear function count result.
+ * @p2p: particle 2 particle function count result.
+ * @p2m: particle 2 multipole function count result.
+ * @m2m: multipole 2 multipole function count result.
+ * @m2l: multipole 2 local function count result.
+ * @l2l: local 2 local function count result.
+ * @l2p: local 2 particle function count result.
+ * @p2l: particle 2 localfunction count result.
+ * @m2p: multipole 2 particle function count result.
+ * @p2p_remote: number of p2p calls with remote nodes.
+ * @m2l_remote: number of m2l calls with remote nodes.
+ *
+ * Retrieves count values for @solver differents functions. Each value
+ * represents the number of calls of the corresponding functino since
+ * last call to aran_solver3d_reinit_stats().
+ */
+void aran_solver3d_get_stats (AranSolver3d *solver, glong *zero_count,
+                              glong *p2p_count, glong *p2m_count,
+                              glong *m2m_count, glong *m2l_count,
+                              glong *l2l_count, glong *l2p_count,
+                              glong *p2l_count, glong *m2p_count,
+                              glong *p2p_remote_count, glong *m2l_remote_count)
+{
+  g_return_if_fail (solver != NULL);
+
+  aran_stats_get_operator (solver->stats, ARAN_STATS_ZERO, zero_count, NULL);
+  aran_stats_get_operator (solver->stats, ARAN_STATS_P2P, p2p_count, NULL);
+  aran_stats_get_operator (solver->stats, ARAN_STATS_P2P_REMOTE,
+                           p2p_remote_count, NULL);
+  aran_stats_get_operator (solver->stats, ARAN_STATS_P2M, p2m_count, NULL);
+  aran_stats_get_operator (solver->stats, ARAN_STATS_M2M, m2m_count, NULL);
+  aran_stats_get_operator (solver->stats, ARAN_STATS_M2L, m2l_count, NULL);
+  aran_stats_get_operator (solver->stats, ARAN_STATS_M2L_REMOTE,
+                           m2l_remote_count, NULL);
+  aran_stats_get_operator (solver->stats, ARAN_STATS_L2L, l2l_count, NULL);
+  aran_stats_get_operator (solver->stats, ARAN_STATS_L2P, l2p_count, NULL);
+  aran_stats_get_operator (solver->stats, ARAN_STATS_P2L, p2l_count, NULL);
+  aran_stats_get_operator (solver->stats, ARAN_STATS_M2P, m2p_count, NULL);
+}
+
+/**
+ * aran_solver3d_peek_stats:
+ * @solver: an #AranSolver3d.
+ *
+ * Gives access to @solver instrumentation: phases wall clock and CPU times,
+ * operators call counts and times, with per level breakdowns. Values are
+ * accumulated over all calls to aran_solver3d_solve() since last call to
+ * aran_solver3d_reinit_stats().
+ *
+ * Returns: @solver #AranStats. Owned by @solver, must not be freed.
+ */
+AranStats *aran_solver3d_peek_stats (AranSolver3d *solver)
+{
+  g_return_val_if_fail (solver != NULL, NULL);
+
+  return solver->stats;
+}
+
+/**
+ * aran_solver3d_get_tolerance:
+ * @solver: an #AranSolver3d.
+ *
+ * Inquiry of the spatial tolerance used in the associated #VsgPRTree3d.
+ *
+ * Returns: spatial tolerance.
  */
-AranSolver3d *aran_solver3d_new (VsgPRTree3d *prtree,
-                                 GType devel_type,
-                                 gpointer devel,
-                                 AranZeroFunc zero)
+gdouble aran_solver3d_get_tolerance (AranSolver3d *solver)
 {
-  VsgVector3d lbound = {-1., -1., -1.};
-  VsgVector3d ubound = {1., 1., 1.};
-  AranSolver3d *solver;
+  g_return_val_if_fail (solver != NULL, -1.);
 
-  solver = _solver3d_alloc ();
+  return vsg_prtree3d_get_tolerance (solver->prtree);
+}
 
-  if (prtree == NULL)
-    solver->prtree = vsg_prtree3d_new (&lbound, &ubound, NULL, 0);
-  else
-    solver->prtree = prtree;
+/**
+ * aran_solver3d_set_tolerance:
+ * @solver: an #AranSolver3d.
+ * @tolerance: a positive #gdouble.
+ *
+ * Sets the spatial tolerance used in the associated #VsgPRTree3d.
+ */
+void aran_solver3d_set_tolerance (AranSolver3d *solver,
+                                  gdouble tolerance)
+{
+  g_return_if_fail (solver != NULL);
 
-  aran_solver3d_set_development (solver, devel_type, devel, zero);
+  vsg_prtree3d_set_tolerance (solver->prtree, tolerance);
+}
 
-  return solver;
+/**
+ * aran_solver3d_get_bounds:
+ * @solver: an #AranSolver3d.
+ * @lbound: bbox lower bound.
+ * @ubound: bbox upper bound.
+ *
+ * Gets the bounding box for the associated #VsgPRTree3d.
+ */
+void aran_solver3d_get_bounds (AranSolver3d *solver,
+                               VsgVector3d *lbound,
+                               VsgVector3d *ubound)
+{
+  g_return_if_fail (solver != NULL);
+
+  vsg_prtree3d_get_bounds (solver->prtree, lbound, ubound);
 }
 
 /**
- * aran_solver3d_free:
+ * aran_solver3d_depth:
  * @solver: an #AranSolver3d.
  *
- * Deallocates all memory associated with @solver (Even the #VsgPRTree3d is
- * freed).
+ * Computes the depth of the associated #VsgPRTree3d.
+ *
+ * Returns: tree depth.
  */
-void aran_solver3d_free (AranSolver3d *solver)
+guint aran_solver3d_depth (const AranSolver3d *solver)
 {
-  if (solver == NULL) return;
+  g_return_val_if_fail (solver != NULL, 0);
 
-  vsg_prtree3d_free (solver->prtree);
+  return vsg_prtree3d_depth (solver->prtree);
+}
 
-  if (solver->devel != NULL)
-    g_boxed_free (solver->devel_type, solver->devel);
+/**
+ * aran_solver3d_point_count:
+ * @solver: an #AranSolver3d.
+ *
+ * Counts the number of points (particles) in the associated #VsgPRTree3d.
+ *
+ * Returns: point count.
+ */
+guint aran_solver3d_point_count (const AranSolver3d *solver)
+{
+  g_return_val_if_fail (solver != NULL, 0);
 
-  _solver3d_dealloc (solver);
+  return vsg_prtree3d_point_count (solver->prtree);
 }
 
 /**
- * aran_solver3d_set_development:
+ * aran_solver3d_insert_point:
  * @solver: an #AranSolver3d.
- * @devel_type: #GType of development to be used by the solver.
- * @devel: instance of type @devel_type for cloning.
- * @zero: @devel_type zeroing function.
+ * @point: a particle.
  *
- * Associates @solver with a new development definition.
+ * Inserts a particle @point into the associated #VsgPRTree3d.
  */
-void aran_solver3d_set_development (AranSolver3d *solver,
-                                    GType devel_type,
-                                    gpointer devel,
-                                    AranZeroFunc zero)
+void aran_solver3d_insert_point (AranSolver3d *solver,
+                                 VsgPoint3 point)
 {
   g_return_if_fail (solver != NULL);
 
-  g_return_if_fail ((devel_type == G_TYPE_NONE) ||
-                    G_TYPE_IS_BOXED (devel_type));
+  vsg_prtree3d_insert_point (solver->prtree, point);
+}
 
-  if (solver->devel != NULL)
-    g_boxed_free (solver->devel_type, solver->devel);
+/**
+ * aran_solver3d_insert_point_local:
+ * @solver: an #AranSolver3d.
+ * @point: a particle.
+ *
+ * Inserts a particle @point into the associated #VsgPRTree3d only if
+ * @point falls in a local region of @solver's tree.
+ *
+ * Returns: #TRUE upon succesfull insertion.
+ */
+gboolean aran_solver3d_insert_point_local (AranSolver3d *solver,
+                                           VsgPoint2 point)
+{
+  g_return_val_if_fail (solver != NULL, FALSE);
 
-  solver->devel_type = devel_type;
-  solver->devel = devel;
-  solver->zero = zero;
+  return vsg_prtree3d_insert_point_local (solver->prtree, point);
+}
 
-  if (devel != NULL)
-    {
-      vsg_prtree3d_set_node_data (solver->prtree, devel_type, devel);
-    }
-  else
-    {
-      vsg_prtree3d_set_node_data (solver->prtree,
-                                  G_TYPE_NONE,
-                                  NULL);
-    }
+/**
+ * aran_solver3d_remove_point:
+ * @solver: an #AranSolver3d.
+ * @point: a particle.
+ *
+ * Removes a particle from the associated #VsgPRTree3d.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean aran_solver3d_remove_point (AranSolver3d *solver,
+                                     VsgPoint3 point)
+{
+  g_return_val_if_fail (solver != NULL, FALSE);
+
+  return vsg_prtree3d_remove_point (solver->prtree, point);
 }
 
 /**
- * aran_solver3d_set_functions:
+ * aran_solver3d_find_point:
  * @solver: an #AranSolver3d.
- * @p2p: particle 2 particle function.
- * @p2m: particle 2 multipole function.
- * @m2m: multipole 2 multipole function.
- * @m2l: multipole 2 local function.
- * @l2l: local 2 local function.
- * @l2p: local 2 particle function.
+ * @selector: a particle.
  *
- * Associates @solver with a minimal set of FMM functions.
+ * See vsg_prtree3d_find_point() in Vsg API docs.
+ *
+ * Returns: found #VsgPoint3 or NULL.
  */
-void aran_solver3d_set_functions (AranSolver3d *solver,
-                                  AranParticle2ParticleFunc3d p2p,
-                                  AranParticle2MultipoleFunc3d p2m,
-                                  AranMultipole2MultipoleFunc3d m2m,
-                                  AranMultipole2LocalFunc3d m2l,
-                                  AranLocal2LocalFunc3d l2l,
-                                  AranLocal2ParticleFunc3d l2p)
+VsgPoint3 aran_solver3d_find_point (AranSolver3d *solver,
+                                    VsgPoint3 selector)
 {
-  aran_solver3d_set_functions_full (solver, p2p, p2m, m2m, m2l, l2l, l2p,
-                                    NULL, NULL, 0);
+  g_return_val_if_fail (solver != NULL, NULL);
+
+  return vsg_prtree3d_find_point (solver->prtree, selector);
 }
 
 /**
- * aran_solver3d_set_functions_full:
+ * aran_solver3d_update_positions:
  * @solver: an #AranSolver3d.
- * @p2p: particle 2 particle function.
- * @p2m: particle 2 multipole function.
- * @m2m: multipole 2 multipole function.
- * @m2l: multipole 2 local function.
- * @l2l: local 2 local function.
- * @l2p: local 2 particle function.
- * @p2l: particle 2 local function.
- * @m2p: multipole 2 particle function.
- * @semifar_threshold: beyond this number of particles, @p2l and @m2p
- * can be called instead of @p2p. If @semifar_threshold is #G_MAXUINT,
- * @p2p will always be called.
+ * @move: particle move function.
+ * @user_data: pointer to pass to @move.
  *
- * Associates @solver with a complete set of FMM functions.
+ * Moves every local particle of @solver to its new position with
+ * @move and updates the associated #VsgPRTree3d accordingly. Particles that
+ * stay inside their leaf are left untouched. Only particles that cross a leaf
+ * boundary are placed back at their previous position with @move in order to
+ * be removed from the tree and are reinserted once all of them have been
+ * removed. This way, leaves splitting or merging triggered by the removals
+ * and the insertions happens at most once per update.
+ *
+ * In parallel mode, particles whose new position falls into a remote region
+ * are only queued: aran_solver3d_migrate_flush() has to be called afterwards
+ * in order to send them to their new owner.
+ *
+ * Returns: the number of particles that crossed a leaf boundary.
  */
-void aran_solver3d_set_functions_full (AranSolver3d *solver,
-                                       AranParticle2ParticleFunc3d p2p,
-                                       AranParticle2MultipoleFunc3d p2m,
-                                       AranMultipole2MultipoleFunc3d m2m,
-                                       AranMultipole2LocalFunc3d m2l,
-                                       AranLocal2LocalFunc3d l2l,
-                                       AranLocal2ParticleFunc3d l2p,
-                                       AranParticle2LocalFunc3d p2l,
-                                       AranMultipole2ParticleFunc3d m2p,
-                                       guint semifar_threshold)
+guint aran_solver3d_update_positions (AranSolver3d *solver,
+                                      AranParticleMoveFunc3d move,
+                                      gpointer user_data)
 {
-  g_return_if_fail (solver != NULL);
+  UpdateData ud = {NULL, move, user_data, NULL};
+  GSList *crossing;
+  guint count = 0;
 
-  if (solver->p2p != p2p) solver->p2p_time = -1.;
-  if (solver->p2m != p2m) solver->p2m_time = -1.;
-  if (solver->m2m != m2m) solver->m2m_time = -1.;
-  if (solver->m2l != m2l) solver->m2l_time = -1.;
-  if (solver->l2l != l2l) solver->l2l_time = -1.;
-  if (solver->l2p != l2p) solver->l2p_time = -1.;
-  if (solver->p2l != p2l) solver->p2l_time = -1.;
-  if (solver->m2p != m2p) solver->m2p_time = -1.;
+  g_return_val_if_fail (solver != NULL, 0);
+  g_return_val_if_fail (move != NULL, 0);
 
-  solver->p2p = p2p;
+  ud.prtree = solver->prtree;
 
-  solver->p2m = p2m;
-  solver->m2m = m2m;
-  solver->m2l = m2l;
-  solver->l2l = l2l;
-  solver->l2p = l2p;
-  solver->p2l = p2l;
-  solver->m2p = m2p;
+  /* tree structure is left unchanged during the traversal */
+  vsg_prtree3d_traverse (solver->prtree, G_POST_ORDER,
+                         (VsgPRTree3dFunc) update_func,
+                         &ud);
+
+  crossing = ud.crossing;
+  while (crossing)
+    {
+      VsgPoint3 point = (VsgPoint3) crossing->data;
+
+      move (point, FALSE, user_data);
+
+      if (! vsg_prtree3d_remove_point (solver->prtree, point))
+        g_critical ("aran_solver3d_update_positions: "
+                    "couldn't remove particle %p from its leaf", point);
+
+      move (point, TRUE, user_data);
+
+      count ++;
+      crossing = crossing->next;
+    }
+
+  crossing = ud.crossing;
+  while (crossing)
+    {
+      vsg_prtree3d_insert_point (solver->prtree, (VsgPoint3) crossing->data);
+
+      crossing = crossing->next;
+    }
+
+  g_slist_free (ud.crossing);
+
+  return count;
+}
+
+typedef struct _EvalLeaf EvalLeaf;
+
+struct _EvalLeaf {
+  const VsgPRTree3dNodeInfo *info; /* expansion node info */
+  guint64 kmin;             /* first Morton key inside the leaf */
+  guint64 kmax;             /* first Morton key after the leaf */
+};
+
+typedef struct _EvalQuery EvalQuery;
+
+struct _EvalQuery {
+  guint64 key;
+  VsgPoint3 point;
+};
+
+typedef struct _EvalBatch EvalBatch;
+
+/* queries sharing the same leaf */
+struct _EvalBatch {
+  const VsgPRTree3dNodeInfo *info; /* expansion node info */
+  EvalQuery *queries;
+  guint n;
+};
+
+typedef struct _EvalData EvalData;
+
+struct _EvalData {
+  GArray *leaves;
+  VsgVector3d lbound;
+  VsgVector3d size;
+  guint depth;
+
+  AranSolver3d *solver;
+  TaskNode *root;
+  AranParticle2ParticleFunc3d p2p;
+  AranLocal2ParticleFunc3d l2p;
+  GPtrArray **neighbors; /* one per worker */
+};
+
+/* maximum tree depth for 64 bits Morton keys */
+#define ARAN_SOLVER3D_EVAL_MAX_DEPTH (21)
+
+static guint64 _morton_key (const gint64 c[3])
+{
+  guint64 key = 0;
+  gint i;
+
+  for (i=ARAN_SOLVER3D_EVAL_MAX_DEPTH-1; i>=0; i--)
+    {
+      key = (key << 3) | (((c[2] >> i) & 1) << 2) |
+        (((c[1] >> i) & 1) << 1) | ((c[0] >> i) & 1);
+    }
+
+  return key;
+}
+
+static gint _eval_leaf_cmp (const EvalLeaf *a, const EvalLeaf *b)
+{
+  return (a->kmin > b->kmin) - (a->kmin < b->kmin);
+}
 
-  solver->semifar_threshold = semifar_threshold;
+static gint _eval_query_cmp (const EvalQuery *a, const EvalQuery *b)
+{
+  return (a->key > b->key) - (a->key < b->key);
 }
 
-void aran_solver3d_get_functions_full (AranSolver3d *solver,
-                                       AranParticle2ParticleFunc3d *p2p,
-                                       AranParticle2MultipoleFunc3d *p2m,
-                                       AranMultipole2MultipoleFunc3d *m2m,
-                                       AranMultipole2LocalFunc3d *m2l,
-                                       AranLocal2LocalFunc3d *l2l,
-                                       AranLocal2ParticleFunc3d *l2p,
-                                       AranParticle2LocalFunc3d *p2l,
-                                       AranMultipole2ParticleFunc3d *m2p,
-                                       guint *semifar_threshold)
+/* @node_info lower cell coordinates and width */
+static gint64 _eval_node_cells (EvalData *ed,
+                                const VsgPRTree3dNodeInfo *node_info,
+                                gint64 lo[3])
 {
-  g_return_if_fail (solver != NULL);
+  gdouble ncells = (gdouble) (1 << ed->depth);
+  gint64 width = 1 << (ed->depth - node_info->depth);
 
-  if (p2m) *p2m = solver->p2m;
-  if (m2m) *m2m = solver->m2m;
-  if (m2l) *m2l = solver->m2l;
-  if (l2l) *l2l = solver->l2l;
-  if (l2p) *l2p = solver->l2p;
-  if (p2l) *p2l = solver->p2l;
-  if (m2p) *m2p = solver->m2p;
+  lo[0] = (gint64) floor ((node_info->center.x - ed->lbound.x) /
+                          ed->size.x * ncells - 0.5 * width + 0.5);
+  lo[1] = (gint64) floor ((node_info->center.y - ed->lbound.y) /
+                          ed->size.y * ncells - 0.5 * width + 0.5);
+  lo[2] = (gint64) floor ((node_info->center.z - ed->lbound.z) /
+                          ed->size.z * ncells - 0.5 * width + 0.5);
 
-  if (semifar_threshold) *semifar_threshold = solver->semifar_threshold;
+  return width;
 }
 
-void aran_solver3d_db_profile_operators (AranSolver3d *solver, gdouble order)
+static void _eval_leaf_add (EvalData *ed,
+                            const VsgPRTree3dNodeInfo *node_info)
 {
-  g_return_if_fail (solver != NULL);
+  const VsgPRTree3dNodeInfo *expansion_info = node_info;
+  EvalLeaf leaf;
+  gint64 lo[3], width;
 
-  if (solver->p2p)
-    {
-      solver->p2p_time = aran_profile_db_address_eval (solver->p2p, 0.);
-    }
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
+#endif
 
-  if (solver->p2m)
-    {
-      solver->p2m_time = aran_profile_db_address_eval (solver->p2m, order);
-    }
+  if (! node_info->isleaf) return;
 
-  if (solver->p2l)
-    {
-      solver->p2l_time = aran_profile_db_address_eval (solver->p2l, order);
-    }
+  width = _eval_node_cells (ed, node_info, lo);
 
-  if (solver->l2p)
-    {
-      solver->l2p_time = aran_profile_db_address_eval (solver->p2p, order);
-    }
+  leaf.kmin = _morton_key (lo);
+  leaf.kmax = leaf.kmin + width * width * width;
 
-  if (solver->m2p)
-    {
-      solver->m2p_time = aran_profile_db_address_eval (solver->m2p, order);
-    }
+  /* empty leaves don't receive l2l: use the closest non empty ancestor
+   * expansion */
+  while (expansion_info->father_info != NULL &&
+         expansion_info->point_count == 0)
+    expansion_info = expansion_info->father_info;
 
-  if (solver->m2m)
-    {
-      solver->m2m_time = aran_profile_db_address_eval (solver->m2m, order);
-    }
+  leaf.info = expansion_info;
 
-  if (solver->m2l)
-    {
-      solver->m2l_time = aran_profile_db_address_eval (solver->m2l, order);
-    }
+  g_array_append_val (ed->leaves, leaf);
+}
 
-  if (solver->l2l)
+/* index of the last leaf starting at or before @key */
+static guint _eval_find_leaf (GArray *leaves, guint64 key)
+{
+  guint lo = 0, hi = leaves->len;
+
+  while (hi - lo > 1)
     {
-      solver->l2l_time = aran_profile_db_address_eval (solver->l2l, order);
-    }
+      guint mid = (lo + hi) / 2;
 
-  g_printerr ("db_p2p_time %p = %g\n", solver->p2p, solver->p2p_time);
-  g_printerr ("db_p2m_time %p = %g\n", solver->p2m, solver->p2m_time);
-  g_printerr ("db_p2l_time %p = %g\n", solver->p2l, solver->p2l_time);
-  g_printerr ("db_m2m_time %p = %g\n", solver->m2m, solver->m2m_time);
-  g_printerr ("db_m2l_time %p = %g\n", solver->m2l, solver->m2l_time);
-  g_printerr ("db_l2l_time %p = %g\n", solver->l2l, solver->l2l_time);
-  g_printerr ("db_l2p_time %p = %g\n", solver->l2p, solver->l2p_time);
-  g_printerr ("db_m2p_time %p = %g\n", solver->m2p, solver->m2p_time);
+      if (g_array_index (leaves, EvalLeaf, mid).kmin <= key) lo = mid;
+      else hi = mid;
+    }
 
+  return lo;
 }
-void aran_solver3d_profile_operators (AranSolver3d *solver,
-                                      AranParticleInitFunc3d point_init,
-                                      gpointer p1, gpointer p2)
+
+/* computes @point Morton key by routing it down the tree with @locfunc */
+static gboolean _eval_point_key (EvalData *ed, VsgPoint3 point,
+                                 VsgPoint3dLocFunc locfunc, guint64 *key)
 {
-  gdouble t;
-  guint maxbox;
-  VsgPRTree3dNodeInfo nodeinfo1 = {{0., 0., 0.},};
-  VsgPRTree3dNodeInfo nodeinfo2 = {{1., 1., 1.},};
-  gpointer dev1, dev2;
+  VsgVector3d ubound, center, half;
+  gint64 c[3] = {0, 0, 0};
+  guint l;
 
-  g_return_if_fail (solver != NULL);
+  vsg_vector3d_add (&ed->lbound, &ed->size, &ubound);
 
-  maxbox = vsg_prtree3d_get_max_point (solver->prtree);
+  /* reject points outside of the tree bounds */
+  if (locfunc (point, &ed->lbound) != (VSG_LOC3_X | VSG_LOC3_Y | VSG_LOC3_Z) ||
+      locfunc (point, &ubound) != 0)
+    return FALSE;
 
-  if (solver->p2p)
+  vsg_vector3d_scalp (&ed->size, 0.5, &center);
+  vsg_vector3d_add (&ed->lbound, &center, &center);
+  vsg_vector3d_scalp (&ed->size, 0.25, &half);
+
+  for (l=0; l<ed->depth; l++)
     {
-      t = aran_profile_nearfunc_3d (solver->p2p, point_init, p1, p2, maxbox);
-      solver->p2p_time = t / (maxbox * maxbox);;
-    }
+      gint loc = locfunc (point, &center);
 
-  dev1 = g_boxed_copy (solver->devel_type, solver->devel);
+      c[0] <<= 1;
+      c[1] <<= 1;
+      c[2] <<= 1;
 
-  if (solver->p2m)
-    {
-      t = aran_profile_p2m_3d (solver->p2m, solver->zero, p1, &nodeinfo1, dev1);
-      solver->p2m_time = t;
-    }
+      if (loc & VSG_LOC3_X) {c[0] |= 1; center.x += half.x;}
+      else center.x -= half.x;
 
-  if (solver->l2p)
-    {
-      t = aran_profile_l2p_3d (solver->l2p, point_init, &nodeinfo1, dev1, p1);
-      solver->l2p_time = t;
-    }
-  if (solver->p2l)
-    {
-      t = aran_profile_p2l_3d (solver->p2l, solver->zero, p1, &nodeinfo1, dev1);
-      solver->p2l_time = t;
+      if (loc & VSG_LOC3_Y) {c[1] |= 1; center.y += half.y;}
+      else center.y -= half.y;
+
+      if (loc & VSG_LOC3_Z) {c[2] |= 1; center.z += half.z;}
+      else center.z -= half.z;
+
+      vsg_vector3d_scalp (&half, 0.5, &half);
     }
 
-  if (solver->m2p)
+  *key = _morton_key (c);
+
+  return TRUE;
+}
+
+/* collects the leaves whose particles interact directly with the
+ * expansion node of ancestors @anc[0..@depth], the way the near/far
+ * traversal does: nodes of the same depth are far once they don't touch,
+ * everything below a touching pair or a touching virtual leaf is visited */
+static void _eval_near_leaves (AranSolver3d *solver, TaskNode *node,
+                               const VsgPRTree3dNodeInfo **anc, guint depth,
+                               GPtrArray *result)
+{
+  guint d = node->info.depth;
+  guint i;
+
+  if (d <= depth && ! _box_touch (&anc[d]->lbound, &anc[d]->ubound,
+                                  &node->info.lbound, &node->info.ubound,
+                                  NULL))
+    return;
+
+  if (node->info.isleaf)
     {
-      t = aran_profile_m2p_3d (solver->m2p, point_init, &nodeinfo1, dev1, p1);
-      solver->m2p_time = t;
+      g_ptr_array_add (result, &node->info);
+      return;
     }
 
-  dev2 = g_boxed_copy (solver->devel_type, solver->devel);
+  if (d < depth && _nf_leaf (solver, &node->info)) depth = d;
 
-  if (solver->m2m)
+  for (i=0; i<node->nchildren; i++)
+    _eval_near_leaves (solver, node->children[i], anc, depth, result);
+}
+
+/* runs @func on @items with @solver's workers, or in the calling thread */
+static void _solver_foreach (AranSolver3d *solver, GPtrArray *items,
+                             AranWorkerFunc func, gpointer user_data)
+{
+  guint i;
+
+  if (solver->workers != NULL)
     {
-      t = aran_profile_m2m_3d (solver->m2m, solver->zero, &nodeinfo1, dev1,
-                               &nodeinfo2, dev2);
-      solver->m2m_time = t;
+      aran_workers_foreach (solver->workers, items, func, user_data);
+      return;
     }
 
-  if (solver->m2l)
+  for (i=0; i<items->len; i ++)
+    func (g_ptr_array_index (items, i), 0, user_data);
+}
+
+static void _eval_prepare (VsgPRTree3dNodeInfo *info, guint worker,
+                           EvalData *ed)
+{
+  ed->solver->leaf_prepare (info, info->user_data,
+                            ed->solver->leaf_prepare_data);
+}
+
+static void _eval_batch (EvalBatch *batch, guint worker, EvalData *ed)
+{
+  AranSolver3d *solver = ed->solver;
+  GPtrArray *neighbors = ed->neighbors[worker];
+  guint i, j;
+
+  if (ed->p2p != NULL)
     {
-      t = aran_profile_m2l_3d (solver->m2l, solver->zero, &nodeinfo1, dev1,
-                               &nodeinfo2, dev2);
-      solver->m2l_time = t;
+      const VsgPRTree3dNodeInfo *anc[ARAN_SOLVER3D_EVAL_MAX_DEPTH+1];
+      const VsgPRTree3dNodeInfo *info = batch->info;
+      guint depth = batch->info->depth;
+
+      while (info != NULL)
+        {
+          anc[info->depth] = info;
+          info = info->father_info;
+        }
+
+      /* the traversal stops at the first virtual leaf */
+      for (j=0; j<depth; j++)
+        if (_nf_leaf (solver, anc[j])) depth = j;
+
+      g_ptr_array_set_size (neighbors, 0);
+      _eval_near_leaves (solver, ed->root, anc, depth, neighbors);
     }
 
-  if (solver->l2l)
+  for (i=0; i<batch->n; i++)
     {
-      t = aran_profile_l2l_3d (solver->l2l, solver->zero, &nodeinfo1, dev1,
-                               &nodeinfo2, dev2);
-      solver->l2l_time = t;
-    }
+      VsgPoint3 query = batch->queries[i].point;
 
-  g_boxed_free (solver->devel_type, dev1);
-  g_boxed_free (solver->devel_type, dev2);
+      if (ed->l2p != NULL)
+        ed->l2p (batch->info, batch->info->user_data, query);
 
-  /* g_printerr ("p2p_time = %g\n", solver->p2p_time); */
-  /* g_printerr ("p2m_time = %g\n", solver->p2m_time); */
-  /* g_printerr ("p2l_time = %g\n", solver->p2l_time); */
-  /* g_printerr ("m2m_time = %g\n", solver->m2m_time); */
-  /* g_printerr ("m2l_time = %g\n", solver->m2l_time); */
-  /* g_printerr ("l2l_time = %g\n", solver->l2l_time); */
-  /* g_printerr ("l2p_time = %g\n", solver->l2p_time); */
-  /* g_printerr ("m2p_time = %g\n", solver->m2p_time); */
+      if (ed->p2p == NULL) continue;
 
-}
+      for (j=0; j<neighbors->len; j++)
+        {
+          const VsgPRTree3dNodeInfo *ninfo = g_ptr_array_index (neighbors, j);
+          GSList *list = ninfo->point_list;
 
-/**
- * aran_solver3d_reinit_stats:
- * @solver: an #AranSolver3d.
- *
- * Resets @solver Near/Far counters to zero.
- */
-void aran_solver3d_reinit_stats (AranSolver3d *solver)
-{
-  g_return_if_fail (solver != NULL);
+          while (list)
+            {
+              VsgPoint3 src = (VsgPoint3) list->data;
 
-  solver->zero_counter = 0;
-  solver->p2p_counter = 0;
-  solver->p2p_remote_counter = 0;
+              if (solver->role == NULL ||
+                  (solver->role (src) & ARAN_PARTICLE_SOURCE))
+                ed->p2p (src, query);
 
-  solver->p2m_counter = 0;
-  solver->m2m_counter = 0;
-  solver->m2l_counter = 0;
-  solver->m2l_remote_counter = 0;
-  solver->l2l_counter = 0;
-  solver->l2p_counter = 0;
-  solver->p2l_counter = 0;
-  solver->m2p_counter = 0;
+              list = list->next;
+            }
+        }
+    }
 }
 
 /**
- * aran_solver3d_get_stats:
+ * aran_solver3d_evaluate_points:
  * @solver: an #AranSolver3d.
- * @zero: Clear function count result.
- * @p2p: particle 2 particle function count result.
- * @p2m: particle 2 multipole function count result.
- * @m2m: multipole 2 multipole function count result.
- * @m2l: multipole 2 local function count result.
- * @l2l: local 2 local function count result.
- * @l2p: local 2 particle function count result.
- * @p2l: particle 2 localfunction count result.
- * @m2p: multipole 2 particle function count result.
- * @p2p_remote: number of p2p calls with remote nodes.
- * @m2l_remote: number of m2l calls with remote nodes.
+ * @points: query particles.
+ * @n: number of elements in @points.
+ * @p2p: one way particle to particle function (from tree particle to
+ * query particle) or %NULL.
+ * @l2p: local to particle function or %NULL for @solver's.
  *
- * Retrieves count values for @solver differents functions. Each value
- * represents the number of calls of the corresponding functino since
- * last call to aran_solver3d_reinit_stats().
- */
-void aran_solver3d_get_stats (AranSolver3d *solver, glong *zero_count,
-                              glong *p2p_count, glong *p2m_count,
-                              glong *m2m_count, glong *m2l_count,
-                              glong *l2l_count, glong *l2p_count,
-                              glong *p2l_count, glong *m2p_count,
-                              glong *p2p_remote_count, glong *m2l_remote_count)
-{
-  g_return_if_fail (solver != NULL);
-
-  *zero_count = solver->zero_counter;
-  *p2p_count = solver->p2p_counter;
-  *p2p_remote_count = solver->p2p_remote_counter;
-  *p2m_count = solver->p2m_counter;
-  *m2m_count = solver->m2m_counter;
-  *m2l_count = solver->m2l_counter;
-  *m2l_remote_count = solver->m2l_remote_counter;
-  *l2l_count = solver->l2l_counter;
-  *l2p_count = solver->l2p_counter;
-  *p2l_count = solver->p2l_counter;
-  *m2p_count = solver->m2p_counter;
-}
-
-/**
- * aran_solver3d_get_tolerance:
- * @solver: an #AranSolver3d.
+ * Evaluates the field computed by the last call to aran_solver3d_solve()
+ * at @points positions, without inserting them in @solver. Each query is
+ * located in its leaf with @solver's point localization (see
+ * aran_solver3d_set_point_loc()), then gets the leaf's local expansion
+ * through @l2p and the near field through @p2p with the particles of every
+ * leaf the solver's traversal puts in near interaction with that leaf. Queries
+ * falling into an empty leaf use the expansion and the near field of the
+ * closest non empty ancestor. Below a virtual leaf (see
+ * aran_solver3d_set_nf_isleaf()), the near field is the one of the virtual
+ * leaf.
+ * Queries are processed in Morton order, in batches sharing the same leaf.
+ * Batches run on the threads set by aran_solver3d_set_threads(), in which
+ * case @p2p and @l2p must be safe to call concurrently on different query
+ * particles and @points must not hold the same particle twice.
  *
- * Inquiry of the spatial tolerance used in the associated #VsgPRTree3d.
+ * Query particles outside of @solver bounds are left untouched. @solver
+ * must not have been modified since its last solve, must not use semifar
+ * interactions nor particle roles (local developments of subtrees without
+ * targets are not computed), must not be periodic (images are not
+ * visited) and must not be distributed.
  *
- * Returns: spatial tolerance.
+ * Returns: the number of evaluated query particles.
  */
-gdouble aran_solver3d_get_tolerance (AranSolver3d *solver)
+guint aran_solver3d_evaluate_points (AranSolver3d *solver,
+                                     VsgPoint3 *points, guint n,
+                                     AranParticle2ParticleFunc3d p2p,
+                                     AranLocal2ParticleFunc3d l2p)
 {
-  g_return_val_if_fail (solver != NULL, -1.);
+  EvalData ed;
+  VsgVector3d ubound;
+  TaskTree *tt;
+  EvalQuery *queries;
+  GArray *batches;
+  GPtrArray *items;
+  GHashTable *prepared;
+  guint nq = 0, count = 0, nworkers;
+  guint i, j;
 
-  return vsg_prtree3d_get_tolerance (solver->prtree);
-}
+  g_return_val_if_fail (solver != NULL, 0);
+  g_return_val_if_fail (n == 0 || points != NULL, 0);
+  g_return_val_if_fail (solver->p2l == NULL || solver->m2p == NULL ||
+                        solver->semifar_threshold == G_MAXUINT, 0);
+  g_return_val_if_fail (solver->role == NULL, 0);
+  g_return_val_if_fail (solver->p2p_shift == NULL, 0);
 
-/**
- * aran_solver3d_set_tolerance:
- * @solver: an #AranSolver3d.
- * @tolerance: a positive #gdouble.
- *
- * Sets the spatial tolerance used in the associated #VsgPRTree3d.
- */
-void aran_solver3d_set_tolerance (AranSolver3d *solver,
-                                  gdouble tolerance)
-{
-  g_return_if_fail (solver != NULL);
+#ifdef VSG_HAVE_MPI
+  {
+    MPI_Comm communicator = vsg_prtree3d_get_communicator (solver->prtree);
+
+    if (communicator != MPI_COMM_NULL)
+      {
+        gint sz;
+
+        MPI_Comm_size (communicator, &sz);
+
+        g_return_val_if_fail (sz == 1, 0);
+      }
+  }
+#endif
+
+  if (l2p == NULL) l2p = solver->l2p;
+
+  ed.depth = aran_solver3d_depth (solver);
+  g_return_val_if_fail (ed.depth <= ARAN_SOLVER3D_EVAL_MAX_DEPTH, 0);
+
+  aran_solver3d_get_bounds (solver, &ed.lbound, &ubound);
+  vsg_vector3d_sub (&ubound, &ed.lbound, &ed.size);
+
+  /* flatten the leaves in Morton order */
+  ed.leaves = g_array_new (FALSE, FALSE, sizeof (EvalLeaf));
+
+  tt = _task_tree_new (solver);
+  ed.root = g_ptr_array_index ((GPtrArray *) g_ptr_array_index (tt->levels, 0),
+                               0);
+
+  for (i=0; i<tt->levels->len; i++)
+    {
+      GPtrArray *level = g_ptr_array_index (tt->levels, i);
+
+      for (j=0; j<level->len; j++)
+        {
+          TaskNode *node = g_ptr_array_index (level, j);
+
+          _eval_leaf_add (&ed, &node->info);
+        }
+    }
+
+  qsort (ed.leaves->data, ed.leaves->len, sizeof (EvalLeaf),
+         (gint (*) (const void *, const void *)) _eval_leaf_cmp);
+
+  /* sort queries in Morton order */
+  queries = g_malloc (n * sizeof (EvalQuery));
+
+  for (i=0; i<n; i++)
+    {
+      if (_eval_point_key (&ed, points[i], solver->point_loc,
+                           &queries[nq].key))
+        {
+          queries[nq].point = points[i];
+          nq ++;
+        }
+    }
+
+  qsort (queries, nq, sizeof (EvalQuery),
+         (gint (*) (const void *, const void *)) _eval_query_cmp);
+
+  /* split queries in batches sharing the same leaf */
+  batches = g_array_new (FALSE, FALSE, sizeof (EvalBatch));
+
+  i = 0;
+  while (i < nq && ed.leaves->len > 0)
+    {
+      EvalLeaf *leaf =
+        &g_array_index (ed.leaves, EvalLeaf,
+                        _eval_find_leaf (ed.leaves, queries[i].key));
+      EvalBatch batch;
+
+      if (queries[i].key < leaf->kmin || queries[i].key >= leaf->kmax)
+        {
+          /* not covered by a local leaf */
+          i ++;
+          continue;
+        }
+
+      batch.info = leaf->info;
+      batch.queries = &queries[i];
+
+      while (i < nq && queries[i].key < leaf->kmax) i ++;
+
+      batch.n = &queries[i] - batch.queries;
+      count += batch.n;
+
+      g_array_append_val (batches, batch);
+    }
 
-  vsg_prtree3d_set_tolerance (solver->prtree, tolerance);
-}
+  ed.solver = solver;
+  ed.p2p = p2p;
+  ed.l2p = l2p;
 
-/**
- * aran_solver3d_get_bounds:
- * @solver: an #AranSolver3d.
- * @lbound: bbox lower bound.
- * @ubound: bbox upper bound.
- *
- * Gets the bounding box for the associated #VsgPRTree3d.
- */
-void aran_solver3d_get_bounds (AranSolver3d *solver,
-                               VsgVector3d *lbound,
-                               VsgVector3d *ubound)
-{
-  g_return_if_fail (solver != NULL);
+  items = g_ptr_array_new ();
 
-  vsg_prtree3d_get_bounds (solver->prtree, lbound, ubound);
-}
+  /* empty leaves share their expansion: prepare each one once */
+  if (l2p != NULL && solver->leaf_prepare != NULL)
+    {
+      prepared = g_hash_table_new (g_direct_hash, g_direct_equal);
 
-/**
- * aran_solver3d_depth:
- * @solver: an #AranSolver3d.
- *
- * Computes the depth of the associated #VsgPRTree3d.
- *
- * Returns: tree depth.
- */
-guint aran_solver3d_depth (const AranSolver3d *solver)
-{
-  g_return_val_if_fail (solver != NULL, 0);
+      for (i=0; i<batches->len; i++)
+        {
+          EvalBatch *batch = &g_array_index (batches, EvalBatch, i);
 
-  return vsg_prtree3d_depth (solver->prtree);
-}
+          if (g_hash_table_lookup (prepared, batch->info) != NULL) continue;
 
-/**
- * aran_solver3d_point_count:
- * @solver: an #AranSolver3d.
- *
- * Counts the number of points (particles) in the associated #VsgPRTree3d.
- *
- * Returns: point count.
- */
-guint aran_solver3d_point_count (const AranSolver3d *solver)
-{
-  g_return_val_if_fail (solver != NULL, 0);
+          g_hash_table_insert (prepared, (gpointer) batch->info,
+                               (gpointer) batch->info);
+          g_ptr_array_add (items, (gpointer) batch->info);
+        }
 
-  return vsg_prtree3d_point_count (solver->prtree);
-}
+      _solver_foreach (solver, items, (AranWorkerFunc) _eval_prepare, &ed);
 
-/**
- * aran_solver3d_insert_point:
- * @solver: an #AranSolver3d.
- * @point: a particle.
- *
- * Inserts a particle @point into the associated #VsgPRTree3d.
- */
-void aran_solver3d_insert_point (AranSolver3d *solver,
-                                 VsgPoint3 point)
-{
-  g_return_if_fail (solver != NULL);
+      g_hash_table_destroy (prepared);
+      g_ptr_array_set_size (items, 0);
+    }
 
-  vsg_prtree3d_insert_point (solver->prtree, point);
-}
+  nworkers = (solver->workers != NULL) ?
+    aran_workers_count (solver->workers) : 1;
 
-/**
- * aran_solver3d_insert_point_local:
- * @solver: an #AranSolver3d.
- * @point: a particle.
- *
- * Inserts a particle @point into the associated #VsgPRTree3d only if
- * @point falls in a local region of @solver's tree.
- *
- * Returns: #TRUE upon succesfull insertion.
- */
-gboolean aran_solver3d_insert_point_local (AranSolver3d *solver,
-                                           VsgPoint2 point)
-{
-  g_return_val_if_fail (solver != NULL, FALSE);
+  ed.neighbors = g_malloc (nworkers * sizeof (GPtrArray *));
+  for (i=0; i<nworkers; i++)
+    ed.neighbors[i] = g_ptr_array_new ();
 
-  return vsg_prtree3d_insert_point_local (solver->prtree, point);
-}
+  for (i=0; i<batches->len; i++)
+    g_ptr_array_add (items, &g_array_index (batches, EvalBatch, i));
 
-/**
- * aran_solver3d_remove_point:
- * @solver: an #AranSolver3d.
- * @point: a particle.
- *
- * Removes a particle from the associated #VsgPRTree3d.
- *
- * Returns: %TRUE on success.
- */
-gboolean aran_solver3d_remove_point (AranSolver3d *solver,
-                                     VsgPoint3 point)
-{
-  g_return_val_if_fail (solver != NULL, FALSE);
+  _solver_foreach (solver, items, (AranWorkerFunc) _eval_batch, &ed);
 
-  return vsg_prtree3d_remove_point (solver->prtree, point);
-}
+  for (i=0; i<nworkers; i++)
+    g_ptr_array_free (ed.neighbors[i], TRUE);
+  g_free (ed.neighbors);
 
-/**
- * aran_solver3d_find_point:
- * @solver: an #AranSolver3d.
- * @selector: a particle.
- *
- * See vsg_prtree3d_find_point() in Vsg API docs.
- *
- * Returns: found #VsgPoint3 or NULL.
- */
-VsgPoint3 aran_solver3d_find_point (AranSolver3d *solver,
-                                    VsgPoint3 selector)
-{
-  g_return_val_if_fail (solver != NULL, NULL);
+  g_ptr_array_free (items, TRUE);
+  g_array_free (batches, TRUE);
+  g_free (queries);
+  g_array_free (ed.leaves, TRUE);
+  _task_tree_free (tt, NULL);
 
-  return vsg_prtree3d_find_point (solver->prtree, selector);
+  return count;
 }
 
 /**
@@ -1091,39 +4515,448 @@ guint aran_solver3d_optimal_semifar_threshold (AranSolver3d *solver)
 {
   guint semifar_threshold;
 
-  g_return_val_if_fail (solver != NULL, G_MAXUINT);
+  g_return_val_if_fail (solver != NULL, G_MAXUINT);
+
+  if (solver->p2l_time < 0. || solver->m2p_time < 0. || solver->p2p_time <= 0.)
+    {
+      semifar_threshold = G_MAXUINT;
+    }
+  else
+    {
+      semifar_threshold = (solver->p2l_time + solver->m2p_time) / solver->p2p_time;
+    }
+
+#ifdef VSG_HAVE_MPI
+  /* semifar threshold values are to be consistent across all processors */
+  {
+    MPI_Comm communicator = vsg_prtree3d_get_communicator (solver->prtree);
+
+    if (communicator != MPI_COMM_NULL)
+      {
+        guint tmp;
+        gint sz;
+
+        MPI_Comm_size (communicator, &sz);
+
+        if (sz > 1)
+          {
+            MPI_Allreduce (&semifar_threshold, &tmp, 1, MPI_UNSIGNED, MPI_MAX, communicator);
+            semifar_threshold = tmp;
+          }
+      }
+  }
+#endif
+
+  return semifar_threshold;
+}
+
+/**
+ * aran_solver3d_set_adaptive_semifar:
+ * @solver: an #AranSolver3d.
+ * @adaptive: whether to decide semifar interactions pair by pair.
+ *
+ * Replaces the global semifar threshold by a decision taken for each pair
+ * of a leaf and a smaller internal node that it does not touch (particles
+ * next to a node would make p2l/m2p diverge): p2l/m2p are used when their
+ * estimated cost is lower than the one of opening the node, computed
+ * recursively from both nodes particle counts and the operator times of
+ * aran_solver3d_profile_operators(). Pairs computed on two processors
+ * count their p2p twice. Operator times are reduced over all processors so
+ * that every one takes the same decisions. The near/far traversal is then
+ * done by @solver itself, which in parallel requires
+ * aran_solver3d_set_let(): otherwise, and when operators are not profiled,
+ * the global threshold is used.
+ */
+void aran_solver3d_set_adaptive_semifar (AranSolver3d *solver,
+                                         gboolean adaptive)
+{
+  g_return_if_fail (solver != NULL);
+
+  solver->adaptive_semifar = adaptive;
+}
+
+/**
+ * AranSolver3dConfig:
+ * @order: multipole expansion degree (as in aran_development3d_new()).
+ * @maxbox: maximum number of particles per tree leaf.
+ * @m2m: multipole to multipole translation function.
+ * @m2l: multipole to local translation function.
+ * @l2l: local to local translation function.
+ * @error: a priori relative error bound for @order.
+ * @time: predicted solve time.
+ *
+ * Solver configuration computed by aran_solver3d_auto_config().
+ */
+
+typedef struct _Translations3d Translations3d;
+
+struct _Translations3d
+{
+  AranMultipole2MultipoleFunc3d m2m;
+  AranMultipole2LocalFunc3d m2l;
+  AranLocal2LocalFunc3d l2l;
+};
+
+static const Translations3d _translations3d[] = {
+  {(AranMultipole2MultipoleFunc3d) aran_development3d_m2m,
+   (AranMultipole2LocalFunc3d) aran_development3d_m2l,
+   (AranLocal2LocalFunc3d) aran_development3d_l2l},
+  {(AranMultipole2MultipoleFunc3d) aran_development3d_m2m_kkylin,
+   (AranMultipole2LocalFunc3d) aran_development3d_m2l_kkylin,
+   (AranLocal2LocalFunc3d) aran_development3d_l2l_kkylin},
+  {(AranMultipole2MultipoleFunc3d) aran_development3d_m2m_rotate,
+   (AranMultipole2LocalFunc3d) aran_development3d_m2l_rotate,
+   (AranLocal2LocalFunc3d) aran_development3d_l2l_rotate},
+};
+
+/*
+ * ratio between a cube radius and the distance from a well separated cube
+ * center to its nearest point: sqrt(3)/2 / (2 - sqrt(3)/2)
+ */
+#define ARAN_SQRT3 (1.7320508075688772935)
+#define ARAN_SOLVER3D_SEPARATION_RATIO (ARAN_SQRT3 / (4. - ARAN_SQRT3))
+
+/* near and far interaction lists sizes in an uniform octree */
+#define ARAN_SOLVER3D_NEAR_SIZE (27.)
+#define ARAN_SOLVER3D_FAR_SIZE (189.)
+
+/**
+ * aran_solver3d_error_bound:
+ * @order: multipole expansion degree.
+ *
+ * Computes an a priori bound for the relative truncation error of
+ * spherical harmonics expansions of degree @order between well separated
+ * octree nodes.
+ *
+ * Returns: relative error bound.
+ */
+gdouble aran_solver3d_error_bound (guint order)
+{
+  gdouble rho = ARAN_SOLVER3D_SEPARATION_RATIO;
+
+  return pow (rho, order) / (1. - rho);
+}
+
+/* uniform octree model of a solve cost */
+static gdouble _predicted_time3d (guint np, guint maxbox,
+                                  gdouble p2p_time,
+                                  gdouble p2m_time, gdouble l2p_time,
+                                  gdouble m2m_time, gdouble m2l_time,
+                                  gdouble l2l_time)
+{
+  gdouble leaves = MAX (1., ceil ((gdouble) np / maxbox));
+  gdouble nodes = (8. * leaves - 1.) / 7.;
+  gdouble far = MIN (ARAN_SOLVER3D_FAR_SIZE, nodes - 1.);
+
+  return 0.5 * ARAN_SOLVER3D_NEAR_SIZE * np * maxbox * p2p_time +
+    np * (p2m_time + l2p_time) +
+    nodes * (m2m_time + l2l_time + far * m2l_time);
+}
+
+/* profile db evaluation of an operator. Unknown operators cost nothing */
+static gdouble _operator_time (gpointer op, gdouble order)
+{
+  gdouble t;
+
+  if (op == NULL) return 0.;
+
+  t = aran_profile_db_address_eval (op, order);
+
+  return isnan (t) ? 0. : t;
+}
+
+/**
+ * aran_solver3d_auto_config:
+ * @solver: an #AranSolver3d.
+ * @epsilon: target relative error.
+ * @np: number of particles of the problem. If 0, the number of particles
+ * of @solver is used.
+ * @config: result location.
+ *
+ * Selects the lowest expansion degree whose a priori error bound (see
+ * aran_solver3d_error_bound()) is below @epsilon. Then, with operators costs
+ * taken from the profile database (see aran_profile_db_read_file()), chooses
+ * the leaf size and the #AranDevelopment3d translation variant (plain,
+ * kkylin or rotate) of minimal predicted time. Translation variants
+ * missing from the profile database are ignored. When @solver p2p
+ * cost is unknown (neither in the database nor measured by
+ * aran_solver3d_profile_operators()), @solver current leaf size is kept.
+ *
+ * @solver particles are only used as a sample: the caller is expected to
+ * create the actual solver from @config (ie. a #VsgPRTree3d with
+ * @config->maxbox, aran_development3d_new (0, @config->order) and
+ * @config translation functions).
+ *
+ * Returns: %TRUE if a configuration meeting @epsilon was found.
+ */
+gboolean aran_solver3d_auto_config (AranSolver3d *solver, gdouble epsilon,
+                                    guint np, AranSolver3dConfig *config)
+{
+  guint order, maxbox, maxbox_min, maxbox_max;
+  gdouble p2p_time, p2m_time, l2p_time;
+  gboolean found = FALSE;
+  gint i;
+
+  g_return_val_if_fail (solver != NULL, FALSE);
+  g_return_val_if_fail (epsilon > 0., FALSE);
+  g_return_val_if_fail (config != NULL, FALSE);
+
+  for (order = 1; order <= ARAN_SOLVER3D_AUTO_MAX_ORDER; order ++)
+    if (aran_solver3d_error_bound (order) <= epsilon) break;
+
+  if (order > ARAN_SOLVER3D_AUTO_MAX_ORDER) return FALSE;
+
+  if (np == 0)
+    {
+      np = aran_solver3d_point_count (solver);
+
+#ifdef VSG_HAVE_MPI
+      {
+        MPI_Comm communicator = vsg_prtree3d_get_communicator (solver->prtree);
+
+        if (communicator != MPI_COMM_NULL)
+          {
+            guint tmp;
+
+            MPI_Allreduce (&np, &tmp, 1, MPI_UNSIGNED, MPI_SUM, communicator);
+            np = tmp;
+          }
+      }
+#endif
+    }
+
+  p2p_time = (solver->p2p != NULL) ?
+    aran_profile_db_address_eval (solver->p2p, 0.) : NAN;
+  if (isnan (p2p_time)) p2p_time = solver->p2p_time;
+
+  if (p2p_time < 0.)
+    {
+      maxbox_min = vsg_prtree3d_get_max_point (solver->prtree);
+      maxbox_max = maxbox_min;
+      p2p_time = 0.;
+    }
+  else
+    {
+      maxbox_min = 1;
+      maxbox_max = ARAN_SOLVER3D_AUTO_MAX_MAXBOX;
+    }
+
+  p2m_time = _operator_time (solver->p2m, order);
+  l2p_time = _operator_time (solver->l2p, order);
+
+  for (i = 0; i < G_N_ELEMENTS (_translations3d); i ++)
+    {
+      const Translations3d *tr = &_translations3d[i];
+      gdouble m2m_time = aran_profile_db_address_eval (tr->m2m, order);
+      gdouble m2l_time = aran_profile_db_address_eval (tr->m2l, order);
+      gdouble l2l_time = aran_profile_db_address_eval (tr->l2l, order);
+
+      if (isnan (m2m_time) || isnan (m2l_time) || isnan (l2l_time))
+        continue;
+
+      for (maxbox = maxbox_min; maxbox <= maxbox_max; maxbox ++)
+        {
+          gdouble t = _predicted_time3d (np, maxbox, p2p_time,
+                                         p2m_time, l2p_time,
+                                         m2m_time, m2l_time, l2l_time);
+
+          if (! found || t < config->time)
+            {
+              found = TRUE;
+
+              config->order = order;
+              config->maxbox = maxbox;
+              config->m2m = tr->m2m;
+              config->m2l = tr->m2l;
+              config->l2l = tr->l2l;
+              config->error = aran_solver3d_error_bound (order);
+              config->time = t;
+            }
+        }
+    }
+
+  return found;
+}
+
+/* leaves whose local development went through the downward pass (empty
+ * nodes get no l2l) and that were prepared */
+static void far_leaf_insert_func (const VsgPRTree3dNodeInfo *node_info,
+                                  AranSolver3d *solver)
+{
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
+#endif
+
+  if (node_info->isleaf && node_info->point_count != 0 &&
+      _node_has_role (node_info, solver->target_nodes))
+    _node_set_insert (solver->far_leaves, node_info);
+}
+
+static gboolean _leaf_has_target (AranSolver3d *solver,
+                                  const VsgPRTree3dNodeInfo *leaf_info)
+{
+  GSList *list = leaf_info->point_list;
+
+  if (solver->role == NULL) return list != NULL;
+
+  for (; list != NULL; list = list->next)
+    if (solver->role ((VsgPoint3) list->data) & ARAN_PARTICLE_TARGET)
+      return TRUE;
+
+  return FALSE;
+}
+
+typedef struct _FarLeafCheck FarLeafCheck;
+struct _FarLeafCheck {
+  AranSolver3d *solver;
+  gboolean same;
+};
+
+static void far_leaf_check_func (const VsgPRTree3dNodeInfo *node_info,
+                                 FarLeafCheck *check)
+{
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return;
+#endif
+
+  if (! node_info->isleaf || ! check->same) return;
+
+  if (g_hash_table_lookup (check->solver->far_leaves, &node_info->id) == NULL &&
+      _leaf_has_target (check->solver, node_info))
+    check->same = FALSE;
+}
+
+/* tells if local developments from the last complete solve can be used in
+ * place of a new far field computation */
+static gboolean _far_reuse_possible (AranSolver3d *solver)
+{
+  FarLeafCheck check = {solver, TRUE};
+
+  if (solver->far_period < 2 || solver->far_leaves == NULL ||
+      solver->far_age + 1 >= solver->far_period) return FALSE;
+
+  if (solver->p2p_shift != NULL) return FALSE;
 
-  if (solver->p2l_time < 0. || solver->m2p_time < 0. || solver->p2p_time <= 0.)
-    {
-      semifar_threshold = G_MAXUINT;
-    }
-  else
-    {
-      semifar_threshold = (solver->p2l_time + solver->m2p_time) / solver->p2p_time;
-    }
+  if (solver->p2l != NULL && solver->m2p != NULL &&
+      (solver->semifar_threshold != G_MAXUINT || solver->adaptive_semifar))
+    return FALSE;
+
+  /* locals are only valid for the leaves they were computed on: every
+   * target has to fall into one of them */
+  vsg_prtree3d_traverse (solver->prtree, G_PRE_ORDER,
+                         (VsgPRTree3dFunc) far_leaf_check_func, &check);
 
 #ifdef VSG_HAVE_MPI
-  /* semifar threshold values are to be consistent across all processors */
   {
     MPI_Comm communicator = vsg_prtree3d_get_communicator (solver->prtree);
 
     if (communicator != MPI_COMM_NULL)
       {
-        guint tmp;
-        gint sz;
+        gint same = check.same;
 
-        MPI_Comm_size (communicator, &sz);
+        MPI_Allreduce (MPI_IN_PLACE, &same, 1, MPI_INT, MPI_LAND,
+                       communicator);
 
-        if (sz > 1)
-          {
-            MPI_Allreduce (&semifar_threshold, &tmp, 1, MPI_UNSIGNED, MPI_MAX, communicator);
-            semifar_threshold = tmp;
-          }
+        check.same = same;
       }
   }
 #endif
 
-  return semifar_threshold;
+  return check.same;
+}
+
+static gdouble _far_l2p (const VsgPRTree3dNodeInfo *node_info,
+                         AranSolver3d *solver, AranStatsBlock *block)
+{
+#ifdef VSG_HAVE_MPI
+  if (VSG_PRTREE3D_NODE_INFO_IS_PRIVATE_REMOTE (node_info)) return 0.;
+#endif
+
+  if (! node_info->isleaf) return 0.;
+
+  /* locals are unchanged since their preparation */
+  return _down_l2p (node_info, solver, block, FALSE);
+}
+
+static void far_l2p_func (const VsgPRTree3dNodeInfo *node_info,
+                          AranSolver3d *solver)
+{
+  _node_cost_add (solver, node_info,
+                  _far_l2p (node_info, solver,
+                            _SOLVER3D_STATS_BLOCK (solver)));
+}
+
+static void _far_l2p_task (TaskNode *node, guint worker,
+                           AranSolver3d *solver)
+{
+  node->cost += _far_l2p (&node->info, solver,
+                          aran_stats_get_block (solver->stats, worker));
+}
+
+/* near field only solve: far field comes from the local developments of
+ * the last complete solve */
+static void _far_reuse_solve (AranSolver3d *solver,
+                              VsgPRTree3dInteractionFunc near)
+{
+  TaskTree *tasks = NULL;
+
+  if (solver->workers != NULL && ! _distributed (solver))
+    tasks = _task_tree_new (solver);
+
+#ifdef VSG_HAVE_MPI
+  if (solver->let && tasks == NULL)
+    tasks = _task_tree_new (solver);
+#endif
+
+  aran_stats_phase_begin (solver->stats, ARAN_STATS_PHASE_NEAR_FAR);
+
+#ifdef VSG_HAVE_MPI
+  if (solver->let)
+    _let_solve (solver, tasks, FALSE, FALSE);
+  else
+#endif
+  if (tasks != NULL)
+    _task_near_far_solve (solver, tasks, FALSE, FALSE);
+  else
+    vsg_prtree3d_near_far_traversal_full (solver->prtree,
+                                          (VsgPRTree3dFarInteractionFunc)
+                                          nop_far_func, near, NULL,
+                                          G_MAXUINT, solver);
+
+  aran_stats_phase_end (solver->stats, ARAN_STATS_PHASE_NEAR_FAR);
+
+  aran_stats_phase_begin (solver->stats, ARAN_STATS_PHASE_DOWN);
+
+  if (solver->workers != NULL && tasks != NULL)
+    _task_tree_foreach (tasks, solver, G_PRE_ORDER,
+                        (AranWorkerFunc) _far_l2p_task);
+  else
+    vsg_prtree3d_traverse (solver->prtree, G_PRE_ORDER,
+                           (VsgPRTree3dFunc) far_l2p_func, solver);
+
+  if (tasks != NULL)
+    _task_tree_free (tasks, solver);
+
+  aran_stats_phase_end (solver->stats, ARAN_STATS_PHASE_DOWN);
+
+  solver->far_age ++;
+}
+
+/* time spent in operators since @stats last reset */
+static gdouble _stats_work (AranStats *stats)
+{
+  gdouble work = 0.;
+  gint op;
+
+  for (op=0; op<ARAN_STATS_OPERATOR_COUNT; op ++)
+    {
+      gdouble time;
+
+      aran_stats_get_operator (stats, op, NULL, &time);
+      work += time;
+    }
+
+  return work;
 }
 
 /**
@@ -1137,17 +4970,74 @@ void aran_solver3d_solve (AranSolver3d *solver)
   VsgPRTree3dFarInteractionFunc far;
   VsgPRTree3dInteractionFunc near;
   VsgPRTree3dSemifarInteractionFunc semifar;
+  TaskTree *tasks = NULL;
+  gboolean task_nf;
 
   g_return_if_fail (solver != NULL);
 
+  /* the tree may have been distributed after aran_solver3d_set_periodic() */
+  if (solver->p2p_shift != NULL && _distributed (solver))
+    {
+      g_critical ("periodic mode unavailable on distributed trees");
+      return;
+    }
+
   VSG_TIMING_START (solve, vsg_prtree3d_get_communicator (solver->prtree));
 
+#ifdef VSG_HAVE_MPI
+  solver->solving = TRUE;
+#endif
+
+  if (solver->node_costs != NULL)
+    g_hash_table_remove_all (solver->node_costs);
+
+  solver->solve_work = - _stats_work (solver->stats);
+
   /*set interaction functions from solevr configuration */
   far = (VsgPRTree3dFarInteractionFunc)
     ((solver->m2l != NULL) ? far_func : nop_far_func);
 
   near = (VsgPRTree3dInteractionFunc)
-    ((solver->p2p != NULL) ? near_func : nop_near_func);
+    ((solver->p2p != NULL) ?
+     ((solver->role != NULL) ? near_func_roles : near_func) : nop_near_func);
+
+  if (_far_reuse_possible (solver))
+    {
+      _far_reuse_solve (solver, near);
+
+      solver->solve_work += _stats_work (solver->stats);
+
+#ifdef VSG_HAVE_MPI
+      solver->solving = FALSE;
+#endif
+
+      VSG_TIMING_END (solve, stderr);
+      return;
+    }
+
+  if (solver->role != NULL)
+    {
+      solver->source_nodes =
+        g_hash_table_new_full ((GHashFunc) _key3d_hash,
+                               (GEqualFunc) _key3d_equal, g_free, NULL);
+      solver->target_nodes =
+        g_hash_table_new_full ((GHashFunc) _key3d_hash,
+                               (GEqualFunc) _key3d_equal, g_free, NULL);
+
+      vsg_prtree3d_traverse (solver->prtree, G_POST_ORDER,
+                             (VsgPRTree3dFunc) roles_func, solver);
+    }
+
+  if (solver->weight != NULL)
+    {
+      solver->weights =
+        g_hash_table_new_full ((GHashFunc) _key3d_hash,
+                               (GEqualFunc) _key3d_equal, NULL, g_free);
+
+      vsg_prtree3d_traverse (solver->prtree, G_PRE_ORDER,
+                             (VsgPRTree3dFunc) weight_init_func,
+                             solver);
+    }
 
   semifar = (VsgPRTree3dSemifarInteractionFunc)
     ((solver->p2l != NULL) && (solver->m2p != NULL) ? semifar_func : NULL);
@@ -1160,17 +5050,43 @@ void aran_solver3d_solve (AranSolver3d *solver)
       g_printerr ("semifar threshold: %u\n", solver->semifar_threshold);
     }
 
+  /* adaptive semifar and threads need the TaskTree near/far traversal.
+   * Remote nodes are only reachable through the local essential tree */
+  task_nf = ((solver->adaptive_semifar && semifar != NULL) ||
+             solver->workers != NULL) && ! _distributed (solver);
+
+  if (solver->workers != NULL || task_nf)
+    tasks = _task_tree_new (solver);
+
+#ifdef VSG_HAVE_MPI
+  if (solver->let && tasks == NULL)
+    tasks = _task_tree_new (solver);
+#endif
+
+  aran_stats_phase_begin (solver->stats, ARAN_STATS_PHASE_CLEAR);
+
   /* clear multipole and local developments before the big work */
-  vsg_prtree3d_traverse (solver->prtree, G_POST_ORDER,
-                         (VsgPRTree3dFunc) clear_func,
-                         solver);
+  if (solver->workers != NULL)
+    _task_tree_foreach (tasks, solver, G_POST_ORDER,
+                        (AranWorkerFunc) _clear_task);
+  else
+    vsg_prtree3d_traverse (solver->prtree, G_POST_ORDER,
+                           (VsgPRTree3dFunc) clear_func,
+                           solver);
+
+  aran_stats_phase_end (solver->stats, ARAN_STATS_PHASE_CLEAR);
 
   VSG_TIMING_START (up, vsg_prtree3d_get_communicator (solver->prtree));
+  aran_stats_phase_begin (solver->stats, ARAN_STATS_PHASE_UP);
 
   /* gather information in Multipole development */
-  vsg_prtree3d_traverse (solver->prtree, G_POST_ORDER,
-                         (VsgPRTree3dFunc) up_func,
-                         solver);
+  if (solver->workers != NULL)
+    _task_tree_foreach (tasks, solver, G_POST_ORDER,
+                        (AranWorkerFunc) _up_task);
+  else
+    vsg_prtree3d_traverse (solver->prtree, G_POST_ORDER,
+                           (VsgPRTree3dFunc) up_func,
+                           solver);
 
 #ifdef VSG_HAVE_MPI
   /* gather shared in_counts */
@@ -1178,26 +5094,139 @@ void aran_solver3d_solve (AranSolver3d *solver)
     VsgPRTreeParallelConfig pc;
 
     vsg_prtree3d_get_parallel (solver->prtree, &pc);
-    vsg_prtree3d_shared_nodes_allreduce (solver->prtree,
-                                         &pc.node_data.visit_forward);
+
+    if (solver->pipelined && ! solver->let)
+      {
+        solver->shared_reduce =
+          aran_shared_reduce_new (_pipeline_communicator (solver),
+                                  &pc.node_data);
+
+        /* same order on every processor */
+        vsg_prtree3d_traverse (solver->prtree, G_PRE_ORDER,
+                               (VsgPRTree3dFunc) shared_add_func,
+                               solver);
+
+        aran_shared_reduce_start (solver->shared_reduce);
+        solver->deferred_far = g_array_new (FALSE, FALSE,
+                                            sizeof (DeferredFar));
+
+        solver->pipeline_far = far;
+        solver->pipeline_near = near;
+        solver->pipeline_semifar = semifar;
+
+        far = (VsgPRTree3dFarInteractionFunc) pipelined_far_func;
+        near = (VsgPRTree3dInteractionFunc) pipelined_near_func;
+        if (semifar != NULL)
+          semifar = (VsgPRTree3dSemifarInteractionFunc) pipelined_semifar_func;
+      }
+    else
+      vsg_prtree3d_shared_nodes_allreduce (solver->prtree,
+                                           &pc.node_data.visit_forward);
   }
 #endif /* VSG_HAVE_MPI */
 
+  aran_stats_phase_end (solver->stats, ARAN_STATS_PHASE_UP);
   VSG_TIMING_END (up, stderr);
 
+  aran_stats_phase_begin (solver->stats, ARAN_STATS_PHASE_NEAR_FAR);
+
   /* transmit info from Multipole to Local developments */
-  vsg_prtree3d_near_far_traversal_full (solver->prtree, far, near, semifar,
-                                        solver->semifar_threshold, solver);
+#ifdef VSG_HAVE_MPI
+  if (solver->let)
+    _let_solve (solver, tasks, TRUE, semifar != NULL);
+  else
+#endif
+  if (task_nf)
+    _task_near_far_solve (solver, tasks, TRUE, semifar != NULL);
+  else
+    vsg_prtree3d_near_far_traversal_full (solver->prtree, far, near, semifar,
+                                          solver->semifar_threshold, solver);
+
+#ifdef VSG_HAVE_MPI
+  if (solver->pipelined && ! solver->let)
+    {
+      guint i;
+
+      aran_shared_reduce_wait (solver->shared_reduce);
+
+      for (i=0; i<solver->deferred_far->len; i ++)
+        {
+          DeferredFar *df = &g_array_index (solver->deferred_far,
+                                            DeferredFar, i);
+          VsgPRTree3dNodeInfo one, other;
+
+          _deferred_node_info (&df->one, &one);
+          _deferred_node_info (&df->other, &other);
+
+          solver->pipeline_far (&one, &other, solver);
+        }
+
+      g_array_free (solver->deferred_far, TRUE);
+      solver->deferred_far = NULL;
+
+      aran_shared_reduce_free (solver->shared_reduce);
+      solver->shared_reduce = NULL;
+    }
+#endif /* VSG_HAVE_MPI */
+
+  if (solver->p2p_shift != NULL)
+    _periodic_solve (solver);
+
+  aran_stats_phase_end (solver->stats, ARAN_STATS_PHASE_NEAR_FAR);
 
   VSG_TIMING_START (down, vsg_prtree3d_get_communicator (solver->prtree));
+  aran_stats_phase_begin (solver->stats, ARAN_STATS_PHASE_DOWN);
 
   /* distribute information through Local developments towards particles */
-  vsg_prtree3d_traverse (solver->prtree, G_PRE_ORDER,
-                         (VsgPRTree3dFunc) down_func,
-                         solver);
+  if (solver->workers != NULL)
+    _task_tree_foreach (tasks, solver, G_PRE_ORDER,
+                        (AranWorkerFunc) _down_task);
+  else
+    vsg_prtree3d_traverse (solver->prtree, G_PRE_ORDER,
+                           (VsgPRTree3dFunc) down_func,
+                           solver);
+
+  if (tasks != NULL)
+    _task_tree_free (tasks, solver);
 
+  aran_stats_phase_end (solver->stats, ARAN_STATS_PHASE_DOWN);
   VSG_TIMING_END (down, stderr);
 
+  if (solver->p2p_shift != NULL && solver->dipole != NULL)
+    _periodic_dipole (solver);
+
+  /* remember which leaves hold the computed far field */
+  _far_reuse_reset (solver);
+  if (solver->far_period > 1)
+    {
+      solver->far_leaves =
+        g_hash_table_new_full ((GHashFunc) _key3d_hash,
+                               (GEqualFunc) _key3d_equal, g_free, NULL);
+
+      vsg_prtree3d_traverse (solver->prtree, G_PRE_ORDER,
+                             (VsgPRTree3dFunc) far_leaf_insert_func, solver);
+    }
+
+  if (solver->role != NULL)
+    {
+      g_hash_table_destroy (solver->source_nodes);
+      g_hash_table_destroy (solver->target_nodes);
+      solver->source_nodes = NULL;
+      solver->target_nodes = NULL;
+    }
+
+  if (solver->weights != NULL)
+    {
+      g_hash_table_destroy (solver->weights);
+      solver->weights = NULL;
+    }
+
+  solver->solve_work += _stats_work (solver->stats);
+
+#ifdef VSG_HAVE_MPI
+  solver->solving = FALSE;
+#endif
+
   VSG_TIMING_END (solve, stderr);
 }
 
@@ -1230,9 +5259,27 @@ aran_solver3d_get_communicator (AranSolver3d *solver)
 void aran_solver3d_set_parallel (AranSolver3d *solver,
                                  VsgPRTreeParallelConfig *pconfig)
 {
+  VsgPRTreeParallelConfig pc;
+
   g_return_if_fail (solver != NULL);
+  g_return_if_fail (pconfig != NULL);
+
+  pc = *pconfig;
+
+  /* node data migration goes through the solver (see
+   * aran_solver3d_set_migrate_structure()) */
+  solver->node_migrate = pconfig->node_data.migrate;
+
+  if (pc.node_data.migrate.pack != NULL && pc.node_data.migrate.unpack != NULL)
+    {
+      pc.node_data.migrate.pack = (VsgMigrablePackDataFunc) _node_migrate_pack;
+      pc.node_data.migrate.pack_data = solver;
+      pc.node_data.migrate.unpack =
+        (VsgMigrablePackDataFunc) _node_migrate_unpack;
+      pc.node_data.migrate.unpack_data = solver;
+    }
 
-  vsg_prtree3d_set_parallel (solver->prtree, pconfig);
+  vsg_prtree3d_set_parallel (solver->prtree, &pc);
 }
 
 void aran_solver3d_get_parallel (AranSolver3d *solver,
@@ -1241,6 +5288,10 @@ void aran_solver3d_get_parallel (AranSolver3d *solver,
   g_return_if_fail (solver != NULL);
 
   vsg_prtree3d_get_parallel (solver->prtree, pconfig);
+
+  if (pconfig->node_data.migrate.pack ==
+      (VsgMigrablePackDataFunc) _node_migrate_pack)
+    pconfig->node_data.migrate = solver->node_migrate;
 }
 
 void aran_solver3d_migrate_flush (AranSolver3d *solver)
@@ -1266,9 +5317,250 @@ void aran_solver3d_distribute_contiguous_leaves (AranSolver3d *solver)
   vsg_prtree3d_distribute_contiguous_leaves (solver->prtree);
 }
 
+/**
+ * aran_solver3d_set_pipelined:
+ * @solver: an #AranSolver3d.
+ * @pipelined: whether to overlap shared nodes reduction with computations.
+ *
+ * When @pipelined is %TRUE, aran_solver3d_solve() sums the multipoles of
+ * shared nodes with non blocking communications instead of a blocking
+ * allreduce. Near interactions and far interactions between unshared nodes
+ * proceed meanwhile and local far interactions that need a shared multipole
+ * are deferred until the reduction completes.
+ */
+void aran_solver3d_set_pipelined (AranSolver3d *solver, gboolean pipelined)
+{
+  g_return_if_fail (solver != NULL);
+
+  solver->pipelined = pipelined;
+}
+
+/**
+ * aran_solver3d_set_let:
+ * @solver: an #AranSolver3d.
+ * @let: whether to exchange local essential trees.
+ *
+ * When @let is %TRUE, aran_solver3d_solve() replaces the remote node
+ * visits of the near/far traversal with one bulk exchange: every processor
+ * sends to each other one the part of its subtrees that the receiver's
+ * interactions need (multipoles of the nodes, particles of the leaves close
+ * to the receiver's domain). Far and near interactions then run without
+ * communication and only local developments and particles are updated, so
+ * that no backward visit is needed. Interactions between neighbouring
+ * leaves of different processors are computed on both sides. Semifar
+ * interactions only involve private nodes: for a pair spanning two
+ * processors, each one updates its own side (p2l on the node owner, m2p on
+ * the leaf owner).
+ */
+void aran_solver3d_set_let (AranSolver3d *solver, gboolean let)
+{
+  g_return_if_fail (solver != NULL);
+
+  solver->let = let;
+}
+
+static void _node_costs_enable (AranSolver3d *solver)
+{
+  if (solver->node_costs == NULL)
+    solver->node_costs =
+      g_hash_table_new_full ((GHashFunc) _key3d_hash,
+                             (GEqualFunc) _key3d_equal, NULL, g_free);
+}
+
+/**
+ * aran_solver3d_distribute_cost:
+ * @solver: an #AranSolver3d.
+ *
+ * Distributes the leaves of @solver's tree so that every processor gets a
+ * contiguous part of the leaves sequence (space filling curve when
+ * aran_solver3d_set_children_order_hilbert() was called) with the same
+ * computational cost. A leaf cost is the time spent by the operators on it
+ * during the last solve, plus its share (by particle count) of the time
+ * spent on its ancestors. When no solve was recorded since the first call
+ * to this function, costs are estimated with particle counts.
+ */
+void aran_solver3d_distribute_cost (AranSolver3d *solver)
+{
+  MPI_Comm comm;
+  CostDistData cdd;
+  gdouble *roots_total, *roots_offset, *roots_start;
+  gdouble total, acc;
+  gint rk, sz;
+  guint i, n;
+
+  g_return_if_fail (solver != NULL);
+
+  comm = vsg_prtree3d_get_communicator (solver->prtree);
+  MPI_Comm_rank (comm, &rk);
+  MPI_Comm_size (comm, &sz);
+
+  cdd.measured = solver->node_costs != NULL &&
+    g_hash_table_size (solver->node_costs) > 0;
+
+  /* later solves record their costs */
+  _node_costs_enable (solver);
+
+  cdd.solver = solver;
+  cdd.root = -1;
+  cdd.local = FALSE;
+  cdd.roots_cost = g_array_new (FALSE, FALSE, sizeof (gdouble));
+  cdd.leaves = g_array_new (FALSE, FALSE, sizeof (NodeCost));
+  cdd.leaves_root = g_array_new (FALSE, FALSE, sizeof (gint));
+  cdd.dest = g_hash_table_new ((GHashFunc) _key3d_hash,
+                               (GEqualFunc) _key3d_equal);
+
+  g_hash_table_foreach (solver->node_costs, (GHFunc) _reset_np, NULL);
+
+  vsg_prtree3d_traverse (solver->prtree, G_POST_ORDER,
+                         (VsgPRTree3dFunc) _cost_np_func, &cdd);
+  vsg_prtree3d_traverse (solver->prtree, G_PRE_ORDER,
+                         (VsgPRTree3dFunc) _cost_leaves_func, &cdd);
+
+  /* position of every private subtree along the leaves sequence */
+  n = cdd.roots_cost->len;
+  roots_total = g_malloc (3 * MAX (n, 1) * sizeof (gdouble));
+  roots_offset = roots_total + MAX (n, 1);
+  roots_start = roots_offset + MAX (n, 1);
+
+  MPI_Allreduce (cdd.roots_cost->data, roots_total, n, MPI_DOUBLE, MPI_SUM,
+                 comm);
+
+  /* a private subtree may be local to several processors */
+  MPI_Exscan (cdd.roots_cost->data, roots_offset, n, MPI_DOUBLE, MPI_SUM,
+              comm);
+  if (rk == 0)
+    for (i=0; i<n; i ++) roots_offset[i] = 0.;
+
+  total = 0.;
+  for (i=0; i<n; i ++)
+    {
+      roots_start[i] = total + roots_offset[i];
+      total += roots_total[i];
+    }
+
+  if (total > 0.)
+    {
+      for (i=0; i<cdd.leaves->len; i ++)
+        {
+          NodeCost *leaf = &g_array_index (cdd.leaves, NodeCost, i);
+          gint root = g_array_index (cdd.leaves_root, gint, i);
+          gint dst;
+
+          acc = roots_start[root];
+          roots_start[root] += leaf->cost;
+
+          dst = (gint) ((acc + 0.5 * leaf->cost) * sz / total);
+          dst = CLAMP (dst, 0, sz-1);
+
+          g_hash_table_insert (cdd.dest, &leaf->id, GINT_TO_POINTER (dst+1));
+        }
+
+      vsg_prtree3d_distribute_nodes (solver->prtree,
+                                     (VsgPRTree3dDistributionFunc) _cost_dist,
+                                     &cdd);
+    }
+
+  g_free (roots_total);
+  g_hash_table_destroy (cdd.dest);
+  g_array_free (cdd.leaves_root, TRUE);
+  g_array_free (cdd.leaves, TRUE);
+  g_array_free (cdd.roots_cost, TRUE);
+}
+
+/**
+ * aran_solver3d_balance:
+ * @solver: an #AranSolver3d.
+ * @balance: the repartitioning policy of @solver.
+ *
+ * Collective call to be done once after every aran_solver3d_solve(). The
+ * operators time of the last solve is recorded in @balance and, when
+ * @balance predicts that repartitioning pays off, @solver is redistributed
+ * with aran_solver3d_distribute_cost(). The time taken by the
+ * redistribution is fed back to @balance for later decisions.
+ *
+ * Returns: %TRUE if @solver was redistributed.
+ */
+gboolean aran_solver3d_balance (AranSolver3d *solver, AranBalance *balance)
+{
+  gdouble t0;
+
+  g_return_val_if_fail (solver != NULL, FALSE);
+  g_return_val_if_fail (balance != NULL, FALSE);
+
+  /* measure costs from now on for the cost model to be ready */
+  _node_costs_enable (solver);
+
+  aran_balance_step (balance, solver->solve_work);
+
+  if (! aran_balance_needed (balance)) return FALSE;
+
+  t0 = MPI_Wtime ();
+
+  aran_solver3d_distribute_cost (solver);
+
+  aran_balance_done (balance, MPI_Wtime () - t0);
+
+  return TRUE;
+}
+
+/**
+ * aran_solver3d_set_migrate_structure:
+ * @solver: an #AranSolver3d.
+ * @structure_only: whether node migrations outside of
+ * aran_solver3d_solve() skip the expansions.
+ *
+ * Expansions are cleared at the beginning of every solve. When
+ * @structure_only is %TRUE, nodes moved between two solves (by
+ * aran_solver3d_distribute_nodes() for instance) are sent without their
+ * expansions and receivers only zero a fresh development. Migrations
+ * happening during a solve still carry the complete node data.
+ */
+void aran_solver3d_set_migrate_structure (AranSolver3d *solver,
+                                          gboolean structure_only)
+{
+  g_return_if_fail (solver != NULL);
+
+  solver->migrate_structure = structure_only;
+}
+
 #endif
 
 
+/**
+ * aran_solver3d_set_point_loc:
+ * @solver: an #AranSolver3d.
+ * @locfunc: a point localization function.
+ *
+ * Sets the point localization function of @solver's tree (see
+ * vsg_prtree3d_set_point_loc() in Vsg API docs) and records it for the
+ * solver's own point routing, as in aran_solver3d_evaluate_points().
+ * Trees built with another localization than vsg_vector3d_vector3d_locfunc()
+ * must be handed to their solver through this function.
+ */
+void aran_solver3d_set_point_loc (AranSolver3d *solver,
+                                  VsgPoint3dLocFunc locfunc)
+{
+  g_return_if_fail (solver != NULL);
+  g_return_if_fail (locfunc != NULL);
+
+  vsg_prtree3d_set_point_loc (solver->prtree, locfunc);
+
+  solver->point_loc = locfunc;
+}
+
+/**
+ * aran_solver3d_set_nf_isleaf:
+ * @solver: an #AranSolver3d.
+ * @isleaf: virtual leaf predicate or %NULL.
+ * @user_data: pointer to pass to @isleaf.
+ *
+ * Makes the near/far traversal stop at nodes for which @isleaf returns
+ * %TRUE, as if they were leaves: two near virtual leaves get the near
+ * interactions of all the leaves below them (see
+ * vsg_prtree3d_set_nf_isleaf() in Vsg API docs). The solver's own
+ * traversals (local essential tree, adaptive semifar, points evaluation)
+ * follow the same rule.
+ */
 void aran_solver3d_set_nf_isleaf (AranSolver3d *solver,
                                   VsgPRTree3dNFIsleafFunc isleaf,
                                   gpointer user_data)
@@ -1276,4 +5568,46 @@ void aran_solver3d_set_nf_isleaf (AranSolver3d *solver,
   g_return_if_fail (solver != NULL);
 
   vsg_prtree3d_set_nf_isleaf (solver->prtree, isleaf, user_data);
+
+  solver->nf_isleaf = isleaf;
+  solver->nf_isleaf_data = user_data;
+}
+
+/**
+ * aran_solver3d_set_threads:
+ * @solver: an #AranSolver3d.
+ * @nthreads: number of threads.
+ *
+ * Runs aran_solver3d_solve() with @nthreads threads, the calling one
+ * included. Local passes (developments clearing, upward and downward
+ * passes) hand every tree level to the threads. Near/far interactions are
+ * first listed by a traversal of the tree in the calling thread, then run
+ * by rounds in which no two interactions write the same local development
+ * or the same leaf particles: each of them receives its contributions in
+ * the same order whatever @nthreads. On a distributed tree, this needs
+ * aran_solver3d_set_let(): otherwise near/far interactions stay in the
+ * calling thread.
+ *
+ * Communications stay in the calling thread, so that a parallel program
+ * only needs MPI_THREAD_FUNNELED support and can run one process per NUMA
+ * domain instead of one per core. Functions given to @solver must be safe
+ * to call concurrently on different leaves and nodes: particle functions
+ * (p2p, p2m, p2l, m2p, l2p, leaf preparation) on different particles and
+ * translations on different target developments.
+ */
+void aran_solver3d_set_threads (AranSolver3d *solver, guint nthreads)
+{
+  g_return_if_fail (solver != NULL);
+
+  if (solver->workers != NULL)
+    {
+      aran_workers_free (solver->workers);
+      solver->workers = NULL;
+    }
+
+  if (nthreads > 1)
+    {
+      solver->workers = aran_workers_new (nthreads);
+      aran_stats_reserve_blocks (solver->stats, nthreads);
+    }
 }
@@ -26,6 +26,8 @@
 
 #include <aran/aran.h>
 #include <aran/arandevelopment3d.h>
+#include <aran/aranstats.h>
+#include <aran/aranbalance.h>
 
 G_BEGIN_DECLS;
 
@@ -35,8 +37,24 @@ typedef struct _AranSolver3d AranSolver3d;
 /* Particle functions */
 typedef void (*AranParticleInitFunc3d) (VsgPoint3 particle);
 
+typedef void (*AranParticleMoveFunc3d) (VsgPoint3 particle, gboolean updated,
+                                        gpointer user_data);
+
 typedef void (*AranParticle2ParticleFunc3d) (VsgPoint3 src, VsgPoint3 dst);
 
+typedef void (*AranParticle2ParticleShiftFunc3d) (VsgPoint3 src,
+                                                  const VsgVector3d *shift,
+                                                  VsgPoint3 dst);
+
+typedef void (*AranParticleDipoleFunc3d) (VsgPoint3 particle,
+                                          const VsgVector3d *origin,
+                                          VsgVector3d *dipole);
+
+typedef void (*AranParticleDipoleCorrectionFunc3d) (VsgPoint3 particle,
+                                                    const VsgVector3d *origin,
+                                                    const VsgVector3d *dipole,
+                                                    gdouble volume);
+
 typedef void (*AranParticle2MultipoleFunc3d) (VsgPoint3 src,
                                               const VsgPRTree3dNodeInfo *dst_node,
                                               gpointer dst);
@@ -66,6 +84,18 @@ typedef AranLocal2ParticleInternalFunc3d AranMultipole2ParticleInternalFunc3d;
 
 typedef AranLocal2ParticleGradInternalFunc3d AranMultipole2ParticleGradInternalFunc3d;
 
+typedef AranParticleRole (*AranParticleRoleFunc3d) (VsgPoint3 particle);
+
+typedef gdouble (*AranParticleWeightFunc3d) (VsgPoint3 particle);
+
+typedef void (*AranLeafPrepareFunc3d) (const VsgPRTree3dNodeInfo *leaf_info,
+                                       gpointer devel,
+                                       gpointer user_data);
+
+typedef void (*AranNodeZeroFunc3d) (const VsgPRTree3dNodeInfo *node_info,
+                                    gpointer devel,
+                                    gpointer user_data);
+
 /* Translation functions */
 typedef void (*AranMultipole2MultipoleFunc3d) (const VsgPRTree3dNodeInfo *src_node,
                                                 gpointer src,
@@ -82,6 +112,25 @@ typedef void (*AranLocal2LocalFunc3d) (const VsgPRTree3dNodeInfo *src_node,
                                         const VsgPRTree3dNodeInfo *dst_node,
                                         gpointer dst);
 
+/* automatic configuration */
+#define ARAN_SOLVER3D_AUTO_MAX_ORDER (64)
+#define ARAN_SOLVER3D_AUTO_MAX_MAXBOX (512)
+
+typedef struct _AranSolver3dConfig AranSolver3dConfig;
+
+struct _AranSolver3dConfig
+{
+  guint order;
+  guint maxbox;
+
+  AranMultipole2MultipoleFunc3d m2m;
+  AranMultipole2LocalFunc3d m2l;
+  AranLocal2LocalFunc3d l2l;
+
+  gdouble error;
+  gdouble time;
+};
+
 /* functions */
 
 AranSolver3d *aran_solver3d_new (VsgPRTree3d *prtree,
@@ -96,6 +145,32 @@ void aran_solver3d_set_development (AranSolver3d *solver,
 				    gpointer devel,
 				    AranZeroFunc zero);
 
+void aran_solver3d_set_node_zero (AranSolver3d *solver,
+                                  AranNodeZeroFunc3d node_zero,
+                                  gpointer user_data);
+
+void aran_solver3d_set_roles (AranSolver3d *solver,
+                              AranParticleRoleFunc3d role,
+                              AranParticle2ParticleFunc3d p2p_one_way);
+
+void aran_solver3d_set_prune (AranSolver3d *solver,
+                              AranParticleWeightFunc3d weight,
+                              gdouble epsilon);
+
+void aran_solver3d_set_far_period (AranSolver3d *solver, guint period);
+
+void aran_solver3d_set_leaf_prepare (AranSolver3d *solver,
+                                     AranLeafPrepareFunc3d prepare,
+                                     gpointer user_data);
+
+void aran_solver3d_set_periodic (AranSolver3d *solver,
+                                 AranParticle2ParticleShiftFunc3d p2p_shift,
+                                 guint lattice_levels);
+
+void aran_solver3d_set_periodic_dipole (AranSolver3d *solver,
+                                        AranParticleDipoleFunc3d dipole,
+                                        AranParticleDipoleCorrectionFunc3d correction);
+
 void aran_solver3d_set_functions (AranSolver3d *solver,
 				  AranParticle2ParticleFunc3d p2p,
 				  AranParticle2MultipoleFunc3d p2m,
@@ -134,6 +209,14 @@ void aran_solver3d_profile_operators (AranSolver3d *solver,
 
 guint aran_solver3d_optimal_semifar_threshold (AranSolver3d *solver);
 
+void aran_solver3d_set_adaptive_semifar (AranSolver3d *solver,
+                                         gboolean adaptive);
+
+gdouble aran_solver3d_error_bound (guint order);
+
+gboolean aran_solver3d_auto_config (AranSolver3d *solver, gdouble epsilon,
+                                    guint np, AranSolver3dConfig *config);
+
 void aran_solver3d_reinit_stats (AranSolver3d *solver);
 void aran_solver3d_get_stats (AranSolver3d *solver, glong *zero_count,
 			      glong *p2p_count, glong *p2m_count,
@@ -142,6 +225,8 @@ void aran_solver3d_get_stats (AranSolver3d *solver, glong *zero_count,
                               glong *p2l_count, glong *m2p_count,
                               glong *p2p_remote_count, glong *m2l_remote_count);
 
+AranStats *aran_solver3d_peek_stats (AranSolver3d *solver);
+
 gdouble aran_solver3d_get_tolerance (AranSolver3d *solver);
 
 void aran_solver3d_set_tolerance (AranSolver3d *solver,
@@ -167,6 +252,15 @@ gboolean aran_solver3d_remove_point (AranSolver3d *solver,
 VsgPoint3 aran_solver3d_find_point (AranSolver3d *solver,
                                     VsgPoint3 selector);
 
+guint aran_solver3d_update_positions (AranSolver3d *solver,
+                                      AranParticleMoveFunc3d move,
+                                      gpointer user_data);
+
+guint aran_solver3d_evaluate_points (AranSolver3d *solver,
+                                     VsgPoint3 *points, guint n,
+                                     AranParticle2ParticleFunc3d p2p,
+                                     AranLocal2ParticleFunc3d l2p);
+
 void aran_solver3d_foreach_point (AranSolver3d *solver,
                                   GFunc func,
                                   gpointer user_data);
@@ -207,12 +301,28 @@ void aran_solver3d_distribute_nodes (AranSolver3d *solver,
 
 void aran_solver3d_distribute_contiguous_leaves (AranSolver3d *solver);
 
+void aran_solver3d_distribute_cost (AranSolver3d *solver);
+
+void aran_solver3d_set_pipelined (AranSolver3d *solver, gboolean pipelined);
+
+void aran_solver3d_set_let (AranSolver3d *solver, gboolean let);
+
+void aran_solver3d_set_migrate_structure (AranSolver3d *solver,
+                                          gboolean structure_only);
+
+gboolean aran_solver3d_balance (AranSolver3d *solver, AranBalance *balance);
+
 #endif /* VSG_HAVE_MPI */
 
+void aran_solver3d_set_point_loc (AranSolver3d *solver,
+                                  VsgPoint3dLocFunc locfunc);
+
 void aran_solver3d_set_nf_isleaf (AranSolver3d *solver,
                                   VsgPRTree3dNFIsleafFunc isleaf,
                                   gpointer user_data);
 
+void aran_solver3d_set_threads (AranSolver3d *solver, guint nthreads);
+
 G_END_DECLS;
 
 #endif /* __ARAN_SOLVER3D_H__ */
@@ -27,6 +27,7 @@
 #include "aranbinomialbufferd.h"
 
 static AranBinomialBufferd *_spherical = NULL;
+G_LOCK_DEFINE_STATIC (spherical);
 
 static gdouble _spherical_generator (guint l, guint m,
                                      AranBinomialBufferd *buf)
@@ -58,15 +59,27 @@ static void _spherical_atexit ()
  */
 void aran_spherical_harmonic_require (guint degree)
 {
-  if (_spherical == NULL)
+  if (g_atomic_pointer_get (&_spherical) == NULL)
     {
-      _spherical = aran_binomial_bufferd_new (_spherical_generator, degree);
-      g_atexit (_spherical_atexit);
-    }
-  else
-    {
-      aran_binomial_bufferd_require (_spherical, degree);
+      AranBinomialBufferd *buf =
+        aran_binomial_bufferd_new (_spherical_generator, degree);
+
+      G_LOCK (spherical);
+
+      if (_spherical == NULL)
+        {
+          g_atomic_pointer_set (&_spherical, buf);
+          buf = NULL;
+
+          g_atexit (_spherical_atexit);
+        }
+
+      G_UNLOCK (spherical);
+
+      aran_binomial_bufferd_free (buf);
     }
+
+  aran_binomial_bufferd_require (_spherical, degree);
 }
 
 /**
@@ -119,5 +119,9 @@ void aran_spherical_seriesd_alpha_require (guint deg);
 gdouble aran_spherical_seriesd_beta (gint l);
 gdouble aran_spherical_seriesd_alpha (guint n, guint p);
 
+void aran_spherical_seriesd_translate_vertical_require (guint deg);
+gdouble aran_spherical_seriesd_translate_vertical_factor (guint l, guint m,
+                                                          guint n);
+
 
 #endif /* __ARAN_SPHERICAL_SERIESD_PRIVATE_H__ */
@@ -34,8 +34,8 @@
 static void _buffer_rotate (AranWigner * aw, guint deg,
                             gcomplex128 * src, gcomplex128 * dst)
 {
-  gcomplex128 src_l[deg];
-  gcomplex128 src_l_neg[deg];
+  gcomplex128 src_l[deg + 1];
+  gcomplex128 src_l_neg[deg + 1];
   gint l, mprime, m;
   gint l_lp1_over_2 = 0;
 
@@ -98,17 +98,15 @@ void aran_spherical_seriesd_rotate (const AranSphericalSeriesd * src,
   guint8 pd = MIN (dst->posdeg, src->posdeg);
   guint8 lmax = MAX (pd+1, nd);
 
-  AranWigner *aw = aran_wigner_repo_lookup (alpha, beta, gamma);
+  AranWigner *aw = aran_wigner_repo_lookup_require (alpha, beta, gamma, lmax);
 
-  aran_wigner_require (aw, lmax);
-
-  _buffer_rotate (aw, src->posdeg,
+  _buffer_rotate (aw, pd,
                   _spherical_seriesd_get_pos_term (src, 0, 0),
                   _spherical_seriesd_get_pos_term (dst, 0, 0));
 
-  if (src->negdeg > 0)
+  if (nd > 0)
     {
-      _buffer_rotate (aw, src->negdeg - 1,
+      _buffer_rotate (aw, nd - 1,
                       _spherical_seriesd_get_neg_term (src, 0, 0),
                       _spherical_seriesd_get_neg_term (dst, 0, 0));
     }
@@ -136,9 +134,7 @@ void aran_spherical_seriesd_rotate_inverse (const AranSphericalSeriesd * src,
   guint8 pd = MIN (dst->posdeg, src->posdeg);
   guint8 lmax = MAX (pd+1, nd);
 
-  AranWigner *aw = aran_wigner_repo_lookup (-gamma, -beta, -alpha);
-
-  aran_wigner_require (aw, lmax);
+  AranWigner *aw = aran_wigner_repo_lookup_require (-gamma, -beta, -alpha, lmax);
 
   _buffer_rotate (aw, pd,
                   _spherical_seriesd_get_pos_term (src, 0, 0),
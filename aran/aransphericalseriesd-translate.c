@@ -35,8 +35,24 @@ struct _AranSquareBufferd {
   gdouble *buffer;
   gdouble **direct;
   AranSquareBufferdGenerator generator;
+  GSList *retired;
 };
 
+/* protects buffers growth. Superseded arrays are kept until the buffer is
+ * freed because other threads may still be reading them.
+ */
+G_LOCK_DEFINE_STATIC (buffers);
+
+static void _retired_free (GSList *retired)
+{
+  GSList *l;
+
+  for (l = retired; l != NULL; l = l->next)
+    g_free (l->data);
+
+  g_slist_free (retired);
+}
+
 void aran_square_bufferd_require (AranSquareBufferd *buf,
                                   guint max);
 
@@ -54,6 +70,7 @@ aran_square_bufferd_new (AranSquareBufferdGenerator generator,
   ret->generator = generator;
   ret->buffer = NULL;
   ret->direct = NULL;
+  ret->retired = NULL;
 
   aran_square_bufferd_require (ret, l);
 
@@ -69,6 +86,8 @@ void aran_square_bufferd_free (AranSquareBufferd *buf)
       if (buf->direct != NULL)
         g_free (buf->direct);
 
+      _retired_free (buf->retired);
+
       buf->buffer = NULL;
       buf->direct = NULL;
 
@@ -78,34 +97,63 @@ void aran_square_bufferd_free (AranSquareBufferd *buf)
 void aran_square_bufferd_require (AranSquareBufferd *buf,
                                     guint max)
 {
+  AranSquareBufferd tmp;
   guint l, size;
-  gint i, j;
+  gint i, j, oldl;
 
   g_return_if_fail (buf != NULL);
 
-  if (buf->l >= (gint) max) return;
+  oldl = g_atomic_int_get (&buf->l);
+
+  if (oldl >= (gint) max) return;
 
-  l = MAX (buf->l, 1);
+  l = MAX (oldl, 1);
 
   while (l < (gint) max) l *= 2;
 
   size = ((l+1)*(l+1));
 
-  buf->direct = g_realloc (buf->direct, (l+1) * sizeof (gdouble *));
-  buf->buffer = g_realloc (buf->buffer, size * sizeof (gdouble));
+  /* rows are strided by @l: every term is regenerated aside */
+  tmp.l = l;
+  tmp.generator = buf->generator;
+  tmp.retired = NULL;
+  tmp.direct = g_malloc ((l+1) * sizeof (gdouble *));
+  tmp.buffer = g_malloc (size * sizeof (gdouble));
 
   for (i=0; i<=l; i ++)
     {
-      buf->direct[i] = buf->buffer + (i*(l+1));
+      tmp.direct[i] = tmp.buffer + (i*(l+1));
     }
 
-  buf->l = l;
-
   for (i=0; i<=l; i ++)
     {
       for (j=0; j<=l; j ++)
-        buf->direct[i][j] = buf->generator (i, j, buf);
+        tmp.direct[i][j] = tmp.generator (i, j, &tmp);
+    }
+
+  G_LOCK (buffers);
+
+  if (buf->l < tmp.l)
+    {
+      if (buf->buffer != NULL)
+        {
+          buf->retired = g_slist_prepend (buf->retired, buf->buffer);
+          buf->retired = g_slist_prepend (buf->retired, buf->direct);
+        }
+
+      g_atomic_pointer_set (&buf->buffer, tmp.buffer);
+      g_atomic_pointer_set (&buf->direct, tmp.direct);
+
+      g_atomic_int_set (&buf->l, tmp.l);
     }
+  else
+    {
+      /* another thread was faster */
+      g_free (tmp.buffer);
+      g_free (tmp.direct);
+    }
+
+  G_UNLOCK (buffers);
 }
 gdouble *aran_square_bufferd_get_unsafe (AranSquareBufferd *buf,
                                             guint l, guint m)
@@ -132,16 +180,26 @@ static void _betal_over_betan_require (guint deg)
 {
   aran_spherical_seriesd_beta_require (deg);
  
-  if (_betal_over_betan_buffer == NULL)
+  if (g_atomic_pointer_get (&_betal_over_betan_buffer) == NULL)
     {
-      _betal_over_betan_buffer = aran_square_bufferd_new (_betal_over_betan_generator, deg);
+      AranSquareBufferd *buf = aran_square_bufferd_new (_betal_over_betan_generator, deg);
 
-      g_atexit (_atexit);
-    }
-  else
-    {
-      aran_square_bufferd_require (_betal_over_betan_buffer, deg);
+      G_LOCK (buffers);
+
+      if (_betal_over_betan_buffer == NULL)
+        {
+          g_atomic_pointer_set (&_betal_over_betan_buffer, buf);
+          buf = NULL;
+
+          g_atexit (_atexit);
+        }
+
+      G_UNLOCK (buffers);
+
+      aran_square_bufferd_free (buf);
     }
+
+  aran_square_bufferd_require (_betal_over_betan_buffer, deg);
 }
 
 static gdouble _betal_over_betan (guint l, guint n)
@@ -158,6 +216,7 @@ struct _AranTranslateBufferd {
   gdouble **direct2;
   gdouble ***direct1;
   AranTranslateBufferdGenerator generator;
+  GSList *retired;
 };
 
 static void aran_translate_bufferd_require (AranTranslateBufferd *buf,
@@ -178,6 +237,7 @@ aran_translate_bufferd_new (AranTranslateBufferdGenerator generator,
   ret->buffer = NULL;
   ret->direct2 = NULL;
   ret->direct1 = NULL;
+  ret->retired = NULL;
 
   aran_translate_bufferd_require (ret, l);
 
@@ -197,6 +257,8 @@ static void aran_translate_bufferd_free (AranTranslateBufferd *buf)
       if (buf->direct2 != NULL)
         g_free (buf->direct2);
 
+      _retired_free (buf->retired);
+
       buf->buffer = NULL;
       buf->direct1 = NULL;
       buf->direct2 = NULL;
@@ -208,44 +270,76 @@ static void aran_translate_bufferd_free (AranTranslateBufferd *buf)
 static void aran_translate_bufferd_require (AranTranslateBufferd *buf,
                                             guint max)
 {
+  AranTranslateBufferd tmp;
   guint l, size;
-  gint i, j, k;
+  gint i, j, k, oldl;
 
   g_return_if_fail (buf != NULL);
 
-  if (buf->l >= (gint) max) return;
+  oldl = g_atomic_int_get (&buf->l);
 
-  l = MAX (buf->l, 1);
+  if (oldl >= (gint) max) return;
+
+  l = MAX (oldl, 1);
 
   while (l < (gint) max) l *= 2;
 
   size = ((l+1)*(l+1)*(l+2))/2;
 
-  buf->direct1 = g_realloc (buf->direct1, (l+1) * sizeof (gdouble *));
-  buf->direct2 = g_realloc (buf->direct2, ((l+1)*(l+2))/2 * sizeof (gdouble *));
-  buf->buffer = g_realloc (buf->buffer, size * sizeof (gdouble));
+  /* rows are strided by @l: every term is regenerated aside */
+  tmp.l = l;
+  tmp.generator = buf->generator;
+  tmp.retired = NULL;
+  tmp.direct1 = g_malloc ((l+1) * sizeof (gdouble *));
+  tmp.direct2 = g_malloc (((l+1)*(l+2))/2 * sizeof (gdouble *));
+  tmp.buffer = g_malloc (size * sizeof (gdouble));
 
   for (i=0; i<=l; i ++)
     {
       for (j=0; j<=i; j++)
-        buf->direct2[(i*(i+1))/2 + j] = buf->buffer + (l+1)*((i*(i+1))/2+j);
+        tmp.direct2[(i*(i+1))/2 + j] = tmp.buffer + (l+1)*((i*(i+1))/2+j);
 
-      buf->direct1[i] = buf->direct2 + (i*(i+1))/2;
+      tmp.direct1[i] = tmp.direct2 + (i*(i+1))/2;
     }
 
-  buf->l = l;
-
   for (i=0; i<=l; i ++)
     {
       for (j=0; j<=i; j ++)
         {
           for (k=0; k<=l; k++)
             {
-              /* g_printerr ("%u %u %u %ld\n", i, j, k, &buf->direct1[i][j][k] - buf->buffer); */
-              buf->direct1[i][j][k] = buf->generator (i, j, k, buf);
+              /* g_printerr ("%u %u %u %ld\n", i, j, k, &tmp.direct1[i][j][k] - tmp.buffer); */
+              tmp.direct1[i][j][k] = tmp.generator (i, j, k, &tmp);
             }
         }
     }
+
+  G_LOCK (buffers);
+
+  if (buf->l < tmp.l)
+    {
+      if (buf->buffer != NULL)
+        {
+          buf->retired = g_slist_prepend (buf->retired, buf->buffer);
+          buf->retired = g_slist_prepend (buf->retired, buf->direct1);
+          buf->retired = g_slist_prepend (buf->retired, buf->direct2);
+        }
+
+      g_atomic_pointer_set (&buf->buffer, tmp.buffer);
+      g_atomic_pointer_set (&buf->direct1, tmp.direct1);
+      g_atomic_pointer_set (&buf->direct2, tmp.direct2);
+
+      g_atomic_int_set (&buf->l, tmp.l);
+    }
+  else
+    {
+      /* another thread was faster */
+      g_free (tmp.buffer);
+      g_free (tmp.direct1);
+      g_free (tmp.direct2);
+    }
+
+  G_UNLOCK (buffers);
 }
 
 static inline gdouble *aran_translate_bufferd_get_unsafe (AranTranslateBufferd *buf,
@@ -279,16 +373,26 @@ static void _precomputed_translate_vertical_require (guint deg)
   aran_spherical_seriesd_alpha_require (deg+deg);
   _betal_over_betan_require (deg);
 
-  if (_precomputed_translate_vertical_buffer == NULL)
+  if (g_atomic_pointer_get (&_precomputed_translate_vertical_buffer) == NULL)
     {
-      _precomputed_translate_vertical_buffer = aran_translate_bufferd_new (_precomputed_translate_vertical_generator, deg);
+      AranTranslateBufferd *buf = aran_translate_bufferd_new (_precomputed_translate_vertical_generator, deg);
 
-      g_atexit (_atexit2);
-    }
-  else
-    {
-      aran_translate_bufferd_require (_precomputed_translate_vertical_buffer, deg);
+      G_LOCK (buffers);
+
+      if (_precomputed_translate_vertical_buffer == NULL)
+        {
+          g_atomic_pointer_set (&_precomputed_translate_vertical_buffer, buf);
+          buf = NULL;
+
+          g_atexit (_atexit2);
+        }
+
+      G_UNLOCK (buffers);
+
+      aran_translate_bufferd_free (buf);
     }
+
+  aran_translate_bufferd_require (_precomputed_translate_vertical_buffer, deg);
 }
 
 static inline gdouble _precomputed_translate_vertical (guint l, guint m, guint n)
@@ -296,6 +400,21 @@ static inline gdouble _precomputed_translate_vertical (guint l, guint m, guint n
   return *aran_translate_bufferd_get_unsafe (_precomputed_translate_vertical_buffer, l, m, n);
 }
 
+/*
+ * exported for the single precision vertical M2L in
+ * aransphericalseriesf.c.
+ */
+void aran_spherical_seriesd_translate_vertical_require (guint deg)
+{
+  _precomputed_translate_vertical_require (deg);
+}
+
+gdouble aran_spherical_seriesd_translate_vertical_factor (guint l, guint m,
+                                                          guint n)
+{
+  return _precomputed_translate_vertical (l, m, n);
+}
+
 /* functions */
 
 static void aran_local_translate_vertical (const AranSphericalSeriesd * src,
@@ -311,9 +430,6 @@ static void aran_local_translate_vertical (const AranSphericalSeriesd * src,
   gcomplex128 *srcterm, *dstterm;
   gint d = MAX (src->posdeg, dst->posdeg);
 
-  if (src->posdeg > dst->posdeg)
-    g_warning ("could loose precision in \"%s\"\n", __PRETTY_FUNCTION__);
-
   aran_spherical_seriesd_beta_require (d);
   aran_spherical_seriesd_alpha_require (d);
   _betal_over_betan_require (d);
@@ -378,9 +494,6 @@ static void aran_local_translate (const AranSphericalSeriesd * src,
   gcomplex128 harmonics[((d + 1) * (d + 2)) / 2];
   gcomplex128 expp = cosp + G_I * sinp;
 
-  if (src->posdeg > dst->posdeg)
-    g_warning ("could loose precision in \"%s\"\n", __PRETTY_FUNCTION__);
-
   aran_spherical_seriesd_beta_require (d);
   aran_spherical_seriesd_alpha_require (d);
   _betal_over_betan_require (d);
@@ -456,9 +569,6 @@ aran_multipole_translate_vertical (const AranSphericalSeriesd * src,
   gcomplex128 *srcterm, *dstterm;
   gint d = MAX (src->negdeg, dst->negdeg) - 1;
 
-  if (src->negdeg > dst->negdeg)
-    g_warning ("could loose precision in \"%s\"\n", __PRETTY_FUNCTION__);
-
   aran_spherical_seriesd_alpha_require (d);
   aran_spherical_seriesd_beta_require (d);
   _betal_over_betan_require (d+1);
@@ -519,9 +629,6 @@ static void aran_multipole_translate (const AranSphericalSeriesd * src,
   gcomplex128 harmonics[((d + 1) * (d + 2)) / 2];
   gcomplex128 expp = cosp + G_I * sinp;
 
-  if (src->negdeg > dst->negdeg)
-    g_warning ("could loose precision in \"%s\"\n", __PRETTY_FUNCTION__);
-
   aran_spherical_seriesd_alpha_require (d);
   aran_spherical_seriesd_beta_require (d);
   _betal_over_betan_require (d);
@@ -79,13 +79,47 @@ static void _atexit ()
   _alpha_buffer = NULL;
 }
 
+G_LOCK_DEFINE_STATIC (buffers);
+
+static void _buffers_init (guint deg)
+{
+  AranCoefficientBufferd *beta =
+    aran_coefficient_bufferd_new (_beta_generator, deg);
+  AranBinomialBufferd *alpha =
+    aran_binomial_bufferd_new (_alpha_generator, deg);
+
+  G_LOCK (buffers);
+
+  /* @_alpha_buffer is published first: it is tested alone */
+  if (_beta_buffer == NULL)
+    {
+      g_atomic_pointer_set (&_alpha_buffer, alpha);
+      g_atomic_pointer_set (&_beta_buffer, beta);
+      alpha = NULL;
+      beta = NULL;
+
+      g_atexit (_atexit);
+    }
+
+  G_UNLOCK (buffers);
+
+  aran_coefficient_bufferd_free (beta);
+  aran_binomial_bufferd_free (alpha);
+}
+
 void aran_spherical_seriesd_beta_require (guint deg)
 {
+  if (g_atomic_pointer_get (&_beta_buffer) == NULL)
+    _buffers_init (deg);
+
   aran_coefficient_bufferd_require (_beta_buffer, deg);
 }
 
 void aran_spherical_seriesd_alpha_require (guint deg)
 {
+  if (g_atomic_pointer_get (&_alpha_buffer) == NULL)
+    _buffers_init (deg);
+
   aran_binomial_bufferd_require (_alpha_buffer, deg);
 }
 
@@ -107,6 +141,103 @@ void aran_spherical_seriesd_unpack (AranSphericalSeriesd *ass, VsgPackedMsg *pm)
                             ARAN_MPI_TYPE_GCOMPLEX128);
 }
 
+/* number of leading degrees whose magnitude exceeds thr */
+static gint _degrees_above (const gcomplex128 *terms, gint deg, gdouble thr)
+{
+  gint l, m, n = 0;
+
+  for (l=0; l<deg; l ++)
+    {
+      for (m=0; m<=l; m ++)
+        {
+          if (fabs (creal (*terms)) > thr || fabs (cimag (*terms)) > thr)
+            n = l+1;
+
+          terms ++;
+        }
+    }
+
+  return n;
+}
+
+static gdouble _max_abs (const gcomplex128 *terms, gint size)
+{
+  gdouble res = 0.;
+  gint i;
+
+  for (i=0; i<size; i ++)
+    res = MAX (res, MAX (fabs (creal (terms[i])), fabs (cimag (terms[i]))));
+
+  return res;
+}
+
+/**
+ * aran_spherical_seriesd_pack_compressed:
+ * @ass: an #AranSphericalSeriesd.
+ * @pm: a #VsgPackedMsg.
+ * @compression: wire format parameters.
+ *
+ * Packs @ass into @pm, leaving out the trailing degrees whose coefficients
+ * are all smaller than @compression->epsilon times the largest coefficient
+ * of @ass. A zero series is reduced to its header.
+ */
+void aran_spherical_seriesd_pack_compressed (AranSphericalSeriesd *ass,
+                                             VsgPackedMsg *pm,
+                                             const AranPackCompression *
+                                             compression)
+{
+  gcomplex128 *pos = (gcomplex128 *) (ass+1);
+  gcomplex128 *neg = pos + _spherical_seriesd_size (ass->posdeg, 0);
+  gdouble thr = compression->epsilon *
+    _max_abs (pos, _spherical_seriesd_size (ass->posdeg, ass->negdeg));
+  gint header[3];
+
+  header[0] = compression->single;
+  header[1] = _degrees_above (pos, ass->posdeg + 1, thr);
+  header[2] = _degrees_above (neg, ass->negdeg, thr);
+
+  vsg_packed_msg_send_append (pm, header, 3, MPI_INT);
+
+  if (header[1] > 0)
+    aran_gcomplex128_pack_array (pm, pos, header[1] * (header[1] + 1) / 2,
+                                 header[0]);
+
+  if (header[2] > 0)
+    aran_gcomplex128_pack_array (pm, neg, header[2] * (header[2] + 1) / 2,
+                                 header[0]);
+}
+
+/**
+ * aran_spherical_seriesd_unpack_compressed:
+ * @ass: an #AranSphericalSeriesd.
+ * @pm: a #VsgPackedMsg.
+ *
+ * Unpacks a series packed by aran_spherical_seriesd_pack_compressed(). Left
+ * out coefficients are set to zero.
+ */
+void aran_spherical_seriesd_unpack_compressed (AranSphericalSeriesd *ass,
+                                               VsgPackedMsg *pm)
+{
+  gcomplex128 *pos = (gcomplex128 *) (ass+1);
+  gcomplex128 *neg = pos + _spherical_seriesd_size (ass->posdeg, 0);
+  gint header[3];
+
+  vsg_packed_msg_recv_read (pm, header, 3, MPI_INT);
+
+  g_return_if_fail (header[1] <= ass->posdeg + 1);
+  g_return_if_fail (header[2] <= ass->negdeg);
+
+  aran_spherical_seriesd_set_zero (ass);
+
+  if (header[1] > 0)
+    aran_gcomplex128_unpack_array (pm, pos, header[1] * (header[1] + 1) / 2,
+                                   header[0]);
+
+  if (header[2] > 0)
+    aran_gcomplex128_unpack_array (pm, neg, header[2] * (header[2] + 1) / 2,
+                                   header[0]);
+}
+
 #endif
 
 /**
@@ -123,19 +254,8 @@ AranSphericalSeriesd *aran_spherical_seriesd_new (guint8 posdeg, guint8 negdeg)
 {
   AranSphericalSeriesd *ass;
 
-  if (_beta_buffer == NULL)
-    {
-      _beta_buffer = aran_coefficient_bufferd_new (_beta_generator,
-                                                   posdeg + negdeg);
-      _alpha_buffer = aran_binomial_bufferd_new (_alpha_generator,
-                                                 posdeg + negdeg);
-      g_atexit (_atexit);
-    }
-  else
-    {
-      aran_spherical_seriesd_beta_require (posdeg + negdeg);
-      aran_spherical_seriesd_alpha_require (posdeg + negdeg);
-    }
+  aran_spherical_seriesd_beta_require (posdeg + negdeg);
+  aran_spherical_seriesd_alpha_require (posdeg + negdeg);
 
   ass = (AranSphericalSeriesd *)
     g_malloc0 (ARAN_SPHERICAL_SERIESD_SIZE (posdeg, negdeg));
@@ -545,6 +665,185 @@ void aran_spherical_seriesd_gradient_evaluate
                                creal (dr), creal (dt), creal (dp), grad);
 }
 
+/**
+ * aran_spherical_seriesd_local_gradient:
+ * @src: an #AranSphericalSeriesd.
+ * @dx: gradient x component result.
+ * @dy: gradient y component result.
+ * @dz: gradient z component result.
+ *
+ * Differentiates the local (positive degree) part of @src into three
+ * local series of degree posdeg(@src)-1, one for each cartesian
+ * component of the gradient. @dx, @dy and @dz must have a positive degree
+ * of at least posdeg(@src)-1. Their extra terms are set to zero.
+ *
+ * Once computed, these series allow to evaluate the gradient of @src at
+ * many locations without the differentiation work of
+ * aran_spherical_seriesd_gradient_evaluate_internal().
+ */
+void aran_spherical_seriesd_local_gradient (const AranSphericalSeriesd *src,
+                                            AranSphericalSeriesd *dx,
+                                            AranSphericalSeriesd *dy,
+                                            AranSphericalSeriesd *dz)
+{
+  gint l, m;
+
+  g_return_if_fail (src != NULL);
+  g_return_if_fail (dx != NULL);
+  g_return_if_fail (dy != NULL);
+  g_return_if_fail (dz != NULL);
+  g_return_if_fail (dx->posdeg + 1 >= src->posdeg);
+  g_return_if_fail (dy->posdeg + 1 >= src->posdeg);
+  g_return_if_fail (dz->posdeg + 1 >= src->posdeg);
+
+  aran_spherical_seriesd_set_zero (dx);
+  aran_spherical_seriesd_set_zero (dy);
+  aran_spherical_seriesd_set_zero (dz);
+
+  /*
+   * With S_l^m = r^l Y_l^m, (d/dx + i d/dy) S_l^m, (d/dx - i d/dy) S_l^m
+   * and d/dz S_l^m are respectively proportional to S_{l-1}^{m+1},
+   * S_{l-1}^{m-1} and S_{l-1}^m.
+   */
+  for (l = 1; l <= src->posdeg; l++)
+    {
+      gdouble f = sqrt ((l + l + 1.) / (l + l - 1.));
+      gcomplex128 *srcterm = _spherical_seriesd_get_pos_term (src, l, 0);
+      gcomplex128 *xterm = _spherical_seriesd_get_pos_term (dx, l - 1, 0);
+      gcomplex128 *yterm = _spherical_seriesd_get_pos_term (dy, l - 1, 0);
+      gcomplex128 *zterm = _spherical_seriesd_get_pos_term (dz, l - 1, 0);
+
+      for (m = 0; m < l; m++)
+        {
+          gcomplex128 prev = (m == 0) ? _sph_sym (srcterm[1], 1) :
+            srcterm[m - 1];
+          gcomplex128 plus = f * sqrt ((l - m + 1.) * (l - m)) * prev;
+          gcomplex128 minus = - f * sqrt ((l + m + 1.) * (l + m)) *
+            srcterm[m + 1];
+
+          xterm[m] = 0.5 * (plus + minus);
+          yterm[m] = -0.5 * G_I * (plus - minus);
+          zterm[m] = f * sqrt ((l - m) * (l + m + 0.)) * srcterm[m];
+        }
+    }
+}
+
+static gcomplex128 _local_horner (const AranSphericalSeriesd *ass,
+                                  gcomplex128 *harmonics, gdouble r)
+{
+  gint l, m;
+  gcomplex128 *coefficient, *hterm;
+  gcomplex128 res = 0.;
+
+  for (l = ass->posdeg; l >= 0; l--)
+    {
+      gcomplex128 sum = 0.;
+
+      coefficient = _spherical_seriesd_get_pos_term (ass, l, 0);
+      hterm = aran_spherical_harmonic_multiple_get_term (l, 0, harmonics);
+
+      for (m = 1; m <= l; m++)
+        {
+          sum += creal (coefficient[m] * hterm[m]);
+        }
+
+      sum = 2. * sum + coefficient[0] * hterm[0];
+
+      res = res * r + sum;
+    }
+
+  return res;
+}
+
+/**
+ * aran_spherical_seriesd_local_field_evaluate_internal:
+ * @ass: an #AranSphericalSeriesd or %NULL.
+ * @dx: gradient x component of @ass.
+ * @dy: gradient y component of @ass.
+ * @dz: gradient z component of @ass.
+ * @r: radius.
+ * @cost: cos (theta).
+ * @sint: sin (theta).
+ * @cosp: cos (phi).
+ * @sinp: sin (phi).
+ * @grad: gradient result.
+ *
+ * Evaluates the local part of @ass and its gradient, as previously computed
+ * by aran_spherical_seriesd_local_gradient(), at a point defined by its
+ * spherical coordinates. All four series share the same spherical
+ * harmonics evaluation.
+ *
+ * Returns: value of @ass local part at the specified location or 0. if
+ * @ass is %NULL.
+ */
+gcomplex128
+aran_spherical_seriesd_local_field_evaluate_internal
+(const AranSphericalSeriesd *ass,
+ const AranSphericalSeriesd *dx,
+ const AranSphericalSeriesd *dy,
+ const AranSphericalSeriesd *dz,
+ gdouble r,
+ gdouble cost, gdouble sint,
+ gdouble cosp, gdouble sinp,
+ VsgVector3d *grad)
+{
+  gint n = MAX (MAX (dx->posdeg, dy->posdeg), dz->posdeg);
+  gcomplex128 expp = cosp + G_I * sinp;
+  gcomplex128 res = 0.;
+
+  if (ass != NULL) n = MAX (n, ass->posdeg);
+
+  {
+    gcomplex128 harmonics[((n + 1) * (n + 2)) / 2];
+
+    aran_spherical_harmonic_evaluate_multiple_internal (n, cost, sint, expp,
+                                                        harmonics);
+
+    if (ass != NULL) res = _local_horner (ass, harmonics, r);
+
+    grad->x = creal (_local_horner (dx, harmonics, r));
+    grad->y = creal (_local_horner (dy, harmonics, r));
+    grad->z = creal (_local_horner (dz, harmonics, r));
+  }
+
+  return res;
+}
+
+/**
+ * aran_spherical_seriesd_local_field_evaluate:
+ * @ass: an #AranSphericalSeriesd or %NULL.
+ * @dx: gradient x component of @ass.
+ * @dy: gradient y component of @ass.
+ * @dz: gradient z component of @ass.
+ * @x: location.
+ * @grad: gradient result.
+ *
+ * Evaluates the local part of @ass and its gradient at @x. This is a
+ * convenience wrapper around
+ * aran_spherical_seriesd_local_field_evaluate_internal().
+ *
+ * Returns: value of @ass local part at @x or 0. if @ass is %NULL.
+ */
+gcomplex128
+aran_spherical_seriesd_local_field_evaluate (const AranSphericalSeriesd *ass,
+                                             const AranSphericalSeriesd *dx,
+                                             const AranSphericalSeriesd *dy,
+                                             const AranSphericalSeriesd *dz,
+                                             const VsgVector3d *x,
+                                             VsgVector3d *grad)
+{
+  gdouble r, cost, sint, cosp, sinp;
+
+  vsg_vector3d_to_spherical_internal (x, &r, &cost, &sint, &cosp, &sinp);
+
+  return aran_spherical_seriesd_local_field_evaluate_internal (ass,
+                                                               dx, dy, dz,
+                                                               r,
+                                                               cost, sint,
+                                                               cosp, sinp,
+                                                               grad);
+}
+
 /**
  * aran_spherical_seriesd_add:
  * @one: a #AranSphericalSeriesd.
@@ -65,6 +65,12 @@ void aran_spherical_seriesd_write (const AranSphericalSeriesd *ass,
 void aran_spherical_seriesd_pack (AranSphericalSeriesd *ass, VsgPackedMsg *pm);
 void aran_spherical_seriesd_unpack (AranSphericalSeriesd *ass,
                                     VsgPackedMsg *pm);
+void aran_spherical_seriesd_pack_compressed (AranSphericalSeriesd *ass,
+                                             VsgPackedMsg *pm,
+                                             const AranPackCompression *
+                                             compression);
+void aran_spherical_seriesd_unpack_compressed (AranSphericalSeriesd *ass,
+                                               VsgPackedMsg *pm);
 #endif
 
 gcomplex128
@@ -86,6 +92,30 @@ void aran_spherical_seriesd_gradient_evaluate_internal
 void aran_spherical_seriesd_gradient_evaluate (const AranSphericalSeriesd *ass,
                                                const VsgVector3d *x, VsgVector3d *grad);
 
+void aran_spherical_seriesd_local_gradient (const AranSphericalSeriesd *src,
+                                            AranSphericalSeriesd *dx,
+                                            AranSphericalSeriesd *dy,
+                                            AranSphericalSeriesd *dz);
+
+gcomplex128
+aran_spherical_seriesd_local_field_evaluate_internal
+(const AranSphericalSeriesd *ass,
+ const AranSphericalSeriesd *dx,
+ const AranSphericalSeriesd *dy,
+ const AranSphericalSeriesd *dz,
+ gdouble r,
+ gdouble cost, gdouble sint,
+ gdouble cosp, gdouble sinp,
+ VsgVector3d *grad);
+
+gcomplex128
+aran_spherical_seriesd_local_field_evaluate (const AranSphericalSeriesd *ass,
+                                             const AranSphericalSeriesd *dx,
+                                             const AranSphericalSeriesd *dy,
+                                             const AranSphericalSeriesd *dz,
+                                             const VsgVector3d *x,
+                                             VsgVector3d *grad);
+
 void aran_spherical_seriesd_add (AranSphericalSeriesd *one,
                                AranSphericalSeriesd *other,
                                AranSphericalSeriesd *result);
@@ -0,0 +1,603 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "aransphericalseriesf.h"
+#include "aransphericalseriesd-private.h"
+
+#include "aranwignerrepo.h"
+#include "aranwigner-private.h"
+
+#include <string.h>
+#include <math.h>
+
+/**
+ * AranSphericalSeriesf:
+ *
+ * Opaque structure. Possesses only private data. Single precision
+ * (#gcomplex64) counterpart of #AranSphericalSeriesd, with the same
+ * coefficients layout and normalization.
+ */
+struct _AranSphericalSeriesf
+{
+  guint8 posdeg;
+  guint8 negdeg;
+};
+
+#define ARAN_SPHERICAL_SERIESF_SIZE(pd, nd) ( \
+sizeof (AranSphericalSeriesf) + \
+_spherical_seriesd_size ((pd), (nd)) * \
+sizeof (gcomplex64) \
+)
+
+static inline
+gcomplex64 *_spherical_seriesf_get_pos_term (const AranSphericalSeriesf *ass,
+                                             guint l, gint m)
+{
+  g_return_val_if_fail (l <= ass->posdeg, NULL);
+  g_return_val_if_fail (ABS (m) <= l, NULL);
+
+  return ((gcomplex64 *) (ass + 1)) + ((l * (l + 1)) / 2 + m);
+}
+
+static inline
+gcomplex64 *_spherical_seriesf_get_neg_term (const AranSphericalSeriesf *ass,
+                                             guint l, gint m)
+{
+  g_return_val_if_fail (l < ass->negdeg, NULL);
+  g_return_val_if_fail (ABS (m) <= l, NULL);
+
+  return ((gcomplex64 *) (ass + 1)) + ((ass->posdeg + 1) * (ass->posdeg + 2) +
+                                       l * (l + 1)) / 2 + m;
+}
+
+static inline gcomplex64 _sph_symf (gcomplex64 z, gint m)
+{
+  z = conjf (z);
+
+  if (m % 2 != 0)
+    return -z;
+
+  return z;
+}
+
+/* functions */
+
+#ifdef VSG_HAVE_MPI
+
+void aran_spherical_seriesf_pack (AranSphericalSeriesf *ass, VsgPackedMsg *pm)
+{
+  vsg_packed_msg_send_append (pm, ass+1,
+                              _spherical_seriesd_size (ass->posdeg, ass->negdeg),
+                              ARAN_MPI_TYPE_GCOMPLEX64);
+}
+
+void aran_spherical_seriesf_unpack (AranSphericalSeriesf *ass, VsgPackedMsg *pm)
+{
+  vsg_packed_msg_recv_read (pm, ass+1,
+                            _spherical_seriesd_size (ass->posdeg, ass->negdeg),
+                            ARAN_MPI_TYPE_GCOMPLEX64);
+}
+
+#endif
+
+/**
+ * aran_spherical_seriesf_new:
+ * @posdeg: the positive expansion degree.
+ * @negdeg: the negative expansion degree.
+ *
+ * Creates a new #AranSphericalSeriesf with required positive (local) and
+ * negative (multipole) degrees.
+ *
+ * Returns: Newly allocated #AranSphericalSeriesf structure.
+ */
+AranSphericalSeriesf *aran_spherical_seriesf_new (guint8 posdeg, guint8 negdeg)
+{
+  AranSphericalSeriesf *ass;
+
+  /* coefficients are shared with double precision series */
+  aran_spherical_seriesd_beta_require (posdeg + negdeg);
+  aran_spherical_seriesd_alpha_require (posdeg + negdeg);
+
+  ass = (AranSphericalSeriesf *)
+    g_malloc0 (ARAN_SPHERICAL_SERIESF_SIZE (posdeg, negdeg));
+
+  ass->posdeg = posdeg;
+  ass->negdeg = negdeg;
+
+  return ass;
+}
+
+/**
+ * aran_spherical_seriesf_free:
+ * @ass: an #AranSphericalSeriesf.
+ *
+ * Frees memory allocated for @ass.
+ */
+void aran_spherical_seriesf_free (AranSphericalSeriesf *ass)
+{
+  g_free (ass);
+}
+
+/**
+ * aran_spherical_seriesf_copy:
+ * @src: an #AranSphericalSeriesf.
+ * @dst: an #AranSphericalSeriesf.
+ *
+ * Copies @src to @dst up to @dst degrees: can loose precision when
+ * @src->posdeg > @dst->posdeg for example.
+ */
+void aran_spherical_seriesf_copy (const AranSphericalSeriesf *src,
+                                  AranSphericalSeriesf *dst)
+{
+  guint8 nd = MIN (dst->negdeg, src->negdeg);
+  guint8 pd = MIN (dst->posdeg, src->posdeg);
+
+  if (src->posdeg > dst->posdeg || src->negdeg > dst->negdeg)
+    g_critical ("Could loose precision in \"%s\"", __PRETTY_FUNCTION__);
+
+  aran_spherical_seriesf_set_zero (dst);
+
+  memcpy (_spherical_seriesf_get_pos_term (dst, 0, 0),
+          _spherical_seriesf_get_pos_term (src, 0, 0),
+          _spherical_seriesd_size (pd, 0) * sizeof (gcomplex64));
+
+  if (nd != 0)
+    memcpy (_spherical_seriesf_get_neg_term (dst, 0, 0),
+            _spherical_seriesf_get_neg_term (src, 0, 0),
+            (_spherical_seriesd_size (0, nd) -
+             _spherical_seriesd_size (0, 0)) * sizeof (gcomplex64));
+}
+
+/**
+ * aran_spherical_seriesf_clone:
+ * @src: an #AranSphericalSeriesf.
+ *
+ * Duplicates @src.
+ *
+ * Returns: a newly allocated #AranSphericalSeriesf identical to @src.
+ */
+AranSphericalSeriesf *
+aran_spherical_seriesf_clone (const AranSphericalSeriesf *src)
+{
+  g_return_val_if_fail (src != NULL, NULL);
+
+  return g_memdup (src,
+                   ARAN_SPHERICAL_SERIESF_SIZE (src->posdeg, src->negdeg));
+}
+
+/**
+ * aran_spherical_seriesf_get_term:
+ * @ass: an #AranSphericalSeriesf.
+ * @i: a #gint. Condition -@ass->negdeg <= @i <= @ass->posdeg must hold.
+ * @j: a #gint. Condition -@i <= @j <= @i must hold.
+ *
+ * Provides access to a specified term in @ass.
+ * Returns: address of the coefficient.
+ */
+gcomplex64 *aran_spherical_seriesf_get_term (AranSphericalSeriesf *ass,
+                                             gint i, gint j)
+{
+  g_return_val_if_fail (ass != NULL, NULL);
+
+  if (i < 0)
+    return _spherical_seriesf_get_neg_term (ass, -i - 1, j);
+
+  return _spherical_seriesf_get_pos_term (ass, i, j);
+}
+
+/**
+ * aran_spherical_seriesf_get_posdeg:
+ * @ass: an #AranSphericalSeriesf.
+ *
+ * Returns: positive degree of @ass.
+ */
+guint8 aran_spherical_seriesf_get_posdeg (const AranSphericalSeriesf *ass)
+{
+  g_return_val_if_fail (ass != NULL, 0);
+  return ass->posdeg;
+}
+
+/**
+ * aran_spherical_seriesf_get_negdeg:
+ * @ass: an #AranSphericalSeriesf.
+ *
+ * Returns: negative degree of @ass.
+ */
+guint8 aran_spherical_seriesf_get_negdeg (const AranSphericalSeriesf *ass)
+{
+  g_return_val_if_fail (ass != NULL, 0);
+  return ass->negdeg;
+}
+
+/**
+ * aran_spherical_seriesf_set_zero:
+ * @ass: an #AranSphericalSeriesf.
+ *
+ * Sets all @ass coefficients to zero. @ass degrees are unchanged.
+ */
+void aran_spherical_seriesf_set_zero (AranSphericalSeriesf *ass)
+{
+  g_return_if_fail (ass != NULL);
+
+  memset (ass+1, 0, _spherical_seriesd_size (ass->posdeg, ass->negdeg) *
+          sizeof (gcomplex64));
+}
+
+/**
+ * aran_spherical_seriesf_write:
+ * @ass: an #AranSphericalSeriesf.
+ * @file: output file.
+ *
+ * Writes @ass to @file.
+ */
+void aran_spherical_seriesf_write (const AranSphericalSeriesf *ass,
+                                   FILE *file)
+{
+  gint16 i, j;
+  gcomplex64 *term;
+
+  g_return_if_fail (ass != NULL);
+
+  fprintf (file, "[");
+
+  for (i = -ass->negdeg; i <= ass->posdeg; i++)
+    {
+      gint16 maxj = ABS (i);
+
+      if (i < 0)
+        {
+          maxj--;
+          term = _spherical_seriesf_get_neg_term (ass, -i - 1, 0);
+        }
+      else
+        term = _spherical_seriesf_get_pos_term (ass, i, 0);
+
+      for (j = 0; j <= maxj; j++)
+        fprintf (file, "[%d,%d]:(%e,%e), ",
+                 i, j, crealf (term[j]), cimagf (term[j]));
+    }
+
+  fprintf (file, "]");
+}
+
+/**
+ * aran_spherical_seriesf_add:
+ * @one:  a #AranSphericalSeriesf.
+ * @other:  a #AranSphericalSeriesf.
+ * @result: a #AranSphericalSeriesf.
+ *
+ * Computes the addition of @one and @other into @result. All
+ * arguments must have the same degree. Argument aliasing is allowed.
+ */
+void aran_spherical_seriesf_add (AranSphericalSeriesf *one,
+                                 AranSphericalSeriesf *other,
+                                 AranSphericalSeriesf *result)
+{
+  gint i, size;
+  gcomplex64 *oneterm;
+  gcomplex64 *otherterm;
+  gcomplex64 *resultterm;
+
+  g_return_if_fail (one != NULL);
+  g_return_if_fail (other != NULL);
+  g_return_if_fail (result != NULL);
+
+  g_return_if_fail (one->posdeg == result->posdeg);
+  g_return_if_fail (other->posdeg == result->posdeg);
+
+  g_return_if_fail (one->negdeg == result->negdeg);
+  g_return_if_fail (other->negdeg == result->negdeg);
+
+  oneterm = (gcomplex64 *) (one+1);
+  otherterm = (gcomplex64 *) (other+1);
+  resultterm = (gcomplex64 *) (result+1);
+
+  size = _spherical_seriesd_size (result->posdeg, result->negdeg);
+
+  for (i=0; i<size; i++)
+    resultterm[i] = oneterm[i] + otherterm[i];
+}
+
+/**
+ * aran_spherical_seriesf_from_seriesd:
+ * @src: a double precision #AranSphericalSeriesd.
+ * @dst: an #AranSphericalSeriesf.
+ *
+ * Rounds @src coefficients to single precision and accumulates them into
+ * @dst, up to the lowest degrees of both series.
+ */
+void aran_spherical_seriesf_from_seriesd (const AranSphericalSeriesd *src,
+                                          AranSphericalSeriesf *dst)
+{
+  guint8 nd, pd;
+  gint i, size;
+  gcomplex128 *srcterm;
+  gcomplex64 *dstterm;
+
+  g_return_if_fail (src != NULL);
+  g_return_if_fail (dst != NULL);
+
+  nd = MIN (dst->negdeg, src->negdeg);
+  pd = MIN (dst->posdeg, src->posdeg);
+
+  srcterm = _spherical_seriesd_get_pos_term (src, 0, 0);
+  dstterm = _spherical_seriesf_get_pos_term (dst, 0, 0);
+  size = _spherical_seriesd_size (pd, 0);
+
+  for (i=0; i<size; i++)
+    dstterm[i] += (gcomplex64) srcterm[i];
+
+  if (nd == 0) return;
+
+  srcterm = _spherical_seriesd_get_neg_term (src, 0, 0);
+  dstterm = _spherical_seriesf_get_neg_term (dst, 0, 0);
+  size = _spherical_seriesd_size (0, nd) - _spherical_seriesd_size (0, 0);
+
+  for (i=0; i<size; i++)
+    dstterm[i] += (gcomplex64) srcterm[i];
+}
+
+/**
+ * aran_spherical_seriesf_to_seriesd:
+ * @src: an #AranSphericalSeriesf.
+ * @dst: a double precision #AranSphericalSeriesd.
+ *
+ * Accumulates @src coefficients into @dst, up to the lowest degrees of
+ * both series.
+ */
+void aran_spherical_seriesf_to_seriesd (const AranSphericalSeriesf *src,
+                                        AranSphericalSeriesd *dst)
+{
+  guint8 nd, pd;
+  gint i, size;
+  gcomplex64 *srcterm;
+  gcomplex128 *dstterm;
+
+  g_return_if_fail (src != NULL);
+  g_return_if_fail (dst != NULL);
+
+  nd = MIN (dst->negdeg, src->negdeg);
+  pd = MIN (dst->posdeg, src->posdeg);
+
+  srcterm = _spherical_seriesf_get_pos_term (src, 0, 0);
+  dstterm = _spherical_seriesd_get_pos_term (dst, 0, 0);
+  size = _spherical_seriesd_size (pd, 0);
+
+  for (i=0; i<size; i++)
+    dstterm[i] += srcterm[i];
+
+  if (nd == 0) return;
+
+  srcterm = _spherical_seriesf_get_neg_term (src, 0, 0);
+  dstterm = _spherical_seriesd_get_neg_term (dst, 0, 0);
+  size = _spherical_seriesd_size (0, nd) - _spherical_seriesd_size (0, 0);
+
+  for (i=0; i<size; i++)
+    dstterm[i] += srcterm[i];
+}
+
+/* double precision work copy of a single precision series */
+#define _WIDEN(src, wide) { \
+  (wide) = (AranSphericalSeriesd *) \
+    g_alloca (ARAN_SPHERICAL_SERIESD_SIZE ((src)->posdeg, (src)->negdeg)); \
+  (wide)->posdeg = (src)->posdeg; \
+  (wide)->negdeg = (src)->negdeg; \
+  aran_spherical_seriesd_set_zero (wide); \
+  aran_spherical_seriesf_to_seriesd ((src), (wide)); \
+}
+
+/**
+ * aran_spherical_seriesf_evaluate:
+ * @ass: an #AranSphericalSeriesf.
+ * @x: evaluation position.
+ *
+ * Evaluates @ass at @x. Evaluation is performed in double precision.
+ *
+ * Returns: value of @ass at @x.
+ */
+gcomplex128 aran_spherical_seriesf_evaluate (const AranSphericalSeriesf *ass,
+                                             const VsgVector3d *x)
+{
+  AranSphericalSeriesd *wide;
+
+  g_return_val_if_fail (ass != NULL, 0.);
+
+  _WIDEN (ass, wide);
+
+  return aran_spherical_seriesd_evaluate (wide, x);
+}
+
+/**
+ * aran_spherical_seriesf_gradient_evaluate:
+ * @ass: an #AranSphericalSeriesf.
+ * @x: evaluation position.
+ * @grad: result.
+ *
+ * Evaluates the gradient of @ass at @x. Evaluation is performed in double
+ * precision.
+ */
+void aran_spherical_seriesf_gradient_evaluate (const AranSphericalSeriesf *ass,
+                                               const VsgVector3d *x,
+                                               VsgVector3d *grad)
+{
+  AranSphericalSeriesd *wide;
+
+  g_return_if_fail (ass != NULL);
+
+  _WIDEN (ass, wide);
+
+  aran_spherical_seriesd_gradient_evaluate (wide, x, grad);
+}
+
+/* rotate a single precision Series buffer (multipole or local) */
+static void _buffer_rotatef (AranWigner * aw, guint deg,
+                             gcomplex64 * src, gcomplex64 * dst)
+{
+  gcomplex64 src_l[deg + 1];
+  gcomplex64 src_l_neg[deg + 1];
+  gint l, mprime, m;
+  gint l_lp1_over_2 = 0;
+
+  for (l = 0; l <= deg; l++)
+    {
+      l_lp1_over_2 += l;
+
+      for (m=0; m<=l; m++)
+        {
+          src_l[m] = src[l_lp1_over_2 + m];
+          src_l_neg[m] = _sph_symf (src_l[m], m);
+        }
+
+      for (mprime = 0; mprime <= l; mprime++)
+        {
+          gcomplex64 sum = 0.f;
+
+          for (m = -l; m < 0; m++)
+            sum += (gcomplex64) *ARAN_WIGNER_TERM (aw, l, mprime, m) *
+              src_l_neg[-m];
+
+          for (m = 0; m <= l; m++)
+            sum += (gcomplex64) *ARAN_WIGNER_TERM (aw, l, mprime, m) *
+              src_l[m];
+
+          dst[l_lp1_over_2 + mprime] += sum;
+        }
+    }
+}
+
+/*
+ * single precision counterpart of
+ * aran_spherical_seriesd_multipole_to_local_vertical(). Coefficients are
+ * computed in double precision and rounded once per term.
+ */
+static void _multipole_to_local_verticalf (const AranSphericalSeriesf *src,
+                                           AranSphericalSeriesf *dst,
+                                           gdouble r, gdouble cost)
+{
+  gint l, m, n;
+  gint d = dst->posdeg + src->negdeg;
+  gdouble rpow[d + 1];
+  gfloat factor[src->negdeg + 1];
+  gdouble pow, inv_r;
+
+  aran_spherical_seriesd_alpha_require (d);
+  aran_spherical_seriesd_beta_require (d);
+  aran_spherical_seriesd_translate_vertical_require (MAX (dst->posdeg,
+                                                          src->negdeg));
+
+  inv_r = 1. / r;
+  pow = 1.;
+  for (l = 0; l <= d; l++)
+    {
+      /* Y_(l+n)^0 reduces to (cost)^(l+n), integrated into rpow */
+      rpow[l] = (l%2 == 0) ? pow * cost : pow;
+      pow *= inv_r;
+    }
+
+  for (l = 0; l <= dst->posdeg; l++)
+    {
+      for (m = 0; m <= l; m++)
+        {
+          gcomplex64 *dstterm = _spherical_seriesf_get_pos_term (dst, l, m);
+          gcomplex64 sum = 0.f;
+
+          for (n = m; n < src->negdeg; n++)
+            factor[n] = rpow[l + n + 1] *
+              aran_spherical_seriesd_translate_vertical_factor (l, m, n);
+
+          for (n = m; n < src->negdeg; n++)
+            sum += *_spherical_seriesf_get_neg_term (src, n, m) * factor[n];
+
+          /* combination of (-1)^l and Y_n^(-m)*/
+          *dstterm += ((l+m)%2 == 0) ? sum : -sum;
+        }
+    }
+}
+
+/**
+ * aran_spherical_seriesf_to_local_rotate:
+ * @src: source expansion series.
+ * @xsrc: @src center.
+ * @dst: destination expansion series.
+ * @xdst: @dst center.
+ *
+ * Single precision version of aran_spherical_seriesd_to_local_rotate():
+ * transforms the multipole part of @src into a local expansion
+ * accumulated in @dst with the "Point and Shoot" algorithm. The local
+ * part of @src is ignored. Rotation and translation coefficients are
+ * computed in double precision while series arithmetic is carried out in
+ * single precision.
+ */
+void aran_spherical_seriesf_to_local_rotate (const AranSphericalSeriesf *src,
+                                             const VsgVector3d *xsrc,
+                                             AranSphericalSeriesf *dst,
+                                             const VsgVector3d *xdst)
+{
+  VsgVector3d dir;
+  gdouble r, theta, phi;
+  gdouble cost = 1.;
+  AranWigner *aw;
+  AranSphericalSeriesf *rot, *trans;
+
+  g_return_if_fail (src != NULL);
+  g_return_if_fail (dst != NULL);
+
+  if (src->negdeg == 0) return;
+
+  rot = (AranSphericalSeriesf *)
+    g_alloca (ARAN_SPHERICAL_SERIESF_SIZE (0, src->negdeg));
+  trans = (AranSphericalSeriesf *)
+    g_alloca (ARAN_SPHERICAL_SERIESF_SIZE (dst->posdeg, 0));
+
+  rot->posdeg = 0;
+  rot->negdeg = src->negdeg;
+  trans->posdeg = dst->posdeg;
+  trans->negdeg = 0;
+
+  aran_spherical_seriesf_set_zero (rot);
+  aran_spherical_seriesf_set_zero (trans);
+
+  /* get translation vector */
+  vsg_vector3d_sub (xdst, xsrc, &dir);
+
+  if (dir.z < 0.)
+    {
+      cost = -1.;
+      vsg_vector3d_scalp (&dir, -1., &dir);
+    }
+
+  /* get rotation angles */
+  vsg_vector3d_to_spherical (&dir, &r, &theta, &phi);
+
+  aw = aran_wigner_repo_lookup_require (-phi, theta, 0., src->negdeg);
+
+  _buffer_rotatef (aw, src->negdeg - 1,
+                   _spherical_seriesf_get_neg_term (src, 0, 0),
+                   _spherical_seriesf_get_neg_term (rot, 0, 0));
+
+  /* translate src to dst center */
+  _multipole_to_local_verticalf (rot, trans, r, cost);
+
+  /* rotate back */
+  aw = aran_wigner_repo_lookup_require (0., -theta, phi, dst->posdeg + 1);
+
+  _buffer_rotatef (aw, dst->posdeg,
+                   _spherical_seriesf_get_pos_term (trans, 0, 0),
+                   _spherical_seriesf_get_pos_term (dst, 0, 0));
+}
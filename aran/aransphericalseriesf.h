@@ -0,0 +1,94 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __ARAN_SPHERICAL_SERIESF_H__
+#define __ARAN_SPHERICAL_SERIESF_H__
+
+#include <glib.h>
+
+#include <vsg/vsgd.h>
+#ifdef VSG_HAVE_MPI
+#include <vsg/vsgpackedmsg.h>
+#endif
+
+#include <aran/arancomplex.h>
+
+#include <aran/aransphericalseriesd.h>
+
+G_BEGIN_DECLS;
+
+/* typedefs */
+
+typedef struct _AranSphericalSeriesf AranSphericalSeriesf;
+
+/* functions */
+
+AranSphericalSeriesf *aran_spherical_seriesf_new (guint8 posdeg, guint8 negdeg);
+
+void aran_spherical_seriesf_free (AranSphericalSeriesf *ass);
+
+void aran_spherical_seriesf_copy (const AranSphericalSeriesf *src,
+                                  AranSphericalSeriesf *dst);
+
+AranSphericalSeriesf *
+aran_spherical_seriesf_clone (const AranSphericalSeriesf *src);
+
+gcomplex64 *aran_spherical_seriesf_get_term (AranSphericalSeriesf *ass,
+                                             gint i, gint j);
+
+guint8 aran_spherical_seriesf_get_posdeg (const AranSphericalSeriesf *ass);
+
+guint8 aran_spherical_seriesf_get_negdeg (const AranSphericalSeriesf *ass);
+
+void aran_spherical_seriesf_set_zero (AranSphericalSeriesf *ass);
+
+void aran_spherical_seriesf_write (const AranSphericalSeriesf *ass,
+                                   FILE *file);
+
+#ifdef VSG_HAVE_MPI
+void aran_spherical_seriesf_pack (AranSphericalSeriesf *ass, VsgPackedMsg *pm);
+void aran_spherical_seriesf_unpack (AranSphericalSeriesf *ass,
+                                    VsgPackedMsg *pm);
+#endif
+
+void aran_spherical_seriesf_add (AranSphericalSeriesf *one,
+                                 AranSphericalSeriesf *other,
+                                 AranSphericalSeriesf *result);
+
+void aran_spherical_seriesf_from_seriesd (const AranSphericalSeriesd *src,
+                                          AranSphericalSeriesf *dst);
+
+void aran_spherical_seriesf_to_seriesd (const AranSphericalSeriesf *src,
+                                        AranSphericalSeriesd *dst);
+
+gcomplex128 aran_spherical_seriesf_evaluate (const AranSphericalSeriesf *ass,
+                                             const VsgVector3d *x);
+
+void aran_spherical_seriesf_gradient_evaluate (const AranSphericalSeriesf *ass,
+                                               const VsgVector3d *x,
+                                               VsgVector3d *grad);
+
+void aran_spherical_seriesf_to_local_rotate (const AranSphericalSeriesf *src,
+                                             const VsgVector3d *xsrc,
+                                             AranSphericalSeriesf *dst,
+                                             const VsgVector3d *xdst);
+
+G_END_DECLS;
+
+#endif /* __ARAN_SPHERICAL_SERIESF_H__ */
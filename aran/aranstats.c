@@ -0,0 +1,508 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "aran-config.h"
+
+#include <string.h>
+#include <time.h>
+
+#include "aranstats.h"
+
+/**
+ * AranStatsPhase:
+ * @ARAN_STATS_PHASE_CLEAR: developments clearing.
+ * @ARAN_STATS_PHASE_UP: upward pass (p2m and m2m).
+ * @ARAN_STATS_PHASE_NEAR_FAR: near/far interactions (p2p, m2l, p2l and m2p).
+ * @ARAN_STATS_PHASE_DOWN: downward pass (l2l and l2p).
+ * @ARAN_STATS_PHASE_COUNT: number of phases.
+ *
+ * Phases of a FMM solve.
+ */
+
+/**
+ * AranStatsOperator:
+ * @ARAN_STATS_ZERO: development clear function.
+ * @ARAN_STATS_P2P: particle to particle.
+ * @ARAN_STATS_P2M: particle to multipole.
+ * @ARAN_STATS_M2M: multipole to multipole.
+ * @ARAN_STATS_M2L: multipole to local.
+ * @ARAN_STATS_L2L: local to local.
+ * @ARAN_STATS_L2P: local to particle.
+ * @ARAN_STATS_P2L: particle to local.
+ * @ARAN_STATS_M2P: multipole to particle.
+ * @ARAN_STATS_P2P_REMOTE: p2p with remote nodes (count only).
+ * @ARAN_STATS_M2L_REMOTE: m2l with remote nodes (count only).
+ * @ARAN_STATS_OPERATOR_COUNT: number of operators.
+ *
+ * FMM operators accounted by #AranStats.
+ */
+
+/**
+ * AranStatsLevel:
+ * @count: operators call counts.
+ * @time: operators cumulative times.
+ *
+ * Operators statistics for one tree level.
+ */
+
+/**
+ * AranStatsBlock:
+ * @count: operators call counts.
+ * @time: operators cumulative times.
+ * @nlevels: size of @levels.
+ * @levels: per level statistics.
+ * @timer: wall clock used to time operators.
+ *
+ * Operators statistics accumulator, owned by one thread. Blocks are merged
+ * by #AranStats inquiry functions.
+ */
+
+/**
+ * AranStats:
+ *
+ * Instrumentation of a FMM solve: per phase wall clock and CPU times, per
+ * operator call counts and cumulative times, with per level breakdowns.
+ */
+struct _AranStats
+{
+  gdouble wall[ARAN_STATS_PHASE_COUNT];
+  gdouble cpu[ARAN_STATS_PHASE_COUNT];
+
+  gdouble wall_start[ARAN_STATS_PHASE_COUNT];
+  clock_t cpu_start[ARAN_STATS_PHASE_COUNT];
+
+  GTimer *timer;
+
+  guint nblocks;
+  AranStatsBlock **blocks;
+};
+
+static const gchar *_phase_names[ARAN_STATS_PHASE_COUNT] = {
+  "clear", "up", "near_far", "down",
+};
+
+static const gchar *_operator_names[ARAN_STATS_OPERATOR_COUNT] = {
+  "zero", "p2p", "p2m", "m2m", "m2l", "l2l", "l2p", "p2l", "m2p",
+  "p2p_remote", "m2l_remote",
+};
+
+static AranStatsBlock *_block_new ()
+{
+  AranStatsBlock *block = g_malloc0 (sizeof (AranStatsBlock));
+
+  block->timer = g_timer_new ();
+
+  return block;
+}
+
+static void _block_free (AranStatsBlock *block)
+{
+  g_timer_destroy (block->timer);
+  g_free (block->levels);
+  g_free (block);
+}
+
+static void _block_reset (AranStatsBlock *block)
+{
+  memset (block->count, 0, sizeof (block->count));
+  memset (block->time, 0, sizeof (block->time));
+
+  memset (block->levels, 0, block->nlevels * sizeof (AranStatsLevel));
+}
+
+/**
+ * aran_stats_new:
+ *
+ * Allocates a new #AranStats with one accumulation block.
+ *
+ * Returns: newly allocated structure.
+ */
+AranStats *aran_stats_new ()
+{
+  AranStats *stats = g_malloc0 (sizeof (AranStats));
+
+  stats->timer = g_timer_new ();
+
+  aran_stats_reserve_blocks (stats, 1);
+
+  return stats;
+}
+
+/**
+ * aran_stats_free:
+ * @stats: an #AranStats.
+ *
+ * Deallocates @stats and all associated memory.
+ */
+void aran_stats_free (AranStats *stats)
+{
+  guint i;
+
+  g_return_if_fail (stats != NULL);
+
+  for (i=0; i<stats->nblocks; i++)
+    _block_free (stats->blocks[i]);
+
+  g_free (stats->blocks);
+  g_timer_destroy (stats->timer);
+  g_free (stats);
+}
+
+/**
+ * aran_stats_reset:
+ * @stats: an #AranStats.
+ *
+ * Sets all @stats counts and times to zero.
+ */
+void aran_stats_reset (AranStats *stats)
+{
+  guint i;
+
+  g_return_if_fail (stats != NULL);
+
+  memset (stats->wall, 0, sizeof (stats->wall));
+  memset (stats->cpu, 0, sizeof (stats->cpu));
+
+  for (i=0; i<stats->nblocks; i++)
+    _block_reset (stats->blocks[i]);
+}
+
+/**
+ * aran_stats_reserve_blocks:
+ * @stats: an #AranStats.
+ * @nblocks: number of accumulation blocks.
+ *
+ * Ensures @stats has at least @nblocks accumulation blocks, ie. one per
+ * thread taking part to a solve. Must be called before entering any
+ * parallel region.
+ */
+void aran_stats_reserve_blocks (AranStats *stats, guint nblocks)
+{
+  guint i;
+
+  g_return_if_fail (stats != NULL);
+
+  if (nblocks <= stats->nblocks) return;
+
+  stats->blocks = g_realloc (stats->blocks, nblocks * sizeof (AranStatsBlock *));
+
+  for (i=stats->nblocks; i<nblocks; i++)
+    stats->blocks[i] = _block_new ();
+
+  stats->nblocks = nblocks;
+}
+
+/**
+ * aran_stats_get_block:
+ * @stats: an #AranStats.
+ * @thread: thread index.
+ *
+ * Returns the accumulation block of thread @thread. @thread must be lower
+ * than the number of blocks reserved with aran_stats_reserve_blocks().
+ *
+ * Returns: an #AranStatsBlock.
+ */
+AranStatsBlock *aran_stats_get_block (AranStats *stats, guint thread)
+{
+  g_return_val_if_fail (stats != NULL, NULL);
+  g_return_val_if_fail (thread < stats->nblocks, NULL);
+
+  return stats->blocks[thread];
+}
+
+/**
+ * aran_stats_block_get_level:
+ * @block: an #AranStatsBlock.
+ * @depth: tree depth.
+ *
+ * Returns @block statistics for level @depth, enlarging @block levels
+ * storage if needed.
+ *
+ * Returns: an #AranStatsLevel.
+ */
+AranStatsLevel *aran_stats_block_get_level (AranStatsBlock *block,
+                                            guint depth)
+{
+  g_return_val_if_fail (block != NULL, NULL);
+
+  if (depth >= block->nlevels)
+    {
+      guint nlevels = MAX (depth + 1, 2 * block->nlevels);
+
+      block->levels = g_realloc (block->levels,
+                                 nlevels * sizeof (AranStatsLevel));
+
+      memset (block->levels + block->nlevels, 0,
+              (nlevels - block->nlevels) * sizeof (AranStatsLevel));
+
+      block->nlevels = nlevels;
+    }
+
+  return &block->levels[depth];
+}
+
+/**
+ * aran_stats_phase_begin:
+ * @stats: an #AranStats.
+ * @phase: an #AranStatsPhase.
+ *
+ * Starts timing @phase.
+ */
+void aran_stats_phase_begin (AranStats *stats, AranStatsPhase phase)
+{
+  g_return_if_fail (stats != NULL);
+  g_return_if_fail (phase < ARAN_STATS_PHASE_COUNT);
+
+  stats->wall_start[phase] = g_timer_elapsed (stats->timer, NULL);
+  stats->cpu_start[phase] = clock ();
+}
+
+/**
+ * aran_stats_phase_end:
+ * @stats: an #AranStats.
+ * @phase: an #AranStatsPhase.
+ *
+ * Stops timing @phase and accumulates the elapsed wall clock and CPU
+ * times since last call to aran_stats_phase_begin().
+ */
+void aran_stats_phase_end (AranStats *stats, AranStatsPhase phase)
+{
+  g_return_if_fail (stats != NULL);
+  g_return_if_fail (phase < ARAN_STATS_PHASE_COUNT);
+
+  stats->wall[phase] +=
+    g_timer_elapsed (stats->timer, NULL) - stats->wall_start[phase];
+  stats->cpu[phase] +=
+    (gdouble) (clock () - stats->cpu_start[phase]) / CLOCKS_PER_SEC;
+}
+
+/**
+ * aran_stats_get_phase:
+ * @stats: an #AranStats.
+ * @phase: an #AranStatsPhase.
+ * @wall: wall clock time result.
+ * @cpu: process CPU time result.
+ *
+ * Retrieves @phase cumulative times, in seconds.
+ */
+void aran_stats_get_phase (AranStats *stats, AranStatsPhase phase,
+                           gdouble *wall, gdouble *cpu)
+{
+  g_return_if_fail (stats != NULL);
+  g_return_if_fail (phase < ARAN_STATS_PHASE_COUNT);
+
+  if (wall != NULL) *wall = stats->wall[phase];
+  if (cpu != NULL) *cpu = stats->cpu[phase];
+}
+
+/**
+ * aran_stats_get_operator:
+ * @stats: an #AranStats.
+ * @op: an #AranStatsOperator.
+ * @count: call count result.
+ * @time: cumulative wall clock time result.
+ *
+ * Retrieves @op statistics, summed over all accumulation blocks.
+ */
+void aran_stats_get_operator (AranStats *stats, AranStatsOperator op,
+                              glong *count, gdouble *time)
+{
+  glong c = 0;
+  gdouble t = 0.;
+  guint i;
+
+  g_return_if_fail (stats != NULL);
+  g_return_if_fail (op < ARAN_STATS_OPERATOR_COUNT);
+
+  for (i=0; i<stats->nblocks; i++)
+    {
+      c += stats->blocks[i]->count[op];
+      t += stats->blocks[i]->time[op];
+    }
+
+  if (count != NULL) *count = c;
+  if (time != NULL) *time = t;
+}
+
+/**
+ * aran_stats_get_depth:
+ * @stats: an #AranStats.
+ *
+ * Inquiry of the number of levels recorded in @stats.
+ *
+ * Returns: number of levels.
+ */
+guint aran_stats_get_depth (AranStats *stats)
+{
+  guint depth = 0;
+  guint i;
+
+  g_return_val_if_fail (stats != NULL, 0);
+
+  for (i=0; i<stats->nblocks; i++)
+    {
+      AranStatsBlock *block = stats->blocks[i];
+      guint d = block->nlevels;
+
+      /* trim empty levels */
+      while (d > depth)
+        {
+          AranStatsLevel *level = &block->levels[d-1];
+          guint op;
+
+          for (op=0; op<ARAN_STATS_OPERATOR_COUNT; op++)
+            if (level->count[op] != 0) break;
+
+          if (op < ARAN_STATS_OPERATOR_COUNT) break;
+
+          d --;
+        }
+
+      depth = MAX (depth, d);
+    }
+
+  return depth;
+}
+
+/**
+ * aran_stats_get_level_operator:
+ * @stats: an #AranStats.
+ * @depth: tree depth.
+ * @op: an #AranStatsOperator.
+ * @count: call count result.
+ * @time: cumulative wall clock time result.
+ *
+ * Retrieves @op statistics at level @depth, summed over all accumulation
+ * blocks.
+ */
+void aran_stats_get_level_operator (AranStats *stats, guint depth,
+                                    AranStatsOperator op,
+                                    glong *count, gdouble *time)
+{
+  glong c = 0;
+  gdouble t = 0.;
+  guint i;
+
+  g_return_if_fail (stats != NULL);
+  g_return_if_fail (op < ARAN_STATS_OPERATOR_COUNT);
+
+  for (i=0; i<stats->nblocks; i++)
+    {
+      AranStatsBlock *block = stats->blocks[i];
+
+      if (depth < block->nlevels)
+        {
+          c += block->levels[depth].count[op];
+          t += block->levels[depth].time[op];
+        }
+    }
+
+  if (count != NULL) *count = c;
+  if (time != NULL) *time = t;
+}
+
+/**
+ * aran_stats_phase_name:
+ * @phase: an #AranStatsPhase.
+ *
+ * Returns: @phase name.
+ */
+const gchar *aran_stats_phase_name (AranStatsPhase phase)
+{
+  g_return_val_if_fail (phase < ARAN_STATS_PHASE_COUNT, NULL);
+
+  return _phase_names[phase];
+}
+
+/**
+ * aran_stats_operator_name:
+ * @op: an #AranStatsOperator.
+ *
+ * Returns: @op name.
+ */
+const gchar *aran_stats_operator_name (AranStatsOperator op)
+{
+  g_return_val_if_fail (op < ARAN_STATS_OPERATOR_COUNT, NULL);
+
+  return _operator_names[op];
+}
+
+static void _write_json_operators (FILE *file, const glong *count,
+                                   const gdouble *time, const gchar *indent)
+{
+  guint op;
+
+  for (op=0; op<ARAN_STATS_OPERATOR_COUNT; op++)
+    {
+      fprintf (file, "%s\"%s\": {\"count\": %ld, \"time\": %.9g}%s\n",
+               indent, _operator_names[op], count[op], time[op],
+               (op+1 < ARAN_STATS_OPERATOR_COUNT) ? "," : "");
+    }
+}
+
+/**
+ * aran_stats_write_json:
+ * @stats: an #AranStats.
+ * @file: output file.
+ *
+ * Writes @stats to @file as a JSON object with "phases", "operators" and
+ * "levels" members.
+ */
+void aran_stats_write_json (AranStats *stats, FILE *file)
+{
+  glong count[ARAN_STATS_OPERATOR_COUNT];
+  gdouble time[ARAN_STATS_OPERATOR_COUNT];
+  guint depth;
+  guint i, op;
+
+  g_return_if_fail (stats != NULL);
+  g_return_if_fail (file != NULL);
+
+  fprintf (file, "{\n  \"phases\": {\n");
+
+  for (i=0; i<ARAN_STATS_PHASE_COUNT; i++)
+    {
+      fprintf (file, "    \"%s\": {\"wall\": %.9g, \"cpu\": %.9g}%s\n",
+               _phase_names[i], stats->wall[i], stats->cpu[i],
+               (i+1 < ARAN_STATS_PHASE_COUNT) ? "," : "");
+    }
+
+  fprintf (file, "  },\n  \"operators\": {\n");
+
+  for (op=0; op<ARAN_STATS_OPERATOR_COUNT; op++)
+    aran_stats_get_operator (stats, op, &count[op], &time[op]);
+
+  _write_json_operators (file, count, time, "    ");
+
+  fprintf (file, "  },\n  \"levels\": [\n");
+
+  depth = aran_stats_get_depth (stats);
+
+  for (i=0; i<depth; i++)
+    {
+      for (op=0; op<ARAN_STATS_OPERATOR_COUNT; op++)
+        aran_stats_get_level_operator (stats, i, op, &count[op], &time[op]);
+
+      fprintf (file, "    {\n");
+      _write_json_operators (file, count, time, "      ");
+      fprintf (file, "    }%s\n", (i+1 < depth) ? "," : "");
+    }
+
+  fprintf (file, "  ]\n}\n");
+}
@@ -0,0 +1,147 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __ARAN_STATS_H__
+#define __ARAN_STATS_H__
+
+#include <stdio.h>
+
+#include <glib.h>
+
+G_BEGIN_DECLS;
+
+/* enums */
+typedef enum _AranStatsPhase AranStatsPhase;
+
+enum _AranStatsPhase {
+  ARAN_STATS_PHASE_CLEAR,
+  ARAN_STATS_PHASE_UP,
+  ARAN_STATS_PHASE_NEAR_FAR,
+  ARAN_STATS_PHASE_DOWN,
+  ARAN_STATS_PHASE_COUNT,
+};
+
+typedef enum _AranStatsOperator AranStatsOperator;
+
+enum _AranStatsOperator {
+  ARAN_STATS_ZERO,
+  ARAN_STATS_P2P,
+  ARAN_STATS_P2M,
+  ARAN_STATS_M2M,
+  ARAN_STATS_M2L,
+  ARAN_STATS_L2L,
+  ARAN_STATS_L2P,
+  ARAN_STATS_P2L,
+  ARAN_STATS_M2P,
+  ARAN_STATS_P2P_REMOTE,
+  ARAN_STATS_M2L_REMOTE,
+  ARAN_STATS_OPERATOR_COUNT,
+};
+
+/* typedefs */
+typedef struct _AranStatsLevel AranStatsLevel;
+typedef struct _AranStatsBlock AranStatsBlock;
+typedef struct _AranStats AranStats;
+
+struct _AranStatsLevel
+{
+  glong count[ARAN_STATS_OPERATOR_COUNT];
+  gdouble time[ARAN_STATS_OPERATOR_COUNT];
+};
+
+struct _AranStatsBlock
+{
+  glong count[ARAN_STATS_OPERATOR_COUNT];
+  gdouble time[ARAN_STATS_OPERATOR_COUNT];
+
+  guint nlevels;
+  AranStatsLevel *levels;
+
+  GTimer *timer;
+};
+
+/* functions */
+AranStats *aran_stats_new ();
+
+void aran_stats_free (AranStats *stats);
+
+void aran_stats_reset (AranStats *stats);
+
+void aran_stats_reserve_blocks (AranStats *stats, guint nblocks);
+
+AranStatsBlock *aran_stats_get_block (AranStats *stats, guint thread);
+
+AranStatsLevel *aran_stats_block_get_level (AranStatsBlock *block,
+                                            guint depth);
+
+void aran_stats_phase_begin (AranStats *stats, AranStatsPhase phase);
+
+void aran_stats_phase_end (AranStats *stats, AranStatsPhase phase);
+
+void aran_stats_get_phase (AranStats *stats, AranStatsPhase phase,
+                           gdouble *wall, gdouble *cpu);
+
+void aran_stats_get_operator (AranStats *stats, AranStatsOperator op,
+                              glong *count, gdouble *time);
+
+guint aran_stats_get_depth (AranStats *stats);
+
+void aran_stats_get_level_operator (AranStats *stats, guint depth,
+                                    AranStatsOperator op,
+                                    glong *count, gdouble *time);
+
+const gchar *aran_stats_phase_name (AranStatsPhase phase);
+
+const gchar *aran_stats_operator_name (AranStatsOperator op);
+
+void aran_stats_write_json (AranStats *stats, FILE *file);
+
+/* inline accumulation */
+
+/**
+ * ARAN_STATS_BLOCK_TIME:
+ * @block: an #AranStatsBlock.
+ *
+ * Reads @block wall clock.
+ */
+#define ARAN_STATS_BLOCK_TIME(block) (g_timer_elapsed ((block)->timer, NULL))
+
+/**
+ * ARAN_STATS_BLOCK_ADD:
+ * @block: an #AranStatsBlock.
+ * @op: an #AranStatsOperator.
+ * @depth: tree depth where @op was applied.
+ * @n: number of @op calls.
+ * @t: time spent in @op calls.
+ *
+ * Accumulates @n calls of @op taking @t seconds at level @depth of @block.
+ */
+#define ARAN_STATS_BLOCK_ADD(block, op, depth, n, t) G_STMT_START {     \
+    AranStatsLevel *_level = ((depth) < (block)->nlevels) ?             \
+      &(block)->levels[depth] :                                         \
+      aran_stats_block_get_level ((block), (depth));                    \
+    (block)->count[op] += (n);                                          \
+    (block)->time[op] += (t);                                           \
+    _level->count[op] += (n);                                           \
+    _level->time[op] += (t);                                            \
+  } G_STMT_END
+
+G_END_DECLS;
+
+#endif /* __ARAN_STATS_H__ */
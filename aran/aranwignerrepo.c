@@ -30,6 +30,9 @@
 static GTree *repo = NULL;
 static gdouble epsilon = 1.e-3;
 
+/* solvers threads share the repository */
+G_LOCK_DEFINE_STATIC (repo);
+
 static gint _angle_compare (gdouble *a, gdouble *b)
 {
   gdouble adiff = a[0]-b[0];
@@ -43,19 +46,7 @@ static gint _angle_compare (gdouble *a, gdouble *b)
 }
 
 
-/**
- * aran_wigner_repo_lookup:
- * @alpha: an angle in radians.
- * @beta: an angle in radians.
- * @gamma: an angle in radians.
- *
- * Looks for corresponding #AranWigner structure in the repository. Creates
- * it if necessary.
- *
- * Returns: the #AranWigner corresponding to a rotation of angle @beta.
- */
-AranWigner *aran_wigner_repo_lookup (gdouble alpha, gdouble beta,
-                                     gdouble gamma)
+static AranWigner *_repo_lookup (gdouble alpha, gdouble beta, gdouble gamma)
 {
   AranWigner *ret;
   gdouble abg[3] = {alpha, beta, gamma};
@@ -81,6 +72,56 @@ AranWigner *aran_wigner_repo_lookup (gdouble alpha, gdouble beta,
   return ret;
 }
 
+/**
+ * aran_wigner_repo_lookup:
+ * @alpha: an angle in radians.
+ * @beta: an angle in radians.
+ * @gamma: an angle in radians.
+ *
+ * Looks for corresponding #AranWigner structure in the repository. Creates
+ * it if necessary.
+ *
+ * Returns: the #AranWigner corresponding to a rotation of angle @beta.
+ */
+AranWigner *aran_wigner_repo_lookup (gdouble alpha, gdouble beta,
+                                     gdouble gamma)
+{
+  AranWigner *ret;
+
+  G_LOCK (repo);
+  ret = _repo_lookup (alpha, beta, gamma);
+  G_UNLOCK (repo);
+
+  return ret;
+}
+
+/**
+ * aran_wigner_repo_lookup_require:
+ * @alpha: an angle in radians.
+ * @beta: an angle in radians.
+ * @gamma: an angle in radians.
+ * @lmax: required degree.
+ *
+ * Looks for corresponding #AranWigner structure in the repository and makes
+ * sure it holds coefficients up to degree @lmax. Unlike
+ * aran_wigner_repo_lookup() followed by aran_wigner_require(), this can be
+ * called by several threads at once.
+ *
+ * Returns: the #AranWigner corresponding to a rotation of angle @beta.
+ */
+AranWigner *aran_wigner_repo_lookup_require (gdouble alpha, gdouble beta,
+                                             gdouble gamma, guint lmax)
+{
+  AranWigner *ret;
+
+  G_LOCK (repo);
+  ret = _repo_lookup (alpha, beta, gamma);
+  aran_wigner_require (ret, lmax);
+  G_UNLOCK (repo);
+
+  return ret;
+}
+
 /**
  * aran_wigner_repo_steal:
  * @alpha: an angle in radians.
@@ -98,9 +139,11 @@ AranWigner *aran_wigner_repo_steal (gdouble alpha, gdouble beta,
 
   g_return_val_if_fail (repo != NULL, NULL);
 
-  ret = aran_wigner_repo_lookup (alpha, beta, gamma);
+  G_LOCK (repo);
+  ret = _repo_lookup (alpha, beta, gamma);
 
   g_tree_steal (repo, &beta);
+  G_UNLOCK (repo);
 
   return ret;
 }
@@ -121,7 +164,9 @@ void aran_wigner_repo_forget (gdouble alpha, gdouble beta,
 
   g_return_if_fail (repo != NULL);
 
+  G_LOCK (repo);
   g_tree_remove (repo, abg);
+  G_UNLOCK (repo);
 }
 
 /**
@@ -132,10 +177,12 @@ void aran_wigner_repo_forget (gdouble alpha, gdouble beta,
  */
 void aran_wigner_repo_forget_all ()
 {
+  G_LOCK (repo);
   if (repo != NULL)
     {
       g_tree_destroy (repo);
       repo = NULL;
-    }  
+    }
+  G_UNLOCK (repo);
 }
 
@@ -26,6 +26,8 @@
 
 AranWigner *aran_wigner_repo_lookup (gdouble alpha, gdouble beta,
                                      gdouble gamma);
+AranWigner *aran_wigner_repo_lookup_require (gdouble alpha, gdouble beta,
+                                             gdouble gamma, guint lmax);
 AranWigner *aran_wigner_repo_steal (gdouble alpha, gdouble beta,
                                     gdouble gamma);
 void aran_wigner_repo_forget (gdouble alpha, gdouble beta,
@@ -0,0 +1,44 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __ARAN_WORKERS_PRIVATE_H__
+#define __ARAN_WORKERS_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS;
+
+/* pool of threads sharing the items of an array, for solvers local passes */
+typedef struct _AranWorkers AranWorkers;
+
+typedef void (*AranWorkerFunc) (gpointer item, guint worker,
+                                gpointer user_data);
+
+AranWorkers *aran_workers_new (guint count);
+
+guint aran_workers_count (AranWorkers *workers);
+
+void aran_workers_foreach (AranWorkers *workers, GPtrArray *items,
+                           AranWorkerFunc func, gpointer user_data);
+
+void aran_workers_free (AranWorkers *workers);
+
+G_END_DECLS;
+
+#endif /* __ARAN_WORKERS_PRIVATE_H__ */
@@ -0,0 +1,132 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "aran-config.h"
+
+#include "aranworkers-private.h"
+
+/*
+ * The calling thread is worker 0 and takes part to every foreach. Other
+ * workers live in a GThreadPool and never call MPI, so that solvers only
+ * need MPI_THREAD_FUNNELED support. Items are handed out one at a time
+ * through an atomic counter.
+ */
+
+struct _AranWorkers
+{
+  guint count;
+
+  GThreadPool *pool;
+  GAsyncQueue *done;
+
+  GPtrArray *items;
+  AranWorkerFunc func;
+  gpointer user_data;
+  volatile gint next;
+};
+
+static void _workers_run (AranWorkers *workers, guint worker)
+{
+  gint i;
+
+  while ((i = g_atomic_int_exchange_and_add (&workers->next, 1)) <
+         (gint) workers->items->len)
+    workers->func (g_ptr_array_index (workers->items, i), worker,
+                   workers->user_data);
+}
+
+static void _pool_func (gpointer data, AranWorkers *workers)
+{
+  _workers_run (workers, GPOINTER_TO_UINT (data));
+
+  g_async_queue_push (workers->done, data);
+}
+
+AranWorkers *aran_workers_new (guint count)
+{
+  AranWorkers *workers = g_malloc (sizeof (AranWorkers));
+
+  workers->count = MAX (count, 1);
+
+  workers->pool = NULL;
+  workers->done = NULL;
+
+  if (workers->count > 1)
+    {
+#if !GLIB_CHECK_VERSION (2, 32, 0)
+      if (! g_thread_supported ()) g_thread_init (NULL);
+#endif
+
+      workers->pool = g_thread_pool_new ((GFunc) _pool_func, workers,
+                                         workers->count - 1, TRUE, NULL);
+      workers->done = g_async_queue_new ();
+    }
+
+  workers->items = NULL;
+  workers->func = NULL;
+  workers->user_data = NULL;
+  workers->next = 0;
+
+  return workers;
+}
+
+guint aran_workers_count (AranWorkers *workers)
+{
+  return workers->count;
+}
+
+/* calls @func on every element of @items. */
+void aran_workers_foreach (AranWorkers *workers, GPtrArray *items,
+                           AranWorkerFunc func, gpointer user_data)
+{
+  guint i, helpers;
+
+  if (items->len == 0) return;
+
+  workers->items = items;
+  workers->func = func;
+  workers->user_data = user_data;
+  workers->next = 0;
+
+  helpers = MIN (workers->count, items->len) - 1;
+
+  /* pushing to the pool publishes the job to the helpers */
+  for (i=0; i<helpers; i ++)
+    g_thread_pool_push (workers->pool, GUINT_TO_POINTER (i+1), NULL);
+
+  _workers_run (workers, 0);
+
+  for (i=0; i<helpers; i ++)
+    g_async_queue_pop (workers->done);
+
+  workers->items = NULL;
+  workers->func = NULL;
+  workers->user_data = NULL;
+}
+
+void aran_workers_free (AranWorkers *workers)
+{
+  if (workers->pool != NULL)
+    {
+      g_thread_pool_free (workers->pool, FALSE, TRUE);
+      g_async_queue_unref (workers->done);
+    }
+
+  g_free (workers);
+}
@@ -0,0 +1,243 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "aran-config.h"
+
+#include <stdlib.h>
+
+#include <complex.h>
+
+#include <math.h>
+
+#include "aran/aran.h"
+#include "aran/arandevelopment3d.h"
+#include "aran/aranblockdevelopment3d.h"
+
+#define BLOCK_SIZE 3
+
+static gdouble epsilon = 1.E-10;
+static guint order = 10;
+
+void parse_args (int argc, char **argv)
+{
+  int iarg = 1;
+  char *arg;
+
+  while (iarg < argc)
+    {
+      arg = argv[iarg];
+
+      if (g_ascii_strcasecmp (arg, "-pr") == 0)
+	{
+	  guint tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (sscanf (arg, "%u", &tmp) == 1 && tmp > 0)
+	      order = tmp;
+	  else
+	    g_printerr ("Invalid precision order value (-pr %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-err") == 0)
+	{
+	  gdouble tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (sscanf (arg, "%lf", &tmp) == 1 && tmp > 0.)
+	      epsilon = tmp;
+	  else
+	    g_printerr ("Invalid error limit value (-err %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "--version") == 0)
+	{
+	  g_printerr ("%s version %s\n", argv[0], PACKAGE_VERSION);
+	  exit (0);
+	}
+      else
+	{
+	  g_printerr ("Invalid argument \"%s\"\n", arg);
+	}
+
+      iarg ++;
+    }
+}
+
+VsgVector3d sources[] = {
+  {0.1, 0.2, 0.15},
+  {0.3, 0.05, 0.4},
+  {0.45, 0.35, 0.2},
+};
+
+gdouble charges[][BLOCK_SIZE] = {
+  {1., 0., -0.5},
+  {0.5, 1., 0.25},
+  {-0.3, 2., 1.},
+};
+
+/* leaf, father, far father, far leaf */
+VsgPRTree3dNodeInfo nodes[] = {
+  {.center = {0.25, 0.25, 0.25},},
+  {.center = {0.5, 0.5, 0.5},},
+  {.center = {-1.5, 0.5, 0.5},},
+  {.center = {-1.25, 0.75, 0.25},},
+};
+
+/* same configuration with a vertical M2L */
+VsgPRTree3dNodeInfo vnodes[] = {
+  {.center = {0.25, 0.25, 0.25},},
+  {.center = {0.5, 0.5, 0.5},},
+  {.center = {0.5, 0.5, 2.5},},
+  {.center = {0.25, 0.75, 2.25},},
+};
+
+static gint check_value (const gchar *msg, gcomplex128 ref, gcomplex128 res)
+{
+  if (cabs (ref-res) > epsilon * MAX (1., cabs (ref)))
+    {
+      g_printerr ("%s error (%e + i%e) (%e + i%e)\n", msg,
+                  creal (ref), cimag (ref), creal (res), cimag (res));
+      return 1;
+    }
+
+  return 0;
+}
+
+static gint check_vector (const gchar *msg, VsgVector3d *ref,
+                          VsgVector3d *res)
+{
+  gdouble dist = vsg_vector3d_dist (ref, res);
+
+  if (dist > epsilon * MAX (1., vsg_vector3d_norm (ref)))
+    {
+      g_printerr ("%s gradient error (%e %e %e) (%e %e %e)\n", msg,
+                  ref->x, ref->y, ref->z, res->x, res->y, res->z);
+      return 1;
+    }
+
+  return 0;
+}
+
+static gint check_chain (VsgPRTree3dNodeInfo *n, VsgVector3d *target)
+{
+  AranDevelopment3d *devs[4][BLOCK_SIZE];
+  AranBlockDevelopment3d *blocks[4];
+  gcomplex128 values[BLOCK_SIZE];
+  VsgVector3d grads[BLOCK_SIZE];
+  VsgVector3d mtarget = {0.8, 1.2, 0.9};
+  gint ret = 0;
+  gint i, j, k;
+
+  for (i=0; i<4; i++)
+    {
+      blocks[i] = aran_block_development3d_new (order, order, BLOCK_SIZE);
+      aran_block_development3d_set_zero (blocks[i]);
+
+      for (k=0; k<BLOCK_SIZE; k++)
+        {
+          devs[i][k] = aran_development3d_new (order, order);
+          aran_development3d_set_zero (devs[i][k]);
+        }
+    }
+
+  for (j=0; j<G_N_ELEMENTS (sources); j++)
+    {
+      aran_block_development3d_p2m (&sources[j], charges[j], &n[0],
+                                    blocks[0]);
+      aran_block_development3d_p2l (&sources[j], charges[j], &n[3],
+                                    blocks[3]);
+
+      for (k=0; k<BLOCK_SIZE; k++)
+        {
+          aran_development3d_p2m (&sources[j], charges[j][k], &n[0],
+                                  devs[0][k]);
+          aran_development3d_p2l (&sources[j], charges[j][k], &n[3],
+                                  devs[3][k]);
+        }
+    }
+
+  aran_block_development3d_m2m (&n[0], blocks[0], &n[1], blocks[1]);
+  aran_block_development3d_m2l (&n[1], blocks[1], &n[2], blocks[2]);
+  aran_block_development3d_l2l (&n[2], blocks[2], &n[3], blocks[3]);
+
+  for (k=0; k<BLOCK_SIZE; k++)
+    {
+      aran_development3d_m2m (&n[0], devs[0][k], &n[1], devs[1][k]);
+      aran_development3d_m2l (&n[1], devs[1][k], &n[2], devs[2][k]);
+      aran_development3d_l2l (&n[2], devs[2][k], &n[3], devs[3][k]);
+    }
+
+  aran_block_development3d_m2p (&n[1], blocks[1], &mtarget, values);
+  for (k=0; k<BLOCK_SIZE; k++)
+    ret += check_value ("M2P",
+                        aran_development3d_m2p (&n[1], devs[1][k], &mtarget),
+                        values[k]);
+
+  aran_block_development3d_l2p (&n[3], blocks[3], target, values);
+  for (k=0; k<BLOCK_SIZE; k++)
+    ret += check_value ("L2P",
+                        aran_development3d_l2p (&n[3], devs[3][k], target),
+                        values[k]);
+
+  aran_block_development3d_m2pv (&n[1], blocks[1], &mtarget, grads);
+  for (k=0; k<BLOCK_SIZE; k++)
+    {
+      VsgVector3d ref;
+
+      aran_development3d_m2pv (&n[1], devs[1][k], &mtarget, &ref);
+      ret += check_vector ("M2PV", &ref, &grads[k]);
+    }
+
+  aran_block_development3d_l2pv (&n[3], blocks[3], target, grads);
+  for (k=0; k<BLOCK_SIZE; k++)
+    {
+      VsgVector3d ref;
+
+      aran_development3d_l2pv (&n[3], devs[3][k], target, &ref);
+      ret += check_vector ("L2PV", &ref, &grads[k]);
+    }
+
+  for (i=0; i<4; i++)
+    {
+      aran_block_development3d_free (blocks[i]);
+
+      for (k=0; k<BLOCK_SIZE; k++)
+        aran_development3d_free (devs[i][k]);
+    }
+
+  return ret;
+}
+
+int main (int argc, char **argv)
+{
+  VsgVector3d target = {-1.3, 0.8, 0.3};
+  VsgVector3d vtarget = {0.3, 0.8, 2.3};
+  int ret = 0;
+
+  aran_init();
+
+  parse_args (argc, argv);
+
+  ret += check_chain (nodes, &target);
+  ret += check_chain (vnodes, &vtarget);
+
+  return ret;
+}
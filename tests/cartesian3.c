@@ -0,0 +1,267 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "aran-config.h"
+
+#include <stdlib.h>
+
+#include <math.h>
+
+#include "aran/aran.h"
+#include "aran/arancartesiandevelopment3d.h"
+
+static gdouble epsilon = 1.E-2;
+static guint order = 4;
+
+void parse_args (int argc, char **argv)
+{
+  int iarg = 1;
+  char *arg;
+
+  while (iarg < argc)
+    {
+      arg = argv[iarg];
+
+      if (g_ascii_strcasecmp (arg, "-pr") == 0)
+	{
+	  guint tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (sscanf (arg, "%u", &tmp) == 1 &&
+              tmp <= ARAN_CARTESIAN_DEVELOPMENT3D_MAX_ORDER)
+	      order = tmp;
+	  else
+	    g_printerr ("Invalid precision order value (-pr %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-err") == 0)
+	{
+	  gdouble tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (sscanf (arg, "%lf", &tmp) == 1 && tmp > 0.)
+	      epsilon = tmp;
+	  else
+	    g_printerr ("Invalid error limit value (-err %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "--version") == 0)
+	{
+	  g_printerr ("%s version %s\n", argv[0], PACKAGE_VERSION);
+	  exit (0);
+	}
+      else
+	{
+	  g_printerr ("Invalid argument \"%s\"\n", arg);
+	}
+
+      iarg ++;
+    }
+}
+
+VsgVector3d sources[] = {
+  {0.1, 0.2, 0.15},
+  {0.3, 0.05, 0.4},
+  {0.45, 0.35, 0.2},
+  {0.2, 0.4, 0.05},
+};
+
+gdouble charges[] = {1., 0.5, 0.3, 0.8};
+
+/* leaf, father, far father, far leaf */
+VsgPRTree3dNodeInfo nodes[] = {
+  {.center = {0.25, 0.25, 0.25},},
+  {.center = {0.5, 0.5, 0.5},},
+  {.center = {-1.5, 0.5, 0.5},},
+  {.center = {-1.25, 0.75, 0.25},},
+};
+
+static void direct (VsgVector3d *target, gdouble *pot, VsgVector3d *grad)
+{
+  gint j;
+
+  *pot = 0.;
+  vsg_vector3d_set (grad, 0., 0., 0.);
+
+  for (j=0; j<G_N_ELEMENTS (sources); j++)
+    {
+      VsgVector3d tmp;
+      gdouble r;
+
+      vsg_vector3d_sub (target, &sources[j], &tmp);
+      r = vsg_vector3d_norm (&tmp);
+
+      *pot += charges[j] / r;
+
+      vsg_vector3d_scalp (&tmp, - charges[j] / (r*r*r), &tmp);
+      vsg_vector3d_add (grad, &tmp, grad);
+    }
+}
+
+static gint check_value (const gchar *msg, gdouble ref, gdouble res,
+                         gdouble eps)
+{
+  if (fabs (ref-res) > eps * MAX (1., fabs (ref)))
+    {
+      g_printerr ("%s error %e %e\n", msg, ref, res);
+      return 1;
+    }
+
+  return 0;
+}
+
+static gint check_vector (const gchar *msg, VsgVector3d *ref,
+                          VsgVector3d *res, gdouble eps)
+{
+  gdouble dist = vsg_vector3d_dist (ref, res);
+
+  if (dist > eps * MAX (1., vsg_vector3d_norm (ref)))
+    {
+      g_printerr ("%s gradient error (%e %e %e) (%e %e %e)\n", msg,
+                  ref->x, ref->y, ref->z, res->x, res->y, res->z);
+      return 1;
+    }
+
+  return 0;
+}
+
+static gint check_chain (VsgPRTree3dNodeInfo *n, VsgVector3d *targets,
+                         guint ntargets)
+{
+  AranCartesianDevelopment3d *devs[4];
+  AranCartesianDevelopment3d *multiple;
+  VsgVector3d mtarget = {0.8, 1.2, 2.9};
+  gdouble x[G_N_ELEMENTS (sources)], y[G_N_ELEMENTS (sources)];
+  gdouble z[G_N_ELEMENTS (sources)];
+  gdouble tx[ntargets], ty[ntargets], tz[ntargets];
+  gdouble pots[ntargets], gx[ntargets], gy[ntargets], gz[ntargets];
+  gdouble pot, ref;
+  VsgVector3d grad, vref;
+  gint ret = 0;
+  gint i, j;
+
+  for (i=0; i<4; i++)
+    devs[i] = aran_cartesian_development3d_new (order);
+
+  multiple = aran_cartesian_development3d_new (order);
+
+  for (j=0; j<G_N_ELEMENTS (sources); j++)
+    {
+      aran_cartesian_development3d_p2m (&sources[j], charges[j], &n[0],
+                                        devs[0]);
+
+      x[j] = sources[j].x;
+      y[j] = sources[j].y;
+      z[j] = sources[j].z;
+    }
+
+  /* multiple particles P2M must match its single particle version */
+  aran_cartesian_development3d_p2m_multiple (G_N_ELEMENTS (sources), x, y, z,
+                                             charges, &n[0], multiple);
+
+  for (j=0; j<ARAN_CARTESIAN_DEVELOPMENT3D_SIZE (order); j++)
+    ret += check_value ("P2M multiple", devs[0]->multipole[j],
+                        multiple->multipole[j], 1.e-12);
+
+  aran_cartesian_development3d_m2m (&n[0], devs[0], &n[1], devs[1]);
+  aran_cartesian_development3d_m2l (&n[1], devs[1], &n[2], devs[2]);
+  aran_cartesian_development3d_l2l (&n[2], devs[2], &n[3], devs[3]);
+
+  direct (&mtarget, &ref, &vref);
+
+  pot = aran_cartesian_development3d_m2p (&n[1], devs[1], &mtarget);
+  ret += check_value ("M2P", ref, pot, epsilon);
+
+  /* gradients are one order less accurate than potentials */
+  aran_cartesian_development3d_m2pv (&n[1], devs[1], &mtarget, &grad);
+  ret += check_vector ("M2PV", &vref, &grad, 10. * epsilon);
+
+  for (i=0; i<ntargets; i++)
+    {
+      direct (&targets[i], &ref, &vref);
+
+      pot = aran_cartesian_development3d_l2p (&n[3], devs[3], &targets[i]);
+      ret += check_value ("L2P", ref, pot, epsilon);
+
+      aran_cartesian_development3d_l2pv (&n[3], devs[3], &targets[i], &grad);
+      ret += check_vector ("L2PV", &vref, &grad, 10. * epsilon);
+
+      tx[i] = targets[i].x;
+      ty[i] = targets[i].y;
+      tz[i] = targets[i].z;
+      pots[i] = gx[i] = gy[i] = gz[i] = 0.;
+    }
+
+  /* multiple particles L2P must match its single particle version */
+  aran_cartesian_development3d_l2p_multiple (&n[3], devs[3], ntargets,
+                                             tx, ty, tz, pots, gx, gy, gz);
+
+  for (i=0; i<ntargets; i++)
+    {
+      VsgVector3d res = {gx[i], gy[i], gz[i]};
+
+      pot = aran_cartesian_development3d_l2p (&n[3], devs[3], &targets[i]);
+      ret += check_value ("L2P multiple", pot, pots[i], 1.e-12);
+
+      aran_cartesian_development3d_l2pv (&n[3], devs[3], &targets[i], &grad);
+      ret += check_vector ("L2PV multiple", &grad, &res, 1.e-12);
+    }
+
+  /* P2L of the sources must approximate the same values */
+  aran_cartesian_development3d_set_zero (devs[3]);
+
+  for (j=0; j<G_N_ELEMENTS (sources); j++)
+    aran_cartesian_development3d_p2l (&sources[j], charges[j], &n[3],
+                                      devs[3]);
+
+  for (i=0; i<ntargets; i++)
+    {
+      direct (&targets[i], &ref, &vref);
+
+      pot = aran_cartesian_development3d_l2p (&n[3], devs[3], &targets[i]);
+      ret += check_value ("P2L", ref, pot, epsilon);
+    }
+
+  for (i=0; i<4; i++)
+    aran_cartesian_development3d_free (devs[i]);
+
+  aran_cartesian_development3d_free (multiple);
+
+  return ret;
+}
+
+int main (int argc, char **argv)
+{
+  VsgVector3d targets[] = {
+    {-1.3, 0.8, 0.3},
+    {-1.1, 0.6, 0.1},
+    {-1.45, 0.95, 0.45},
+  };
+  int ret = 0;
+
+  aran_init();
+
+  parse_args (argc, argv);
+
+  ret += check_chain (nodes, targets, G_N_ELEMENTS (targets));
+
+  return ret;
+}
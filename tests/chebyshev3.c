@@ -0,0 +1,296 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "aran-config.h"
+
+#include <stdlib.h>
+
+#include <math.h>
+
+#include "aran/aran.h"
+#include "aran/aranchebyshevdevelopment3d.h"
+
+static gdouble epsilon = 1.E-4;
+static guint order = 6;
+
+void parse_args (int argc, char **argv)
+{
+  int iarg = 1;
+  char *arg;
+
+  while (iarg < argc)
+    {
+      arg = argv[iarg];
+
+      if (g_ascii_strcasecmp (arg, "-pr") == 0)
+	{
+	  guint tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (sscanf (arg, "%u", &tmp) == 1 && tmp >= 2)
+	      order = tmp;
+	  else
+	    g_printerr ("Invalid precision order value (-pr %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-err") == 0)
+	{
+	  gdouble tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (sscanf (arg, "%lf", &tmp) == 1 && tmp > 0.)
+	      epsilon = tmp;
+	  else
+	    g_printerr ("Invalid error limit value (-err %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "--version") == 0)
+	{
+	  g_printerr ("%s version %s\n", argv[0], PACKAGE_VERSION);
+	  exit (0);
+	}
+      else
+	{
+	  g_printerr ("Invalid argument \"%s\"\n", arg);
+	}
+
+      iarg ++;
+    }
+}
+
+/* 1/r */
+static void laplace (const VsgVector3d *target, const VsgVector3d *source,
+                     gdouble *values, gpointer user_data)
+{
+  values[0] = 1. / vsg_vector3d_dist (target, source);
+}
+
+/* exp(-lambda r)/r */
+static void yukawa (const VsgVector3d *target, const VsgVector3d *source,
+                    gdouble *values, gpointer user_data)
+{
+  gdouble lambda = *(gdouble *) user_data;
+  gdouble r = vsg_vector3d_dist (target, source);
+
+  values[0] = exp (- lambda * r) / r;
+}
+
+/* regularized Stokeslet (Cortez) */
+static void stokeslet (const VsgVector3d *target, const VsgVector3d *source,
+                       gdouble *values, gpointer user_data)
+{
+  gdouble eps = *(gdouble *) user_data;
+  VsgVector3d d;
+  gdouble x[3], r2, denom;
+  gint i, j;
+
+  vsg_vector3d_sub (target, source, &d);
+
+  x[0] = d.x;
+  x[1] = d.y;
+  x[2] = d.z;
+
+  r2 = x[0]*x[0] + x[1]*x[1] + x[2]*x[2];
+  denom = 1. / pow (r2 + eps*eps, 1.5);
+
+  for (i=0; i<3; i++)
+    for (j=0; j<3; j++)
+      values[i*3 + j] =
+        ((i == j ? r2 + 2.*eps*eps : 0.) + x[i]*x[j]) * denom;
+}
+
+VsgVector3d sources[] = {
+  {0.1, 0.2, 0.15},
+  {0.3, 0.05, 0.4},
+  {0.45, 0.35, 0.2},
+  {0.2, 0.4, 0.05},
+};
+
+/* three components per source, scalar kernels only use the first one */
+gdouble charges[][3] = {
+  {1., 0.2, -0.5},
+  {0.5, -0.7, 0.1},
+  {0.3, 0.4, 0.9},
+  {0.8, -0.1, -0.3},
+};
+
+/* leaf, father, far father, far leaf */
+VsgPRTree3dNodeInfo nodes[] = {
+  {.center = {0.25, 0.25, 0.25}, .lbound = {0., 0., 0.},
+   .ubound = {0.5, 0.5, 0.5},},
+  {.center = {0.5, 0.5, 0.5}, .lbound = {0., 0., 0.},
+   .ubound = {1., 1., 1.},},
+  {.center = {-1.5, 0.5, 0.5}, .lbound = {-2., 0., 0.},
+   .ubound = {-1., 1., 1.},},
+  {.center = {-1.25, 0.75, 0.25}, .lbound = {-1.5, 0.5, 0.},
+   .ubound = {-1., 1., 0.5},},
+};
+
+static void direct (AranChebyshev3d *chebyshev, AranKernelFunc3d func,
+                    gpointer user_data, VsgVector3d *target,
+                    gdouble *result)
+{
+  guint dim = aran_chebyshev3d_get_dim (chebyshev);
+  gdouble values[dim * dim];
+  gint i, a, b;
+
+  for (a=0; a<dim; a++)
+    result[a] = 0.;
+
+  for (i=0; i<G_N_ELEMENTS (sources); i++)
+    {
+      func (target, &sources[i], values, user_data);
+
+      for (a=0; a<dim; a++)
+        for (b=0; b<dim; b++)
+          result[a] += values[a*dim + b] * charges[i][b];
+    }
+}
+
+static gint check_values (const gchar *msg, guint dim, gdouble *ref,
+                          gdouble *res, gdouble eps)
+{
+  gdouble err = 0., norm = 0.;
+  gint a;
+
+  for (a=0; a<dim; a++)
+    {
+      err += (ref[a] - res[a]) * (ref[a] - res[a]);
+      norm += ref[a] * ref[a];
+    }
+
+  if (sqrt (err) > eps * MAX (1., sqrt (norm)))
+    {
+      g_printerr ("%s error %e (", msg, sqrt (err));
+      for (a=0; a<dim; a++)
+        g_printerr (" %e/%e", ref[a], res[a]);
+      g_printerr (" )\n");
+      return 1;
+    }
+
+  return 0;
+}
+
+static gint check_chain (const gchar *name, AranKernelFunc3d func,
+                         guint dim, gpointer user_data,
+                         VsgPRTree3dNodeInfo *n, VsgVector3d *targets,
+                         guint ntargets)
+{
+  AranChebyshev3d *chebyshev =
+    aran_chebyshev3d_new (func, dim, user_data, order, epsilon * 1.e-2);
+  AranChebyshevDevelopment3d *devs[4];
+  VsgVector3d mtarget = {0.8, 1.2, 2.9};
+  gdouble ref[dim], res[dim];
+  gchar *msg;
+  gint ret = 0;
+  gint i, j;
+
+  for (i=0; i<4; i++)
+    devs[i] = aran_chebyshev_development3d_new (chebyshev);
+
+  /* developments keep a reference on their interpolation operators */
+  aran_chebyshev3d_unref (chebyshev);
+
+  for (j=0; j<G_N_ELEMENTS (sources); j++)
+    aran_chebyshev_development3d_p2m (&sources[j], charges[j], &n[0], devs[0]);
+
+  aran_chebyshev_development3d_m2m (&n[0], devs[0], &n[1], devs[1]);
+  aran_chebyshev_development3d_m2l (&n[1], devs[1], &n[2], devs[2]);
+  aran_chebyshev_development3d_l2l (&n[2], devs[2], &n[3], devs[3]);
+
+  direct (chebyshev, func, user_data, &mtarget, ref);
+
+  msg = g_strdup_printf ("%s M2P", name);
+  aran_chebyshev_development3d_m2p (&n[1], devs[1], &mtarget, res);
+  ret += check_values (msg, dim, ref, res, epsilon);
+  g_free (msg);
+
+  for (i=0; i<ntargets; i++)
+    {
+      direct (chebyshev, func, user_data, &targets[i], ref);
+
+      msg = g_strdup_printf ("%s L2P", name);
+      aran_chebyshev_development3d_l2p (&n[3], devs[3], &targets[i], res);
+      ret += check_values (msg, dim, ref, res, epsilon);
+      g_free (msg);
+    }
+
+  /* M2L between different level nodes must approximate the same values */
+  aran_chebyshev_development3d_set_zero (devs[3]);
+
+  aran_chebyshev_development3d_m2l (&n[1], devs[1], &n[3], devs[3]);
+
+  for (i=0; i<ntargets; i++)
+    {
+      direct (chebyshev, func, user_data, &targets[i], ref);
+
+      msg = g_strdup_printf ("%s M2L other level", name);
+      aran_chebyshev_development3d_l2p (&n[3], devs[3], &targets[i], res);
+      ret += check_values (msg, dim, ref, res, epsilon);
+      g_free (msg);
+    }
+
+  /* P2L of the sources must approximate the same values */
+  aran_chebyshev_development3d_set_zero (devs[3]);
+
+  for (j=0; j<G_N_ELEMENTS (sources); j++)
+    aran_chebyshev_development3d_p2l (&sources[j], charges[j], &n[3], devs[3]);
+
+  for (i=0; i<ntargets; i++)
+    {
+      direct (chebyshev, func, user_data, &targets[i], ref);
+
+      msg = g_strdup_printf ("%s P2L", name);
+      aran_chebyshev_development3d_l2p (&n[3], devs[3], &targets[i], res);
+      ret += check_values (msg, dim, ref, res, epsilon);
+      g_free (msg);
+    }
+
+  for (i=0; i<4; i++)
+    aran_chebyshev_development3d_free (devs[i]);
+
+  return ret;
+}
+
+int main (int argc, char **argv)
+{
+  VsgVector3d targets[] = {
+    {-1.3, 0.8, 0.3},
+    {-1.1, 0.6, 0.1},
+    {-1.45, 0.95, 0.45},
+  };
+  gdouble lambda = 2.;
+  gdouble eps = 0.05;
+  int ret = 0;
+
+  aran_init();
+
+  parse_args (argc, argv);
+
+  ret += check_chain ("laplace", laplace, 1, NULL, nodes, targets,
+                      G_N_ELEMENTS (targets));
+  ret += check_chain ("yukawa", yukawa, 1, &lambda, nodes, targets,
+                      G_N_ELEMENTS (targets));
+  ret += check_chain ("stokeslet", stokeslet, 3, &eps, nodes, targets,
+                      G_N_ELEMENTS (targets));
+
+  return ret;
+}
@@ -222,6 +222,8 @@ static guint order = K;
 static gboolean check = TRUE;
 static guint maxbox = 1;
 static guint virtual_maxbox = 0;
+static gboolean scaled = FALSE;
+static gboolean cached = FALSE;
 
 static void (*_distribution) (PointAccum **, AranSolver2d *solver) =
 _one_circle_distribution;
@@ -306,6 +308,14 @@ void parse_args (int argc, char **argv)
 	  else
 	    g_printerr ("Invalid error limit value (-err %s)\n", arg);
 	}
+      else if (g_ascii_strcasecmp (arg, "-scaled") == 0)
+	{
+	  scaled = TRUE;
+	}
+      else if (g_ascii_strcasecmp (arg, "-cached") == 0)
+	{
+	  cached = TRUE;
+	}
       else if (g_ascii_strcasecmp (arg, "-nocheck") == 0)
 	{
 	  check = FALSE;
@@ -433,13 +443,26 @@ int main (int argc, char **argv)
     aran_solver2d_set_nf_isleaf (solver, _nf_isleaf_virtual_maxbox,
                                  &virtual_maxbox);
 
-  aran_solver2d_set_functions (solver,
-			       (AranParticle2ParticleFunc2d) p2p,
-			       (AranParticle2MultipoleFunc2d) p2m,
-			       (AranMultipole2MultipoleFunc2d) aran_development2d_m2m,
-			       (AranMultipole2LocalFunc2d) aran_development2d_m2l,
-			       (AranLocal2LocalFunc2d) aran_development2d_l2l,
-			       (AranLocal2ParticleFunc2d)l2p);
+  if (scaled || cached)
+    aran_solver2d_set_functions (solver,
+                                 (AranParticle2ParticleFunc2d) p2p,
+                                 (AranParticle2MultipoleFunc2d) p2m,
+                                 (AranMultipole2MultipoleFunc2d)
+                                 aran_development2d_m2m_scaled,
+                                 (AranMultipole2LocalFunc2d)
+                                 (cached ? aran_development2d_m2l_cached :
+                                  aran_development2d_m2l_scaled),
+                                 (AranLocal2LocalFunc2d)
+                                 aran_development2d_l2l_scaled,
+                                 (AranLocal2ParticleFunc2d)l2p);
+  else
+    aran_solver2d_set_functions (solver,
+                                 (AranParticle2ParticleFunc2d) p2p,
+                                 (AranParticle2MultipoleFunc2d) p2m,
+                                 (AranMultipole2MultipoleFunc2d) aran_development2d_m2m,
+                                 (AranMultipole2LocalFunc2d) aran_development2d_m2l,
+                                 (AranLocal2LocalFunc2d) aran_development2d_l2l,
+                                 (AranLocal2ParticleFunc2d)l2p);
 
   _distribution (points, solver);
 
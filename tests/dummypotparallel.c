@@ -252,6 +252,13 @@ static guint virtual_maxbox = 0;
 static gboolean _verbose = FALSE;
 static gboolean _hilbert = FALSE;
 static guint semifar_threshold = G_MAXUINT;
+static guint _threads = 1;
+
+#ifdef VSG_HAVE_MPI
+static AranPackCompression _compression = {0., FALSE};
+static gboolean _compress = FALSE;
+static gboolean _migrate_structure = FALSE;
+#endif
 
 static void (*_distribution) (GPtrArray *, AranSolver2d *solver) =
 _one_circle_distribution;
@@ -378,6 +385,44 @@ void parse_args (int argc, char **argv)
 	{
 	  _hilbert = TRUE;
 	}
+#ifdef VSG_HAVE_MPI
+      else if (g_ascii_strcasecmp (arg, "-compress") == 0)
+	{
+	  gdouble tmp = 0.;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (sscanf (arg, "%lf", &tmp) == 1 && tmp >= 0.)
+            {
+              _compression.epsilon = tmp;
+              _compress = TRUE;
+            }
+	  else
+	    g_printerr ("Invalid compression epsilon (-compress %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-single") == 0)
+	{
+	  _compression.single = TRUE;
+	  _compress = TRUE;
+	}
+      else if (g_ascii_strcasecmp (arg, "-migrate-structure") == 0)
+	{
+	  _migrate_structure = TRUE;
+	}
+#endif
+      else if (g_ascii_strcasecmp (arg, "-threads") == 0)
+	{
+	  guint tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (sscanf (arg, "%u", &tmp) == 1 && tmp > 0)
+	    _threads = tmp;
+	  else
+	    g_printerr ("Invalid threads number (-threads %s)\n", arg);
+	}
       else if (g_ascii_strncasecmp (arg, "-v", 2) == 0 ||
                g_ascii_strncasecmp (arg, "--verbose", 9) == 0)
         {
@@ -715,7 +760,12 @@ int main (int argc, char **argv)
   GTimer *timer = NULL;
 
 #ifdef VSG_HAVE_MPI
-  MPI_Init (&argc, &argv);
+  {
+    int provided;
+
+    /* solver threads never communicate */
+    MPI_Init_thread (&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+  }
 
   MPI_Comm_size (MPI_COMM_WORLD, &sz);
   MPI_Comm_rank (MPI_COMM_WORLD, &rk);
@@ -731,6 +781,10 @@ int main (int argc, char **argv)
   pconfig.point = point_accum_vtable;
 
   aran_development2d_vtable_init (&pconfig.node_data, 0, order);
+
+  if (_compress)
+    aran_development2d_vtable_set_compression (&pconfig.node_data,
+                                               &_compression);
 #endif
 
   points = g_ptr_array_new ();
@@ -752,8 +806,11 @@ int main (int argc, char **argv)
 
 #ifdef VSG_HAVE_MPI
   aran_solver2d_set_parallel (solver, &pconfig);
+  aran_solver2d_set_migrate_structure (solver, _migrate_structure);
 #endif
 
+  aran_solver2d_set_threads (solver, _threads);
+
   if (virtual_maxbox != 0)
     aran_solver2d_set_nf_isleaf (solver, _nf_isleaf_virtual_maxbox,
                                  &virtual_maxbox);
@@ -119,6 +119,82 @@ static void check (const gchar *log,
 }
 
 
+static void check_field (const gchar *log,
+                         AranSphericalSeriesd *ass, gdouble radius,
+                         VsgVector3d *center,
+                         void (*f) (VsgVector3d *x, VsgVector3d *grad))
+{
+  guint8 deg = aran_spherical_seriesd_get_posdeg (ass);
+  AranSphericalSeriesd *dx = aran_spherical_seriesd_new (deg-1, 0);
+  AranSphericalSeriesd *dy = aran_spherical_seriesd_new (deg-1, 0);
+  AranSphericalSeriesd *dz = aran_spherical_seriesd_new (deg-1, 0);
+  guint i, j, k;
+  gdouble t, p;
+  gdouble err;
+  gdouble r, cost, sint, cosp, sinp;
+
+  aran_spherical_seriesd_local_gradient (ass, dx, dy, dz);
+
+  for (i=0; i<N ; i ++)
+    {
+      p = 2.*G_PI * i/(N-1.);
+      cosp = cos (p);
+      sinp = sin (p);
+
+      for (j=0; j<N; j ++)
+	{
+	  t = G_PI * j/(N-1.);
+	  cost = cos (t);
+	  sint = sin (t);
+
+	  for (k=0; k<N; k ++)
+	    {
+	      VsgVector3d vec;
+	      VsgVector3d vref;
+	      VsgVector3d vres;
+	      VsgVector3d verr;
+
+	      r = radius * k/(N-1.);
+
+	      vsg_vector3d_from_spherical_internal (&vec, r,
+						    cost, sint,
+						    cosp, sinp);
+
+              aran_spherical_seriesd_local_field_evaluate_internal (NULL,
+                                                                    dx, dy, dz,
+                                                                    r,
+                                                                    cost, sint,
+                                                                    cosp, sinp,
+                                                                    &vres);
+
+              vsg_vector3d_scalp (&vres, -1., &vres);
+
+	      vsg_vector3d_add (&vec, center, &vec);
+
+	      f (&vec, &vref);
+
+	      vsg_vector3d_sub (&vref, &vres, &verr);
+
+              err = vsg_vector3d_norm (&verr) / vsg_vector3d_norm (&vref);
+
+	      if (fabs (err) > epsilon || !finite (err))
+		{
+		  g_printerr ("Error %s (%f,%f,%f) : " \
+                              "(%f,%f,%f) != (%f,%f,%f) -> %e\n",
+                              log,
+			      r, t, p,
+			      vref.x, vref.y, vref.z,
+			      vres.x, vres.y, vres.z,
+			      fabs (err));
+		}
+	    }
+	}
+    }
+
+  aran_spherical_seriesd_free (dx);
+  aran_spherical_seriesd_free (dy);
+  aran_spherical_seriesd_free (dz);
+}
 
 static VsgVector3d p;
 
@@ -252,6 +328,7 @@ int main (int argc, char **argv)
 /*   aran_spherical_seriesd_write (ass, stderr); */
 /*   g_printerr ("\n\n"); */
   check ("devel", ass, 1., &center, newtongrad);
+  check_field ("devel field", ass, 1., &center, newtongrad);
 
   ast = aran_spherical_seriesd_clone (ass);
   aran_spherical_seriesd_set_zero (ast);
@@ -279,6 +356,7 @@ int main (int argc, char **argv)
 /*   aran_spherical_seriesd_write (ast3, stderr); */
 /*   g_printerr ("\n\n"); */
   check ("translated rotate", ast3, 0.5, &tr, newtongrad);
+  check_field ("translated rotate field", ast3, 0.5, &tr, newtongrad);
 
   aran_spherical_seriesd_free (ass);
   aran_spherical_seriesd_free (ast);
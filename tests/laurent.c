@@ -217,7 +217,7 @@ static void check_add ()
 int main (int argc, char **argv)
 {
   int ret = 0;
-  AranLaurentSeriesd *als, *alst, *alstt;
+  AranLaurentSeriesd *als, *alst, *alstt, *alsttt;
 
   aran_init();
 
@@ -242,9 +242,33 @@ int main (int argc, char **argv)
   aran_laurent_seriesd_to_taylor (als, 0., alstt, I*6.);
   taylor_check ("laurent to taylor translation", alstt, inv_z_m_1, I*6., 2.);
 
+  /* same with scaled translations */
+  aran_laurent_seriesd_set_zero (alst);
+  aran_laurent_seriesd_translate_scaled (als, 0., alst, I*2.);
+  laurent_check ("scaled laurent series translation", alst, inv_z_m_1, I*2.,
+		 4.);
+
+  aran_laurent_seriesd_set_zero (alstt);
+  aran_laurent_seriesd_to_taylor_scaled (als, 0., alstt, I*6.);
+  taylor_check ("scaled laurent to taylor translation", alstt, inv_z_m_1,
+                I*6., 2.);
+
+  /* translate taylor series */
+  alsttt = aran_laurent_seriesd_new (order, 0);
+
+  aran_laurent_seriesd_translate (alstt, I*6., alsttt, I*6.+.5);
+  taylor_check ("taylor series translation", alsttt, inv_z_m_1, I*6.+.5,
+                1.5);
+
+  aran_laurent_seriesd_set_zero (alsttt);
+  aran_laurent_seriesd_translate_scaled (alstt, I*6., alsttt, I*6.+.5);
+  taylor_check ("scaled taylor series translation", alsttt, inv_z_m_1,
+                I*6.+.5, 1.5);
+
   aran_laurent_seriesd_free (als);
   aran_laurent_seriesd_free (alst);
   aran_laurent_seriesd_free (alstt);
+  aran_laurent_seriesd_free (alsttt);
 
   check_add ();
 
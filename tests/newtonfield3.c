@@ -52,6 +52,8 @@ struct _PointAccum
   VsgVector3d field;
 
   guint id;
+
+  VsgVector3d previous;
 };
 
 
@@ -136,6 +138,24 @@ void l2p (const VsgPRTree3dNodeInfo *devel_node, AranDevelopment3d *devel,
   vsg_vector3d_add (&particle->field, &tmp, &particle->field);
 }
 
+/* leaf local expansion gradient (see -leaf-gradient) */
+void leaf_gradient_prepare (const VsgPRTree3dNodeInfo *leaf_info,
+                            AranDevelopment3d *devel, gpointer user_data)
+{
+  aran_development3d_gradient_prepare (leaf_info, devel);
+}
+
+void l2p_gradient (const VsgPRTree3dNodeInfo *devel_node,
+                   AranDevelopment3d *devel, PointAccum *particle)
+{
+  VsgVector3d tmp;
+
+  aran_development3d_gradient_l2pv (devel_node, devel,
+                                    &particle->vector, &tmp);
+
+  vsg_vector3d_add (&particle->field, &tmp, &particle->field);
+}
+
 void p2l (PointAccum *particle, const VsgPRTree3dNodeInfo *dst_node,
           AranDevelopment3d *dst)
 {
@@ -288,6 +308,9 @@ static gboolean check = TRUE;
 static gboolean direct = FALSE;
 static guint maxbox = 1;
 static guint virtual_maxbox = 0;
+static gdouble update_angle = 0.;
+static gchar *level_orders = NULL;
+static gboolean use_leaf_gradient = FALSE;
 
 static AranMultipole2MultipoleFunc3d m2m =
 (AranMultipole2MultipoleFunc3d) aran_development3d_m2m;
@@ -370,6 +393,29 @@ void parse_args (int argc, char **argv)
 	  else
 	    g_printerr ("Invalid virtual maxbox (-virtual-maxbox %s)\n", arg);
 	}
+      else if (g_ascii_strcasecmp (arg, "-update") == 0)
+	{
+	  gdouble tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (sscanf (arg, "%lf", &tmp) == 1)
+	      update_angle = tmp;
+	  else
+	    g_printerr ("Invalid update angle value (-update %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-level-orders") == 0)
+	{
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (arg != NULL)
+	      level_orders = arg;
+	  else
+	    g_printerr ("Missing level orders (-level-orders o0,o1,...)\n");
+	}
       else if (g_ascii_strcasecmp (arg, "-err") == 0)
 	{
 	  gdouble tmp = 0;
@@ -395,6 +441,10 @@ void parse_args (int argc, char **argv)
 	{
 	  direct = TRUE;
 	}
+      else if (g_ascii_strcasecmp (arg, "-leaf-gradient") == 0)
+	{
+	  use_leaf_gradient = TRUE;
+	}
       else if (g_ascii_strcasecmp (arg, "-dist") == 0)
 	{
 	  iarg ++;
@@ -594,6 +644,24 @@ gboolean _nf_isleaf_virtual_maxbox (const VsgPRTree3dNodeInfo *node_info,
   return node_info->point_count <= * ((guint *) virtual_maxbox);
 }
 
+static void _move (PointAccum *point, gboolean updated, gpointer data)
+{
+  if (updated)
+    {
+      gdouble c = 0.7 * cos (update_angle);
+      gdouble s = 0.7 * sin (update_angle);
+
+      point->previous = point->vector;
+
+      point->vector.x = c * point->previous.x - s * point->previous.y;
+      point->vector.y = s * point->previous.x + c * point->previous.y;
+    }
+  else
+    {
+      point->vector = point->previous;
+    }
+}
+
 int main (int argc, char **argv)
 {
   VsgVector3d lbound = {-TR, -TR, -TR};
@@ -601,6 +669,7 @@ int main (int argc, char **argv)
   PointAccum **points;
   VsgPRTree3d *prtree;
   AranSolver3d *solver;
+  AranDevelopment3dSchedule *schedule = NULL;
   int ret = 0;
   guint i;
 
@@ -626,6 +695,23 @@ int main (int argc, char **argv)
     aran_solver3d_set_nf_isleaf (solver, _nf_isleaf_virtual_maxbox,
                                  &virtual_maxbox);
 
+  if (level_orders != NULL)
+    {
+      gchar **orders = g_strsplit (level_orders, ",", 0);
+
+      schedule = aran_development3d_schedule_new (0, order);
+
+      for (i=0; orders[i] != NULL; i ++)
+        aran_development3d_schedule_set_level (schedule, i, 0,
+                                               atoi (orders[i]));
+
+      g_strfreev (orders);
+
+      aran_solver3d_set_node_zero (solver, (AranNodeZeroFunc3d)
+                                   aran_development3d_schedule_zero,
+                                   schedule);
+    }
+
   aran_solver3d_set_functions (solver,
 			       (AranParticle2ParticleFunc3d) p2p,
 			       (AranParticle2MultipoleFunc3d) p2m,
@@ -634,8 +720,28 @@ int main (int argc, char **argv)
 			       l2l,
 			       (AranLocal2ParticleFunc3d)l2p);
 
+  if (use_leaf_gradient)
+    {
+      aran_solver3d_set_leaf_prepare (solver, (AranLeafPrepareFunc3d)
+                                      leaf_gradient_prepare, NULL);
+
+      aran_solver3d_set_functions (solver,
+                                   (AranParticle2ParticleFunc3d) p2p,
+                                   (AranParticle2MultipoleFunc3d) p2m,
+                                   m2m,
+                                   m2l,
+                                   l2l,
+                                   (AranLocal2ParticleFunc3d) l2p_gradient);
+    }
+
   _distribution (points, solver);
 
+  if (update_angle != 0. && !direct)
+    aran_solver3d_update_positions (solver, (AranParticleMoveFunc3d) _move,
+                                    NULL);
+  else if (update_angle != 0.)
+    for (i=0; i<np; i ++) _move (points[i], TRUE, NULL);
+
 /*   g_printerr ("ok depth = %d size = %d\n", */
 /*               aran_solver3d_depth (solver), */
 /*               aran_solver3d_point_count (solver)); */
@@ -645,8 +751,24 @@ int main (int argc, char **argv)
 
 /*   vsg_prtree3d_write (prtree, stderr); */
 
+  if (update_angle != 0. && !direct)
+    {
+      /* every particle has to be found where its position leads to */
+      for (i=0; i<np; i ++)
+        {
+          if (! aran_solver3d_remove_point (solver, points[i]))
+            {
+              g_printerr ("Particle %u not found after update\n", i);
+              ret ++;
+            }
+        }
+    }
+
   aran_solver3d_free (solver);
 
+  if (schedule != NULL)
+    aran_development3d_schedule_free (schedule);
+
   if (check)
     {
       gint i, j;
@@ -487,6 +487,16 @@ static gboolean _verbose = FALSE;
 static gboolean _write = FALSE;
 static gboolean _hilbert = FALSE;
 static guint semifar_threshold = G_MAXUINT;
+static guint _threads = 1;
+
+#ifdef VSG_HAVE_MPI
+static AranPackCompression _compression = {0., FALSE};
+static gboolean _compress = FALSE;
+static gboolean _migrate_structure = FALSE;
+static gboolean _let = FALSE;
+static guint _balance_steps = 0;
+static gdouble _balance_tolerance = 0.05;
+#endif
 
 static AranMultipole2MultipoleFunc3d m2m =
 (AranMultipole2MultipoleFunc3d) aran_development3d_m2m;
@@ -688,6 +698,73 @@ void parse_args (int argc, char **argv)
         {
           _hilbert = TRUE;
         }
+#ifdef VSG_HAVE_MPI
+      else if (g_ascii_strcasecmp (arg, "-compress") == 0)
+        {
+          gdouble tmp = 0.;
+          iarg ++;
+
+          arg = (iarg<argc) ? argv[iarg] : NULL;
+
+          if (sscanf (arg, "%lf", &tmp) == 1 && tmp >= 0.)
+            {
+              _compression.epsilon = tmp;
+              _compress = TRUE;
+            }
+          else
+            g_printerr ("Invalid compression epsilon (-compress %s)\n", arg);
+        }
+      else if (g_ascii_strcasecmp (arg, "-single") == 0)
+        {
+          _compression.single = TRUE;
+          _compress = TRUE;
+        }
+      else if (g_ascii_strcasecmp (arg, "-migrate-structure") == 0)
+        {
+          _migrate_structure = TRUE;
+        }
+      else if (g_ascii_strcasecmp (arg, "-let") == 0)
+        {
+          _let = TRUE;
+        }
+      else if (g_ascii_strcasecmp (arg, "-balance") == 0)
+        {
+          guint tmp = 0;
+          iarg ++;
+
+          arg = (iarg<argc) ? argv[iarg] : NULL;
+
+          if (sscanf (arg, "%u", &tmp) == 1)
+            _balance_steps = tmp;
+          else
+            g_printerr ("Invalid balance steps number (-balance %s)\n", arg);
+        }
+      else if (g_ascii_strcasecmp (arg, "-balance-tolerance") == 0)
+        {
+          gdouble tmp = 0.;
+          iarg ++;
+
+          arg = (iarg<argc) ? argv[iarg] : NULL;
+
+          if (sscanf (arg, "%lf", &tmp) == 1 && tmp >= 0.)
+            _balance_tolerance = tmp;
+          else
+            g_printerr ("Invalid balance tolerance (-balance-tolerance %s)\n",
+                        arg);
+        }
+#endif
+      else if (g_ascii_strcasecmp (arg, "-threads") == 0)
+        {
+          guint tmp = 0;
+          iarg ++;
+
+          arg = (iarg<argc) ? argv[iarg] : NULL;
+
+          if (sscanf (arg, "%u", &tmp) == 1 && tmp > 0)
+            _threads = tmp;
+          else
+            g_printerr ("Invalid threads number (-threads %s)\n", arg);
+        }
       else if (g_ascii_strncasecmp (arg, "--save-fma", 10) == 0)
         {
           iarg ++;
@@ -1364,7 +1441,12 @@ int main (int argc, char **argv)
   GTimer *timer = NULL;
 
 #ifdef VSG_HAVE_MPI
-  MPI_Init (&argc, &argv);
+  {
+    int provided;
+
+    /* solver threads never communicate */
+    MPI_Init_thread (&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+  }
 
   MPI_Comm_size (MPI_COMM_WORLD, &sz);
   MPI_Comm_rank (MPI_COMM_WORLD, &rk);
@@ -1380,6 +1462,10 @@ int main (int argc, char **argv)
   pconfig.point = point_accum_vtable;
 
   aran_development3d_vtable_init (&pconfig.node_data, 0, order);
+
+  if (_compress)
+    aran_development3d_vtable_set_compression (&pconfig.node_data,
+                                               &_compression);
 #endif
 
   if (check)
@@ -1400,8 +1486,12 @@ int main (int argc, char **argv)
 
 #ifdef VSG_HAVE_MPI
   aran_solver3d_set_parallel (solver, &pconfig);
+  aran_solver3d_set_migrate_structure (solver, _migrate_structure);
+  aran_solver3d_set_let (solver, _let);
 #endif
 
+  aran_solver3d_set_threads (solver, _threads);
+
   if (virtual_maxbox != 0)
     aran_solver3d_set_nf_isleaf (solver, _nf_isleaf_virtual_maxbox,
                                  &virtual_maxbox);
@@ -1481,6 +1571,37 @@ int main (int argc, char **argv)
       g_timer_destroy (timer);
     }
 
+#ifdef VSG_HAVE_MPI
+  if (_balance_steps > 0)
+    {
+      AranBalance *balance = aran_balance_new (MPI_COMM_WORLD,
+                                               _balance_tolerance);
+      guint step;
+
+      /* preliminary solves letting the policy repartition the tree */
+      for (step=0; step<_balance_steps; step ++)
+        {
+          gboolean repartitioned;
+
+          aran_solver3d_solve (solver);
+
+          repartitioned = aran_solver3d_balance (solver, balance);
+
+          if (_verbose && rk == 0)
+            {
+              gdouble max, mean, loss;
+
+              aran_balance_get_imbalance (balance, &max, &mean, &loss);
+              g_printerr ("%d : step %u work max=%g mean=%g loss=%g%s\n", rk,
+                          step, max, mean, loss,
+                          repartitioned ? " repartitioned" : "");
+            }
+        }
+
+      aran_balance_free (balance);
+    }
+#endif
+
   if (_verbose)
     {
       g_printerr ("%d : solve begin\n", rk);
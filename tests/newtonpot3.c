@@ -27,6 +27,10 @@
 
 #include "aran/aran.h"
 #include "aran/aransolver3d.h"
+#include "aran/arancartesiandevelopment3d.h"
+#include "aran/arandevelopment3df.h"
+#include "aran/arankerneldevelopment3d.h"
+#include "aran/aranchebyshevdevelopment3d.h"
 #include "aran/aranbinomial.h"
 #include "aran/aranprofile.h"
 #include "aran/aranprofiledb.h"
@@ -103,6 +107,165 @@ void m2p (const VsgPRTree3dNodeInfo *devel_node, AranDevelopment3d *devel,
                                                             &particle->vector);
 }
 
+/* low order cartesian developments (see -cartesian) */
+void p2m_cartesian (PointAccum *particle, const VsgPRTree3dNodeInfo *dst_node,
+                    AranCartesianDevelopment3d *dst)
+{
+  aran_cartesian_development3d_p2m (&particle->vector, particle->density,
+                                    dst_node, dst);
+}
+
+void l2p_cartesian (const VsgPRTree3dNodeInfo *devel_node,
+                    AranCartesianDevelopment3d *devel, PointAccum *particle)
+{
+  particle->accum += aran_cartesian_development3d_l2p (devel_node, devel,
+                                                       &particle->vector);
+}
+
+void p2l_cartesian (PointAccum *particle, const VsgPRTree3dNodeInfo *dst_node,
+                    AranCartesianDevelopment3d *dst)
+{
+  aran_cartesian_development3d_p2l (&particle->vector, particle->density,
+                                    dst_node, dst);
+}
+
+void m2p_cartesian (const VsgPRTree3dNodeInfo *devel_node,
+                    AranCartesianDevelopment3d *devel, PointAccum *particle)
+{
+  particle->accum += aran_cartesian_development3d_m2p (devel_node, devel,
+                                                       &particle->vector);
+}
+
+/* single precision developments (see -precision) */
+void p2m_single (PointAccum *particle, const VsgPRTree3dNodeInfo *dst_node,
+                 AranDevelopment3df *dst)
+{
+  aran_development3df_p2m (&particle->vector, particle->density, dst_node,
+                           dst);
+}
+
+void l2p_single (const VsgPRTree3dNodeInfo *devel_node,
+                 AranDevelopment3df *devel, PointAccum *particle)
+{
+  particle->accum += aran_development3df_l2p (devel_node, devel,
+                                              &particle->vector);
+}
+
+void p2l_single (PointAccum *particle, const VsgPRTree3dNodeInfo *dst_node,
+                 AranDevelopment3df *dst)
+{
+  aran_development3df_p2l (&particle->vector, particle->density, dst_node,
+                           dst);
+}
+
+void m2p_single (const VsgPRTree3dNodeInfo *devel_node,
+                 AranDevelopment3df *devel, PointAccum *particle)
+{
+  particle->accum += aran_development3df_m2p (devel_node, devel,
+                                              &particle->vector);
+}
+
+/* kernel independent developments (see -kernel) */
+static void newton_kernel (const VsgVector3d *target, const VsgVector3d *source,
+                           gdouble *values, gpointer user_data)
+{
+  values[0] = 1. / vsg_vector3d_dist (target, source);
+}
+
+void p2m_kernel (PointAccum *particle, const VsgPRTree3dNodeInfo *dst_node,
+                 AranKernelDevelopment3d *dst)
+{
+  aran_kernel_development3d_p2m (&particle->vector, &particle->density,
+                                 dst_node, dst);
+}
+
+void l2p_kernel (const VsgPRTree3dNodeInfo *devel_node,
+                 AranKernelDevelopment3d *devel, PointAccum *particle)
+{
+  gdouble value;
+
+  aran_kernel_development3d_l2p (devel_node, devel, &particle->vector,
+                                 &value);
+  particle->accum += value;
+}
+
+void p2l_kernel (PointAccum *particle, const VsgPRTree3dNodeInfo *dst_node,
+                 AranKernelDevelopment3d *dst)
+{
+  aran_kernel_development3d_p2l (&particle->vector, &particle->density,
+                                 dst_node, dst);
+}
+
+void m2p_kernel (const VsgPRTree3dNodeInfo *devel_node,
+                 AranKernelDevelopment3d *devel, PointAccum *particle)
+{
+  gdouble value;
+
+  aran_kernel_development3d_m2p (devel_node, devel, &particle->vector,
+                                 &value);
+  particle->accum += value;
+}
+
+/* Chebyshev interpolation developments (see -chebyshev) */
+void p2m_chebyshev (PointAccum *particle, const VsgPRTree3dNodeInfo *dst_node,
+                    AranChebyshevDevelopment3d *dst)
+{
+  aran_chebyshev_development3d_p2m (&particle->vector, &particle->density,
+                                    dst_node, dst);
+}
+
+void l2p_chebyshev (const VsgPRTree3dNodeInfo *devel_node,
+                    AranChebyshevDevelopment3d *devel, PointAccum *particle)
+{
+  gdouble value;
+
+  aran_chebyshev_development3d_l2p (devel_node, devel, &particle->vector,
+                                    &value);
+  particle->accum += value;
+}
+
+void p2l_chebyshev (PointAccum *particle, const VsgPRTree3dNodeInfo *dst_node,
+                    AranChebyshevDevelopment3d *dst)
+{
+  aran_chebyshev_development3d_p2l (&particle->vector, &particle->density,
+                                    dst_node, dst);
+}
+
+void m2p_chebyshev (const VsgPRTree3dNodeInfo *devel_node,
+                    AranChebyshevDevelopment3d *devel, PointAccum *particle)
+{
+  gdouble value;
+
+  aran_chebyshev_development3d_m2p (devel_node, devel, &particle->vector,
+                                    &value);
+  particle->accum += value;
+}
+
+/* one way p2p for query particles evaluation */
+void p2p_eval (PointAccum *src, PointAccum *dst)
+{
+  VsgVector3d tmp;
+
+  vsg_vector3d_sub (&dst->vector, &src->vector, &tmp);
+
+  dst->accum += src->density / vsg_vector3d_norm (&tmp);
+}
+
+/* mixes pure sources, pure targets and regular particles */
+AranParticleRole point_accum_role (PointAccum *pa)
+{
+  static const AranParticleRole roles[3] = {
+    ARAN_PARTICLE_SOURCE, ARAN_PARTICLE_TARGET, ARAN_PARTICLE_SOURCE_TARGET,
+  };
+
+  return roles[pa->id % 3];
+}
+
+gdouble point_accum_weight (PointAccum *pa)
+{
+  return fabs (pa->density);
+}
+
 static void _direct (PointAccum **points, guint np)
 {
   guint i, j;
@@ -213,7 +376,32 @@ static gboolean check = TRUE;
 static gboolean direct = FALSE;
 static guint maxbox = 1;
 static guint semifar_threshold = G_MAXUINT;
+static gboolean adaptive_semifar = FALSE;
 static gboolean verbose = FALSE;
+static gchar *stats_file = NULL;
+static guint neval = 0;
+static gboolean roles = FALSE;
+static gboolean prune = FALSE;
+static guint far_period = 1;
+static gdouble far_move = 0.;
+static guint virtual_maxbox = 0;
+static guint nthreads = 1;
+static gboolean cartesian = FALSE;
+static gboolean single = FALSE;
+static gboolean kernel = FALSE;
+static gboolean chebyshev = FALSE;
+static gboolean mixed = FALSE;
+static guint wide_depth = 0;
+
+static AranParticle2MultipoleFunc3d p2m_func =
+(AranParticle2MultipoleFunc3d) p2m;
+
+static AranLocal2ParticleFunc3d l2p_func = (AranLocal2ParticleFunc3d) l2p;
+
+static AranParticle2LocalFunc3d p2l_func = (AranParticle2LocalFunc3d) p2l;
+
+static AranMultipole2ParticleFunc3d m2p_func =
+(AranMultipole2ParticleFunc3d) m2p;
 
 static AranMultipole2MultipoleFunc3d m2m =
 (AranMultipole2MultipoleFunc3d) aran_development3d_m2m;
@@ -227,6 +415,250 @@ static AranLocal2LocalFunc3d l2l =
 static void (*_distribution) (PointAccum **, AranSolver3d *solver) =
 _one_circle_distribution;
 
+/* operators calls as seen from the callbacks, to be checked against the
+ * solver statistics (see -stats) */
+static gint op_calls[ARAN_STATS_OPERATOR_COUNT];
+
+static AranParticle2MultipoleFunc3d counted_p2m;
+static AranMultipole2MultipoleFunc3d counted_m2m;
+static AranMultipole2LocalFunc3d counted_m2l;
+static AranLocal2LocalFunc3d counted_l2l;
+static AranLocal2ParticleFunc3d counted_l2p;
+static AranParticle2LocalFunc3d counted_p2l;
+static AranMultipole2ParticleFunc3d counted_m2p;
+
+static void p2p_counted (PointAccum *one, PointAccum *other)
+{
+  g_atomic_int_add (&op_calls[ARAN_STATS_P2P], 1);
+  p2p (one, other);
+}
+
+static void p2m_counted (VsgPoint3 particle,
+                         const VsgPRTree3dNodeInfo *dst_node, gpointer dst)
+{
+  g_atomic_int_add (&op_calls[ARAN_STATS_P2M], 1);
+  counted_p2m (particle, dst_node, dst);
+}
+
+static void m2m_counted (const VsgPRTree3dNodeInfo *src_node, gpointer src,
+                         const VsgPRTree3dNodeInfo *dst_node, gpointer dst)
+{
+  g_atomic_int_add (&op_calls[ARAN_STATS_M2M], 1);
+  counted_m2m (src_node, src, dst_node, dst);
+}
+
+static void m2l_counted (const VsgPRTree3dNodeInfo *src_node, gpointer src,
+                         const VsgPRTree3dNodeInfo *dst_node, gpointer dst)
+{
+  g_atomic_int_add (&op_calls[ARAN_STATS_M2L], 1);
+  counted_m2l (src_node, src, dst_node, dst);
+}
+
+static void l2l_counted (const VsgPRTree3dNodeInfo *src_node, gpointer src,
+                         const VsgPRTree3dNodeInfo *dst_node, gpointer dst)
+{
+  g_atomic_int_add (&op_calls[ARAN_STATS_L2L], 1);
+  counted_l2l (src_node, src, dst_node, dst);
+}
+
+static void l2p_counted (const VsgPRTree3dNodeInfo *devel_node, gpointer devel,
+                         VsgPoint3 particle)
+{
+  g_atomic_int_add (&op_calls[ARAN_STATS_L2P], 1);
+  counted_l2p (devel_node, devel, particle);
+}
+
+static void p2l_counted (VsgPoint3 particle,
+                         const VsgPRTree3dNodeInfo *dst_node, gpointer dst)
+{
+  g_atomic_int_add (&op_calls[ARAN_STATS_P2L], 1);
+  counted_p2l (particle, dst_node, dst);
+}
+
+static void m2p_counted (const VsgPRTree3dNodeInfo *devel_node, gpointer devel,
+                         VsgPoint3 particle)
+{
+  g_atomic_int_add (&op_calls[ARAN_STATS_M2P], 1);
+  counted_m2p (devel_node, devel, particle);
+}
+
+/* routes the operators through the counting wrappers above */
+static void _count_calls ()
+{
+  counted_p2m = p2m_func;
+  counted_m2m = m2m;
+  counted_m2l = m2l;
+  counted_l2l = l2l;
+  counted_l2p = l2p_func;
+  counted_p2l = p2l_func;
+  counted_m2p = m2p_func;
+
+  p2m_func = (AranParticle2MultipoleFunc3d) p2m_counted;
+  m2m = (AranMultipole2MultipoleFunc3d) m2m_counted;
+  m2l = (AranMultipole2LocalFunc3d) m2l_counted;
+  l2l = (AranLocal2LocalFunc3d) l2l_counted;
+  l2p_func = (AranLocal2ParticleFunc3d) l2p_counted;
+  p2l_func = (AranParticle2LocalFunc3d) p2l_counted;
+  m2p_func = (AranMultipole2ParticleFunc3d) m2p_counted;
+}
+
+/* compares the solver operators counts with the calls of the callbacks */
+static int _check_calls (AranSolver3d *solver)
+{
+  AranStats *stats = aran_solver3d_peek_stats (solver);
+  AranStatsOperator ops[] = {ARAN_STATS_P2P, ARAN_STATS_P2M, ARAN_STATS_M2M,
+                             ARAN_STATS_M2L, ARAN_STATS_L2L, ARAN_STATS_L2P,
+                             ARAN_STATS_P2L, ARAN_STATS_M2P};
+  int ret = 0;
+  guint i;
+
+  for (i=0; i<G_N_ELEMENTS (ops); i++)
+    {
+      glong count;
+
+      /* with roles, pairs of non interacting particles still count */
+      if (ops[i] == ARAN_STATS_P2P && roles) continue;
+
+      aran_stats_get_operator (stats, ops[i], &count, NULL);
+
+      if (count != op_calls[ops[i]])
+        {
+          g_printerr ("Error: %s count %ld != %d calls\n",
+                      aran_stats_operator_name (ops[i]), count,
+                      op_calls[ops[i]]);
+          ret ++;
+        }
+    }
+
+  /* a single complete solve gathers and evaluates every particle once */
+  if (! roles && ! prune && ! direct && far_period == 1)
+    {
+      if (op_calls[ARAN_STATS_P2M] != np || op_calls[ARAN_STATS_L2P] != np)
+        {
+          g_printerr ("Error: %d p2m and %d l2p calls for %u particles\n",
+                      op_calls[ARAN_STATS_P2M], op_calls[ARAN_STATS_L2P],
+                      np);
+          ret ++;
+        }
+    }
+
+  return ret;
+}
+
+/* strict JSON syntax check: returns the end of the value at @s or NULL */
+static const gchar *_json_value (const gchar *s);
+
+static const gchar *_json_space (const gchar *s)
+{
+  while (g_ascii_isspace (*s)) s ++;
+  return s;
+}
+
+static const gchar *_json_string (const gchar *s)
+{
+  if (*s != '"') return NULL;
+
+  for (s++; *s != '"'; s++)
+    {
+      if (*s == '\0' || (guchar) *s < 0x20) return NULL;
+      if (*s == '\\' && *(++s) == '\0') return NULL;
+    }
+
+  return s+1;
+}
+
+static const gchar *_json_number (const gchar *s)
+{
+  const gchar *digits;
+
+  if (*s == '-') s ++;
+
+  digits = s;
+  while (g_ascii_isdigit (*s)) s ++;
+  if (s == digits) return NULL;
+
+  if (*s == '.')
+    {
+      digits = ++s;
+      while (g_ascii_isdigit (*s)) s ++;
+      if (s == digits) return NULL;
+    }
+
+  if (*s == 'e' || *s == 'E')
+    {
+      s ++;
+      if (*s == '+' || *s == '-') s ++;
+
+      digits = s;
+      while (g_ascii_isdigit (*s)) s ++;
+      if (s == digits) return NULL;
+    }
+
+  return s;
+}
+
+static const gchar *_json_members (const gchar *s, gchar close,
+                                   gboolean object)
+{
+  s = _json_space (s+1);
+  if (*s == close) return s+1;
+
+  while (s != NULL)
+    {
+      if (object)
+        {
+          s = _json_string (_json_space (s));
+          if (s == NULL) return NULL;
+
+          s = _json_space (s);
+          if (*s != ':') return NULL;
+          s ++;
+        }
+
+      s = _json_value (s);
+      if (s == NULL) return NULL;
+
+      s = _json_space (s);
+      if (*s == close) return s+1;
+      if (*s != ',') return NULL;
+      s ++;
+    }
+
+  return NULL;
+}
+
+static const gchar *_json_value (const gchar *s)
+{
+  s = _json_space (s);
+
+  switch (*s)
+    {
+    case '{': return _json_members (s, '}', TRUE);
+    case '[': return _json_members (s, ']', FALSE);
+    case '"': return _json_string (s);
+    case 't': return g_str_has_prefix (s, "true") ? s+4 : NULL;
+    case 'f': return g_str_has_prefix (s, "false") ? s+5 : NULL;
+    case 'n': return g_str_has_prefix (s, "null") ? s+4 : NULL;
+    default: return _json_number (s);
+    }
+}
+
+static gboolean _json_check (const gchar *filename)
+{
+  gchar *text;
+  const gchar *end;
+  gboolean ok;
+
+  if (! g_file_get_contents (filename, &text, NULL, NULL)) return FALSE;
+
+  end = _json_value (text);
+  ok = end != NULL && *_json_space (end) == '\0';
+
+  g_free (text);
+
+  return ok;
+}
+
 
 static
 void parse_args (int argc, char **argv)
@@ -308,6 +740,10 @@ void parse_args (int argc, char **argv)
 	  else
 	    g_printerr ("Invalid semifar threshold (-semifar %s)\n", arg);
 	}
+      else if (g_ascii_strcasecmp (arg, "-adaptive-semifar") == 0)
+	{
+	  adaptive_semifar = TRUE;
+	}
       else if (g_ascii_strcasecmp (arg, "-nocheck") == 0)
 	{
 	  check = FALSE;
@@ -321,6 +757,42 @@ void parse_args (int argc, char **argv)
 	{
 	  direct = TRUE;
 	}
+      else if (g_ascii_strcasecmp (arg, "-cartesian") == 0)
+	{
+	  cartesian = TRUE;
+	}
+      else if (g_ascii_strcasecmp (arg, "-kernel") == 0)
+	{
+	  kernel = TRUE;
+	}
+      else if (g_ascii_strcasecmp (arg, "-chebyshev") == 0)
+	{
+	  chebyshev = TRUE;
+	}
+      else if (g_ascii_strcasecmp (arg, "-precision") == 0)
+	{
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (g_ascii_strcasecmp (arg, "single") == 0)
+	    {
+	      single = TRUE;
+	      mixed = FALSE;
+	    }
+	  else if (g_ascii_strcasecmp (arg, "mixed") == 0)
+	    {
+	      single = TRUE;
+	      mixed = TRUE;
+	    }
+	  else if (g_ascii_strcasecmp (arg, "double") == 0)
+	    {
+	      single = FALSE;
+	      mixed = FALSE;
+	    }
+	  else
+	    g_printerr ("Invalid precision (-precision %s)\n", arg);
+	}
       else if (g_ascii_strcasecmp (arg, "-dist") == 0)
 	{
 	  iarg ++;
@@ -385,6 +857,85 @@ void parse_args (int argc, char **argv)
 	      g_printerr ("Invalid translation name (-translation %s)\n", arg);
 	    }
 	}
+      else if (g_ascii_strcasecmp (arg, "-roles") == 0)
+	{
+	  roles = TRUE;
+	}
+      else if (g_ascii_strcasecmp (arg, "-prune") == 0)
+	{
+	  prune = TRUE;
+	}
+      else if (g_ascii_strcasecmp (arg, "-far-period") == 0)
+	{
+	  guint tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (arg != NULL && sscanf (arg, "%u", &tmp) == 1)
+	    far_period = tmp;
+	  else
+	    g_printerr ("Invalid far field period (-far-period %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-far-move") == 0)
+	{
+	  gdouble tmp = 0.;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (arg != NULL && sscanf (arg, "%lf", &tmp) == 1 && tmp >= 0.)
+	    far_move = tmp;
+	  else
+	    g_printerr ("Invalid far field move (-far-move %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-virtual-maxbox") == 0)
+	{
+	  guint tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (arg != NULL && sscanf (arg, "%u", &tmp) == 1)
+            virtual_maxbox = tmp;
+	  else
+	    g_printerr ("Invalid virtual maxbox (-virtual-maxbox %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-threads") == 0)
+	{
+	  guint tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (arg != NULL && sscanf (arg, "%u", &tmp) == 1 && tmp > 0)
+	    nthreads = tmp;
+	  else
+	    g_printerr ("Invalid threads number (-threads %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-eval") == 0)
+	{
+	  guint tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (arg != NULL && sscanf (arg, "%u", &tmp) == 1)
+	    neval = tmp;
+	  else
+	    g_printerr ("Invalid evaluation points number (-eval %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-stats") == 0)
+	{
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (arg != NULL)
+	    stats_file = arg;
+	  else
+	    g_printerr ("Invalid stats file name (-stats)\n");
+	}
       else if (g_ascii_strcasecmp (arg, "--verbose") == 0)
 	{
 	  verbose = TRUE;
@@ -581,6 +1132,25 @@ static void _plummer_fill (PointAccum **points,
   g_rand_free (rand);
 }
 
+/* small deterministic displacement, undone when @updated is FALSE */
+static void _far_move (PointAccum *point, gboolean updated, gpointer data)
+{
+  gdouble d = (updated ? far_move : -far_move) * R;
+
+  point->vector.x += d * cos (point->id);
+  point->vector.y += d * sin (point->id);
+  point->vector.z += d * cos (2. * point->id);
+}
+
+gboolean _nf_isleaf_virtual_maxbox (const VsgPRTree3dNodeInfo *node_info,
+                                    gpointer virtual_maxbox)
+{
+  /* shared nodes only know their local point_count */
+  if (VSG_PRTREE3D_NODE_INFO_IS_SHARED (node_info)) return FALSE;
+
+  return node_info->point_count <= * ((guint *) virtual_maxbox);
+}
+
 int main (int argc, char **argv)
 {
   VsgVector3d lbound = {-TR, -TR, -TR};
@@ -588,6 +1158,7 @@ int main (int argc, char **argv)
   PointAccum **points;
   VsgPRTree3d *prtree;
   AranSolver3d *solver;
+  AranParticle2ParticleFunc3d p2p_func = (AranParticle2ParticleFunc3d) p2p;
   int ret = 0;
   guint i;
 
@@ -605,44 +1176,220 @@ int main (int argc, char **argv)
 			    (VsgPoint3dDistFunc) vsg_vector3d_dist,
 			    (VsgRegion3dLocFunc) NULL, maxbox);
 
-  solver = aran_solver3d_new (prtree, ARAN_TYPE_DEVELOPMENT3D,
-			      aran_development3d_new (0, order),
-			      (AranZeroFunc) aran_development3d_set_zero);
+  if (cartesian)
+    {
+      solver = aran_solver3d_new (prtree, ARAN_TYPE_CARTESIAN_DEVELOPMENT3D,
+                                  aran_cartesian_development3d_new (order),
+                                  (AranZeroFunc)
+                                  aran_cartesian_development3d_set_zero);
+
+      m2m = (AranMultipole2MultipoleFunc3d) aran_cartesian_development3d_m2m;
+      m2l = (AranMultipole2LocalFunc3d) aran_cartesian_development3d_m2l;
+      l2l = (AranLocal2LocalFunc3d) aran_cartesian_development3d_l2l;
+
+      p2m_func = (AranParticle2MultipoleFunc3d) p2m_cartesian;
+      l2p_func = (AranLocal2ParticleFunc3d) l2p_cartesian;
+      p2l_func = (AranParticle2LocalFunc3d) p2l_cartesian;
+      m2p_func = (AranMultipole2ParticleFunc3d) m2p_cartesian;
+    }
+  else if (kernel)
+    {
+      AranKernel3d *newton = aran_kernel3d_new (newton_kernel, 1, NULL, order);
+
+      solver = aran_solver3d_new (prtree, ARAN_TYPE_KERNEL_DEVELOPMENT3D,
+                                  aran_kernel_development3d_new (newton),
+                                  (AranZeroFunc)
+                                  aran_kernel_development3d_set_zero);
+
+      /* the solver development now holds its own reference */
+      aran_kernel3d_unref (newton);
+
+      m2m = (AranMultipole2MultipoleFunc3d) aran_kernel_development3d_m2m;
+      m2l = (AranMultipole2LocalFunc3d) aran_kernel_development3d_m2l;
+      l2l = (AranLocal2LocalFunc3d) aran_kernel_development3d_l2l;
+
+      p2m_func = (AranParticle2MultipoleFunc3d) p2m_kernel;
+      l2p_func = (AranLocal2ParticleFunc3d) l2p_kernel;
+      p2l_func = (AranParticle2LocalFunc3d) p2l_kernel;
+      m2p_func = (AranMultipole2ParticleFunc3d) m2p_kernel;
+    }
+  else if (chebyshev)
+    {
+      AranChebyshev3d *newton =
+        aran_chebyshev3d_new (newton_kernel, 1, NULL, order, err_lim * 1.e-2);
+
+      solver = aran_solver3d_new (prtree, ARAN_TYPE_CHEBYSHEV_DEVELOPMENT3D,
+                                  aran_chebyshev_development3d_new (newton),
+                                  (AranZeroFunc)
+                                  aran_chebyshev_development3d_set_zero);
+
+      /* the solver development now holds its own reference */
+      aran_chebyshev3d_unref (newton);
+
+      m2m = (AranMultipole2MultipoleFunc3d) aran_chebyshev_development3d_m2m;
+      m2l = (AranMultipole2LocalFunc3d) aran_chebyshev_development3d_m2l;
+      l2l = (AranLocal2LocalFunc3d) aran_chebyshev_development3d_l2l;
+
+      p2m_func = (AranParticle2MultipoleFunc3d) p2m_chebyshev;
+      l2p_func = (AranLocal2ParticleFunc3d) l2p_chebyshev;
+      p2l_func = (AranParticle2LocalFunc3d) p2l_chebyshev;
+      m2p_func = (AranMultipole2ParticleFunc3d) m2p_chebyshev;
+    }
+  else if (single)
+    {
+      solver = aran_solver3d_new (prtree, ARAN_TYPE_DEVELOPMENT3DF,
+                                  aran_development3df_new (0, order),
+                                  (AranZeroFunc) aran_development3df_set_zero);
+
+      m2m = (AranMultipole2MultipoleFunc3d) aran_development3df_m2m;
+      m2l = (AranMultipole2LocalFunc3d) aran_development3df_m2l;
+      l2l = (AranLocal2LocalFunc3d) aran_development3df_l2l;
+
+      p2m_func = (AranParticle2MultipoleFunc3d) p2m_single;
+      l2p_func = (AranLocal2ParticleFunc3d) l2p_single;
+      p2l_func = (AranParticle2LocalFunc3d) p2l_single;
+      m2p_func = (AranMultipole2ParticleFunc3d) m2p_single;
+    }
+  else
+    solver = aran_solver3d_new (prtree, ARAN_TYPE_DEVELOPMENT3D,
+                                aran_development3d_new (0, order),
+                                (AranZeroFunc) aran_development3d_set_zero);
+
+  if (stats_file != NULL)
+    {
+      _count_calls ();
+      p2p_func = (AranParticle2ParticleFunc3d) p2p_counted;
+    }
 
   aran_solver3d_set_functions (solver,
-                               (AranParticle2ParticleFunc3d) p2p,
-                               (AranParticle2MultipoleFunc3d) p2m,
+                               p2p_func,
+                               p2m_func,
                                m2m,
                                m2l,
                                l2l,
-                               (AranLocal2ParticleFunc3d)l2p);
+                               l2p_func);
 
   if (semifar_threshold < G_MAXUINT)
     {
       aran_solver3d_set_functions_full (solver,
-                                        (AranParticle2ParticleFunc3d) p2p,
-                                        (AranParticle2MultipoleFunc3d) p2m,
+                                        p2p_func,
+                                        p2m_func,
                                         m2m,
                                         m2l,
                                         l2l,
-                                        (AranLocal2ParticleFunc3d) l2p,
-                                        (AranParticle2LocalFunc3d) p2l,
-                                        (AranMultipole2ParticleFunc3d) m2p,
+                                        l2p_func,
+                                        p2l_func,
+                                        m2p_func,
                                         semifar_threshold);
     }
 
+  aran_solver3d_set_adaptive_semifar (solver, adaptive_semifar);
+
+  if (roles)
+    aran_solver3d_set_roles (solver,
+                             (AranParticleRoleFunc3d) point_accum_role,
+                             (AranParticle2ParticleFunc3d) p2p_eval);
+
+  if (nthreads > 1)
+    aran_solver3d_set_threads (solver, nthreads);
+
+  if (virtual_maxbox != 0)
+    aran_solver3d_set_nf_isleaf (solver, _nf_isleaf_virtual_maxbox,
+                                 &virtual_maxbox);
+
+  if (prune)
+    aran_solver3d_set_prune (solver,
+                             (AranParticleWeightFunc3d) point_accum_weight,
+                             0.);
+
   _distribution (points, solver);
 
+  if (prune)
+    {
+      /* leave half of the domain without sources */
+      for (i=0; i<np; i ++)
+        if (points[i]->vector.x > 0.) points[i]->density = 0.;
+    }
+
+  if (mixed)
+    {
+      /* double precision near the root, single precision below */
+      wide_depth = aran_development3df_mixed_depth (err_lim, order,
+                                                    aran_solver3d_depth (solver));
+
+      aran_solver3d_set_node_zero (solver,
+                                   (AranNodeZeroFunc3d)
+                                   aran_development3df_mixed_zero,
+                                   &wide_depth);
+    }
+
 
 /*    g_printerr ("ok depth = %d size = %d\n", */
 /*                aran_solver3d_depth (solver), */
 /*                aran_solver3d_point_count (solver)); */
 
   if (direct) _direct (points, np);
+  else if (far_period > 1)
+    {
+      aran_solver3d_set_far_period (solver, far_period);
+
+      aran_solver3d_solve (solver);
+
+      if (far_move > 0.)
+        aran_solver3d_update_positions (solver,
+                                        (AranParticleMoveFunc3d) _far_move,
+                                        NULL);
+
+      /* second solve reuses the far field of the first one */
+      for (i=0; i<np; i ++)
+        points[i]->accum = 0.;
+
+      aran_solver3d_solve (solver);
+
+      if (far_move > 0.)
+        {
+          gcomplex128 *reused = g_malloc (np * sizeof (gcomplex128));
+
+          /* compare with a complete solve at the new positions */
+          for (i=0; i<np; i ++)
+            {
+              reused[i] = points[i]->accum;
+              points[i]->accum = 0.;
+            }
+
+          aran_solver3d_set_far_period (solver, 1);
+          aran_solver3d_solve (solver);
+
+          for (i=0; i<np; i ++)
+            {
+              gcomplex128 err;
+
+              if (roles &&
+                  ! (point_accum_role (points[i]) & ARAN_PARTICLE_TARGET))
+                continue;
+
+              err = (reused[i] - points[i]->accum) /
+                MAX (cabs (reused[i]), cabs (points[i]->accum));
+
+              if (cabs (err) > err_lim || !finite (cabs (err)))
+                {
+                  g_printerr ("Error: reused far field %u (%e,%e)\n", i,
+                              creal (err), cimag (err));
+                  ret ++;
+                }
+            }
+
+          g_free (reused);
+        }
+    }
   else aran_solver3d_solve (solver);
 
 /*   vsg_prtree3d_write (prtree, stderr); */
 
+  /* before evaluation points add their own calls */
+  if (stats_file != NULL)
+    ret += _check_calls (solver);
+
   if (verbose)
     {
       glong zero_count, p2p_count, p2m_count, m2m_count;
@@ -673,6 +1420,103 @@ int main (int argc, char **argv)
       g_printerr ("m2p count=%ld\n", m2p_count);
     }
 
+  if (neval > 0 && ! direct)
+    {
+      PointAccum *queries = g_malloc0 (neval * sizeof (PointAccum));
+      VsgPoint3 *qpoints = g_malloc (neval * sizeof (VsgPoint3));
+      guint evaluated;
+
+      for (i=0; i<neval; i++)
+        {
+          queries[i].vector.x = g_random_double_range (-R, R);
+          queries[i].vector.y = g_random_double_range (-R, R);
+          queries[i].vector.z = g_random_double_range (-R, R);
+          qpoints[i] = &queries[i];
+        }
+
+      evaluated =
+        aran_solver3d_evaluate_points (solver, qpoints, neval,
+                                       (AranParticle2ParticleFunc3d) p2p_eval,
+                                       NULL);
+
+      if (evaluated != neval)
+        {
+          g_printerr ("Error: %u evaluated points out of %u\n",
+                      evaluated, neval);
+          ret ++;
+        }
+
+      for (i=0; i<neval; i++)
+        {
+          guint j;
+          gcomplex128 sum = 0.;
+          gcomplex128 err;
+
+          for (j=0; j<np; j++)
+            {
+              VsgVector3d tmp;
+
+              vsg_vector3d_sub (&queries[i].vector, &points[j]->vector, &tmp);
+              sum += points[j]->density / vsg_vector3d_norm (&tmp);
+            }
+
+          err = (queries[i].accum - sum) /
+            MAX (cabs (queries[i].accum), cabs (sum));
+
+          if (cabs (err) > err_lim || !finite (cabs (err)))
+            {
+              g_printerr ("Error: query %u (%e,%e): (%e,%e)!=(%e,%e)\n", i,
+                          creal (err), cimag (err),
+                          creal (queries[i].accum), cimag (queries[i].accum),
+                          creal (sum), cimag (sum));
+              ret ++;
+            }
+        }
+
+      g_free (qpoints);
+      g_free (queries);
+    }
+
+  if (stats_file != NULL)
+    {
+      AranStats *stats = aran_solver3d_peek_stats (solver);
+      guint depth = aran_stats_get_depth (stats);
+      AranStatsOperator op;
+      FILE *file;
+
+      /* per level breakdowns must sum up to operators totals */
+      for (op=0; op<ARAN_STATS_OPERATOR_COUNT; op++)
+        {
+          glong count, level_count, sum = 0;
+          guint l;
+
+          aran_stats_get_operator (stats, op, &count, NULL);
+
+          for (l=0; l<depth; l++)
+            {
+              aran_stats_get_level_operator (stats, l, op, &level_count, NULL);
+              sum += level_count;
+            }
+
+          if (sum != count)
+            {
+              g_printerr ("Error: %s level counts sum %ld != %ld\n",
+                          aran_stats_operator_name (op), sum, count);
+              ret ++;
+            }
+        }
+
+      file = fopen (stats_file, "w");
+      aran_stats_write_json (stats, file);
+      fclose (file);
+
+      if (! _json_check (stats_file))
+        {
+          g_printerr ("Error: invalid JSON in %s\n", stats_file);
+          ret ++;
+        }
+    }
+
   aran_solver3d_free (solver);
 
   if (check)
@@ -683,8 +1527,25 @@ int main (int argc, char **argv)
 	  gcomplex128 sum = 0.;
 	  gcomplex128 err;
 
+	  if (roles && ! (point_accum_role (points[i]) & ARAN_PARTICLE_TARGET))
+	    {
+	      /* pure sources must not receive anything */
+	      if (points[i]->accum != 0.)
+		{
+		  g_printerr ("Error: source pt%u received (%e,%e)\n", i,
+			      creal (points[i]->accum),
+			      cimag (points[i]->accum));
+		  ret ++;
+		}
+	      continue;
+	    }
+
 	  for (j=0; j<np; j++)
 	    {
+	      if (roles &&
+		  ! (point_accum_role (points[j]) & ARAN_PARTICLE_SOURCE))
+		continue;
+
 	      if (i != j)
 		{
 		  VsgVector3d tmp;
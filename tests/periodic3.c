@@ -0,0 +1,451 @@
+/* LIBARAN - Fast Multipole Method library
+ * Copyright (C) 2006-2007 Pierre Gay
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "aran-config.h"
+
+#include <stdlib.h>
+
+#include <math.h>
+
+#include "aran/aran.h"
+#include "aran/aransolver3d.h"
+
+/* periodic cell size */
+#define TR (1.)
+
+/* Ewald splitting parameter and reciprocal space cutoff */
+#define EWALD_ALPHA (5.6)
+#define EWALD_KMAX (11)
+
+typedef struct _PointAccum PointAccum;
+
+struct _PointAccum
+{
+  VsgVector3d vector;
+
+  gdouble density;
+
+  gcomplex128 accum;
+
+  guint id;
+};
+
+static guint np = 200;
+static guint order = 10;
+static guint maxbox = 10;
+static guint levels = 4;
+static gdouble err_lim = 1.E-4;
+static gboolean check = TRUE;
+static guint semifar_threshold = G_MAXUINT;
+static guint solves = 1;
+
+void p2p (PointAccum *one, PointAccum *other)
+{
+  if (one != other)
+    {
+      VsgVector3d tmp;
+      gdouble inv_r;
+
+      vsg_vector3d_sub (&one->vector, &other->vector, &tmp);
+
+      inv_r = 1. / vsg_vector3d_norm (&tmp);
+
+      one->accum += inv_r * other->density;
+      other->accum += inv_r * one->density;
+    }
+}
+
+/* one way interaction with a periodic image of src */
+void p2p_shift (PointAccum *src, const VsgVector3d *shift, PointAccum *dst)
+{
+  VsgVector3d tmp;
+
+  vsg_vector3d_add (&src->vector, shift, &tmp);
+  vsg_vector3d_sub (&dst->vector, &tmp, &tmp);
+
+  dst->accum += src->density / vsg_vector3d_norm (&tmp);
+}
+
+void p2m (PointAccum *particle, const VsgPRTree3dNodeInfo *dst_node,
+          AranDevelopment3d *dst)
+{
+  aran_development3d_p2m (&particle->vector, particle->density, dst_node,
+                          dst);
+}
+
+void l2p (const VsgPRTree3dNodeInfo *devel_node, AranDevelopment3d *devel,
+          PointAccum *particle)
+{
+  particle->accum += aran_development3d_local_evaluate (devel_node, devel,
+							&particle->vector);
+}
+
+void p2l (PointAccum *particle, const VsgPRTree3dNodeInfo *dst_node,
+          AranDevelopment3d *dst)
+{
+  aran_development3d_p2l (&particle->vector, particle->density, dst_node, dst);
+}
+
+void m2p (const VsgPRTree3dNodeInfo *devel_node, AranDevelopment3d *devel,
+          PointAccum *particle)
+{
+  particle->accum += aran_development3d_multipole_evaluate (devel_node, devel,
+                                                            &particle->vector);
+}
+
+void dipole (PointAccum *particle, const VsgVector3d *origin,
+             VsgVector3d *dipole)
+{
+  VsgVector3d tmp;
+
+  vsg_vector3d_sub (&particle->vector, origin, &tmp);
+  vsg_vector3d_scalp (&tmp, particle->density, &tmp);
+  vsg_vector3d_add (dipole, &tmp, dipole);
+}
+
+/* removes the surface term: tin foil boundary conditions */
+void dipole_correction (PointAccum *particle, const VsgVector3d *origin,
+                        const VsgVector3d *dipole, gdouble volume)
+{
+  VsgVector3d tmp;
+
+  vsg_vector3d_sub (&particle->vector, origin, &tmp);
+
+  particle->accum -= 4. * G_PI / (3. * volume) *
+    vsg_vector3d_dotp (dipole, &tmp);
+}
+
+/* Ewald summation with tin foil boundary conditions */
+static void _ewald (PointAccum **points, guint n, gdouble *result)
+{
+  gdouble alpha = EWALD_ALPHA;
+  gdouble volume = TR * TR * TR;
+  guint i, j;
+  gint a, b, c;
+
+  for (i=0; i<n; i++)
+    result[i] = - 2. * alpha / sqrt (G_PI) * points[i]->density;
+
+  /* real space: the cell and its neighbors */
+  for (i=0; i<n; i++)
+    for (j=0; j<n; j++)
+      for (a=-1; a<=1; a++)
+        for (b=-1; b<=1; b++)
+          for (c=-1; c<=1; c++)
+            {
+              VsgVector3d d;
+              gdouble r;
+
+              if (i == j && a == 0 && b == 0 && c == 0) continue;
+
+              d.x = points[i]->vector.x - points[j]->vector.x - a * TR;
+              d.y = points[i]->vector.y - points[j]->vector.y - b * TR;
+              d.z = points[i]->vector.z - points[j]->vector.z - c * TR;
+
+              r = vsg_vector3d_norm (&d);
+
+              result[i] += points[j]->density * erfc (alpha * r) / r;
+            }
+
+  /* reciprocal space */
+  for (a=-EWALD_KMAX; a<=EWALD_KMAX; a++)
+    for (b=-EWALD_KMAX; b<=EWALD_KMAX; b++)
+      for (c=-EWALD_KMAX; c<=EWALD_KMAX; c++)
+        {
+          VsgVector3d k;
+          gdouble k2, factor, sre = 0., sim = 0.;
+
+          if (a == 0 && b == 0 && c == 0) continue;
+
+          vsg_vector3d_set (&k, 2. * G_PI * a / TR, 2. * G_PI * b / TR,
+                            2. * G_PI * c / TR);
+          k2 = vsg_vector3d_dotp (&k, &k);
+          factor = 4. * G_PI / volume * exp (- k2 / (4. * alpha * alpha)) / k2;
+
+          for (j=0; j<n; j++)
+            {
+              gdouble phase = vsg_vector3d_dotp (&k, &points[j]->vector);
+
+              sre += points[j]->density * cos (phase);
+              sim += points[j]->density * sin (phase);
+            }
+
+          for (i=0; i<n; i++)
+            {
+              gdouble phase = vsg_vector3d_dotp (&k, &points[i]->vector);
+
+              result[i] += factor * (cos (phase) * sre + sin (phase) * sim);
+            }
+        }
+}
+
+static void _mean_remove (gdouble *values, guint n)
+{
+  gdouble mean = 0.;
+  guint i;
+
+  for (i=0; i<n; i++)
+    mean += values[i];
+
+  mean /= n;
+
+  for (i=0; i<n; i++)
+    values[i] -= mean;
+}
+
+void parse_args (int argc, char **argv)
+{
+  int iarg = 1;
+  char *arg;
+
+  while (iarg < argc)
+    {
+      arg = argv[iarg];
+
+      if (g_ascii_strcasecmp (arg, "-np") == 0)
+	{
+	  guint tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (sscanf (arg, "%u", &tmp) == 1 && tmp > 1)
+            np = tmp;
+	  else
+	    g_printerr ("Invalid particles number (-np %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-pr") == 0)
+	{
+	  guint tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (sscanf (arg, "%u", &tmp) == 1)
+            order = tmp;
+	  else
+	    g_printerr ("Invalid precision order value (-pr %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-s") == 0)
+	{
+	  guint tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (sscanf (arg, "%u", &tmp) == 1 && tmp > 0)
+            maxbox = tmp;
+	  else
+	    g_printerr ("Invalid maximum box size value (-s %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-levels") == 0)
+	{
+	  guint tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (sscanf (arg, "%u", &tmp) == 1)
+            levels = tmp;
+	  else
+	    g_printerr ("Invalid lattice levels value (-levels %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-err") == 0)
+	{
+	  gdouble tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (sscanf (arg, "%lf", &tmp) == 1 && tmp > 0.)
+            err_lim = tmp;
+	  else
+	    g_printerr ("Invalid error limit value (-err %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-semifar") == 0)
+	{
+	  guint tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (arg != NULL && sscanf (arg, "%u", &tmp) == 1)
+            semifar_threshold = tmp;
+	  else
+	    g_printerr ("Invalid semifar threshold (-semifar %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-solves") == 0)
+	{
+	  guint tmp = 0;
+	  iarg ++;
+
+	  arg = (iarg<argc) ? argv[iarg] : NULL;
+
+	  if (arg != NULL && sscanf (arg, "%u", &tmp) == 1 && tmp > 0)
+            solves = tmp;
+	  else
+	    g_printerr ("Invalid solves number (-solves %s)\n", arg);
+	}
+      else if (g_ascii_strcasecmp (arg, "-nocheck") == 0)
+	{
+	  check = FALSE;
+	}
+      else if (g_ascii_strcasecmp (arg, "--version") == 0)
+	{
+	  g_printerr ("%s version %s\n", argv[0], PACKAGE_VERSION);
+	  exit (0);
+	}
+      else
+	{
+	  g_printerr ("Invalid argument \"%s\"\n", arg);
+	}
+
+      iarg ++;
+    }
+}
+
+int main (int argc, char **argv)
+{
+  VsgVector3d lbound = {0., 0., 0.};
+  VsgVector3d ubound = {TR, TR, TR};
+  VsgPRTree3d *prtree;
+  AranSolver3d *solver;
+  PointAccum *points;
+  PointAccum **ptrs;
+  gdouble *ref = NULL, *res = NULL;
+  gdouble total = 0., maxerr = 0., maxref = 0.;
+  GRand *rand;
+  int ret = 0;
+  guint i, s;
+
+  aran_init ();
+
+  parse_args (argc, argv);
+
+  rand = g_rand_new_with_seed (12345);
+
+  points = g_malloc (np * sizeof (PointAccum));
+  ptrs = g_malloc (np * sizeof (PointAccum *));
+
+  /* globally neutral random charges */
+  for (i=0; i<np; i++)
+    {
+      vsg_vector3d_set (&points[i].vector,
+                        g_rand_double_range (rand, 0., TR),
+                        g_rand_double_range (rand, 0., TR),
+                        g_rand_double_range (rand, 0., TR));
+      points[i].density = (i+1 < np) ?
+        g_rand_double_range (rand, -1., 1.) : - total;
+      points[i].accum = 0.;
+      points[i].id = i;
+
+      total += points[i].density;
+      ptrs[i] = &points[i];
+    }
+
+  prtree =
+    vsg_prtree3d_new_full (&lbound, &ubound,
+                           (VsgPoint3dLocFunc) vsg_vector3d_vector3d_locfunc,
+                           (VsgPoint3dDistFunc) vsg_vector3d_dist,
+                           (VsgRegion3dLocFunc) NULL, maxbox);
+
+  solver = aran_solver3d_new (prtree, ARAN_TYPE_DEVELOPMENT3D,
+                              aran_development3d_new (0, order),
+                              (AranZeroFunc) aran_development3d_set_zero);
+
+  /* with m2p and p2l, periodic images of leaves of different sizes may
+   * interact without refinement */
+  aran_solver3d_set_functions_full (solver,
+                                    (AranParticle2ParticleFunc3d) p2p,
+                                    (AranParticle2MultipoleFunc3d) p2m,
+                                    (AranMultipole2MultipoleFunc3d)
+                                    aran_development3d_m2m,
+                                    (AranMultipole2LocalFunc3d)
+                                    aran_development3d_m2l,
+                                    (AranLocal2LocalFunc3d)
+                                    aran_development3d_l2l,
+                                    (AranLocal2ParticleFunc3d) l2p,
+                                    (semifar_threshold < G_MAXUINT) ?
+                                    (AranParticle2LocalFunc3d) p2l : NULL,
+                                    (semifar_threshold < G_MAXUINT) ?
+                                    (AranMultipole2ParticleFunc3d) m2p : NULL,
+                                    semifar_threshold);
+
+  aran_solver3d_set_periodic (solver,
+                              (AranParticle2ParticleShiftFunc3d) p2p_shift,
+                              levels);
+  aran_solver3d_set_periodic_dipole (solver,
+                                     (AranParticleDipoleFunc3d) dipole,
+                                     (AranParticleDipoleCorrectionFunc3d)
+                                     dipole_correction);
+
+  for (i=0; i<np; i++)
+    aran_solver3d_insert_point (solver, &points[i]);
+
+  if (check)
+    {
+      ref = g_malloc (np * sizeof (gdouble));
+      res = g_malloc (np * sizeof (gdouble));
+
+      _ewald (ptrs, np, ref);
+      _mean_remove (ref, np);
+
+      for (i=0; i<np; i++)
+        maxref = MAX (maxref, fabs (ref[i]));
+    }
+
+  /* later solves go through the cached lattice sum */
+  for (s=0; s<solves; s++)
+    {
+      for (i=0; i<np; i++)
+        points[i].accum = 0.;
+
+      aran_solver3d_solve (solver);
+
+      if (! check) continue;
+
+      for (i=0; i<np; i++)
+        res[i] = creal (points[i].accum);
+
+      /* potentials are defined up to a constant */
+      _mean_remove (res, np);
+
+      maxerr = 0.;
+      for (i=0; i<np; i++)
+        maxerr = MAX (maxerr, fabs (res[i] - ref[i]));
+
+      if (maxerr > err_lim * maxref || ! finite (maxerr))
+        {
+          g_printerr ("Error: periodic potential error %e (reference %e) "
+                      "at solve %u\n", maxerr, maxref, s);
+          ret ++;
+        }
+    }
+
+  g_free (ref);
+  g_free (res);
+
+  aran_solver3d_free (solver);
+
+  g_rand_free (rand);
+  g_free (ptrs);
+  g_free (points);
+
+  return ret;
+}
@@ -25,6 +25,8 @@
 #include "aran/aranprofiledb.h"
 #include "aran/arandevelopment2d.h"
 #include "aran/arandevelopment3d.h"
+#include "aran/aransolver2d.h"
+#include "aran/aransolver3d.h"
 
 static gchar _filename[1024] = "profiledb-test.ini";
 static gchar _group[1024] = ARAN_PROFILE_DB_DEFAULT_GROUP;
@@ -104,6 +106,71 @@ static void _check_operator_profile (gpointer op, gchar *name)
 
 #define CHECK_OPERATOR_PROFILE(op) _check_operator_profile (op, #op)
 
+/* checks automatic configuration with the loaded profiles */
+static void _check_auto_config (gdouble epsilon, guint np)
+{
+  VsgVector2d lb2 = {-1., -1.};
+  VsgVector2d ub2 = {1., 1.};
+  VsgVector3d lb3 = {-1., -1., -1.};
+  VsgVector3d ub3 = {1., 1., 1.};
+  VsgPRTree2d *prtree2;
+  VsgPRTree3d *prtree3;
+  AranSolver2d *solver2;
+  AranSolver3d *solver3;
+  AranSolver2dConfig config2;
+  AranSolver3dConfig config3;
+
+  prtree2 =
+    vsg_prtree2d_new_full (&lb2, &ub2,
+                           (VsgPoint2dLocFunc) vsg_vector2d_vector2d_locfunc,
+                           (VsgPoint2dDistFunc) vsg_vector2d_dist,
+                           (VsgRegion2dLocFunc) NULL, 10);
+
+  solver2 = aran_solver2d_new (prtree2, ARAN_TYPE_DEVELOPMENT2D,
+                               aran_development2d_new (0, 1),
+                               (AranZeroFunc) aran_development2d_set_zero);
+
+  if (! aran_solver2d_auto_config (solver2, epsilon, np, &config2))
+    g_printerr ("Error: 2D auto configuration failed for epsilon=%g\n",
+                epsilon);
+  else if (config2.error > epsilon || config2.maxbox != 10 ||
+           config2.m2l == NULL || ! (config2.time > 0.))
+    g_printerr ("Error: bad 2D auto configuration for epsilon=%g " \
+                "(order=%u maxbox=%u error=%g time=%g)\n", epsilon,
+                config2.order, config2.maxbox, config2.error, config2.time);
+  else if (_verbose)
+    g_printerr ("2D auto configuration ok for epsilon=%g " \
+                "(order=%u maxbox=%u error=%g time=%g)\n", epsilon,
+                config2.order, config2.maxbox, config2.error, config2.time);
+
+  aran_solver2d_free (solver2);
+
+  prtree3 =
+    vsg_prtree3d_new_full (&lb3, &ub3,
+                           (VsgPoint3dLocFunc) vsg_vector3d_vector3d_locfunc,
+                           (VsgPoint3dDistFunc) vsg_vector3d_dist,
+                           (VsgRegion3dLocFunc) NULL, 10);
+
+  solver3 = aran_solver3d_new (prtree3, ARAN_TYPE_DEVELOPMENT3D,
+                               aran_development3d_new (0, 1),
+                               (AranZeroFunc) aran_development3d_set_zero);
+
+  if (! aran_solver3d_auto_config (solver3, epsilon, np, &config3))
+    g_printerr ("Error: 3D auto configuration failed for epsilon=%g\n",
+                epsilon);
+  else if (config3.error > epsilon || config3.maxbox != 10 ||
+           config3.m2l == NULL || ! (config3.time > 0.))
+    g_printerr ("Error: bad 3D auto configuration for epsilon=%g " \
+                "(order=%u maxbox=%u error=%g time=%g)\n", epsilon,
+                config3.order, config3.maxbox, config3.error, config3.time);
+  else if (_verbose)
+    g_printerr ("3D auto configuration ok for epsilon=%g " \
+                "(order=%u maxbox=%u error=%g time=%g)\n", epsilon,
+                config3.order, config3.maxbox, config3.error, config3.time);
+
+  aran_solver3d_free (solver3);
+}
+
 int main (int argc, char **argv)
 {
   int ret = 0;
@@ -129,6 +196,10 @@ int main (int argc, char **argv)
   CHECK_OPERATOR_PROFILE (aran_development3d_m2l);
   CHECK_OPERATOR_PROFILE (aran_development3d_l2l);
 
+  /* check automatic configuration (p2p unknown: maxbox is kept) */
+  _check_auto_config (1.e-3, 10000);
+  _check_auto_config (1.e-6, 10000);
+
   /* try to evaluate a bad symbol, check if response is correct */
   {
     gdouble x = aran_profile_db_address_eval (&ret, 1.);